@@ -0,0 +1,29 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/_asan/cli/cliWords.cpp.cpp" "cli/CMakeFiles/angortcli.dir/cliWords.cpp.cpp.o" "gcc" "cli/CMakeFiles/angortcli.dir/cliWords.cpp.cpp.o.d"
+  "/root/repo/_asan/cli/debtoks.cpp" "cli/CMakeFiles/angortcli.dir/debtoks.cpp.o" "gcc" "cli/CMakeFiles/angortcli.dir/debtoks.cpp.o.d"
+  "/root/repo/cli/debugger.cpp" "cli/CMakeFiles/angortcli.dir/debugger.cpp.o" "gcc" "cli/CMakeFiles/angortcli.dir/debugger.cpp.o.d"
+  "/root/repo/cli/main.cpp" "cli/CMakeFiles/angortcli.dir/main.cpp.o" "gcc" "cli/CMakeFiles/angortcli.dir/main.cpp.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_asan/cli/debtoks.h" "/root/repo/_asan/cli/debtoks.cpp"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_asan/lib/CMakeFiles/angort.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,28 @@
+/**
+ * @file deprecated.cpp
+ * @brief  Brief description of file.
+ *
+ */
+
+#include "angort.h"
+
+using namespace angort;
+
+namespace angort {
+}
+
+
+namespace _angortlib_ns_deprecated {
+
+static angort::WordDef _wordlist_[]={
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_deprecated 
+
+angort::LibraryDef _angortlib_deprecated = {
+    "deprecated",
+    _angortlib_ns_deprecated::_wordlist_,
+    _angortlib_ns_deprecated::_binoplist_,
+    NULL,NULL
+};
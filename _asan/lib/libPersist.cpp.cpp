@@ -0,0 +1,142 @@
+#include "angort.h"
+#include "hash.h"
+
+
+using namespace angort;
+
+namespace _angortlib_ns_persist {
+
+static void _word__vec(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    Value in;
+    in.copy(p0);
+    Iterator<Value *> *iter = in.t->makeIterator(&in);
+    PVecObject *o = Types::tPVec->set(a->pushval());
+    try {
+        for(iter->first();!iter->isDone();iter->next())
+            o->append(iter->current());
+    } catch(Exception& e){
+        delete iter;
+        throw;
+    }
+    delete iter;
+}
+
+static void _word__map(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    Value in;
+    in.copy(p0);
+    Hash *h = Types::tHash->get(&in);
+    PMapObject *o = Types::tPMap->set(a->pushval());
+    ReadLock lock(h);
+    for(int i=h->nextUsed(0);i>=0;i=h->nextUsed(i+1))
+        o->put(h->keyAt(i),h->valAt(i));
+}
+
+static void _word__push(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    PVecObject *o = Types::tPVec->get(p1)->push(p0);
+    Types::tPVec->set(a->pushval(),o);
+}
+
+static void _word__pop(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    PVecObject *o = Types::tPVec->get(p0)->pop();
+    Types::tPVec->set(a->pushval(),o);
+}
+
+static void _word__set(angort::Runtime *a)
+{
+Value *_parms[3];
+a->popParams(_parms,"vvv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+Value * p2 = _parms[2];
+    if(p2->t == Types::tPVec){
+        PVecObject *o = Types::tPVec->get(p2)->set(p1->toInt(),p0);
+        Types::tPVec->set(a->pushval(),o);
+    } else {
+        PMapObject *o = Types::tPMap->get(p2)->set(p1,p0);
+        Types::tPMap->set(a->pushval(),o);
+    }
+}
+
+static void _word__del(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    PMapObject *o = Types::tPMap->get(p1)->del(p0);
+    if(o)
+        Types::tPMap->set(a->pushval(),o);
+    else
+        a->pushval()->copy(p1);
+}
+
+static void _word__tolist(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    Value in;
+    in.copy(p0);
+    PVecObject *o = Types::tPVec->get(&in);
+    ArrayList<Value> *list = Types::tList->set(a->pushval(),o->count);
+    WriteLock lock=WL(list);
+    for(int i=0;i<o->count;i++)
+        list->append()->copy(o->get(i));
+}
+
+static void _word__tohash(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    Value in;
+    in.copy(p0);
+    PMapObject *o = Types::tPMap->get(&in);
+    Hash *h = Types::tHash->set(a->pushval());
+    WriteLock lock=WL(h);
+    h->reserve(o->count);
+    Iterator<Value *> *iter = o->makeKeyIterator();
+    Iterator<Value *> *viter = o->makeValueIterator();
+    viter->first();
+    for(iter->first();!iter->isDone();iter->next(),viter->next())
+        h->set(iter->current(),viter->current());
+    delete iter;
+    delete viter;
+}
+static angort::WordDef _wordlist_[]={
+    {"vec","(iterable -- pvec) make a persistent vector holding the items of an iterable",_word__vec},
+    {"map","(hash -- pmap) make a persistent map holding the keys and values of a hash",_word__map},
+    {"push","(item pvec -- pvec) a new vector with an item added to the end",_word__push},
+    {"pop","(pvec -- pvec) a new vector with the last item removed\n Throws ex$outofrange if the vector is empty.",_word__pop},
+    {"set","(val key coll -- coll) a new vector or map with an item set\n For a vector, the key can be the length of the vector, which adds\n the item to the end; any other index out of range throws ex$outofrange.",_word__set},
+    {"del","(key pmap -- pmap) a new map without a key\n If the key isn't in the map, the same map is returned.",_word__del},
+    {"tolist","(pvec -- list) make a new list holding the items of a vector",_word__tolist},
+    {"tohash","(pmap -- hash) make a new hash holding the keys and values of a map",_word__tohash},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_persist 
+
+angort::LibraryDef _angortlib_persist = {
+    "persist",
+    _angortlib_ns_persist::_wordlist_,
+    _angortlib_ns_persist::_binoplist_,
+    NULL,NULL
+};
@@ -0,0 +1,466 @@
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "angort.h"
+#include "hash.h"
+#include "wrappers.h"
+
+
+using namespace angort;
+
+template <class F,class T> static void eachInArray(ArrayList<T> *list,F& f){
+    ReadLock lock(list);
+    int n = list->count();
+    if(n){
+        T *p = list->get(0);
+        for(int i=0;i<n;i++)
+            f((double)p[i]);
+    }
+}
+
+/// call f(x) for each number x in a list, range, numeric vector or
+/// other iterable, as a double.
+template <class F> static void eachNumber(Value *v,F& f){
+    const Type *t = v->t;
+    if(t == Types::tList){
+        ArrayList<Value> *list = Types::tList->get(v);
+        ReadLock lock(list);
+        int n = list->count();
+        for(int i=0;i<n;i++)
+            f(list->get(i)->toDouble());
+    } else if(t == Types::tI32)
+        eachInArray(Types::tI32->get(v),f);
+    else if(t == Types::tI64)
+        eachInArray(Types::tI64->get(v),f);
+    else if(t == Types::tF32)
+        eachInArray(Types::tF32->get(v),f);
+    else if(t == Types::tF64)
+        eachInArray(Types::tF64->get(v),f);
+    else if(t == Types::tIRange){
+        Range<int> *r = v->v.irange;
+        if(r->step>0){
+            for(int i=r->start;i<r->end;i+=r->step)f(i);
+        } else if(r->step<0){
+            for(int i=r->start;i>r->end;i+=r->step)f(i);
+        }
+    } else if(t == Types::tFRange){
+        Range<float> *r = v->v.frange;
+        if(r->step>0){
+            for(float i=r->start;i<r->end;i+=r->step)f(i);
+        } else if(r->step<0){
+            for(float i=r->start;i>r->end;i+=r->step)f(i);
+        }
+    } else {
+        Value in;
+        in.copy(v);
+        Iterator<Value *> *iter = in.t->makeIterator(&in);
+        try {
+            for(iter->first();!iter->isDone();iter->next())
+                f(iter->current()->toDouble());
+        } catch(Exception& e){
+            delete iter;
+            throw;
+        }
+        delete iter;
+    }
+}
+
+/// a running count, mean, variance, minimum and maximum, using
+/// Welford's method so that the variance is accurate even when the
+/// mean is large.
+struct StatsAcc {
+    long n;
+    double mean;
+    double m2; //!< sum of squared differences from the mean
+    double min,max;
+
+    StatsAcc(){
+        reset();
+    }
+    void reset(){
+        n=0;
+        mean=m2=0;
+        min=max=0;
+    }
+    void operator()(double x){
+        n++;
+        double d = x-mean;
+        mean += d/n;
+        m2 += d*(x-mean);
+        if(n==1 || x<min)min=x;
+        if(n==1 || x>max)max=x;
+    }
+
+    /// merge another accumulator into this one
+    void merge(const StatsAcc& b){
+        if(!b.n)return;
+        if(!n){
+            *this = b;
+            return;
+        }
+        long nn = n+b.n;
+        double d = b.mean-mean;
+        mean += d*b.n/nn;
+        m2 += b.m2 + d*d*((double)n*b.n/nn);
+        if(b.min<min)min=b.min;
+        if(b.max>max)max=b.max;
+        n = nn;
+    }
+
+    /// population variance, or NAN if there is no data
+    double popvar() const {
+        return n ? m2/n : NAN;
+    }
+    /// sample variance, or NAN if there are fewer than two items
+    double sampvar() const {
+        return n>1 ? m2/(n-1) : NAN;
+    }
+};
+
+/// collects numbers into a malloced array of doubles
+struct Collector {
+    double *data;
+    int n,cap;
+
+    Collector(){
+        n=0;cap=1024;
+        data = (double *)malloc(cap*sizeof(double));
+    }
+    ~Collector(){
+        free(data);
+    }
+    void operator()(double x){
+        if(n==cap){
+            cap*=2;
+            data = (double *)realloc(data,cap*sizeof(double));
+        }
+        data[n++]=x;
+    }
+};
+
+// push a double, or none if it's NAN because there was no data
+static void pushResult(Runtime *a,double d){
+    if(isnan(d))
+        a->pushNone();
+    else
+        a->pushDouble(d);
+}
+
+/// The pth percentile (0-100) of some numbers, which will be reordered,
+/// interpolating linearly between the two nearest ranks. Only items
+/// from start onwards are touched: all those before it must be no
+/// greater than any after it, so percentiles can be found in ascending
+/// order without going over the same ground.
+static double percentile(double *data,int n,double p,int *start){
+    if(p<0 || p>100)
+        throw RUNT(EX_BADPARAM,"").set("percentile out of range: %f",p);
+    double h = (n-1)*p/100.0;
+    int k = (int)floor(h);
+    if(k<*start)k=*start; // shouldn't happen, but be careful
+    std::nth_element(data+*start,data+k,data+n);
+    *start=k;
+    double r = data[k];
+    double frac = h-k;
+    if(frac>0 && k+1<n){
+        // the next item up is the smallest of those after k
+        double next = *std::min_element(data+k+1,data+n);
+        r += frac*(next-r);
+    }
+    return r;
+}
+
+/// counts numbers into equal-width bins
+struct Binner {
+    double min,max,scale;
+    int nbins;
+    int *bins;
+    Binner(double mn,double mx,int n){
+        min=mn;max=mx;nbins=n;
+        scale = n/(mx-mn);
+        bins = new int[n];
+        for(int i=0;i<n;i++)bins[i]=0;
+    }
+    ~Binner(){
+        delete [] bins;
+    }
+    void operator()(double x){
+        if(x>=min && x<=max){
+            int b = (int)((x-min)*scale);
+            if(b>=nbins)b=nbins-1; // x==max goes in the last bin
+            bins[b]++;
+        }
+    }
+};
+
+/// sorts indices into an array of doubles
+struct IndexCmp {
+    const double *d;
+    IndexCmp(const double *dd){d=dd;}
+    bool operator()(int x,int y) const {
+        return d[x]<d[y];
+    }
+};
+
+namespace _angortlib_ns_stat {
+
+// the accumulator type, which wraps a StatsAcc
+static BasicWrapperType<StatsAcc> tAcc("SACC");
+
+
+static void _word__mean(angort::Runtime *a){
+    StatsAcc s;
+    eachNumber(a->popval(),s);
+    pushResult(a,s.n ? s.mean : NAN);
+}
+
+static void _word__popvariance(angort::Runtime *a){
+    StatsAcc s;
+    eachNumber(a->popval(),s);
+    pushResult(a,s.popvar());
+}
+
+static void _word__sampvariance(angort::Runtime *a){
+    StatsAcc s;
+    eachNumber(a->popval(),s);
+    pushResult(a,s.sampvar());
+}
+
+static void _word__popsd(angort::Runtime *a){
+    StatsAcc s;
+    eachNumber(a->popval(),s);
+    pushResult(a,sqrt(s.popvar()));
+}
+
+static void _word__sampsd(angort::Runtime *a){
+    StatsAcc s;
+    eachNumber(a->popval(),s);
+    pushResult(a,sqrt(s.sampvar()));
+}
+
+static void _word__median(angort::Runtime *a){
+    Collector c;
+    eachNumber(a->popval(),c);
+    int start=0;
+    pushResult(a,c.n ? percentile(c.data,c.n,50,&start) : NAN);
+}
+
+static void _word__percentile(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vd");
+Value * p0 = _parms[0];
+double p1 = _parms[1]->toDouble();
+    Collector c;
+    eachNumber(p0,c);
+    int start=0;
+    pushResult(a,c.n ? percentile(c.data,c.n,p1,&start) : NAN);
+}
+
+static void _word__percentiles(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vl");
+Value * p0 = _parms[0];
+ArrayList<Value> *p1 = Types::tList->get(_parms[1]);
+    Collector c;
+    eachNumber(p0,c);
+
+    int np = p1->count();
+    // sort the indices of the percentiles so we can find them in order
+    int *order = new int[np];
+    double *ps = new double[np];
+    for(int i=0;i<np;i++){
+        order[i]=i;
+        ps[i]=p1->get(i)->toDouble();
+    }
+    std::sort(order,order+np,IndexCmp(ps));
+
+    double *res = new double[np];
+    try {
+        int start=0;
+        for(int i=0;i<np;i++){
+            int j=order[i];
+            res[j] = c.n ? percentile(c.data,c.n,ps[j],&start) : NAN;
+        }
+    } catch(Exception& e){
+        delete [] order;delete [] ps;delete [] res;
+        throw;
+    }
+
+    ArrayList<Value> *list = Types::tList->set(a->pushval());
+    for(int i=0;i<np;i++){
+        Value *v = list->append();
+        if(!isnan(res[i]))
+            Types::tDouble->set(v,res[i]);
+    }
+    delete [] order;delete [] ps;delete [] res;
+}
+
+static void _word__histogram(angort::Runtime *a)
+{
+Value *_parms[4];
+a->popParams(_parms,"vddi");
+Value * p0 = _parms[0];
+double p1 = _parms[1]->toDouble();
+double p2 = _parms[2]->toDouble();
+int p3 = _parms[3]->toInt();
+    if(p3<1)
+        throw RUNT(EX_BADPARAM,"").set("bad bin count: %d",p3);
+    if(!(p2>p1))
+        throw RUNT(EX_BADPARAM,"histogram max must be greater than min");
+
+    Binner b(p1,p2,p3);
+    eachNumber(p0,b);
+    ArrayList<Value> *list = Types::tList->set(a->pushval());
+    for(int i=0;i<p3;i++)
+        Types::tInteger->set(list->append(),b.bins[i]);
+}
+
+// get two sets of numbers of the same length for covariance
+static void getPairs(Value *x,Value *y,Collector& cx,Collector& cy){
+    eachNumber(x,cx);
+    eachNumber(y,cy);
+    if(cx.n!=cy.n)
+        throw RUNT(EX_BADPARAM,"").set("different lengths: %d and %d",cx.n,cy.n);
+}
+
+// sample covariance of two sets of numbers, returning the sample
+// variances too if required
+static double covariance(Collector& cx,Collector& cy,double *vx=NULL,double *vy=NULL){
+    int n = cx.n;
+    if(n<2)return NAN;
+    double mx=0,my=0;
+    for(int i=0;i<n;i++){
+        mx+=cx.data[i];
+        my+=cy.data[i];
+    }
+    mx/=n;my/=n;
+    double sxy=0,sxx=0,syy=0;
+    for(int i=0;i<n;i++){
+        double dx = cx.data[i]-mx;
+        double dy = cy.data[i]-my;
+        sxy+=dx*dy;
+        sxx+=dx*dx;
+        syy+=dy*dy;
+    }
+    if(vx)*vx=sxx/(n-1);
+    if(vy)*vy=syy/(n-1);
+    return sxy/(n-1);
+}
+
+static void _word__covariance(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    Collector cx,cy;
+    getPairs(p0,p1,cx,cy);
+    pushResult(a,covariance(cx,cy));
+}
+
+static void _word__correlation(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    Collector cx,cy;
+    getPairs(p0,p1,cx,cy);
+    double vx,vy;
+    double c = covariance(cx,cy,&vx,&vy);
+    pushResult(a,isnan(c) ? c : c/sqrt(vx*vy));
+}
+
+static void _word__acc(angort::Runtime *a){
+    tAcc.set(a->pushval(),StatsAcc());
+}
+
+static void _word__add(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"dA",&tAcc);
+double p0 = _parms[0]->toDouble();
+StatsAcc *p1 = tAcc.get(_parms[1]);
+    (*p1)(p0);
+}
+
+static void _word__addall(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vA",&tAcc);
+Value * p0 = _parms[0];
+StatsAcc *p1 = tAcc.get(_parms[1]);
+    eachNumber(p0,*p1);
+}
+
+static void _word__merge(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"AB",&tAcc,&tAcc);
+StatsAcc *p0 = tAcc.get(_parms[0]);
+StatsAcc *p1 = tAcc.get(_parms[1]);
+    p1->merge(*p0);
+}
+
+static void _word__reset(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"A",&tAcc);
+StatsAcc *p0 = tAcc.get(_parms[0]);
+    p0->reset();
+}
+
+static void _word__get(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"A",&tAcc);
+StatsAcc *p0 = tAcc.get(_parms[0]);
+    Hash *h = Types::tHash->set(a->pushval());
+    h->setSymInt("count",p0->n);
+    Value v;
+    if(p0->n){
+        h->setSymDouble("mean",p0->mean);
+        h->setSymDouble("popvariance",p0->popvar());
+        h->setSymDouble("min",p0->min);
+        h->setSymDouble("max",p0->max);
+    } else {
+        h->setSym("mean",&v);
+        h->setSym("popvariance",&v);
+        h->setSym("min",&v);
+        h->setSym("max",&v);
+    }
+    if(p0->n>1)
+        h->setSymDouble("sampvariance",p0->sampvar());
+    else
+        h->setSym("sampvariance",&v);
+}
+static angort::WordDef _wordlist_[]={
+    {"mean","(iterable -- mean) the mean of a list, range or vector of numbers\n Returns none if there are no numbers.",_word__mean},
+    {"popvariance","(iterable -- var) the population variance of some numbers",_word__popvariance},
+    {"sampvariance","(iterable -- var) the sample variance of some numbers\n Returns none if there are fewer than two numbers.",_word__sampvariance},
+    {"popsd","(iterable -- sd) the population standard deviation of some numbers",_word__popsd},
+    {"sampsd","(iterable -- sd) the sample standard deviation of some numbers",_word__sampsd},
+    {"median","(iterable -- median) the median of some numbers\n This is the mean of the two middle numbers if there is an even number of\n them, and none if there are no numbers. The input is not modified.",_word__median},
+    {"percentile","(iterable p -- x) the pth percentile (0-100) of some numbers\n Interpolates linearly between the two nearest ranks, as the median does\n (and as the default in R and numpy). Uses selection, so takes linear\n rather than n log n time. Returns none if there are no numbers.",_word__percentile},
+    {"percentiles","(iterable plist -- list) several percentiles of some numbers\n Like percentile, but finds all the percentiles in the list (which need\n not be in order) in one go, and returns them as a list in the same order.",_word__percentiles},
+    {"histogram","(iterable min max nbins -- list) count numbers into equal bins\n Returns a list of nbins counts, splitting [min,max] into nbins bins of\n equal width. Numbers equal to max go in the last bin, and those outside\n the range are not counted.",_word__histogram},
+    {"covariance","(x y -- cov) sample covariance of two sets of numbers\n The two sets must have the same number of items. Returns none if\n there are fewer than two.",_word__covariance},
+    {"correlation","(x y -- r) Pearson correlation coefficient of two sets of numbers\n The two sets must have the same number of items. Returns none if\n there are fewer than two.",_word__correlation},
+    {"acc","(-- acc) create a streaming statistics accumulator\n Numbers are added to the accumulator with stat$add or stat$addall, and\n stat$get returns the count, mean, variances, minimum and maximum of all\n the numbers added so far, without the numbers themselves being kept.",_word__acc},
+    {"add","(x acc --) add a number to an accumulator",_word__add},
+    {"addall","(iterable acc --) add all the numbers in a list, range or vector to an accumulator",_word__addall},
+    {"merge","(acc1 acc2 --) add all the numbers in acc1 to acc2\n Useful for combining accumulators built up in different threads.",_word__merge},
+    {"reset","(acc --) clear an accumulator",_word__reset},
+    {"get","(acc -- hash) get the statistics from an accumulator\n The hash has the keys count, mean, popvariance, sampvariance, min and\n max; those which can't be worked out from the numbers added are none.",_word__get},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_stat 
+
+angort::LibraryDef _angortlib_stat = {
+    "stat",
+    _angortlib_ns_stat::_wordlist_,
+    _angortlib_ns_stat::_binoplist_,
+    NULL,NULL
+};
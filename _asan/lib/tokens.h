@@ -0,0 +1,94 @@
+// Token list - generated by gentoks.py from /root/repo/lib/tokens
+
+#include "tokeniser.h"
+namespace angort {
+extern TokenRegistry tokens[];
+#define	T_END	0
+#define	T_STRING	1
+#define	T_IDENT	2
+#define	T_INT	3
+#define	T_FLOAT	4
+#define	T_DOUBLE	5
+#define	T_LONG	6
+#define	T_NOTEQUAL	7
+#define	T_LE	8
+#define	T_GE	9
+#define	T_HASHGETSYMB	10
+#define	T_HASHSETSYMB	11
+#define	T_VARINC	12
+#define	T_VARDEC	13
+#define	T_DOUBLEANGLEOPEN	14
+#define	T_DOUBLEANGLECLOSE	15
+#define	T_DOUBLEQUERY	16
+#define	T_OCURLY	17
+#define	T_CCURLY	18
+#define	T_OPREN	19
+#define	T_CPREN	20
+#define	T_OSQB	21
+#define	T_CSQB	22
+#define	T_COMMA	23
+#define	T_LT	24
+#define	T_GT	25
+#define	T_EQUALS	26
+#define	T_ADD	27
+#define	T_DIV	28
+#define	T_SUB	29
+#define	T_MUL	30
+#define	T_SEMI	31
+#define	T_DOT	32
+#define	T_PLING	33
+#define	T_QUESTION	34
+#define	T_AT	35
+#define	T_COLON	36
+#define	T_HASH	37
+#define	T_AMPERSAND	38
+#define	T_PIPE	39
+#define	T_PERC	40
+#define	T_BACKTICK	41
+#define	T_IF	42
+#define	T_THEN	43
+#define	T_ELSE	44
+#define	T_LEAVE	45
+#define	T_DUP	46
+#define	T_CALL	47
+#define	T_GLOBAL	48
+#define	T_SWAP	49
+#define	T_DROP	50
+#define	T_NOT	51
+#define	T_AND	52
+#define	T_OR	53
+#define	T_IFLEAVE	54
+#define	T_CONST	55
+#define	T_OVER	56
+#define	T_EACH	57
+#define	T_INCLUDE	58
+#define	T_INCLUDEIFEXISTS	59
+#define	T_STOP	60
+#define	T_CMP	61
+#define	T_PACKAGE	62
+#define	T_REQUIRE	63
+#define	T_PRIVATE	64
+#define	T_PUBLIC	65
+#define	T_DEF	66
+#define	T_DEFCONST	67
+#define	T_RECURSE	68
+#define	T_SELF	69
+#define	T_COMPILEIF	70
+#define	T_ELSECOMPILEIF	71
+#define	T_ENDCOMPILEIF	72
+#define	T_CASES	73
+#define	T_CASE	74
+#define	T_OTHERWISE	75
+#define	T_SOURCELINE	76
+#define	T_YIELD	77
+#define	T_TRY	78
+#define	T_CATCH	79
+#define	T_CATCHALL	80
+#define	T_ENDTRY	81
+#define	T_THROW	82
+#define	T_INC	83
+#define	T_DEC	84
+#define	T_BRK	85
+#define	T_WITH	86
+#define	T_ENDWITH	87
+}
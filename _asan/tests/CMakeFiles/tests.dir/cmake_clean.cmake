@@ -0,0 +1,21 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/tests.dir/hash.cpp.o"
+  "CMakeFiles/tests.dir/hash.cpp.o.d"
+  "CMakeFiles/tests.dir/linetable.cpp.o"
+  "CMakeFiles/tests.dir/linetable.cpp.o.d"
+  "CMakeFiles/tests.dir/main.cpp.o"
+  "CMakeFiles/tests.dir/main.cpp.o.d"
+  "CMakeFiles/tests.dir/null.cpp.o"
+  "CMakeFiles/tests.dir/null.cpp.o.d"
+  "CMakeFiles/tests.dir/range.cpp.o"
+  "CMakeFiles/tests.dir/range.cpp.o.d"
+  "CMakeFiles/tests.dir/strview.cpp.o"
+  "CMakeFiles/tests.dir/strview.cpp.o.d"
+  "tests"
+  "tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
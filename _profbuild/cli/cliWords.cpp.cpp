@@ -0,0 +1,49 @@
+/**
+ * @file cliWords.cpp
+ * @brief  Brief description of file.
+ *
+ */
+
+#include "angort.h"
+
+
+
+using namespace angort;
+
+extern Value strippedArgVal;
+Value promptCallback;
+
+extern void cliShutdown();
+
+namespace _angortlib_ns_cli {
+
+static void _word__prompt(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"C");
+Value * p0 = _parms[0];
+    promptCallback.copy(p0);
+}
+
+static void _word__args(angort::Runtime *a){
+    a->pushval()->copy(&strippedArgVal);
+}
+    
+static void __shutdown__(angort::Runtime *a)
+{
+    cliShutdown();
+}
+static angort::WordDef _wordlist_[]={
+    {"prompt","(function --) set prompt callback\n Sets a function to be called to generate the prompt. This is a\n function which has the form (gc stkcount promptchar -- string).\n Note that any ANSI escape sequences should be wrapped with characters\n 001 and 002.",_word__prompt},
+    {"args","(-- args) list of arguments, stripped of those handled by Angort\n This returns the arguments passed to the program, except for those\n which are parsed by Angort itself (e.g. \"-d\"). Any arguments after \"--\"\n are not stripped and are not handled by Angort, and the \"--\" itself is\n not added to this list.",_word__args},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_cli 
+
+angort::LibraryDef _angortlib_cli = {
+    "cli",
+    _angortlib_ns_cli::_wordlist_,
+    _angortlib_ns_cli::_binoplist_,
+    NULL,_angortlib_ns_cli::__shutdown__
+};
@@ -0,0 +1,29 @@
+// Token table - generated by gentoks.py from /root/repo/cli/debtoks
+
+#include "debtoks.h"
+namespace angort {
+TokenRegistry debtoks[] = {
+	{"*e", T_END},
+	{"*s", T_STRING},
+	{"*i", T_IDENT},
+	{"*n", T_INT},
+	{"*f", T_FLOAT},
+	{"*D", T_DOUBLE},
+	{"*L", T_LONG},
+	{"*c?", T_QUESTION},
+	{"b", T_BREAK},
+	{"stack", T_STACK},
+	{"disasm", T_DISASM},
+	{"frame", T_FRAME},
+	{"abort", T_ABORT},
+	{"print", T_PRINT},
+	{"quit", T_QUIT},
+	{"n", T_NEXT},
+	{"f", T_FUNC},
+	{"h", T_HELP},
+	{"terminate", T_TERMINATE},
+	{"bt", T_BACKTRACE},
+{NULL,-10}
+};
+
+} // end namespace
@@ -0,0 +1,28 @@
+/**
+ * @file future.cpp
+ * @brief  Brief description of file.
+ *
+ */
+
+#include "angort.h"
+
+using namespace angort;
+
+namespace angort {
+}
+
+
+namespace _angortlib_ns_future {
+
+static angort::WordDef _wordlist_[]={
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_future 
+
+angort::LibraryDef _angortlib_future = {
+    "future",
+    _angortlib_ns_future::_wordlist_,
+    _angortlib_ns_future::_binoplist_,
+    NULL,NULL
+};
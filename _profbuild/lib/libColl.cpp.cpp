@@ -0,0 +1,979 @@
+/**
+ * @file
+ * Lists and hashes
+ * 
+ */
+
+
+#include "angort.h"
+#include "hash.h"
+#include "opcodes.h"
+
+using namespace angort;
+
+namespace angort {
+// DESTRUCTIVE comparator - damages the stack!
+struct RevStdComparator : public ArrayListComparator<Value> {
+    Runtime *ang;
+    RevStdComparator(Runtime *a){
+        ang = a;
+    }
+    virtual int compare(const Value *a, const Value *b){
+        // binop isn't const, sadly.
+        ang->binop(const_cast<Value *>(b),
+                   const_cast<Value *>(a),OP_CMP);
+        return ang->popInt();
+    }
+};
+
+// DESTRUCTIVE comparator - damages the stack!
+struct StdComparator : public ArrayListComparator<Value> {
+    Runtime *ang;
+    StdComparator(Runtime *a){
+        ang = a;
+    }
+    virtual int compare(const Value *a, const Value *b){
+        // binop isn't const, sadly.
+        ang->binop(const_cast<Value *>(a),
+                   const_cast<Value *>(b),OP_CMP);
+        return ang->popInt();
+    }
+};
+
+
+// DESTRUCTIVE comparator - damages the stack!
+struct FuncComparator : public ArrayListComparator<Value> {
+    Value *func;
+    Runtime *ang;
+    
+    FuncComparator(Runtime *a,Value *f){
+        ang = a;
+        func = f;
+    }
+    virtual int compare(const Value *a, const Value *b){
+        ang->pushval()->copy(a);
+        ang->pushval()->copy(b);
+        ang->runValue(func);
+        return ang->popInt();
+    }
+};
+
+}
+
+namespace _angortlib_ns_coll {
+
+static void _word__head(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vi");
+Value * p0 = _parms[0];
+int p1 = _parms[1]->toInt();
+    if(p0->t == Types::tList){
+        ArrayList<Value> *in = Types::tList->get(p0);
+        ReadLock rlock(in);
+        
+        Value r;
+        ArrayList<Value> *list = Types::tList->set(&r);
+        WriteLock wlock=WL(list);
+        
+        for(int i=0;i<p1;i++){
+            if(i==in->count())break;
+            list->append()->copy(in->get(i));
+        }
+        a->pushval()->copy(&r);
+    } else {
+        Value tmp,r;
+        Value *s = Types::tString->coerce(p0,&tmp);
+        
+        if(p1<=0){
+            a->pushString("");
+            return;
+        }
+        int len = Types::tString->getCount(s);
+        Types::tString->substring(&r,s,0,p1<len ? p1 : len);
+        a->pushval()->copy(&r);
+    }
+}
+
+static void _word__tail(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vi");
+Value * p0 = _parms[0];
+int p1 = _parms[1]->toInt();
+    if(p0->t == Types::tList){
+        ArrayList<Value> *in = Types::tList->get(p0);
+        ReadLock rlock(in);
+        
+        Value r;
+        ArrayList<Value> *list = Types::tList->set(&r);
+        WriteLock wlock=WL(list);
+        
+        int start = in->count()-p1;
+        if(start<0)start=0;
+        for(int i=start;i<in->count();i++){
+            list->append()->copy(in->get(i));
+        }
+        a->pushval()->copy(&r);
+    } else {
+        Value tmp,r;
+        Value *s = Types::tString->coerce(p0,&tmp);
+        if(p1<=0){
+            a->pushString("");
+            return;
+        }
+        int len = Types::tString->getCount(s);
+        Types::tString->substring(&r,s,p1<len ? len-p1 : 0,len);
+        a->pushval()->copy(&r);
+    }
+}
+
+static void _word__splitlist(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"li");
+ArrayList<Value> *p0 = Types::tList->get(_parms[0]);
+int p1 = _parms[1]->toInt();
+    ReadLock lock(p0);
+    
+    Value r;
+    ArrayList<Value> *list = Types::tList->set(&r);
+    WriteLock wlock=WL(list);
+    ArrayList<Value> *list1 = Types::tList->set(list->append());
+    WriteLock wlocka=WL(list1);
+    ArrayList<Value> *list2 = Types::tList->set(list->append());
+    WriteLock wlockb=WL(list2);
+    
+    for(int i=0;i<p0->count();i++){
+        (i<p1 ? list1 : list2)->append()->copy(p0->get(i));
+    }
+    a->pushval()->copy(&r);
+}
+
+
+static void _word__last(angort::Runtime *a){
+    Value *c = a->stack.peekptr();
+    
+    ReadLock lock(c->getLockable());
+    
+    int n = c->t->getCount(c)-1;
+    if(n<0)
+        c->clr();
+    else {
+        Value v,out;
+        Types::tInteger->set(&v,n);
+        c->t->getValue(c,&v,&out);
+        c->copy(&out);
+    }
+}
+
+inline void getByIndex(Value *c,int idx){
+    ReadLock lock(c->getLockable());
+    
+    if(idx>=c->t->getCount(c))
+        c->clr();
+    else {
+        Value v,out;
+        Types::tInteger->set(&v,idx);
+        c->t->getValue(c,&v,&out);
+        c->copy(&out);
+    }
+}
+
+static void _word__min(angort::Runtime *a){
+    StdComparator cmp(a);
+    Value m;
+    Value *i1 = a->popval(); // pop first item
+    
+    if(i1->t->flags & TF_ITERABLE){
+        // if an iterable just run over those.
+        Iterator<Value *> *iter = i1->t->makeIterator(i1);
+        if(iter->isDone())
+            m.clr();
+        else {
+            iter->first();
+            m.copy(iter->current());
+            if(!iter->isDone()){
+                for(;!iter->isDone();iter->next()){
+                    if(cmp.compare(iter->current(),&m)<0){
+                        m.copy(iter->current());
+                    }
+                }
+            }
+        }
+        delete iter;
+    }else{
+        // if it's not an iterable, we pop TWO items. Sadly comparators
+        // are destructive. I could fix that and I should, but it's
+        // really tedious to fix. This is just an extra copy.
+        m.copy(a->popval());
+        m.copy( (cmp.compare(i1,&m)<0) ? i1 : &m);
+    }        
+    a->pushval()->copy(&m);
+}
+
+static void _word__max(angort::Runtime *a){
+    StdComparator cmp(a);
+    Value m;
+    Value *i1 = a->popval(); // pop first item
+    
+    if(i1->t->flags & TF_ITERABLE){
+        // if an iterable just run over those.
+        Iterator<Value *> *iter = i1->t->makeIterator(i1);
+        if(iter->isDone())
+            m.clr();
+        else {
+            iter->first();
+            m.copy(iter->current());
+            if(!iter->isDone()){
+                for(;!iter->isDone();iter->next()){
+                    if(cmp.compare(iter->current(),&m)>0){
+                        m.copy(iter->current());
+                    }
+                }
+            }
+        }
+        delete iter;
+    }else{
+        // if it's not an iterable, we pop TWO items. Sadly comparators
+        // are destructive. I could fix that and I should, but it's
+        // really tedious to fix. This is just an extra copy.
+        m.copy(a->popval());
+        int q = cmp.compare(i1,&m);
+        m.copy( q>0 ? i1 : &m);
+    }        
+    a->pushval()->copy(&m);
+}
+
+static void _word__maxf(angort::Runtime *a){
+    Value func;
+    Value m;
+    
+    func.copy(a->popval());
+    FuncComparator cmp(a,&func);
+    
+    // see max and min for how we deal with pairs and iterables
+    // differently
+    Value *i1 = a->popval();
+    
+    if(i1->t->flags & TF_ITERABLE){
+        Iterator<Value *> *iter = i1->t->makeIterator(i1);
+        if(iter->isDone())
+            m.clr();
+        else {
+            iter->first();
+            m.copy(iter->current());
+            if(!iter->isDone()){
+                for(;!iter->isDone();iter->next()){
+                    if(cmp.compare(iter->current(),&m)>0){
+                        m.copy(iter->current());
+                    }
+                }
+            }
+        }
+        delete iter;
+    } else {
+        Value v;
+        v.copy(i1); // to avoid overwrite
+        m.copy(a->popval());
+        int q = cmp.compare(&v,&m);
+        m.copy( q>0 ? &v : &m);
+    }
+    a->pushval()->copy(&m);
+}
+
+
+
+
+
+
+static void _word__explode(angort::Runtime *a){
+    Value *iterable = a->popval();
+    Iterator<Value *> *iter = iterable->t->makeIterator(iterable);
+    
+    for(iter->first();!iter->isDone();iter->next()){
+        a->pushval()->copy(iter->current());
+    }
+    delete iter;
+}    
+
+static void _word__gather(angort::Runtime *a){
+    Value out;
+    int n = a->popInt();
+    ArrayList<Value> *outlist = Types::tList->set(&out,n);
+    
+    for(int i=0;i<n;i++){
+        Value *v = a->stack.peekptr((n-1)-i);
+        outlist->append()->copy(v);
+    }
+    for(int i=0;i<n;i++)a->popval();
+    a->pushval()->copy(&out);
+}
+    
+
+static void _word__fst(angort::Runtime *a){
+    getByIndex(a->stack.peekptr(),0);
+}
+
+static void _word__snd(angort::Runtime *a){
+    getByIndex(a->stack.peekptr(),1);
+}
+static void _word__third(angort::Runtime *a){
+    getByIndex(a->stack.peekptr(),2);
+}
+static void _word__fourth(angort::Runtime *a){
+    getByIndex(a->stack.peekptr(),3);
+}
+
+
+static void _word__get(angort::Runtime *a){
+    Value *c = a->popval();
+    Value *keyAndResult = a->stack.peekptr();
+    Value v;
+    c->t->getValue(c,keyAndResult,&v);
+    keyAndResult->copy(&v); // copy into the key's slot
+}
+static void _word__set(angort::Runtime *a){
+    Value *c = a->popval();
+    Value *k = a->popval();
+    Value *v = a->popval();
+    c->t->setValue(c,k,v);
+}
+static void _word__len(angort::Runtime *a){
+    Value *c = a->stack.peekptr();
+    int ct = c->t->getCount(c);
+    Types::tInteger->set(c,ct);
+}
+
+static void _word__remove(angort::Runtime *a){
+    Value c;
+    c.copy(a->popval()); // temp copy to avoid GC
+    
+    Value *keyAndResult = a->stack.peekptr();
+    Value v;
+    c.t->removeAndReturn(&c,keyAndResult,&v);
+    keyAndResult->copy(&v); // copy into the key's slot
+}
+
+static void _word__unique(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"l");
+ArrayList<Value> *p0 = Types::tList->get(_parms[0]);
+    Value out;
+    ReadLock lock(p0);
+    ArrayListIterator<Value> iter(p0);
+    ArrayList<Value> *outlist = Types::tList->set(&out);
+    
+    for(iter.first();!iter.isDone();iter.next()){
+        Value *v = iter.current();
+        // go over existing list to see if we've got it
+        bool isin=false;
+        for(int i=0;i<outlist->count();i++){
+            Value *cmp = outlist->get(i);
+            if(cmp->equalForHashTable(v)){
+                isin=true;break;
+            }
+        }
+        if(!isin)
+            outlist->append()->copy(v);
+    }
+    a->pushval()->copy(&out);
+}
+
+static bool equalityCheck(Runtime *ang,Value *a,Value *b){
+    if(a->t == Types::tList){
+        if(b->t != Types::tList)
+            return false;
+        else {
+            ArrayList<Value> *listA = Types::tList->get(a);
+            ArrayList<Value> *listB = Types::tList->get(b);
+            ReadLock lockA(listA);
+            ReadLock lockB(listB);
+            if(listA->count() != listB->count())
+                return false;
+            for(int i=0;i<listA->count();i++){
+                Value *p = listA->get(i);
+                Value *q = listB->get(i);
+                if(!equalityCheck(ang,p,q))
+                    return false;
+            }
+        }
+        return true;
+    } else if(a->t == Types::tHash) {
+        if(b->t != Types::tHash)
+            return false;
+        else {
+            Hash *hashA = Types::tHash->get(a);
+            Hash *hashB = Types::tHash->get(b);
+            ReadLock lockA(hashA);
+            ReadLock lockB(hashB);
+            if(hashA->count()!=hashB->count())
+                return false;
+            // A and B are the same size, so if B has a key
+            // which isn't in A, A must have a key which isn't
+            // in B. We only have to do the equality check by
+            // looking at all the keys in A and making sure they
+            // exist with the same value in B.
+            HashKeyIterator i(hashA);
+            for(i.first();!i.isDone();i.next()){
+                if(!hashA->find(i.current()))
+                    throw WTF;
+                Value *p = hashA->getval();
+                if(!hashB->find(i.current()))
+                    return false;
+                Value *q = hashB->getval();
+                if(!equalityCheck(ang,p,q))
+                    return false;
+            }
+        }
+        return true;
+    } else {
+        // standard equality check with coercion.
+        ang->binop(a,b,OP_EQUALS);
+        return ang->popInt();
+    }
+            
+            
+}
+
+static void _word__eq(angort::Runtime *a){
+    Value v0,v1;
+    v0.copy(a->popval());
+    v1.copy(a->popval());
+    
+    a->pushInt(equalityCheck(a,&v0,&v1)?1:0);
+}
+
+
+static void _word__shift(angort::Runtime *a){
+    Value vv;
+    vv.copy(a->popval()); // to keep the list around
+    
+    ArrayList<Value> *list = Types::tList->get(&vv);
+    
+    Value *v = a->pushval(); // for the return item
+    
+    WriteLock lock=WL(list); // get() doesn't lock
+    v->copy(list->get(0));
+    list->remove(0);
+}
+
+static void _word__unshift(angort::Runtime *a){
+    ArrayList<Value> *list = Types::tList->get(a->popval());
+    
+    WriteLock lock=WL(list); // get() doesn't lock
+    Value *v = a->popval();
+    list->insert(0)->copy(v);
+}
+
+static void _word__pop(angort::Runtime *a){
+    Value v;
+    v.copy(a->popval());
+    ArrayList<Value> *list = Types::tList->get(&v);
+    
+    WriteLock lock=WL(list); // get() doesn't lock
+    Value *p = a->pushval();
+    Value *src = list->get(list->count()-1);
+    p->copy(src);
+    list->remove(list->count()-1);
+}
+
+
+static void _word__push(angort::Runtime *a){
+    ArrayList<Value> *list = Types::tList->get(a->popval());
+    Value *v = a->popval();
+    WriteLock lock=WL(list); // append() doesn't lock
+    list->append()->copy(v);
+}
+
+
+static void _word__listcap(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"i");
+int p0 = _parms[0]->toInt();
+    Types::tList->set(a->pushval(),p0);
+}
+
+static void _word__hashcap(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"i");
+int p0 = _parms[0]->toInt();
+    Types::tHash->set(a->pushval())->reserve(p0);
+}
+
+static void _word__extend(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    Value listv,in;
+    // hold references, because running a lazy pipeline can
+    // overwrite the stack
+    listv.copy(p1);
+    in.copy(p0);
+    ArrayList<Value> *list = Types::tList->get(&listv);
+    int n = in.t->getSizeHint(&in);
+    
+    if(in.t==Types::tList && Types::tList->get(&in)==list){
+        // extending a list with itself; there's no need to iterate.
+        WriteLock lock=WL(list);
+        n = list->count();
+        list->reserve(n*2);
+        for(int i=0;i<n;i++){
+            // there's room for them all, so append() won't move v
+            Value *v = list->get(i);
+            list->append()->copy(v);
+        }
+        return;
+    }
+    
+    Iterator<Value *> *iter = in.t->makeIterator(&in);
+    WriteLock lock=WL(list); // append() doesn't lock
+    if(n>0)
+        list->reserve(list->count()+n);
+    try {
+        for(iter->first();!iter->isDone();iter->next())
+            list->append()->copy(iter->current());
+    } catch(Exception& e){
+        delete iter;
+        throw;
+    }
+    delete iter;
+}
+
+static void _word__hashupdate(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"hh");
+Hash *p0 = Types::tHash->get(_parms[0]);
+Hash *p1 = Types::tHash->get(_parms[1]);
+    if(p0==p1)
+        return;
+    ReadLock lock0(p0);
+    WriteLock lock1=WL(p1);
+    p1->reserve(p1->count()+p0->count());
+    for(int i=p0->nextUsed(0);i>=0;i=p0->nextUsed(i+1))
+        p1->set(p0->keyAt(i),p0->valAt(i));
+}
+
+static void _word__map(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"Ic");
+Value *p0 = _parms[0];
+Value * p1 = _parms[1];
+    Value func;
+    func.copy(p1); // need a local copy
+    
+    int n = p0->t->getSizeHint(p0);
+    Iterator<Value *> *iter = p0->t->makeIterator(p0);
+    ArrayList<Value> *list = Types::tList->set(a->pushval(),n);
+    
+    WriteLock lock=WL(list);
+    
+    for(iter->first();!iter->isDone();iter->next()){
+        a->pushval()->copy(iter->current());
+        a->runValue(&func);
+        Value *v = list->append();
+        v->copy(a->popval());
+    }
+    delete iter;
+}
+
+static void _word__reduce(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"Ic");
+Value *p0 = _parms[0];
+Value * p1 = _parms[1];
+    Value func;
+    func.copy(p1); // need a local copy
+    
+    Iterator<Value *> *iter = p0->t->makeIterator(p0);
+    
+    // accumulator is already on the stack
+    
+    for(iter->first();!iter->isDone();iter->next()){
+        a->pushval()->copy(iter->current()); // stack the iterator on top of the accum
+        a->runValue(&func); // run the function, leaving the new accumulator
+    }
+    delete iter;
+}
+
+static void _word__filter(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"Ic");
+Value *p0 = _parms[0];
+Value * p1 = _parms[1];
+    Value func;
+    func.copy(p1); // need a local copy
+    
+    Iterator<Value *> *iter = p0->t->makeIterator(p0);
+    ArrayList<Value> *list = Types::tList->set(a->pushval());
+    
+    WriteLock lock=WL(list);
+    for(iter->first();!iter->isDone();iter->next()){
+        a->pushval()->copy(iter->current());
+        a->runValue(&func);
+        if(a->popval()->toBool()){
+            Value *v = list->append();
+            v->copy(iter->current());
+        }
+    }
+    delete iter;
+}
+
+static void _word__filter2(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"Ic");
+Value *p0 = _parms[0];
+Value * p1 = _parms[1];
+    Value func;
+    func.copy(p1); // need a local copy
+    
+    Iterator<Value *> *iter = p0->t->makeIterator(p0);
+    ArrayList<Value> *falselist = Types::tList->set(a->pushval());
+    ArrayList<Value> *truelist = Types::tList->set(a->pushval());
+    
+    WriteLock lock1=WL(falselist);
+    WriteLock lock2=WL(truelist);
+    
+    for(iter->first();!iter->isDone();iter->next()){
+        a->pushval()->copy(iter->current());
+        a->runValue(&func);
+        Value *v;
+        if(a->popval()->toBool())
+            v = truelist->append();
+        else
+            v = falselist->append();
+        v->copy(iter->current());
+        
+    }
+    delete iter;
+}
+
+static void _word__in(angort::Runtime *a){
+    Value *iterable = a->popval();
+    Value *item = a->popval();
+    
+    // may create an iterator which has a lock
+    bool b = iterable->t->contains(iterable,item);
+    
+    a->pushInt(b?1:0);
+}
+
+static void _word__index(angort::Runtime *a){
+    Value *iterable = a->popval();
+    Value *item = a->popval();
+    
+    // will create an iterator which has a lock
+    int i = iterable->t->getIndexOfContainedItem(iterable,item);
+    if(i<0)a->pushNone();
+    else a->pushInt(i);
+}
+
+static void _word__slice(angort::Runtime *a)
+{
+Value *_parms[3];
+a->popParams(_parms,"vii");
+Value * p0 = _parms[0];
+int p1 = _parms[1]->toInt();
+int p2 = _parms[2]->toInt();
+    Value iterable;
+    iterable.copy(p0);
+    int start = p1;
+    int len = p2;
+    
+    Value *res = a->pushval();
+    iterable.t->slice(res,&iterable,start,len);
+}
+
+static void _word__slicelen(angort::Runtime *a)
+{
+Value *_parms[3];
+a->popParams(_parms,"vii");
+Value * p0 = _parms[0];
+int p1 = _parms[1]->toInt();
+int p2 = _parms[2]->toInt();
+    Value iterable;
+    iterable.copy(p0);
+    int start = p1;
+    int len = p2;
+    
+    Value *res = a->pushval();
+    iterable.t->slice_dep(res,&iterable,start,len);
+}
+
+static void _word__clone(angort::Runtime *a){
+    Value *v = a->stack.peekptr();
+    v->t->clone(v,v,false);
+}
+
+static void _word__deepclone(angort::Runtime *a){
+    Value *v = a->stack.peekptr();
+    v->t->clone(v,v,true);
+    
+}
+
+static void _word__sort(angort::Runtime *a){
+    Value listv;
+    // need copy because comparators use the stack
+    listv.copy(a->popval());
+    if(listv.t->flags & TF_NUMVEC){
+        // numeric vectors sort themselves
+        ((NumVecTypeBase *)listv.t)->sort(&listv,false);
+        return;
+    }
+    ArrayList<Value> *list = Types::tList->get(&listv);
+    
+    StdComparator cmp(a);
+    WriteLock lock=WL(list);
+    list->sort(&cmp);
+}
+
+static void _word__rsort(angort::Runtime *a){
+    Value listv;
+    // need copy because comparators use the stack
+    listv.copy(a->popval());
+    if(listv.t->flags & TF_NUMVEC){
+        // numeric vectors sort themselves
+        ((NumVecTypeBase *)listv.t)->sort(&listv,true);
+        return;
+    }
+    ArrayList<Value> *list = Types::tList->get(&listv);
+    
+    RevStdComparator cmp(a);
+    WriteLock lock=WL(list);
+    list->sort(&cmp);
+}
+
+
+static void _word__fsort(angort::Runtime *a){
+    Value func,listv;
+    
+    // need copies because comparators use the stack
+    func.copy(a->popval());
+    listv.copy(a->popval());
+    
+    ArrayList<Value> *list = Types::tList->get(&listv);
+    
+    FuncComparator cmp(a,&func);
+    WriteLock lock=WL(list);
+    list->sort(&cmp);
+}
+
+static void _word__all(angort::Runtime *a){
+    int rv=1; // true by default
+    
+    Value func;
+    func.copy(a->popval()); // need a local copy
+    
+    Value *iterable = a->popval();
+    Iterator<Value *> *iter = iterable->t->makeIterator(iterable);
+    
+    for(iter->first();!iter->isDone();iter->next()){
+        a->pushval()->copy(iter->current()); // stack the iterator on top of the accum
+        a->runValue(&func); // run the function
+        if(!a->popBool()){
+            rv = 0;
+            break;
+        }
+    }
+    a->pushInt(rv);
+    delete iter;
+}
+
+static void _word__any(angort::Runtime *a){
+    int rv=0; // false by default
+    
+    Value func;
+    func.copy(a->popval()); // need a local copy
+    
+    Value *iterable = a->popval();
+    Iterator<Value *> *iter = iterable->t->makeIterator(iterable);
+    
+    for(iter->first();!iter->isDone();iter->next()){
+        a->pushval()->copy(iter->current()); // stack the iterator on top of the accum
+        a->runValue(&func); // run the function
+        if(a->popBool()){
+            rv = 1;
+            break;
+        }
+    }
+    a->pushInt(rv);
+    delete iter;
+}
+
+static void _word__zipWith(angort::Runtime *a){
+    Value *p[3];
+    a->popParams(p,"IIc");
+    Iterator<Value *> *iter1 = p[0]->t->makeIterator(p[0]);
+    Iterator<Value *> *iter2 = p[1]->t->makeIterator(p[1]);
+    
+    Value func;
+    func.copy(p[2]); // need a local copy
+    
+    ArrayList<Value> *list = Types::tList->set(a->pushval());
+    WriteLock wlock=WL(list);
+    
+    for(iter1->first(),iter2->first();
+        !(iter1->isDone() || iter2->isDone());
+        iter1->next(),iter2->next()){
+        
+        a->pushval()->copy(iter1->current());
+        a->pushval()->copy(iter2->current());
+        a->runValue(&func);
+        
+        list->append()->copy(a->popval());
+    }
+    
+    delete iter1;
+    delete iter2;
+    
+}
+
+static void _word__reverse(angort::Runtime *a){
+    Value *p = a->popval();
+    Iterator<Value *> *iter = p->t->makeIterator(p);
+    
+    // quickest thing to do is count the items by hand. This
+    // is optimised if we know the input iterable is a list.
+    
+    int n;
+    if(p->t == Types::tList){
+        n = Types::tList->get(p)->count();
+    } else {
+        n=0;
+        for(iter->first();!iter->isDone();iter->next())n++;
+    }
+    
+    // new list
+    ArrayList<Value> *list = Types::tList->set(a->pushval());
+    WriteLock lock=WL(list);
+    
+    int i=n;
+    for(iter->first();!iter->isDone();iter->next()){
+        Value *v = iter->current();
+        list->set(--i,v);
+    }
+    delete iter;
+    
+}
+
+
+
+static void _word__intercalate(angort::Runtime *a){
+    Value *p[2];
+    a->popParams(p,"vv"); // can be any type
+    
+    Value *v = p[0];
+    Iterator<Value *> *iter = v->t->makeIterator(v);
+    const StringBuffer& s = p[1]->toString();
+    const char *sep = s.get();
+    int seplen = strlen(sep);
+    
+    // build in one pass, so each item is only converted once
+    StringBuilder out;
+    int n;
+    for(n=0,iter->first();!iter->isDone();iter->next(),n++){
+        if(n)
+            out.append(sep,seplen);
+        out.append(iter->current());
+    }
+    delete iter;
+    
+    Value t;
+    Types::tString->setwithlen(&t,out.get(),out.length());
+    a->pushval()->copy(&t);
+}
+
+
+static void _word__listintercalate(angort::Runtime *a){
+    Value *p[2];
+    a->popParams(p,"vv"); // can be any type
+    
+    Value *v = p[0];
+    Iterator<Value *> *iter = v->t->makeIterator(v);
+    
+    Value sep,output;
+    sep.copy(p[1]);
+    ArrayList<Value> *list = Types::tList->set(&output);
+    WriteLock lock=WL(list);
+    
+    int count = v->t->getCount(v);
+    int n=0;
+    for(iter->first();!iter->isDone();iter->next(),n++){
+        list->append()->copy(iter->current());
+        if(n!=count-1){
+            list->append()->copy(&sep);
+        }
+    }
+    delete iter;
+    
+    a->pushval()->copy(&output);
+    output.clr();
+}
+static angort::WordDef _wordlist_[]={
+    {"head","(coll/str n -- list) get the first n items/chars of a list or string\n If a list, get the first n items into a new list - returns a list even if the length\n requested is 1. (See also \"fst\".) In the case of a string, returns the first n characters.",_word__head},
+    {"tail","(coll n -- list) get the last n items of a list\n If a list, get the last n items into a new list - returns a list even if the length\n requested is 1. (See also \"last\".) In the case of a string, returns the last n chars.",_word__tail},
+    {"splitlist","(coll n -- [list,list]) split list into two lists of [n,count-n] items\n Creates two new lists, returned as elements of a list, consisting of the\n first n items in the first list and the remainder in the second list.",_word__splitlist},
+    {"last","(coll -- item/none) get last item\n Return the last item of a list or NONE if list is empty.",_word__last},
+    {"min","([a,b...]|a b -- minimum) Find minimum value in iterable or pair\n This either a single iterable or a pair of values.",_word__min},
+    {"max","([a,b...]|a b -- maximum) Find maximum value in iterable or pair\n This either a single iterable or a pair of values.",_word__max},
+    {"maxf","( ([a,b...]| a b) func -- maximum) Find maximum value in iterable or pair using function\n This uses the supplied function as a comparator to find the maximum item in an iterable or a pair. \n It takes a function and either a single iterable or a pair of values. There is no corresponding\n minf function, since this can be constructed by negating the output of the function which\n would be passed to maxf.",_word__maxf},
+    {"explode","([x,y,..] -- x,y,..) put all items onto stack\n Puts all items from the list onto the stack, permitting the metaphor\n [a,b,c] explode !c !b !a. Note the reversal of the order - a typical\n usage is \"reverse explode\" (but this is slow).",_word__explode},
+    {"gather","(a b c d .. n -- [a,b,c,d]) turn N items on stack into a list",_word__gather},
+    {"fst","(coll -- item/none) get first item\n Return the first item of a list or NONE if list is empty.",_word__fst},
+    {"snd","(coll -- item/none) get second item\n Return the 2nd item of a list or NONE if not present.",_word__snd},
+    {"third","(coll -- item/none) get second item\n Return the 3rd item of a list or NONE if not present.",_word__third},
+    {"fourth","(coll -- item/none) get second item\n Return the 4th item of a list or NONE if not present.",_word__fourth},
+    {"get","(key coll --) get an item from a list or hash\n For a list, get the key'th item (starting from zero). For a hash, look up\n the key and return the item. Lists will throw a ex$outofrange exception\n if out of range, hashes will return NONE if item not found.",_word__get},
+    {"set","(val key coll --) put an item into a list or hash\n Store an item in a list of hash. Lists will be expanded to the required\n size, with all unset items set to NONE. This can result in enormous\n memory usage: lists are not stored sparsely.",_word__set},
+    {"len","(coll --) get length of list, hash or string\n Get the number of items in a list, hash or string.",_word__len},
+    {"remove","(key coll -- item) remove an item by key or index, returning it.\n Removes the nth item of a list, moving all subsequent items down.\n In a hash, removes the item given by the key. In both cases the\n removed item is returned.",_word__remove},
+    {"unique","(list -- list) remove duplicate items",_word__unique},
+    {"eq","(item item -- bool) equality testing by traversal\n Normal \"=\" just uses identity checking for deep collections;\n this word will test the structures for equality. For the primitive\n elements, the appropriate binop will be used and coercions\n made (so \"1\" will equal 1).",_word__eq},
+    {"shift","(list -- item) remove and return the first item of the list\n Removes and returns the first item of the list, throwing ex$outofrange\n if there are no items.",_word__shift},
+    {"unshift","(item list --) prepend an item to a list\n Adds an item to the start of a list.",_word__unshift},
+    {"pop","(list -- item) pop an item from the end of the list\n Removes and returns the last item of the list, throwing ex$outofrange\n if there are no items.",_word__pop},
+    {"push","(item list --) append an item to a list\n Adds an item to the end of a list.",_word__push},
+    {"listcap","(n -- list) create an empty list with room for n items\n Appending up to n items to the list won't need it to be reallocated.",_word__listcap},
+    {"hashcap","(n -- hash) create an empty hash with room for n keys\n Adding up to n keys to the hash won't need it to be resized.",_word__hashcap},
+    {"extend","(iterable list --) append all the items of an iterable to a list\n If the number of items is known (for lists, hashes, vectors and integer\n ranges) room is made for them all first.",_word__extend},
+    {"hashupdate","(hash2 hash --) copy all the keys and values of one hash into another\n Existing keys in the second hash are overwritten. Room is made for all\n the new keys first.",_word__hashupdate},
+    {"map","(iter func -- list) apply a function to an iterable, giving a list\n For each item in the iterable (list, range  or hash) apply a function,\n creating a new list containing the results. In the case of hashes, the\n hash key is passed to the function.",_word__map},
+    {"reduce","(accumulator iter func -- result) perform a (left) fold or reduce on an iterable.\n Works on lists, ranges or hashes. For each item or hash key, calculate the\n result of the binary function where the first operand is the accumulator\n and the second is the item or key, and set the accumulator to this value.\n Thus, \"0 [1,2,3,4] (+) reduce\" will sum the values.",_word__reduce},
+    {"filter","(iter func -- list) filter an iterable with a boolean function\n For each item in an iterable, return a list of those items for which the\n function returns nonzero. Accepts lists, ranges or hashes (in the latter case\n the hash key is used).",_word__filter},
+    {"filter2","(iter func -- falselist truelist) filter an iterable with a boolean function into two lists\n For each item in an iterable, return two lists of those items for which the\n function returns zero and those for which it returns nonzero. Accepts\n lists, ranges or hashes (in the latter case the hash key is used).",_word__filter2},
+    {"in","(item iterable -- bool) return if item is in list or hash keys\n Return true if an iterable (list, hash or integer range) contains\n the item.",_word__in},
+    {"index","(item iterable -- int) return index of item in iterable, or none\n Return the zero based index of an item in a list. Other iterables will return\n none, non-iterable types will throw ex$noiter.",_word__index},
+    {"slice","(iterable start end -- iterable) produce a slice of a string or list\n Return a slice of a string or list, returning another string or or list,\n given the start and end positions. The end index is exclusive; that element\n will not be included. Inappropriate types will throw ex$notcoll.\n If length of the iterable is greater than the length required, then the\n output will be truncated to the remainder of the iterable.\n Negative indices count from just past the end, so -1 is the last\n element. A zero end index thus means the end.\n Empty results will be returned if the requested slice does not intersect\n the iterable.",_word__slice},
+    {"slicelen","(iterable start len -- iterable) produce a slice of a string or list\n Return a slice of a string or list, returning another string or or list,\n given the start and length. Inappropriate types will throw ex$notcoll.\n If length of the iterable  is greater than the length requested, then the\n slice will go to the end. If the start<0 it is counted from the end.\n Empty results will be returned if the requested slice does not intersect\n the iterable.",_word__slicelen},
+    {"clone","(in -- out) construct a shallow copy of a collection\n Create a new collection (list or hash) of the same type, where\n each item is a shallow copy. For example, copying a list of lists\n creates a new list containing references to the lists in the original.",_word__clone},
+    {"deepclone","(in -- out) produce a deep copy of a value\n Create a new collection (list or hash) of the same type, where\n each item is a deep copy (i.e. a recursive copy). For example, copying\n a list of lists creates a new list containing new copies of the original\n lists.",_word__deepclone},
+    {"sort","(in --) sort a list in place using default comparator\n Reorders the list using a standard comparison, which will fail if\n the types of the items are not comparable. Numeric vectors (i32 etc.)\n can also be sorted.",_word__sort},
+    {"rsort","(in --) reverse sort a list in place using default comparator\n Reorders the list using a standard comparison, which will fail if\n the types of the items are not comparable. Numeric vectors (i32 etc.)\n can also be sorted.",_word__rsort},
+    {"fsort","(in func --) sort a list in place using function comparator\n Reorders the list using a binary function.",_word__fsort},
+    {"all","(iterable func -- all) true if the function returns true for all items\n Returns true if the unary function provided returns nonzero for all the items\n in the iterable. For hashes, this will use the key.",_word__all},
+    {"any","(iterable func -- bool) true if the function returns true for all items\n Returns true if the unary function provided returns nonzero for any item\n in the iterable. For hashes, this will use the key.",_word__any},
+    {"zipWith","(in1 in2 func -- out) apply binary func to pairs of items in list\n For two lists, apply a binary function to pairs of items taken sequentially\n from each list, creating a new list. Thus, \"[1,2,3] [10,20,30] (+) zipWith\"\n will return \"[11,22,33]\". ",_word__zipWith},
+    {"reverse","(iter -- list) reverse an iterable to return a list\n Reverse an iterable (list, hash, string, int range) creating\n a new list of the results. Will work on hashes, but is pointless\n since the keys are unordered.",_word__reverse},
+    {"intercalate","(iter string -- string) concatenate strings of items with separator\n For each element in a list, turn that element into a string. Concatenate\n the strings together with the separator string supplied, and return the\n result. Thus, '[1,2,3] \",\" intercalate' will return \"1,2,3\".",_word__intercalate},
+    {"listintercalate","(iter item -- list) intercalate items in a list with another item\n Create a new list, containing items in the iterable (list, hash etc.)\n separated by the provided item.",_word__listintercalate},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_coll 
+
+angort::LibraryDef _angortlib_coll = {
+    "coll",
+    _angortlib_ns_coll::_wordlist_,
+    _angortlib_ns_coll::_binoplist_,
+    NULL,NULL
+};
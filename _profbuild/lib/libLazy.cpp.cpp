@@ -0,0 +1,113 @@
+#include "angort.h"
+
+
+using namespace angort;
+
+namespace _angortlib_ns_lazy {
+
+static void _word__map(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vc");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    Value func;
+    func.copy(p1);
+    LazyObject *o = Types::tLazy->set(a->pushval(),a,LZ_MAP,p0);
+    o->func->copy(&func);
+}
+
+static void _word__filter(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vc");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    Value func;
+    func.copy(p1);
+    LazyObject *o = Types::tLazy->set(a->pushval(),a,LZ_FILTER,p0);
+    o->func->copy(&func);
+}
+
+static void _word__take(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vi");
+Value * p0 = _parms[0];
+int p1 = _parms[1]->toInt();
+    LazyObject *o = Types::tLazy->set(a->pushval(),a,LZ_TAKE,p0);
+    o->n = p1;
+}
+
+static void _word__drop(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vi");
+Value * p0 = _parms[0];
+int p1 = _parms[1]->toInt();
+    LazyObject *o = Types::tLazy->set(a->pushval(),a,LZ_DROP,p0);
+    o->n = p1;
+}
+
+static void _word__zip(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    Types::tLazy->set(a->pushval(),a,LZ_ZIP,p0,p1);
+}
+
+static void _word__chain(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    Types::tLazy->set(a->pushval(),a,LZ_CHAIN,p0,p1);
+}
+
+static void _word__enumerate(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    Types::tLazy->set(a->pushval(),a,LZ_ENUMERATE,p0);
+}
+
+static void _word__tolist(angort::Runtime *a){
+    Value *p = a->stack.peekptr();
+    Value in;
+    in.copy(p);
+    Iterator<Value *> *iter = in.t->makeIterator(&in);
+    ArrayList<Value> *list = Types::tList->set(p);
+    WriteLock lock=WL(list);
+    try {
+        for(iter->first();!iter->isDone();iter->next())
+            list->append()->copy(iter->current());
+    } catch(Exception& e){
+        delete iter;
+        throw;
+    }
+    delete iter;
+}
+static angort::WordDef _wordlist_[]={
+    {"map","(iterable func -- lazy) lazily apply a function to each item",_word__map},
+    {"filter","(iterable func -- lazy) lazily pass on those items for which a function is true",_word__filter},
+    {"take","(iterable n -- lazy) lazily pass on the first n items\n Nothing after the nth item is pulled from the iterable, so functions in\n earlier stages are not run on the rest.",_word__take},
+    {"drop","(iterable n -- lazy) lazily skip the first n items",_word__drop},
+    {"zip","(iterable1 iterable2 -- lazy) lazily pair items from two iterables\n Each item is a two-item list [a,b], and the pipeline ends when either\n of the iterables does.",_word__zip},
+    {"chain","(iterable1 iterable2 -- lazy) lazily run through one iterable and then another",_word__chain},
+    {"enumerate","(iterable -- lazy) lazily pair each item with its index\n Each item is a two-item list [index,item], starting at zero.",_word__enumerate},
+    {"tolist","(iterable -- list) run a lazy pipeline (or any iterable) into a list",_word__tolist},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_lazy 
+
+angort::LibraryDef _angortlib_lazy = {
+    "lazy",
+    _angortlib_ns_lazy::_wordlist_,
+    _angortlib_ns_lazy::_binoplist_,
+    NULL,NULL
+};
@@ -0,0 +1,1023 @@
+/**
+ * @file
+ * brief description, full stop.
+ *
+ * long description, many sentences.
+ * 
+ */
+
+#include "angort.h"
+#include "cycle.h"
+
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+
+
+using namespace angort;
+
+void sighandler(int sig){
+    signal(sig,NULL);
+    char buf[32];
+    sprintf(buf,"ex$sig%d",sig);
+    throw RUNT(buf,"").set("Caught signal %d (%s)",sig,strsignal(sig));
+}
+
+namespace angort {
+
+bool boojum=false;
+
+/// define a property to set and get the auto cycle detection interval.
+/// It will be called "autogc".
+
+class AutoGCProperty: public Property {
+private:
+    Runtime *run;
+public:
+    AutoGCProperty(Runtime *_a){
+        run = _a;
+    }
+    
+    virtual void postSet(){
+        WriteLock lock=WL(&globalLock);
+        run->ang->autoCycleInterval = v.toInt();
+        run->autoCycleCount = run->ang->autoCycleInterval;
+    }
+    
+    virtual void preGet(){
+        Types::tInteger->set(&v,run->ang->autoCycleInterval);
+    }
+};
+
+/// a property to get and set the library search path,
+/// called "searchpath".
+class SearchPathProperty : public Property {
+private:
+    Angort *a;
+public:
+    SearchPathProperty(Runtime *_a){
+        a = _a->ang;
+    }
+    
+    virtual void postSet(){
+        if(a->searchPath)
+            free((void *)a->searchPath);
+        a->searchPath = strdup(v.toString().get());
+    }
+    
+    virtual void preGet(){
+        Types::tString->set(&v,
+                            a->searchPath ? a->searchPath:DEFAULTSEARCHPATH);
+    }
+};
+
+// assumes (nsid name --) on the stack. Must be locked!
+static NamespaceEnt *getNSEnt(Runtime *a){
+    const StringBuffer &s = a->popString();
+    int nsid = Types::tNSID->get(a->popval());
+    
+    Namespace *ns = a->ang->names.getSpaceByIdx(nsid);
+    
+    int idx = ns->get(s.get());
+    if(idx<0)
+        throw RUNT(EX_NOTFOUND,"cannot find name in namespace");
+    return ns->getEnt(idx);
+}
+
+}// end namespace
+
+
+
+
+namespace _angortlib_ns_std {
+
+static void trapsig(int sig){
+    struct sigaction act;
+    
+    act.sa_handler = sighandler;
+    sigemptyset(&act.sa_mask);
+    sigaddset(&act.sa_mask,SIGABRT);
+    act.sa_flags = 0;
+    sigaction(sig,&act,NULL);
+}
+
+static void _word__signal(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"i");
+int p0 = _parms[0]->toInt();
+    trapsig(p0);
+}
+
+static void _word__signals(angort::Runtime *a){
+    trapsig(SIGHUP);
+    trapsig(SIGINT);
+    trapsig(SIGQUIT);
+    trapsig(SIGILL);
+    trapsig(SIGTRAP);
+    trapsig(SIGIOT);
+    trapsig(SIGBUS);
+    trapsig(SIGFPE);
+    trapsig(SIGUSR1);
+    trapsig(SIGSEGV);
+    trapsig(SIGUSR2);
+    trapsig(SIGPIPE);
+    trapsig(SIGALRM);
+    trapsig(SIGTERM);
+    trapsig(SIGALRM);
+    trapsig(SIGSTKFLT);
+    trapsig(SIGCHLD);
+    trapsig(SIGCONT);
+    trapsig(SIGTSTP);
+    trapsig(SIGTTIN);
+    trapsig(SIGTTOU);
+    trapsig(SIGURG);
+    trapsig(SIGXCPU);
+    trapsig(SIGXFSZ);
+    trapsig(SIGVTALRM);
+    trapsig(SIGPROF);
+    trapsig(SIGWINCH);
+    trapsig(SIGIO);
+    trapsig(SIGPWR);
+    trapsig(SIGSYS);
+}
+
+
+static void _word__strsignal(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"i");
+int p0 = _parms[0]->toInt();
+    a->pushString(strsignal(p0));
+}
+
+
+
+static void _word__version(angort::Runtime *a){
+    a->pushString(a->ang->getVersion());
+}
+
+static void _word__barewords(angort::Runtime *a){
+    a->ang->barewords = a->popInt()?true:false;
+}
+
+static void _word__show(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    char *p=NULL;
+    p0->dump(&p);
+    a->pushString(p);
+    free(p);
+}
+
+
+static void _word__dump(angort::Runtime *a){
+    a->dumpStack(a->popString().get());
+}
+
+static void _word__raisesignal(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"i");
+int p0 = _parms[0]->toInt();
+    kill(getpid(),p0);
+}
+
+static void _word__snark(angort::Runtime *a){
+    static int snarkct=0;
+    printf("SNARK %d\n",snarkct++);
+}
+
+static void _word__esnark(angort::Runtime *a){
+    static int snarkct=0;
+    fprintf(stderr,"SNARK %d\n",snarkct++);
+}
+
+static void _word__boojum(angort::Runtime *a){
+    WriteLock lock = WL(&globalLock);
+    printf("Setting boojum\n");
+    boojum=true;
+}
+
+static void _word__endboojum(angort::Runtime *a){
+    WriteLock lock = WL(&globalLock);
+    printf("Clearing boojum\n");
+    boojum=false;
+}
+
+static void _word__none(angort::Runtime *a){
+    Value *v = a->pushval();
+    v->clr();
+}
+
+static void _word__ct(angort::Runtime *a){
+    a->pushInt(a->stack.ct);
+}
+
+static void _word__rct(angort::Runtime *a){
+    Value *v = a->popval();
+    GarbageCollected *gc = v->t->getGC(v);
+    if(gc){
+        a->pushInt(gc->refct);
+    } else 
+        a->pushInt(0);
+}
+
+static void _word__p(angort::Runtime *a){
+    fputs(a->popString().get(),a->outputStream);
+}
+
+static void _word__x(angort::Runtime *a){
+    int x = a->popval()->toInt();
+    fprintf(a->outputStream,"%x",x);
+}
+
+static void _word__rawp(angort::Runtime *a){
+    void *p = a->popval()->getRaw();
+    fprintf(a->outputStream,"%p",p);
+}
+
+
+static void _word__redir(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"s");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+    a->endredir();
+    FILE *f = fopen(p0,"w");
+     if(!f)
+        throw RUNT(EX_FAILED,"").set("redir unable to open file %s",p0);
+    a->outputStream=f;
+}
+
+static void _word__endredir(angort::Runtime *a){
+    a->endredir();
+}
+
+
+static void _word__nl(angort::Runtime *a){
+    fputc('\n',a->outputStream);
+}
+
+static void _word__errp(angort::Runtime *a){
+    const StringBuffer& str = a->popString();
+    fputs(str.get(),stderr);
+}
+
+static void _word__errnl(angort::Runtime *a){
+    fputc('\n',stderr);
+}
+
+
+static void _word__quit(angort::Runtime *a){
+    //todo threads - might cause problems if threads survive
+    a->ang->shutdown();
+    exit(0);
+}
+
+static void _word__abort(angort::Runtime *a){
+    //todo threads - might cause problems if threads survive
+    a->ang->shutdown();
+    fprintf(stderr,"%s\n",a->popString().get());
+    exit(1);
+}
+
+static void _word__debug(angort::Runtime *a){
+    a->trace = a->popInt()!=0;
+}
+
+static void _word__disasm(angort::Runtime *a){
+    //todo threads - might cause weirdness if invoked in another thread, so
+    //turning it off there
+    a->checkzerothread();
+    
+    Value *v = a->popval();
+    if(v->t == Types::tString)
+        a->ang->disasm(v->v.s);
+    else if(v->t == Types::tClosure)
+        a->ang->disasm(v->v.closure->cb);
+    else if(v->t == Types::tCode)
+        a->ang->disasm(v->v.cb);
+    else 
+        throw RUNT(EX_BADPARAM,"bad type for 'disasm'");
+        
+}
+
+static void _word__assertdebug(angort::Runtime *a){
+    a->assertDebug = a->popBool()!=0;
+}
+
+static void _word__assert(angort::Runtime *a){
+    const StringBuffer &desc = a->popString();
+    bool cond = (a->popBool()==0);
+    
+    if(a->assertNegated){
+        cond=!cond;
+        if(a->assertDebug)printf("Negated ");
+    }
+    if(cond){
+        if(a->assertDebug)printf("Assertion failed: %s\n",desc.get());
+        throw AssertException(desc.get(),a->ang->getLineNumber());
+    } else if(a->assertDebug)
+        printf("Assertion passed: %s\n",desc.get());
+}
+
+static int stackcheck=-1;
+static void _word__chkstart(angort::Runtime *a){
+    a->checkzerothread();
+    stackcheck = a->stack.ct;
+}
+static void _word__chkend(angort::Runtime *a){
+    if(a->stack.ct!=stackcheck)
+        throw AssertException("stack check failed",a->ang->getLineNumber());
+    
+}
+
+
+
+
+static void _word__assertmode(angort::Runtime *a){
+    const StringBuffer& sb = a->popString();
+    if(!strcmp(sb.get(),"negated"))
+        a->assertNegated=true;
+    else
+        a->assertNegated=false;
+}
+
+static void _word__asserteq(angort::Runtime *a){
+    if(a->popInt()!=a->popInt())
+        throw RUNT(EX_ASSERT,"assertq failure");
+}
+
+static void _word__abs(angort::Runtime *a){
+    Value *v = a->stack.peekptr();
+    v->t->absolute(v,v);
+}
+
+static void _word__neg(angort::Runtime *a){
+    Value *v = a->stack.peekptr();
+    v->t->negate(v,v);
+}
+    
+
+static void _word__isnone(angort::Runtime *a){
+    Value *s = a->stack.peekptr();
+    Types::tInteger->set(s,s->isNone()?1:0);
+}
+
+static void _word__isnumber(angort::Runtime *a){
+    Value *s = a->stack.peekptr();
+    Types::tInteger->set(s,s->t->flags & TF_NUMBER?1:0);
+}
+
+static void _word__iscallable(angort::Runtime *a){
+    Value *s = a->stack.peekptr();
+    Types::tInteger->set(s,s->t->isCallable()?1:0);
+}
+
+static void _word__gccount(angort::Runtime *a){
+    a->pushInt(GarbageCollected::getGlobalCount());
+}
+
+static void _word__getglobal(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"s");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+    int id = a->ang->findOrCreateGlobal(p0);
+    ReadLock lock(&a->ang->names);
+    Value *v = a->ang->names.getVal(id);
+    // have to deal with properties too. Ugly.
+    if(v->t == Types::tProp){
+        v->v.property->preGet();
+        a->pushval()->copy(&v->v.property->v);
+        v->v.property->postGet();
+    }
+    else
+        a->pushval()->copy(a->ang->names.getVal(id));
+}
+static void _word__setglobal(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vs");
+Value * p0 = _parms[0];
+const StringBuffer &_sb1 = _parms[1]->toString();
+const char *p1 = _sb1.get();
+    WriteLock lock=WL(&a->ang->names);
+    int id = a->ang->findOrCreateGlobal(p1);
+    Value *v = a->ang->names.getVal(id);
+    // have to deal with properties too. Ugly.
+    if(v->t == Types::tProp){
+        v->v.property->preSet();
+        v->v.property->v.copy(p0);
+        v->v.property->postSet();
+    }
+    else
+        a->ang->names.getVal(id)->copy(p0);
+}
+
+
+static void _word__range(angort::Runtime *a){
+    int end = a->popInt();
+    int start = a->popInt();
+    Value *v = a->pushval();
+    Types::tIRange->set(v,start,end,end>=start?1:-1);
+}
+
+static void _word__srange(angort::Runtime *a){
+    int step = a->popInt();
+    int end = a->popInt();
+    int start = a->popInt();
+    Value *v = a->pushval();
+    Types::tIRange->set(v,start,end,step);
+}
+
+static void _word__frange(angort::Runtime *a){
+    float step = a->popFloat();
+    float end = a->popFloat();
+    float start = a->popFloat();
+    Value *v = a->pushval();
+    Types::tFRange->set(v,start,end,step);
+}
+
+static void _word__frangesteps(angort::Runtime *a){
+    float steps = a->popFloat();
+    float end = a->popFloat();
+    float start = a->popFloat();
+    float step = (end-start)/steps;
+    end += step * 0.4f;
+    
+    Value *v = a->pushval();
+    Types::tFRange->set(v,start,end,step);
+}
+
+static void _word__i(angort::Runtime *a){
+    Value *p = a->pushval();
+    p->copy(&a->getTopIterator()->current);
+}
+static void _word__j(angort::Runtime *a){
+    Value *p = a->pushval();
+    p->copy(&a->getTopIterator(1)->current);
+}
+static void _word__k(angort::Runtime *a){
+    Value *p = a->pushval();
+    p->copy(&a->getTopIterator(2)->current);
+}
+
+static void _word__ival(angort::Runtime *a){
+    Value *iterable = &a->getTopIterator()->iterable;
+    Value *cur = &a->getTopIterator()->current;
+    Value *p = a->pushval();
+    iterable->t->getValue(iterable,cur,p);
+}
+
+static void _word__jval(angort::Runtime *a){
+    Value *iterable = &a->getTopIterator(1)->iterable;
+    Value *cur = &a->getTopIterator(1)->current;
+    Value *p = a->pushval();
+    iterable->t->getValue(iterable,cur,p);
+}
+
+static void _word__kval(angort::Runtime *a){
+    Value *iterable = &a->getTopIterator(2)->iterable;
+    Value *cur = &a->getTopIterator(2)->current;
+    Value *p = a->pushval();
+    iterable->t->getValue(iterable,cur,p);
+}
+
+static void _word__iidx(angort::Runtime *a){
+    a->pushInt(a->getTopIterator()->index());
+}    
+
+static void _word__jidx(angort::Runtime *a){
+    a->pushInt(a->getTopIterator(1)->index());
+}    
+
+static void _word__kidx(angort::Runtime *a){
+    a->pushInt(a->getTopIterator(2)->index());
+}    
+
+
+static void _word__iter(angort::Runtime *a){
+    Value *p = a->pushval();
+    p->copy(&a->getTopIterator()->iterable);
+}
+
+static void _word__mkiter(angort::Runtime *a){
+    Value *p = a->stack.peekptr();
+    p->t->createIterator(p,p);
+}
+
+static void _word__icur(angort::Runtime *a){
+    Value *p = a->stack.peekptr();
+    Iterator<Value *>* i = Types::tIter->get(p);
+    if(i->isDone())
+        p->clr();
+    else
+        p->copy(i->current());
+}
+
+static void _word__inext(angort::Runtime *a){
+    Value *p = a->stack.popptr();
+    Iterator<Value *>* i = Types::tIter->get(p);
+    i->next();
+}
+
+static void _word__icurnext(angort::Runtime *a){
+    Value *p = a->stack.peekptr();
+    Iterator<Value *>* i = Types::tIter->get(p);
+    if(i->isDone())
+        p->clr();
+    else {
+        p->copy(i->current());
+        i->next();
+    }
+        
+}
+
+static void _word__ifirst(angort::Runtime *a){
+    Value *p = a->stack.popptr();
+    Iterator<Value *>* i = Types::tIter->get(p);
+    i->first();
+}
+
+static void _word__idone(angort::Runtime *a){
+    Value *p = a->stack.peekptr();
+    Iterator<Value *>* i = Types::tIter->get(p);
+    Types::tInteger->set(p,i->isDone()?1:0);
+}
+    
+static void _word__iteridx(angort::Runtime *a){
+    Value *p = a->stack.peekptr();
+    Iterator<Value *>* i = Types::tIter->get(p);
+    Types::tInteger->set(p,i->index());
+}
+    
+
+static void _word__reset(angort::Runtime *a){
+    while(!a->stack.isempty()){
+        Value *v = a->popval();
+        v->clr();
+    }
+    a->clear();
+}
+
+static void _word__clear(angort::Runtime *a){
+    while(!a->stack.isempty()){
+        Value *v = a->popval();
+        v->clr();
+    }
+}
+
+static void _word__list(angort::Runtime *a){
+    a->ang->list();
+}
+
+static void _word__help(angort::Runtime *a){
+    const StringBuffer &name = a->popString();
+    const char *s = a->ang->getSpec(name.get());
+    if(!s)s="no help found";
+    printf("%s: %s\n",name.get(),s);
+}
+
+static void _word__listhelp(angort::Runtime *a){
+    // this may lock the namespace for quite some time.
+    ReadLock lock(&a->ang->names);
+    Namespace *s = a->ang->names.getSpaceByName(a->popString().get());
+    for(int i=0;i<s->count();i++){
+        NamespaceEnt *e = s->getEnt(i);
+        if(!e->isPriv){
+            const char *spec = e->spec?e->spec:"";
+            if(spec)
+                printf("%-20s : %s\n",s->getName(i),spec);
+            else
+                printf("%-20s\n",s->getName(i));
+        }
+    }                                  
+}
+
+
+static void _word__type(angort::Runtime *a){
+    Value *v = a->stack.peekptr();
+    // views are strings as far as anyone outside should be concerned
+    const Type *t = v->t == Types::tStrView ? Types::tString : v->t;
+    Types::tSymbol->set(v,t->nameSymb);
+}
+
+static void _word__listtypes(angort::Runtime *a){
+    Type::dumpTypes();
+}
+
+
+
+static void _word__gc(angort::Runtime *a){
+    a->gc();
+}
+
+static void _word__getns(angort::Runtime *a){
+    ReadLock lock(&a->ang->names);
+    Types::tNSID->set(a->pushval(),a->ang->names.getCurrent());
+}
+
+static void _word__nsname(angort::Runtime *a){
+    ReadLock lock(&a->ang->names);
+    int idx = Types::tNSID->get(a->popval());
+    const char *s = a->ang->names.spaces.getName(idx);
+    a->pushString(s);
+}
+        
+    
+    
+    
+
+static void _word__nspace(angort::Runtime *a){
+    ReadLock lock(&a->ang->names);
+    const StringBuffer& name = a->popString();
+    int idx = a->ang->names.spaces.get(name.get());
+    if(idx<0)
+        a->pushNone();
+    else
+        Types::tNSID->set(a->pushval(),idx);
+}
+
+static void _word__nspaces(angort::Runtime *a){
+    ReadLock lock(&a->ang->names);
+    ArrayList<Value> *list=Types::tList->set(a->pushval());
+    a->ang->names.spaces.appendNamesToList(list);
+}
+
+static void _word__names(angort::Runtime *a){
+    ReadLock lock(&a->ang->names);
+    int idx = Types::tNSID->get(a->popval());
+    Namespace *ns = a->ang->names.getSpaceByIdx(idx);
+    if(!ns)a->pushNone();
+    else {
+        ArrayList<Value> *list=Types::tList->set(a->pushval());
+        ns->appendNamesToList(list);
+    }
+}
+
+
+static void _word__ispriv(angort::Runtime *a){
+    ReadLock lock(&a->ang->names);
+    NamespaceEnt *ent = getNSEnt(a);
+    a->pushInt(ent->isPriv?1:0);
+    
+}
+static void _word__isconst(angort::Runtime *a){
+    ReadLock lock(&a->ang->names);
+    NamespaceEnt *ent = getNSEnt(a);
+    a->pushInt(ent->isConst?1:0);
+    
+}
+
+static void _word__lookup(angort::Runtime *a){
+    ReadLock lock(&a->ang->names);
+    NamespaceEnt *ent = getNSEnt(a);
+    a->pushval()->copy(&ent->v);
+}
+    
+static void _word__tostr(angort::Runtime *a){
+    const StringBuffer& str = a->popString();
+    
+    // we'll get a problems if we try to do this is
+    // one move, because we may be writing a string back
+    // to itself. This will deallocate the string before
+    // it can be copied over onto itself.
+    Value tmp;
+    Types::tString->set(&tmp,str.get());
+    a->pushval()->copy(&tmp);
+    
+}
+    
+
+static void _word__tosymbol(angort::Runtime *a){
+    const StringBuffer& name = a->popString();
+    int symb = SymbolType::getSymbol(name.get());
+    
+    Types::tSymbol->set(a->pushval(),symb);
+    
+}
+
+static void _word__tolong(angort::Runtime *a){
+    Value *v = a->stack.peekptr();
+    Types::tLong->set(v,v->toLong());
+}
+
+static void _word__todouble(angort::Runtime *a){
+    Value *v = a->stack.peekptr();
+    Types::tDouble->set(v,v->toDouble());
+}
+
+static void _word__toint(angort::Runtime *a){
+    Value *v = a->stack.peekptr();
+    Types::tInteger->set(v,v->toInt());
+}
+        
+static void _word__tofloat(angort::Runtime *a){
+    Value *v = a->stack.peekptr();
+    Types::tFloat->set(v,v->toFloat());
+}
+        
+
+static void _word__endpackage(angort::Runtime *a){
+    a->checkzerothread();
+    a->ang->endPackageInScript();
+}
+
+
+static void _word__dumpframe(angort::Runtime *a){
+    a->dumpFrame();
+}
+
+static void _word__bor(angort::Runtime *a){
+    Value *p[2];
+    a->popParams(p,"nn");
+    int x = p[0]->toLong();
+    int y = p[1]->toLong();
+    a->pushLong(x|y);
+}
+static void _word__band(angort::Runtime *a){
+    Value *p[2];
+    a->popParams(p,"nn");
+    int x = p[0]->toLong();
+    int y = p[1]->toLong();
+    a->pushLong(x&y);
+}
+static void _word__bxor(angort::Runtime *a){
+    Value *p[2];
+    a->popParams(p,"nn");
+    int x = p[0]->toLong();
+    int y = p[1]->toLong();
+    a->pushLong(x^y);
+}
+static void _word__bnot(angort::Runtime *a){
+    Value *p;
+    a->popParams(&p,"n");
+    int x = p->toLong();
+    a->pushLong(~x);
+}
+static void _word__shiftleft(angort::Runtime *a){
+    Value *p[2];
+    a->popParams(p,"nn");
+    int x = p[0]->toLong();
+    int y = p[1]->toLong();
+    a->pushLong(x<<y);
+}
+static void _word__shiftright(angort::Runtime *a){
+    Value *p[2];
+    a->popParams(p,"nn");
+    int x = p[0]->toLong();
+    int y = p[1]->toLong();
+    a->pushLong(x>>y);
+}
+
+static void _word__read(angort::Runtime *a){
+    if(!feof(stdin)){
+        char *buf=NULL;
+        size_t size;
+        int rv = getline(&buf,&size,stdin);
+        if(rv<=0)
+            a->pushNone();
+        else{
+            buf[rv-1]=0;
+            a->pushString(buf);
+        }
+        if(buf)free(buf);
+    } else
+        a->pushNone();
+}
+
+static void _word__setfloatformat(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"s");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+    if(strlen(p0)>63)
+        throw RUNT(EX_LONGNAME,"format string too long");
+    strcpy(Types::tFloat->formatString,p0);
+}
+
+static void _word__setdoubleformat(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"s");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+    if(strlen(p0)>63)
+        throw RUNT(EX_LONGNAME,"format string too long");
+    strcpy(Types::tDouble->formatString,p0);
+}
+
+static void _word__library(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"s");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+    
+    Types::tNSID->set(a->pushval(),a->ang->plugin(p0));
+}
+
+static void _word__import(angort::Runtime *a){
+    WriteLock lock=WL(&a->ang->names);
+    a->checkzerothread();
+    if(a->stack.peekptr()->t==Types::tNSID){
+        int nsid = Types::tNSID->get(a->popval());
+        a->ang->names.import(nsid,NULL);
+    } else if(a->stack.peekptr()->t==Types::tList){
+        ArrayList<Value> *lst = Types::tList->get(a->popval());
+        int nsid = Types::tNSID->get(a->popval());
+        a->ang->names.import(nsid,lst);
+    } else
+        throw SyntaxException("expected package list or package in import");
+}
+
+static void _word__alias(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"ss");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+const StringBuffer &_sb1 = _parms[1]->toString();
+const char *p1 = _sb1.get();
+    a->ang->names.alias(p0,p1);
+}
+
+static void _word__eval(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"ls");
+ArrayList<Value> *p0 = Types::tList->get(_parms[0]);
+const StringBuffer &_sb1 = _parms[1]->toString();
+const char *p1 = _sb1.get();
+    // sadly this isn't threadsafe, because there's only one compile context
+    // stack, so we're going to lock everything by locking the names.
+    WriteLock lock = WL(&a->ang->names);
+    
+    // compile the string
+    Value code;
+    a->ang->compile(p1,&code);
+    
+    // get a new runtime 
+    Runtime r(a->ang,"eval"); 
+    
+    // push the list elements
+    int len = p0->count();
+    for(int i=0;i<len;i++){
+        r.pushval()->copy(p0->get(i));
+    }
+    // run the code
+    r.trace = a->trace; // make sure we're debugging if the parent is
+    r.runValue(&code);
+    
+    // get top item and transfer or push none
+    if(r.stack.isempty())
+        a->pushNone();
+    else
+        a->pushval()->copy(r.popval());
+}
+
+static void _word__showclosure(angort::Runtime *a){
+    Value *v = a->popval();
+    if(v->t == Types::tClosure)
+        v->v.closure->show("Show command");
+}
+
+static void _word__setshowinit(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"q");
+bool p0 = _parms[0]->toBool();
+    a->ang->setShowInit(p0);
+}
+
+
+
+
+static void __init__(angort::Runtime *a,bool showinit)
+{
+    a->ang->registerProperty("autogc",new angort::AutoGCProperty(a));
+    a->ang->registerProperty("searchpath",new angort::SearchPathProperty(a));
+}
+static angort::WordDef _wordlist_[]={
+    {"signal","(sig --) install a signal handler for signal number sig\n After this call, signal number i will result in an exception ex$sigN,\n where N is the signal number i.",_word__signal},
+    {"signals","(--) install a handler for a good subset of signals\n After this call, a signal will result in an exception ex$sigN,\n where N is the signal number. The signals trapped are:\n SIGHUP, SIGINT, SIGQUIT, SIGILL, SIGTRAP, SIGIOT, SIGBUS, SIGFPE, SIGUSR1,\n SIGSEGV SIGUSR2, SIGPIPE, SIGALRM, SIGTERM, SIGALRM, SIGSTKFLT, SIGCHLD,\n SIGCONT, SIGTSTP SIGTTIN, SIGTTOU, SIGURG, SIGXCPU, SIGXFSZ, SIGVTALRM,\n SIGPROF, SIGWINCH, SIGIO SIGPWR, SIGSYS",_word__signals},
+    {"strsignal","(sig -- name) get signal name for signal number\n Return the standard signal name for a given signal, e.g. \"Hangup\" for\n SIGHUP (1).",_word__strsignal},
+    {"version","( -- version ) version number\n Return the Angort version number as an string.",_word__version},
+    {"barewords","(v --) turn bare words on or off\n If set to true, unknown identifiers will be converted to symbol values.",_word__barewords},
+    {"show","(v -- s) show a variable into a string\n This shows more detail than a . or p, for example recursively showing\n lists and hashes. It outputs to a string.",_word__show},
+    {"dump","( title -- ) dump the stack\n Print the values on the stack with a title, using naive string conversion\n (e.g. all the items in a list will not be printed, just a brief string\n identifying the list).",_word__dump},
+    {"raisesignal","(sig --) throw a signal",_word__raisesignal},
+    {"snark","( ) used during debugging; prints an autoincremented count\n Simply prints SNARK N, where N increments at every call. These are added\n to programs during debugging, so that one can \"hunt the snarks\" when\n removing them.",_word__snark},
+    {"esnark","( ) used during debugging; prints an autoincremented count to stderr\n Simply prints SNARK N, where N increments at every call. These are added\n to programs during debugging, so that one can \"hunt the snarks\" when\n removing them.",_word__esnark},
+    {"boojum","( ) used during debugging; sets the boojum global",_word__boojum},
+    {"endboojum","( ) used during debugging; clears the boojum global",_word__endboojum},
+    {"none","( -- none ) stack a None value",_word__none},
+    {"ct","(-- ct) push the current stack count",_word__ct},
+    {"rct","(gcv -- ct) push the ref count for a GC value\n For a garbage collected item, push the reference count. Pushes 0\n for other items.",_word__rct},
+    {"p","( v -- ) print a value\n Prints a string representation of a value to stdout without a\n trailing newline.",_word__p},
+    {"x","(v -- ) print a value in hex\n Prints a hex representation of an integer value to stdout without a\n trailing newline.",_word__x},
+    {"rawp","(v --) print a ptr value as raw hex\n Prints a raw hex representation of an  value to stdout without a\n trailing newline.",_word__rawp},
+    {"redir","(filename --) open a new file and redirect output to it.\n For more complex file output, use the IO library. On fail, throws\n ex$failed.",_word__redir},
+    {"endredir","(--) close a redirected output stream",_word__endredir},
+    {"nl","( -- ) print a new line",_word__nl},
+    {"errp","( s -- ) print a string to stdout",_word__errp},
+    {"errnl","( -- ) print newline to stdout",_word__errnl},
+    {"quit","( -- ) exit with return code 0\n Typically used to terminate an Angort program, which would normally\n drop back to the interpreter.",_word__quit},
+    {"abort","( s -- ) exit with return code 1 and an error message to stderr",_word__abort},
+    {"debug","( v -- ) turn debugging on or off (value is 0 or 1)\n If true, every instruction executed will print to stdout along\n with a stack dump. Slows down the program!",_word__debug},
+    {"disasm","(name|codeblock|closure -- ) disassemble word\n Print to stdout the instructions for a named Angort function.",_word__disasm},
+    {"assertdebug","(bool --) turn assertion printout on/off\n Assertions will not be printed if this is false. If true,\n both true and false assertions will print.",_word__assertdebug},
+    {"assert","(bool desc --) throw exception with string 'desc' if bool is false\n Asserts that the boolean is true, throwing ex$assert if not. Will\n print the assertion, even if it passes, if assertdebug has been set.\n If assertmode has been set to `negated, false assertions will pass (used\n in assertion testing). All prints are to stdout.",_word__assert},
+    {"chkstart","(--) start stack check block (save stack ct)\n Records the stack count, ready for \"chkend\".",_word__chkstart},
+    {"chkend","(--) end stack check block (check stack count agrees with saved)\n If the current stack count does not match that stored by the last\n \"chkstart\", throw an ex$assert exception.",_word__chkend},
+    {"assertmode","(mode --) set to `negated or `normal, if negated assertion conditions are negated\n If set to `negated, subsequent assertions pass if they are false. This is\n used to test the assertion functionality.",_word__assertmode},
+    {"asserteq","(a b -- ) if a!=b assert\n Shortcut for asserting that two integer values are equal.",_word__asserteq},
+    {"abs","(x --) absolute value\n return the absolute value of a float or int.",_word__abs},
+    {"neg","(x --) negate\n Negate an int or float.",_word__neg},
+    {"isnone","(val -- bool) is a value NONE\n Returns true if the value is a NONE value.",_word__isnone},
+    {"isnumber","(val -- bool) return true if a numeric type",_word__isnumber},
+    {"iscallable","(val -- bool) return true if is codeblock or closure\n Return true if the value is a function.",_word__iscallable},
+    {"gccount","(-- val) return the number of GC objects\n Returns the total number of garbage collected objects in the system.",_word__gccount},
+    {"getglobal","(string -- val) get a global by name\n Gets the value of a global variable by name.",_word__getglobal},
+    {"setglobal","(val string -- val) set a global by name\n Sets the value of a global variable by name.",_word__setglobal},
+    {"range","(start end -- range) build a range object\n Returns a new integer range object, which covers the range [start,end),\n i.e. \"0 10 range\" returns a range for the values 0 to 9. If the end\n is less than the start, the range will run backwards (step will be -1),\n otherwise the step will be 1.",_word__range},
+    {"srange","(start end step -- range) build a range object with step\n Returns a new integer range object, which covers the range [start,end),\n i.e. \"0 10 1 srange\" returns a range for the values 0 to 9. The step\n gives the interval, so \"0 10 2 srange \" will give the numbers 0,2,4,6,8.",_word__srange},
+    {"frange","(start end step -- range) build a float range object with step size\n Returns a new floating point range object, with a step size for iteration.\n This excludes the end value, so \"0 10 1 frange\" will iterate over 0-9.",_word__frange},
+    {"frangesteps","(start end stepcount -- range) build a float range object with step count\n Returns a new floating point range object, generating the step size from\n the number of steps required. This excludes the end value, so\n \"0 10 10 frangesteps\" will iterate over 0-9.",_word__frangesteps},
+    {"i","(-- current) get current iterator value (key if hash)\n If in an iterator (\"each\") loop, return the current value. For hashes,\n this will return the key.",_word__i},
+    {"j","(-- current) get nested iterator value (key if hash)\n If in an 2-deep iterator (\"each\") loop, return the current value of\n the outer loop. For hashes, this will return the key.",_word__j},
+    {"k","(-- current) get nested iterator value (key if hash)\n If in an 3-deep iterator (\"each\") loop, return the current value of\n the outer loop. For hashes, this will return the key.",_word__k},
+    {"ival","(-- current) get current iterator value (value if hash)\n If in an iterator (\"each\") loop, return the current value. For hashes,\n this will return the value (as opposed to \"i\").",_word__ival},
+    {"jval","(-- current) get nested iterator value (value if hash)\n If in an 2-deep iterator (\"each\") loop, return the current value of\n the outer loop. For hashes, this will return the value (as opposed to \"j\").",_word__jval},
+    {"kval","(-- current) get nested iterator value (value if hash)\n If in an 3-deep iterator (\"each\") loop, return the current value of\n the outer loop. For hashes, this will return the value (as opposed to \"k\").",_word__kval},
+    {"iidx","(-- index) get current iterator index integer\n The iterator index counts how many times the iterator has moved forwards\n in the iterable.",_word__iidx},
+    {"jidx","(-- index) get nested iterator index integer.\n The iterator index counts how many times the iterator has moved forwards\n in the iterable.",_word__jidx},
+    {"kidx","(-- index) get 2nd nested iterator index integer.\n The iterator index counts how many times the iterator has moved forwards\n in the iterable.",_word__kidx},
+    {"iter","(-- iterable) get the iterable which is currently being looped over\n Return the actual iterable object which is being iterated over inside an\n \"each\" loop.",_word__iter},
+    {"mkiter","(iterable -- iterator) make an iterator object\n Create an iterator for an iterable value. Typical usage might be\n something like \n  \"?L mkiter !I { ?I idone ifleave ?I icurnext.}\"\n although \"each\" is advisable for this simple situation.",_word__mkiter},
+    {"icur","(iterator -- item) get current item in iterator made with mkiter\n Get the current value of an iterator created with \"mkiter\". Returns\n NONE if the iterator has completed.",_word__icur},
+    {"inext","(iterator --) advance the iterator\n Advance an iterator created with \"mkiter\".",_word__inext},
+    {"icurnext","(iterator -- item) combined icur and inext\n Get the current value of an iterator created with \"mkiter\", advance\n the iterator and return the value. Returns NONE if the iterator has\n completed.",_word__icurnext},
+    {"ifirst","(iterator --) reset the iterator to the start\n Reset an iterator created with \"mkiter\" to the start of the iterable.",_word__ifirst},
+    {"idone","(iterator -- boolean) true if iterator is done\n Return true if an iterator created with \"mkiter\" has completed.",_word__idone},
+    {"iteridx","(iterator -- int) return iterator index (see iidx)",_word__iteridx},
+    {"reset","(--) Clear everything\n Clears the stack and resets all namespaces.",_word__reset},
+    {"clear","(--) Clear the stack, and also set all values to None\n Clears the stack and resets all stack values to NONE, which should\n release any stale garbage collected objects which were previously\n on the stack (although those in the local variable stack and in\n globals will survive).",_word__clear},
+    {"list","(--) List everything\n List the names registered in all namespaces.",_word__list},
+    {"help","(s --) get help on a word or native function\n This is the same as \"??name\".",_word__help},
+    {"listhelp","(s --) list and show help for all public functions in the given namespace\n List all words in a given namespace, showing the help texts for all\n of them.",_word__listhelp},
+    {"type","(v -- symb) get the type of the item as a symbol",_word__type},
+    {"listtypes","( -- ) print the types\n Lists the names of all Angort types, including the internal ones\n (such as \"natprop\" and \"deleted\").",_word__listtypes},
+    {"gc","(--) perform a major garbage detect and cycle removal\n Runs a major garbage detect, which includes detecting cycles. This\n is automatically run every \"autogc\" ticks, so you may need to do this\n if your program has done \"0!autogc\" to turn that off. Alternatively\n you may not if your program does not create cyclic references (data\n structures which refer to themselves).",_word__gc},
+    {"getns","(-- nsid) get the current namespace ID\n Gets the NSID of the namespace to which names are currently being written.",_word__getns},
+    {"nsname","(nsid -- name) get the name of a namespace",_word__nsname},
+    {"nspace","(name -- nsid|none) get a namespace by name\n Return a namespace ID for a given namespace or NONE.",_word__nspace},
+    {"nspaces","(-- list) return a list of all namespaces in index order\n Returns a list names of all namespaces, in the order in which they\n were created.",_word__nspaces},
+    {"names","(nsid --) get a list of names from a namespace\n Returns a list of names from a namespace whose handle has been obtained\n with \"nspace\".",_word__names},
+    {"ispriv","(nsid name -- bool) return true if the definition is private in the namespace\n Returns true if the identifier is private inside the given namespace, which\n is identified by a nsid returned by \"nspace\".",_word__ispriv},
+    {"isconst","(nsid name -- bool) return true if the definition is constant in the namespace\n Returns true if the identifier is modifiable inside the given namespace, which\n is identified by a nsid returned by \"nspace\".",_word__isconst},
+    {"lookup","(nsid name -- value) look up the value of a namespace entity\n Looks up an identifier in a namespace, which is identified by a nsid\n returned by \"nspace\", and returns its value.",_word__lookup},
+    {"tostr","(val -- string) convert value to string",_word__tostr},
+    {"tosymbol","(val -- symbol) convert value to symbol",_word__tosymbol},
+    {"tolong","(val -- long) -- convert value to long int",_word__tolong},
+    {"todouble","(val -- double) -- convert value to double",_word__todouble},
+    {"toint","(string -- int) string to integer",_word__toint},
+    {"tofloat","(string -- float) string to float",_word__tofloat},
+    {"endpackage","(-- namespaceID) mark end of package, only when used within a single script\n For packages which are part of a long script, this marks the end. Normally\n the end of a package is marked by the end of the file.",_word__endpackage},
+    {"dumpframe","() debugging - dump the frame variables and GC objects\n Prints internal debugging data.",_word__dumpframe},
+    {"bor","(a b -- a|b) bitwise or",_word__bor},
+    {"band","(a b -- a&b) bitwise and",_word__band},
+    {"bxor","(a b -- a^b) bitwise xor",_word__bxor},
+    {"bnot","(a -- ~a) bitwise not",_word__bnot},
+    {"shiftleft","(a b -- a<<b) bitshift left",_word__shiftleft},
+    {"shiftright","(a b -- a>>b) bitshift right",_word__shiftright},
+    {"read","(-- s|none) read line from stdin\n Reads and returns a line from stdin, unless the end of file has been\n reached in which case NONE is returned.",_word__read},
+    {"setfloatformat","(s --) set a printf format string for floats\n Sets the format string used for the standard conversion from floats\n to strings. The default is \"%f\". Doubles have a separate string set\n with setdoubleformat.",_word__setfloatformat},
+    {"setdoubleformat","(s --) set a printf format string for doubless\n Sets the format string used for the standard conversion from doubles\n to strings. The default is \"%f\". Floats have a separate string set\n with setfloatformat.",_word__setdoubleformat},
+    {"library","(name -- nsid) load a plugin library, returning the namespace ID\n This loads a C++ native library and returns the NSID. Typically the\n next step will be to either drop or import the library. The latter\n will be to mark the library's namespace as imported, so that its\n symbols can be used without a fully-qualified name.",_word__library},
+    {"import","(namespaceint --) or (namespaceint list --) import namespace or namespace members into default space\n The first form will add a namespace to the \"imported namespace list\",\n so that all members of the namespace will be available without full\n qualification (i.e. without a \"$\").\n The second form will import copy single values from a namespace\n into the default namespace, making them available without full\n qualification. The idiom for this is typically:\n `libname nspace [`s1,`s2..] import",_word__import},
+    {"alias","(newname oldname --) create a copy of a namespace with a different name",_word__alias},
+    {"eval","(list string -- result or none) evaluate an Angort string\n Evaluates an Angort string in its own compile and runtime context\n (so locals aren't accessible). Arguments may be passed in a list\n which is exploded onto the stack: [1,2,3] becomes (1 2 3 --)\n If the stack is not empty at end, the top item is pushed, otherwise none\n is pushed.",_word__eval},
+    {"showclosure","(cl --)",_word__showclosure},
+    {"setshowinit","(bool --) change whether libraries should print in %init",_word__setshowinit},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_std 
+
+angort::LibraryDef _angortlib_std = {
+    "std",
+    _angortlib_ns_std::_wordlist_,
+    _angortlib_ns_std::_binoplist_,
+    _angortlib_ns_std::__init__,NULL
+};
+extern "C" angort::LibraryDef *init(angort::Runtime *api){
+    return &_angortlib_std;
+}   
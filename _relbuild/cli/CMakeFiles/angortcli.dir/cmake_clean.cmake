@@ -0,0 +1,20 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/angortcli.dir/cliWords.cpp.cpp.o"
+  "CMakeFiles/angortcli.dir/cliWords.cpp.cpp.o.d"
+  "CMakeFiles/angortcli.dir/debtoks.cpp.o"
+  "CMakeFiles/angortcli.dir/debtoks.cpp.o.d"
+  "CMakeFiles/angortcli.dir/debugger.cpp.o"
+  "CMakeFiles/angortcli.dir/debugger.cpp.o.d"
+  "CMakeFiles/angortcli.dir/main.cpp.o"
+  "CMakeFiles/angortcli.dir/main.cpp.o.d"
+  "angort"
+  "angort.pdb"
+  "cliWords.cpp.cpp"
+  "debtoks.cpp"
+  "debtoks.h"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/angortcli.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
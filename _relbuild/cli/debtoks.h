@@ -0,0 +1,26 @@
+// Token list - generated by gentoks.py from /root/repo/cli/debtoks
+
+#include "tokeniser.h"
+namespace angort {
+extern TokenRegistry debtoks[];
+#define	T_END	0
+#define	T_STRING	1
+#define	T_IDENT	2
+#define	T_INT	3
+#define	T_FLOAT	4
+#define	T_DOUBLE	5
+#define	T_LONG	6
+#define	T_QUESTION	7
+#define	T_BREAK	8
+#define	T_STACK	9
+#define	T_DISASM	10
+#define	T_FRAME	11
+#define	T_ABORT	12
+#define	T_PRINT	13
+#define	T_QUIT	14
+#define	T_NEXT	15
+#define	T_FUNC	16
+#define	T_HELP	17
+#define	T_TERMINATE	18
+#define	T_BACKTRACE	19
+}
@@ -0,0 +1,84 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/lib/angort.cpp" "lib/CMakeFiles/angort.dir/angort.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/angort.cpp.o.d"
+  "/root/repo/lib/binop.cpp" "lib/CMakeFiles/angort.dir/binop.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/binop.cpp.o.d"
+  "/root/repo/lib/cycle.cpp" "lib/CMakeFiles/angort.dir/cycle.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/cycle.cpp.o.d"
+  "/root/repo/_relbuild/lib/deprecated.cpp.cpp" "lib/CMakeFiles/angort.dir/deprecated.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/deprecated.cpp.cpp.o.d"
+  "/root/repo/lib/filefind.cpp" "lib/CMakeFiles/angort.dir/filefind.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/filefind.cpp.o.d"
+  "/root/repo/lib/format.cpp" "lib/CMakeFiles/angort.dir/format.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/format.cpp.o.d"
+  "/root/repo/_relbuild/lib/future.cpp.cpp" "lib/CMakeFiles/angort.dir/future.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/future.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libColl.cpp.cpp" "lib/CMakeFiles/angort.dir/libColl.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libColl.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libEnv.cpp.cpp" "lib/CMakeFiles/angort.dir/libEnv.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libEnv.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libFile.cpp.cpp" "lib/CMakeFiles/angort.dir/libFile.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libFile.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libJSON.cpp.cpp" "lib/CMakeFiles/angort.dir/libJSON.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libJSON.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libLazy.cpp.cpp" "lib/CMakeFiles/angort.dir/libLazy.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libLazy.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libMath.cpp.cpp" "lib/CMakeFiles/angort.dir/libMath.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libMath.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libOMap.cpp.cpp" "lib/CMakeFiles/angort.dir/libOMap.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libOMap.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libPersist.cpp.cpp" "lib/CMakeFiles/angort.dir/libPersist.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libPersist.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libProf.cpp.cpp" "lib/CMakeFiles/angort.dir/libProf.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libProf.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libSer.cpp.cpp" "lib/CMakeFiles/angort.dir/libSer.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libSer.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libStats.cpp.cpp" "lib/CMakeFiles/angort.dir/libStats.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libStats.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libStd.cpp.cpp" "lib/CMakeFiles/angort.dir/libStd.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libStd.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libStrBuild.cpp.cpp" "lib/CMakeFiles/angort.dir/libStrBuild.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libStrBuild.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libString.cpp.cpp" "lib/CMakeFiles/angort.dir/libString.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libString.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libThread.cpp.cpp" "lib/CMakeFiles/angort.dir/libThread.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libThread.cpp.cpp.o.d"
+  "/root/repo/_relbuild/lib/libVec.cpp.cpp" "lib/CMakeFiles/angort.dir/libVec.cpp.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/libVec.cpp.cpp.o.d"
+  "/root/repo/lib/namespace.cpp" "lib/CMakeFiles/angort.dir/namespace.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/namespace.cpp.o.d"
+  "/root/repo/lib/output.cpp" "lib/CMakeFiles/angort.dir/output.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/output.cpp.o.d"
+  "/root/repo/lib/plugins.cpp" "lib/CMakeFiles/angort.dir/plugins.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/plugins.cpp.o.d"
+  "/root/repo/lib/profiler.cpp" "lib/CMakeFiles/angort.dir/profiler.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/profiler.cpp.o.d"
+  "/root/repo/lib/serialise.cpp" "lib/CMakeFiles/angort.dir/serialise.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/serialise.cpp.o.d"
+  "/root/repo/lib/stringbuf.cpp" "lib/CMakeFiles/angort.dir/stringbuf.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/stringbuf.cpp.o.d"
+  "/root/repo/lib/strkernels.cpp" "lib/CMakeFiles/angort.dir/strkernels.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/strkernels.cpp.o.d"
+  "/root/repo/lib/strkernels_avx2.cpp" "lib/CMakeFiles/angort.dir/strkernels_avx2.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/strkernels_avx2.cpp.o.d"
+  "/root/repo/lib/strkernels_sse2.cpp" "lib/CMakeFiles/angort.dir/strkernels_sse2.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/strkernels_sse2.cpp.o.d"
+  "/root/repo/lib/tokeniser.cpp" "lib/CMakeFiles/angort.dir/tokeniser.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/tokeniser.cpp.o.d"
+  "/root/repo/_relbuild/lib/tokens.cpp" "lib/CMakeFiles/angort.dir/tokens.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/tokens.cpp.o.d"
+  "/root/repo/lib/types.cpp" "lib/CMakeFiles/angort.dir/types.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types.cpp.o.d"
+  "/root/repo/lib/types/closure.cpp" "lib/CMakeFiles/angort.dir/types/closure.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/closure.cpp.o.d"
+  "/root/repo/lib/types/code.cpp" "lib/CMakeFiles/angort.dir/types/code.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/code.cpp.o.d"
+  "/root/repo/lib/types/double.cpp" "lib/CMakeFiles/angort.dir/types/double.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/double.cpp.o.d"
+  "/root/repo/lib/types/file.cpp" "lib/CMakeFiles/angort.dir/types/file.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/file.cpp.o.d"
+  "/root/repo/lib/types/float.cpp" "lib/CMakeFiles/angort.dir/types/float.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/float.cpp.o.d"
+  "/root/repo/lib/types/hashtype.cpp" "lib/CMakeFiles/angort.dir/types/hashtype.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/hashtype.cpp.o.d"
+  "/root/repo/lib/types/int.cpp" "lib/CMakeFiles/angort.dir/types/int.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/int.cpp.o.d"
+  "/root/repo/lib/types/iter.cpp" "lib/CMakeFiles/angort.dir/types/iter.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/iter.cpp.o.d"
+  "/root/repo/lib/types/lazy.cpp" "lib/CMakeFiles/angort.dir/types/lazy.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/lazy.cpp.o.d"
+  "/root/repo/lib/types/list.cpp" "lib/CMakeFiles/angort.dir/types/list.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/list.cpp.o.d"
+  "/root/repo/lib/types/long.cpp" "lib/CMakeFiles/angort.dir/types/long.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/long.cpp.o.d"
+  "/root/repo/lib/types/native.cpp" "lib/CMakeFiles/angort.dir/types/native.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/native.cpp.o.d"
+  "/root/repo/lib/types/nsid.cpp" "lib/CMakeFiles/angort.dir/types/nsid.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/nsid.cpp.o.d"
+  "/root/repo/lib/types/numvec.cpp" "lib/CMakeFiles/angort.dir/types/numvec.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/numvec.cpp.o.d"
+  "/root/repo/lib/types/omap.cpp" "lib/CMakeFiles/angort.dir/types/omap.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/omap.cpp.o.d"
+  "/root/repo/lib/types/persist.cpp" "lib/CMakeFiles/angort.dir/types/persist.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/persist.cpp.o.d"
+  "/root/repo/lib/types/range.cpp" "lib/CMakeFiles/angort.dir/types/range.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/range.cpp.o.d"
+  "/root/repo/lib/types/strbuild.cpp" "lib/CMakeFiles/angort.dir/types/strbuild.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/strbuild.cpp.o.d"
+  "/root/repo/lib/types/string.cpp" "lib/CMakeFiles/angort.dir/types/string.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/string.cpp.o.d"
+  "/root/repo/lib/types/strview.cpp" "lib/CMakeFiles/angort.dir/types/strview.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/strview.cpp.o.d"
+  "/root/repo/lib/types/symbol.cpp" "lib/CMakeFiles/angort.dir/types/symbol.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/types/symbol.cpp.o.d"
+  "/root/repo/lib/value.cpp" "lib/CMakeFiles/angort.dir/value.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/value.cpp.o.d"
+  "/root/repo/lib/veckernels.cpp" "lib/CMakeFiles/angort.dir/veckernels.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/veckernels.cpp.o.d"
+  "/root/repo/lib/veckernels_avx.cpp" "lib/CMakeFiles/angort.dir/veckernels_avx.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/veckernels_avx.cpp.o.d"
+  "/root/repo/lib/veckernels_sse2.cpp" "lib/CMakeFiles/angort.dir/veckernels_sse2.cpp.o" "gcc" "lib/CMakeFiles/angort.dir/veckernels_sse2.cpp.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_relbuild/lib/tokens.h" "/root/repo/_relbuild/lib/tokens.cpp"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
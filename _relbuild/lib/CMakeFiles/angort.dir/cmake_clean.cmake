@@ -0,0 +1,149 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/angort.dir/angort.cpp.o"
+  "CMakeFiles/angort.dir/angort.cpp.o.d"
+  "CMakeFiles/angort.dir/binop.cpp.o"
+  "CMakeFiles/angort.dir/binop.cpp.o.d"
+  "CMakeFiles/angort.dir/cycle.cpp.o"
+  "CMakeFiles/angort.dir/cycle.cpp.o.d"
+  "CMakeFiles/angort.dir/deprecated.cpp.cpp.o"
+  "CMakeFiles/angort.dir/deprecated.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/filefind.cpp.o"
+  "CMakeFiles/angort.dir/filefind.cpp.o.d"
+  "CMakeFiles/angort.dir/format.cpp.o"
+  "CMakeFiles/angort.dir/format.cpp.o.d"
+  "CMakeFiles/angort.dir/future.cpp.cpp.o"
+  "CMakeFiles/angort.dir/future.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libColl.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libColl.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libEnv.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libEnv.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libFile.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libFile.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libJSON.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libJSON.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libLazy.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libLazy.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libMath.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libMath.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libOMap.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libOMap.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libPersist.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libPersist.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libProf.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libProf.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libSer.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libSer.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libStats.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libStats.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libStd.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libStd.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libStrBuild.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libStrBuild.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libString.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libString.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libThread.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libThread.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/libVec.cpp.cpp.o"
+  "CMakeFiles/angort.dir/libVec.cpp.cpp.o.d"
+  "CMakeFiles/angort.dir/namespace.cpp.o"
+  "CMakeFiles/angort.dir/namespace.cpp.o.d"
+  "CMakeFiles/angort.dir/output.cpp.o"
+  "CMakeFiles/angort.dir/output.cpp.o.d"
+  "CMakeFiles/angort.dir/plugins.cpp.o"
+  "CMakeFiles/angort.dir/plugins.cpp.o.d"
+  "CMakeFiles/angort.dir/profiler.cpp.o"
+  "CMakeFiles/angort.dir/profiler.cpp.o.d"
+  "CMakeFiles/angort.dir/serialise.cpp.o"
+  "CMakeFiles/angort.dir/serialise.cpp.o.d"
+  "CMakeFiles/angort.dir/stringbuf.cpp.o"
+  "CMakeFiles/angort.dir/stringbuf.cpp.o.d"
+  "CMakeFiles/angort.dir/strkernels.cpp.o"
+  "CMakeFiles/angort.dir/strkernels.cpp.o.d"
+  "CMakeFiles/angort.dir/strkernels_avx2.cpp.o"
+  "CMakeFiles/angort.dir/strkernels_avx2.cpp.o.d"
+  "CMakeFiles/angort.dir/strkernels_sse2.cpp.o"
+  "CMakeFiles/angort.dir/strkernels_sse2.cpp.o.d"
+  "CMakeFiles/angort.dir/tokeniser.cpp.o"
+  "CMakeFiles/angort.dir/tokeniser.cpp.o.d"
+  "CMakeFiles/angort.dir/tokens.cpp.o"
+  "CMakeFiles/angort.dir/tokens.cpp.o.d"
+  "CMakeFiles/angort.dir/types.cpp.o"
+  "CMakeFiles/angort.dir/types.cpp.o.d"
+  "CMakeFiles/angort.dir/types/closure.cpp.o"
+  "CMakeFiles/angort.dir/types/closure.cpp.o.d"
+  "CMakeFiles/angort.dir/types/code.cpp.o"
+  "CMakeFiles/angort.dir/types/code.cpp.o.d"
+  "CMakeFiles/angort.dir/types/double.cpp.o"
+  "CMakeFiles/angort.dir/types/double.cpp.o.d"
+  "CMakeFiles/angort.dir/types/file.cpp.o"
+  "CMakeFiles/angort.dir/types/file.cpp.o.d"
+  "CMakeFiles/angort.dir/types/float.cpp.o"
+  "CMakeFiles/angort.dir/types/float.cpp.o.d"
+  "CMakeFiles/angort.dir/types/hashtype.cpp.o"
+  "CMakeFiles/angort.dir/types/hashtype.cpp.o.d"
+  "CMakeFiles/angort.dir/types/int.cpp.o"
+  "CMakeFiles/angort.dir/types/int.cpp.o.d"
+  "CMakeFiles/angort.dir/types/iter.cpp.o"
+  "CMakeFiles/angort.dir/types/iter.cpp.o.d"
+  "CMakeFiles/angort.dir/types/lazy.cpp.o"
+  "CMakeFiles/angort.dir/types/lazy.cpp.o.d"
+  "CMakeFiles/angort.dir/types/list.cpp.o"
+  "CMakeFiles/angort.dir/types/list.cpp.o.d"
+  "CMakeFiles/angort.dir/types/long.cpp.o"
+  "CMakeFiles/angort.dir/types/long.cpp.o.d"
+  "CMakeFiles/angort.dir/types/native.cpp.o"
+  "CMakeFiles/angort.dir/types/native.cpp.o.d"
+  "CMakeFiles/angort.dir/types/nsid.cpp.o"
+  "CMakeFiles/angort.dir/types/nsid.cpp.o.d"
+  "CMakeFiles/angort.dir/types/numvec.cpp.o"
+  "CMakeFiles/angort.dir/types/numvec.cpp.o.d"
+  "CMakeFiles/angort.dir/types/omap.cpp.o"
+  "CMakeFiles/angort.dir/types/omap.cpp.o.d"
+  "CMakeFiles/angort.dir/types/persist.cpp.o"
+  "CMakeFiles/angort.dir/types/persist.cpp.o.d"
+  "CMakeFiles/angort.dir/types/range.cpp.o"
+  "CMakeFiles/angort.dir/types/range.cpp.o.d"
+  "CMakeFiles/angort.dir/types/strbuild.cpp.o"
+  "CMakeFiles/angort.dir/types/strbuild.cpp.o.d"
+  "CMakeFiles/angort.dir/types/string.cpp.o"
+  "CMakeFiles/angort.dir/types/string.cpp.o.d"
+  "CMakeFiles/angort.dir/types/strview.cpp.o"
+  "CMakeFiles/angort.dir/types/strview.cpp.o.d"
+  "CMakeFiles/angort.dir/types/symbol.cpp.o"
+  "CMakeFiles/angort.dir/types/symbol.cpp.o.d"
+  "CMakeFiles/angort.dir/value.cpp.o"
+  "CMakeFiles/angort.dir/value.cpp.o.d"
+  "CMakeFiles/angort.dir/veckernels.cpp.o"
+  "CMakeFiles/angort.dir/veckernels.cpp.o.d"
+  "CMakeFiles/angort.dir/veckernels_avx.cpp.o"
+  "CMakeFiles/angort.dir/veckernels_avx.cpp.o.d"
+  "CMakeFiles/angort.dir/veckernels_sse2.cpp.o"
+  "CMakeFiles/angort.dir/veckernels_sse2.cpp.o.d"
+  "deprecated.cpp.cpp"
+  "future.cpp.cpp"
+  "libColl.cpp.cpp"
+  "libEnv.cpp.cpp"
+  "libFile.cpp.cpp"
+  "libJSON.cpp.cpp"
+  "libLazy.cpp.cpp"
+  "libMath.cpp.cpp"
+  "libOMap.cpp.cpp"
+  "libPersist.cpp.cpp"
+  "libProf.cpp.cpp"
+  "libSer.cpp.cpp"
+  "libStats.cpp.cpp"
+  "libStd.cpp.cpp"
+  "libStrBuild.cpp.cpp"
+  "libString.cpp.cpp"
+  "libThread.cpp.cpp"
+  "libVec.cpp.cpp"
+  "libangort.a"
+  "libangort.pdb"
+  "tokens.cpp"
+  "tokens.h"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/angort.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
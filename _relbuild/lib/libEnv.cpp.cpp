@@ -0,0 +1,79 @@
+#include "angort.h"
+
+
+using namespace angort;
+
+
+static Value argList;
+
+// we store this because in certain plugins the arglist is useful.
+
+namespace angort {
+char **sysArgv;
+int sysArgc;
+};
+
+void setArgumentList(int argc,char *argv[]){
+    ArrayList<Value>*list = Types::tList->set(&argList);
+    
+    sysArgc=argc;
+    sysArgv=argv;
+    
+    for(int i=0;i<argc;i++){
+        Value *v = list->append();
+        Types::tString->set(v,argv[i]);
+    }
+}
+              
+namespace _angortlib_ns_env {
+
+static void _word__rawargs(angort::Runtime *a){
+    Value *v = a->pushval();
+    v->copy(&argList);
+}
+
+static void _word__getenv(angort::Runtime *a){
+    Value *p;
+    a->popParams(&p,"s");
+    
+    const char *s = getenv(p->toString().get());
+    p = a->pushval();
+    
+    if(s)
+        Types::tString->set(p,s);
+    else
+        p->setNone();
+}
+
+
+static void _word__setenv(angort::Runtime *a){
+    Value *p[2];
+    a->popParams(p,"ss");
+    setenv(p[1]->toString().get(),p[0]->toString().get(),1);
+}
+
+static void _word__unsetenv(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"s");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+    unsetenv(p0);
+}
+    
+static angort::WordDef _wordlist_[]={
+    {"rawargs","(-- list) get command line arguments without stripping\n This retrieves the full command line arguments passed to main(), without\n doing the stripping of Angort-specific arguments performed by std$args.",_word__rawargs},
+    {"getenv","(name -- string/none) get environment variable",_word__getenv},
+    {"setenv","(value name --) set environment variable",_word__setenv},
+    {"unsetenv","(name --) unset environment variable",_word__unsetenv},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_env 
+
+angort::LibraryDef _angortlib_env = {
+    "env",
+    _angortlib_ns_env::_wordlist_,
+    _angortlib_ns_env::_binoplist_,
+    NULL,NULL
+};
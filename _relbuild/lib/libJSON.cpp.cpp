@@ -0,0 +1,622 @@
+#include "angort.h"
+#include "hash.h"
+#include "strkernels.h"
+
+#include <math.h>
+#include <limits.h>
+
+
+using namespace angort;
+
+/// objects and arrays can't be nested deeper than this, which stops
+/// both parsing and dumping (of lists which contain themselves, say)
+/// from running out of C stack.
+#define JSON_MAXDEPTH 1000
+
+/// the bytes which end a run of ordinary characters in a JSON string
+static const strk::ByteSet stringEnds("\"\\",2);
+
+namespace {
+
+/// a recursive descent parser, building the values as it goes
+class JSONParser {
+    const char *start,*end;
+    const char *p;
+    int depth;
+    StringBuilder sb; // for strings with escapes in them
+
+    void fail(const char *what){
+        throw RUNT(EX_SYNTAX,"").set("JSON: %s at byte %d",what,(int)(p-start));
+    }
+
+    static bool isWS(char c){
+        return c==' ' || c=='\n' || c=='\t' || c=='\r';
+    }
+
+    void skipWS(){
+        // usually there's none, or a single space after a comma or
+        // colon; only longer runs (indentation) are worth a scan.
+        if(p<end && isWS(*p)){
+            p++;
+            if(p<end && isWS(*p))
+                p += strk::skipAny(p,end-p,strk::whitespace);
+        }
+    }
+
+    void expect(char c,const char *what){
+        skipWS();
+        if(p==end || *p!=c)
+            fail(what);
+        p++;
+    }
+
+    void literal(const char *s,int len){
+        if(end-p<len || memcmp(p,s,len))
+            fail("unknown literal");
+        p+=len;
+    }
+
+    /// read 4 hex digits of a \u escape
+    unsigned int hex4(){
+        if(end-p<4)
+            fail("bad \\u escape");
+        unsigned int u=0;
+        for(int i=0;i<4;i++){
+            char c = *p++;
+            u<<=4;
+            if(c>='0' && c<='9')u|=c-'0';
+            else if(c>='a' && c<='f')u|=c-'a'+10;
+            else if(c>='A' && c<='F')u|=c-'A'+10;
+            else fail("bad \\u escape");
+        }
+        return u;
+    }
+
+    void appendUTF8(unsigned int u){
+        char buf[4];
+        int n;
+        if(u<0x80){
+            buf[0]=u;n=1;
+        } else if(u<0x800){
+            buf[0]=0xc0|(u>>6);
+            buf[1]=0x80|(u&0x3f);n=2;
+        } else if(u<0x10000){
+            buf[0]=0xe0|(u>>12);
+            buf[1]=0x80|((u>>6)&0x3f);
+            buf[2]=0x80|(u&0x3f);n=3;
+        } else {
+            buf[0]=0xf0|(u>>18);
+            buf[1]=0x80|((u>>12)&0x3f);
+            buf[2]=0x80|((u>>6)&0x3f);
+            buf[3]=0x80|(u&0x3f);n=4;
+        }
+        sb.append(buf,n);
+    }
+
+    /// parse a string, just after its opening quote
+    void string(Value *out){
+        int n = strk::findAny(p,end-p,stringEnds);
+        if(p+n<end && p[n]=='"'){
+            // no escapes, which is the usual case
+            Types::tString->setwithlen(out,p,n);
+            p+=n+1;
+            return;
+        }
+        sb.clear();
+        for(;;){
+            sb.append(p,n);
+            p+=n;
+            if(p==end)
+                fail("unterminated string");
+            if(*p++=='"')
+                break;
+            // an escape
+            if(p==end)
+                fail("unterminated string");
+            switch(*p++){
+            case '"':sb.append("\"",1);break;
+            case '\\':sb.append("\\",1);break;
+            case '/':sb.append("/",1);break;
+            case 'b':sb.append("\b",1);break;
+            case 'f':sb.append("\f",1);break;
+            case 'n':sb.append("\n",1);break;
+            case 'r':sb.append("\r",1);break;
+            case 't':sb.append("\t",1);break;
+            case 'u':{
+                unsigned int u = hex4();
+                // a surrogate pair makes one code point
+                if(u>=0xd800 && u<0xdc00 && end-p>=6 && p[0]=='\\' && p[1]=='u'){
+                    const char *save=p;
+                    p+=2;
+                    unsigned int lo = hex4();
+                    if(lo>=0xdc00 && lo<0xe000)
+                        u = 0x10000+((u-0xd800)<<10)+(lo-0xdc00);
+                    else
+                        p=save;
+                }
+                appendUTF8(u);
+                break;
+            }
+            default:
+                p--;
+                fail("bad escape");
+            }
+            n = strk::findAny(p,end-p,stringEnds);
+        }
+        Types::tString->setwithlen(out,sb.get(),sb.length());
+    }
+
+    void number(Value *out){
+        const char *s=p;
+        bool neg = *p=='-';
+        if(neg)p++;
+        if(p==end || *p<'0' || *p>'9')
+            fail("unexpected character");
+        if(*p=='0' && p+1<end && p[1]>='0' && p[1]<='9'){
+            p++;
+            fail("leading zero");
+        }
+        // stop accumulating once there are too many digits for a long;
+        // the number is then a double, which strtod deals with.
+        long v=0;
+        int digits=0;
+        while(p<end && *p>='0' && *p<='9'){
+            if(digits<18)
+                v = v*10+(*p-'0');
+            p++;
+            digits++;
+        }
+        if(digits<=18 && (p==end || (*p!='.' && *p!='e' && *p!='E'))){
+            if(neg)v=-v;
+            if(v>=INT_MIN && v<=INT_MAX)
+                Types::tInteger->set(out,(int)v);
+            else
+                Types::tLong->set(out,v);
+            return;
+        }
+        // fractions, exponents and huge integers are doubles. If the
+        // digits fit in a double's mantissa and the power of ten is
+        // small enough to be exact, a single multiply or divide gives
+        // the correctly rounded result (Clinger's fast path);
+        // otherwise leave it to strtod.
+        if(digits<=15){
+            int scale=0; // power of ten to divide by
+            if(p<end && *p=='.'){
+                p++;
+                const char *f=p;
+                while(p<end && *p>='0' && *p<='9' && digits<=15){
+                    v = v*10+(*p++-'0');
+                    digits++;
+                }
+                scale=p-f;
+                if(!scale)
+                    fail("bad number");
+            }
+            if(digits<=15 && (p==end || (*p>'9' || *p<'0'))){
+                int exp=0;
+                if(p<end && (*p=='e' || *p=='E')){
+                    p++;
+                    bool eneg=false;
+                    if(p<end && (*p=='+' || *p=='-'))
+                        eneg = *p++=='-';
+                    if(p==end || *p<'0' || *p>'9')
+                        fail("bad number");
+                    while(p<end && *p>='0' && *p<='9'){
+                        if(exp<1000)exp = exp*10+(*p-'0');
+                        p++;
+                    }
+                    if(eneg)exp=-exp;
+                }
+                exp-=scale;
+                if(exp>=-22 && exp<=22){
+                    static const double pow10[] = {
+                        1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+                        1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22
+                    };
+                    double d = (double)v;
+                    d = exp<0 ? d/pow10[-exp] : d*pow10[exp];
+                    Types::tDouble->set(out,neg?-d:d);
+                    return;
+                }
+            }
+        }
+        while(p<end && ((*p>='0' && *p<='9') || *p=='.' || *p=='e' ||
+                        *p=='E' || *p=='+' || *p=='-'))
+            p++;
+        char buf[64];
+        int len = p-s;
+        if(len>=(int)sizeof(buf))
+            fail("number too long");
+        memcpy(buf,s,len);
+        buf[len]=0;
+        char *e;
+        double d = strtod(buf,&e);
+        if(e!=buf+len){
+            p=s+(e-buf);
+            fail("bad number");
+        }
+        Types::tDouble->set(out,d);
+    }
+
+    void array(Value *out){
+        if(++depth>JSON_MAXDEPTH)
+            fail("nested too deeply");
+        ArrayList<Value> *list = Types::tList->set(out);
+        skipWS();
+        if(p<end && *p==']')
+            p++;
+        else {
+            for(;;){
+                value(list->append());
+                skipWS();
+                if(p<end && *p==','){
+                    p++;
+                    continue;
+                }
+                if(p<end && *p==']'){
+                    p++;
+                    break;
+                }
+                fail("expected , or ]");
+            }
+        }
+        depth--;
+    }
+
+    void object(Value *out){
+        if(++depth>JSON_MAXDEPTH)
+            fail("nested too deeply");
+        Hash *h = Types::tHash->set(out);
+        skipWS();
+        if(p<end && *p=='}')
+            p++;
+        else {
+            Value k,v;
+            for(;;){
+                expect('"',"expected a string key");
+                string(&k);
+                expect(':',"expected :");
+                value(&v);
+                h->set(&k,&v);
+                skipWS();
+                if(p<end && *p==','){
+                    p++;
+                    continue;
+                }
+                if(p<end && *p=='}'){
+                    p++;
+                    break;
+                }
+                fail("expected , or }");
+            }
+        }
+        depth--;
+    }
+
+    void value(Value *out){
+        skipWS();
+        if(p==end)
+            fail("unexpected end");
+        switch(*p){
+        case '{':p++;object(out);break;
+        case '[':p++;array(out);break;
+        case '"':p++;string(out);break;
+        case 't':literal("true",4);Types::tInteger->set(out,1);break;
+        case 'f':literal("false",5);Types::tInteger->set(out,0);break;
+        case 'n':literal("null",4);out->clr();break;
+        default:number(out);break;
+        }
+    }
+
+public:
+    /// parse the only value in some text into out
+    void parse(Value *out,const char *s,int len){
+        start=p=s;
+        end=s+len;
+        depth=0;
+        value(out);
+        skipWS();
+        if(p!=end)
+            fail("unexpected characters after the value");
+    }
+};
+
+/// writes values as JSON into a builder
+class JSONWriter {
+    StringBuilder& b;
+    int depth;
+
+    void string(const char *s,int len){
+        b.append("\"",1);
+        int run=0; // start of the run of characters needing no escape
+        for(int i=0;i<len;i++){
+            unsigned char c = s[i];
+            if(c>=0x20 && c!='"' && c!='\\')
+                continue;
+            b.append(s+run,i-run);
+            run=i+1;
+            switch(c){
+            case '"':b.append("\\\"",2);break;
+            case '\\':b.append("\\\\",2);break;
+            case '\n':b.append("\\n",2);break;
+            case '\r':b.append("\\r",2);break;
+            case '\t':b.append("\\t",2);break;
+            default:{
+                char buf[8];
+                snprintf(buf,8,"\\u%04x",c);
+                b.append(buf,6);
+            }
+            }
+        }
+        b.append(s+run,len-run);
+        b.append("\"",1);
+    }
+
+    void integer(long v){
+        char buf[24];
+        char *q = buf+sizeof(buf);
+        unsigned long u = v<0 ? -(unsigned long)v : v;
+        do {
+            *--q = '0'+u%10;
+            u/=10;
+        } while(u);
+        if(v<0)
+            *--q='-';
+        b.append(q,buf+sizeof(buf)-q);
+    }
+
+    /// the shortest decimal which reads back as the same value, trying
+    /// precisions from lo to hi
+    void real(double d,int lo,int hi,bool isfloat){
+        if(!isfinite(d)){
+            b.append("null",4);
+            return;
+        }
+        char buf[32];
+        int n=0;
+        for(int prec=lo;prec<=hi;prec++){
+            n = snprintf(buf,sizeof(buf),"%.*g",prec,d);
+            double r = strtod(buf,NULL);
+            if(isfloat ? (float)r==(float)d : r==d)
+                break;
+        }
+        b.append(buf,n);
+        // make sure it reads back as a double rather than an integer
+        if(!strpbrk(buf,".eEn"))
+            b.append(".0",2);
+    }
+
+    void value(Value *v){
+        const Type *t = v->t;
+        if(t==Types::tNone)
+            b.append("null",4);
+        else if(t==Types::tInteger)
+            integer(Types::tInteger->get(v));
+        else if(t==Types::tLong)
+            integer(Types::tLong->get(v));
+        else if(t==Types::tDouble)
+            real(Types::tDouble->get(v),15,17,false);
+        else if(t==Types::tFloat)
+            real(Types::tFloat->get(v),6,9,true);
+        else if(StringType::isString(v))
+            string(Types::tString->getBytes(v),Types::tString->getByteLength(v));
+        else if(t==Types::tSymbol){
+            const char *s = Types::tSymbol->get(v);
+            string(s,strlen(s));
+        } else if(t==Types::tList){
+            nest();
+            ArrayList<Value> *list = Types::tList->get(v);
+            ReadLock lock(list);
+            b.append("[",1);
+            for(int i=0;i<list->count();i++){
+                if(i)b.append(",",1);
+                value(list->get(i));
+            }
+            b.append("]",1);
+            depth--;
+        } else if(t==Types::tHash){
+            nest();
+            Hash *h = Types::tHash->get(v);
+            ReadLock lock(h);
+            b.append("{",1);
+            bool first=true;
+            for(int i=h->nextUsed(0);i>=0;i=h->nextUsed(i+1)){
+                if(!first)b.append(",",1);
+                first=false;
+                Value *k = h->keyAt(i);
+                if(StringType::isString(k))
+                    string(Types::tString->getBytes(k),Types::tString->getByteLength(k));
+                else {
+                    const StringBuffer& sb = k->toString();
+                    string(sb.get(),strlen(sb.get()));
+                }
+                b.append(":",1);
+                value(h->valAt(i));
+            }
+            b.append("}",1);
+            depth--;
+        } else if(t->flags & TF_ITERABLE){
+            nest();
+            Iterator<Value *> *iter = t->makeIterator(v);
+            b.append("[",1);
+            try {
+                bool first=true;
+                for(iter->first();!iter->isDone();iter->next()){
+                    if(!first)b.append(",",1);
+                    first=false;
+                    value(iter->current());
+                }
+            } catch(Exception& e){
+                delete iter;
+                throw;
+            }
+            delete iter;
+            b.append("]",1);
+            depth--;
+        } else {
+            const StringBuffer& sb = v->toString();
+            string(sb.get(),strlen(sb.get()));
+        }
+    }
+
+    void nest(){
+        if(++depth>JSON_MAXDEPTH)
+            throw RUNT(EX_OUTOFRANGE,"JSON: nested too deeply (does something contain itself?)");
+    }
+
+public:
+    JSONWriter(StringBuilder& sb) : b(sb) {
+        depth=0;
+    }
+    void write(Value *v){
+        value(v);
+    }
+};
+
+/// iterates over the values on the lines of a file
+class JSONLinesIterator : public Iterator<Value *> {
+    FileObject *f;
+    Value cur;
+    JSONParser parser;
+    bool done;
+    int idx;
+
+    void read(){
+        const char *s;
+        int len;
+        for(;;){
+            if(!f->nextLine(&s,&len)){
+                done=true;
+                return;
+            }
+            // skip blank lines
+            int i=0;
+            while(i<len && (s[i]==' ' || s[i]=='\t' || s[i]=='\r'))i++;
+            if(i<len)
+                break;
+        }
+        parser.parse(&cur,s,len);
+    }
+public:
+    JSONLinesIterator(FileObject *file){
+        f=file;
+        done=false;
+        idx=0;
+    }
+    // as with file streams, this carries on from where the file is
+    virtual void first(){
+        idx=0;
+        done=false;
+        read();
+    }
+    virtual void next(){
+        idx++;
+        read();
+    }
+    virtual bool isDone() const {
+        return done;
+    }
+    virtual Value *current(){
+        return &cur;
+    }
+    virtual int index() const {
+        return idx;
+    }
+};
+
+}
+
+/// the iterable returned by json$lines, which holds the file
+struct JSONLinesObject : public GarbageCollected {
+    Value file;
+
+    JSONLinesObject() : GarbageCollected("jsonlines") {}
+
+    virtual Iterator<class Value *> *makeValueIterator()const{
+        return new JSONLinesIterator((FileObject *)file.v.gc);
+    }
+    virtual Iterator<class Value *> *makeKeyIterator()const{
+        return makeValueIterator();
+    }
+    // the file holds no values, so there's nothing to cycle-detect
+    virtual Iterator<class Value *> *makeGCValueIterator(){
+        return NULL;
+    }
+    virtual Iterator<class Value *> *makeGCKeyIterator(){
+        return NULL;
+    }
+};
+
+class JSONLinesType : public GCType {
+public:
+    JSONLinesType(){
+        add("jsonlines","JSNL");
+        flags |= TF_ITERABLE;
+    }
+
+    void set(Value *v,Value *file)const{
+        Types::tFile->get(file); // check it's a file
+        JSONLinesObject *o = new JSONLinesObject();
+        o->file.copy(file);
+        v->clr();
+        v->t = this;
+        v->v.gc = o;
+        incRef(v);
+    }
+};
+
+static JSONLinesType tJSONLines;
+
+namespace _angortlib_ns_json {
+
+static void _word__parse(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    StringBuffer sb;
+    int len;
+    const char *s = Types::tString->getBytes(p0,&len,sb);
+    JSONParser parser;
+    Value t;
+    parser.parse(&t,s,len);
+    a->pushval()->copy(&t);
+}
+
+static void _word__dump(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    StringBuilder b;
+    JSONWriter w(b);
+    w.write(p0);
+    Value t;
+    Types::tString->setwithlen(&t,b.get(),b.length());
+    a->pushval()->copy(&t);
+}
+
+static void _word__lines(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    Value t;
+    tJSONLines.set(&t,p0);
+    a->pushval()->copy(&t);
+}
+static angort::WordDef _wordlist_[]={
+    {"parse","(string -- value) parse JSON text\n Throws ex$syntax if the text isn't valid JSON.",_word__parse},
+    {"dump","(value -- string) convert a value to JSON text",_word__dump},
+    {"lines","(file -- iterable) iterate over the JSON values on the lines of a file stream\n Blank lines are skipped. As with iterating over the file itself, this\n starts from wherever the file has got to.",_word__lines},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_json 
+
+angort::LibraryDef _angortlib_json = {
+    "json",
+    _angortlib_ns_json::_wordlist_,
+    _angortlib_ns_json::_binoplist_,
+    NULL,NULL
+};
@@ -0,0 +1,162 @@
+#include "angort.h"
+#include "hash.h"
+
+
+using namespace angort;
+
+namespace _angortlib_ns_omap {
+
+static void _word__new(angort::Runtime *a){
+    Types::tOMap->set(a->pushval());
+}
+
+static void _word__fromhash(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    Value in;
+    in.copy(p0);
+    Hash *h = Types::tHash->get(&in);
+    OMapObject *o = Types::tOMap->set(a->pushval());
+    ReadLock lock(h);
+    for(int i=h->nextUsed(0);i>=0;i=h->nextUsed(i+1))
+        o->set(h->keyAt(i),h->valAt(i));
+}
+
+/// push the key at a position, or none if it's the end
+static void pushKey(Runtime *a,OMapObject *o,OMapPos *p){
+    Value *k = p->leaf ? o->keyAt(*p) : NULL;
+    if(k)
+        a->pushval()->copy(k);
+    else
+        a->pushNone();
+}
+
+static void _word__floor(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    Value k,m;
+    k.copy(p0);
+    m.copy(p1);
+    OMapObject *o = Types::tOMap->get(&m);
+    ReadLock lock(&o->tree);
+    OMapPos p;
+    o->lowerBound(&k,&p);
+    if(!p.leaf || o->compare(o->keyAt(p),&k))
+        o->prev(&p);
+    pushKey(a,o,&p);
+}
+
+static void _word__ceil(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    Value k,m;
+    k.copy(p0);
+    m.copy(p1);
+    OMapObject *o = Types::tOMap->get(&m);
+    ReadLock lock(&o->tree);
+    OMapPos p;
+    o->lowerBound(&k,&p);
+    pushKey(a,o,&p);
+}
+
+static void _word__first(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    Value m;
+    m.copy(p0);
+    OMapObject *o = Types::tOMap->get(&m);
+    ReadLock lock(&o->tree);
+    OMapPos p = o->begin();
+    pushKey(a,o,&p);
+}
+
+static void _word__last(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    Value m;
+    m.copy(p0);
+    OMapObject *o = Types::tOMap->get(&m);
+    ReadLock lock(&o->tree);
+    OMapPos p;
+    p.leaf=NULL;
+    o->prev(&p);
+    pushKey(a,o,&p);
+}
+
+static void _word__rank(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    Value k,m;
+    k.copy(p0);
+    m.copy(p1);
+    OMapObject *o = Types::tOMap->get(&m);
+    ReadLock lock(&o->tree);
+    OMapPos p;
+    a->pushInt(o->lowerBound(&k,&p));
+}
+
+static void _word__select(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"iv");
+int p0 = _parms[0]->toInt();
+Value * p1 = _parms[1];
+    Value m;
+    m.copy(p1);
+    OMapObject *o = Types::tOMap->get(&m);
+    ReadLock lock(&o->tree);
+    OMapPos p;
+    if(!o->select(p0,&p))
+        throw RUNT(EX_OUTOFRANGE,"omap select out of range");
+    pushKey(a,o,&p);
+}
+
+static void _word__range(angort::Runtime *a)
+{
+Value *_parms[3];
+a->popParams(_parms,"vvv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+Value * p2 = _parms[2];
+    Value lo,hi,m;
+    lo.copy(p0);
+    hi.copy(p1);
+    m.copy(p2);
+    Types::tOMapRange->set(a->pushval(),&m,&lo,&hi);
+}
+static angort::WordDef _wordlist_[]={
+    {"new","(-- omap) make a new, empty ordered map",_word__new},
+    {"fromhash","(hash -- omap) make an ordered map holding the keys and values of a hash",_word__fromhash},
+    {"floor","(key omap -- key) the greatest key no greater than a key, or none",_word__floor},
+    {"ceil","(key omap -- key) the least key no less than a key, or none",_word__ceil},
+    {"first","(omap -- key) the least key, or none if empty",_word__first},
+    {"last","(omap -- key) the greatest key, or none if empty",_word__last},
+    {"rank","(key omap -- n) the number of keys less than a key\n If the key is in the map, this is its index in the order (as given by\n index).",_word__rank},
+    {"select","(n omap -- key) the nth key in order, starting from zero\n Throws ex$outofrange if there aren't that many keys.",_word__select},
+    {"range","(lo hi omap -- range) the keys from lo up to but not including hi\n This doesn't copy anything; the range can be iterated over with each\n (where ival gives the value for each key), and len and in work on it.\n It always reflects the current contents of the map. Either bound can be\n none, in which case the range is unbounded at that end.",_word__range},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_omap 
+
+angort::LibraryDef _angortlib_omap = {
+    "omap",
+    _angortlib_ns_omap::_wordlist_,
+    _angortlib_ns_omap::_binoplist_,
+    NULL,NULL
+};
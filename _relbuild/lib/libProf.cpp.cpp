@@ -0,0 +1,50 @@
+#include "angort.h"
+#include "profiler.h"
+
+
+using namespace angort;
+
+namespace _angortlib_ns_prof {
+static void __shutdown__(angort::Runtime *a)
+{
+    // write any profile requested from the command line
+    Profiler::finish(a->ang);
+}
+
+static void _word__start(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"i");
+int p0 = _parms[0]->toInt();
+    Profiler::start(p0);
+}
+
+static void _word__stop(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"s");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+    Profiler::stop();
+    if(!Profiler::write(a->ang,p0))
+        throw RUNT(EX_NOTFOUND,"").set("cannot write profile to %s",p0);
+}
+
+static void _word__running(angort::Runtime *a){
+    a->pushInt(Profiler::isRunning()?1:0);
+}
+static angort::WordDef _wordlist_[]={
+    {"start","(hz --) start sampling at a given rate\n Any previous profile data is discarded. A rate of zero or less\n uses the default of 100Hz.",_word__start},
+    {"stop","(filename --) stop sampling and write the profile\n Folded stacks are written to the given file, and the table of\n self/total samples (and times) per word to the file with \".words\"\n appended.",_word__stop},
+    {"running","(-- bool) is the profiler currently sampling?",_word__running},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_prof 
+
+angort::LibraryDef _angortlib_prof = {
+    "prof",
+    _angortlib_ns_prof::_wordlist_,
+    _angortlib_ns_prof::_binoplist_,
+    NULL,_angortlib_ns_prof::__shutdown__
+};
@@ -0,0 +1,49 @@
+#include "angort.h"
+
+
+using namespace angort;
+
+namespace _angortlib_ns_ser {
+
+static void _word__dump(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    StringBuilder b;
+    Serialiser s(b);
+    s.write(p0);
+    Value t;
+    Types::tString->setwithlen(&t,b.get(),b.length());
+    a->pushval()->copy(&t);
+}
+
+static void _word__load(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    if(!StringType::isString(p0))
+        throw RUNT(EX_TYPE,"ser$load needs a string");
+    Deserialiser d(Types::tString->getBytes(p0),
+                   Types::tString->getByteLength(p0));
+    Value t;
+    d.read(&t);
+    if(!d.atEnd())
+        d.fail("unexpected data after the value");
+    a->pushval()->copy(&t);
+}
+static angort::WordDef _wordlist_[]={
+    {"dump","(value -- string) serialise a value into a string of bytes\n Throws ex$notsup if the value is or contains something which can't be\n serialised.",_word__dump},
+    {"load","(string -- value) turn a string made by ser$dump back into a value\n Throws ex$corrupt if the data is damaged or not from ser$dump, or\n ex$notfound if it contains a type which doesn't exist here (such as\n one from a plugin which isn't loaded).",_word__load},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_ser 
+
+angort::LibraryDef _angortlib_ser = {
+    "ser",
+    _angortlib_ns_ser::_wordlist_,
+    _angortlib_ns_ser::_binoplist_,
+    NULL,NULL
+};
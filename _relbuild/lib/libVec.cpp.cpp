@@ -0,0 +1,288 @@
+#include "angort.h"
+#include "veckernels.h"
+
+
+using namespace angort;
+
+// calls f<T>(a,vtype,...) for the type of the vector v, throwing
+// if it isn't a numeric vector.
+#define DISPATCHVEC(v,f,...) \
+    if((v)->t == Types::tI32)f(a,Types::tI32,##__VA_ARGS__); \
+    else if((v)->t == Types::tI64)f(a,Types::tI64,##__VA_ARGS__); \
+    else if((v)->t == Types::tF32)f(a,Types::tF32,##__VA_ARGS__); \
+    else if((v)->t == Types::tF64)f(a,Types::tF64,##__VA_ARGS__); \
+    else throw RUNT(EX_TYPE,"").set("not a numeric vector: %s",(v)->t->name)
+
+/// get the arrays of two vectors, which must be of the same type and length
+template <class T> static void getPair(const NumVecType<T> *t,Value *pa,Value *pb,
+                                       ArrayList<T> **la,ArrayList<T> **lb){
+    if(pb->t != t)
+        throw RUNT(EX_TYPE,"").set("vectors must be of the same type: %s and %s",
+                                  t->name,pb->t->name);
+    *la = t->get(pa);
+    *lb = t->get(pb);
+    if((*la)->count() != (*lb)->count())
+        throw RUNT(EX_BADPARAM,"").set("vectors must be of the same length: %d and %d",
+                                      (*la)->count(),(*lb)->count());
+}
+
+// add or multiply two vectors into a new one
+template <class T> static void vecBinop(Runtime *a,const NumVecType<T> *t,bool mul){
+    Value *pb = a->popval();
+    Value *pa = a->stack.peekptr();
+    ArrayList<T> *la,*lb;
+    getPair(t,pa,pb,&la,&lb);
+    
+    Value r;
+    ArrayList<T> *lc = t->set(&r);
+    {
+        ReadLock l1(la);
+        ReadLock l2(lb);
+        int n = la->count();
+        if(n){
+            lc->set(n-1);
+            T *c = lc->get(0);
+            if(mul)
+                veck::mul(c,la->get(0),lb->get(0),n);
+            else
+                veck::add(c,la->get(0),lb->get(0),n);
+        }
+    }
+    pa->copy(&r);
+}
+
+// push the sum of a vector, as a long for integers and a double for floats
+template <class T> static void pushAcc(Runtime *a,T x){
+    a->pushLong(x);
+}
+template <> void pushAcc(Runtime *a,double x){
+    a->pushDouble(x);
+}
+
+template <class T> static void vecDot(Runtime *a,const NumVecType<T> *t){
+    Value *pb = a->popval();
+    Value *pa = a->popval();
+    ArrayList<T> *la,*lb;
+    getPair(t,pa,pb,&la,&lb);
+    typename veck::Acc<T>::type s=0;
+    {
+        ReadLock l1(la);
+        ReadLock l2(lb);
+        if(la->count())
+            s = veck::dot(la->get(0),lb->get(0),la->count());
+    }
+    pushAcc(a,s);
+}
+
+template <class T> static void vecSum(Runtime *a,const NumVecType<T> *t){
+    ArrayList<T> *la = t->get(a->popval());
+    typename veck::Acc<T>::type s=0;
+    {
+        ReadLock l(la);
+        if(la->count())
+            s = veck::sum(la->get(0),la->count());
+    }
+    pushAcc(a,s);
+}
+
+template <class T> static void vecMinmax(Runtime *a,const NumVecType<T> *t){
+    ArrayList<T> *la = t->get(a->popval());
+    ReadLock l(la);
+    if(la->count()){
+        T mn,mx;
+        veck::minmax(la->get(0),la->count(),&mn,&mx);
+        NumVecType<T>::toValue(a->pushval(),mn);
+        NumVecType<T>::toValue(a->pushval(),mx);
+    } else {
+        a->pushNone();
+        a->pushNone();
+    }
+}
+
+// integer items are scaled in double precision and converted back one
+// by one, so that 0.5 halves an int vector rather than zeroing it.
+template <class T> static void scaleItems(T *c,const T *a,double k,int n){
+    for(int i=0;i<n;i++)c[i]=(T)(a[i]*k);
+}
+template <> void scaleItems(float *c,const float *a,double k,int n){
+    veck::scale(c,a,(float)k,n);
+}
+template <> void scaleItems(double *c,const double *a,double k,int n){
+    veck::scale(c,a,k,n);
+}
+
+template <class T> static void vecScale(Runtime *a,const NumVecType<T> *t,Value *k){
+    Value *pa = a->stack.peekptr();
+    ArrayList<T> *la = t->get(pa);
+    double kk = k->toDouble();
+    Value r;
+    ArrayList<T> *lc = t->set(&r);
+    {
+        ReadLock l(la);
+        int n = la->count();
+        if(n){
+            lc->set(n-1);
+            scaleItems(lc->get(0),la->get(0),kk,n);
+        }
+    }
+    pa->copy(&r);
+}
+
+template <class T> static void vecAxpy(Runtime *a,const NumVecType<T> *t,Value *alpha,Value *px){
+    Value *py = a->popval();
+    ArrayList<T> *ly,*lx;
+    getPair(t,py,px,&ly,&lx);
+    T al = NumVecType<T>::fromValue(alpha);
+    WriteLock l1=WL(ly);
+    // x and y may be the same vector, which we already have locked
+    ReadLock l2(lx==ly ? NULL : lx);
+    if(ly->count())
+        veck::axpy(ly->get(0),lx->get(0),al,ly->count());
+}
+
+static void makeVec(Runtime *a,const NumVecTypeBase *t){
+    Value *p = a->stack.peekptr();
+    t->fromIterable(p,p);
+}
+
+namespace _angortlib_ns_vec {
+
+static void _word__i32(angort::Runtime *a){
+    makeVec(a,Types::tI32);
+}
+
+static void _word__i64(angort::Runtime *a){
+    makeVec(a,Types::tI64);
+}
+
+static void _word__f32(angort::Runtime *a){
+    makeVec(a,Types::tF32);
+}
+
+static void _word__f64(angort::Runtime *a){
+    makeVec(a,Types::tF64);
+}
+
+static void _word__zeros(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"iS");
+int p0 = _parms[0]->toInt();
+const StringBuffer &_sb1 = _parms[1]->toString();
+const char *p1 = _sb1.get();
+    Type *t = Type::getByName(p1);
+    if(!t || !(t->flags & TF_NUMVEC))
+        throw RUNT(EX_TYPE,"").set("not a vector type: %s",p1);
+    ((NumVecTypeBase *)t)->create(a->pushval(),p0);
+}
+
+static void _word__tolist(angort::Runtime *a){
+    Value *p = a->stack.peekptr();
+    Value in;
+    in.copy(p);
+    Iterator<Value *> *iter = in.t->makeIterator(&in);
+    ArrayList<Value> *list = Types::tList->set(p);
+    WriteLock lock=WL(list);
+    try {
+        for(iter->first();!iter->isDone();iter->next())
+            list->append()->copy(iter->current());
+    } catch(Exception& e){
+        delete iter;
+        throw;
+    }
+    delete iter;
+}
+
+static void _word__isvec(angort::Runtime *a){
+    Value *p = a->stack.peekptr();
+    Types::tInteger->set(p,(p->t->flags & TF_NUMVEC)?1:0);
+}
+
+static void _word__add(angort::Runtime *a){
+    Value *p = a->stack.peekptr(1);
+    DISPATCHVEC(p,vecBinop,false);
+}
+
+static void _word__mul(angort::Runtime *a){
+    Value *p = a->stack.peekptr(1);
+    DISPATCHVEC(p,vecBinop,true);
+}
+
+static void _word__dot(angort::Runtime *a){
+    Value *p = a->stack.peekptr(1);
+    DISPATCHVEC(p,vecDot);
+}
+
+static void _word__sum(angort::Runtime *a){
+    Value *p = a->stack.peekptr();
+    DISPATCHVEC(p,vecSum);
+}
+
+static void _word__minmax(angort::Runtime *a){
+    Value *p = a->stack.peekptr();
+    DISPATCHVEC(p,vecMinmax);
+}
+
+static void _word__scale(angort::Runtime *a){
+    Value k;
+    k.copy(a->popval());
+    Value *p = a->stack.peekptr();
+    DISPATCHVEC(p,vecScale,&k);
+}
+
+static void _word__axpy(angort::Runtime *a){
+    Value *p = a->stack.peekptr();
+    Value alpha,x;
+    x.copy(a->stack.peekptr(1));
+    alpha.copy(a->stack.peekptr(2));
+    DISPATCHVEC(p,vecAxpy,&alpha,&x);
+    a->popval();
+    a->popval();
+}
+
+static void _word__simd(angort::Runtime *a){
+    a->pushString(veck::getLevelName(veck::getLevel()));
+}
+
+static void _word__setsimd(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"s");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+    for(int i=veck::VK_SCALAR;i<=veck::VK_AVX;i++){
+        if(!strcmp(p0,veck::getLevelName((veck::Level)i))){
+            veck::setLevel((veck::Level)i);
+            return;
+        }
+    }
+    throw RUNT(EX_BADPARAM,"").set("unknown SIMD set: %s",p0);
+}
+static angort::WordDef _wordlist_[]={
+    {"i32","(iterable -- i32) make a vector of 32-bit ints from a list or other iterable",_word__i32},
+    {"i64","(iterable -- i64) make a vector of 64-bit ints from a list or other iterable",_word__i64},
+    {"f32","(iterable -- f32) make a vector of floats from a list or other iterable",_word__f32},
+    {"f64","(iterable -- f64) make a vector of doubles from a list or other iterable",_word__f64},
+    {"zeros","(n type -- vec) make a vector of n zeroes\n The type is one of the symbols `i32, `i64, `f32 or `f64.",_word__zeros},
+    {"tolist","(iterable -- list) make a list from a vector or other iterable",_word__tolist},
+    {"isvec","(v -- bool) true if the value is a numeric vector",_word__isvec},
+    {"add","(a b -- c) add two vectors of the same type and length elementwise\n For f32 and f64 vectors this uses SSE2 or AVX where available (see vec$simd).",_word__add},
+    {"mul","(a b -- c) multiply two vectors of the same type and length elementwise",_word__mul},
+    {"dot","(a b -- n) the dot product of two vectors of the same type and length\n The result is a long for integer vectors and a double for float vectors,\n which are summed in double precision.",_word__dot},
+    {"sum","(v -- n) the sum of the items in a vector\n The result is a long for integer vectors and a double for float vectors,\n which are summed in double precision.",_word__sum},
+    {"minmax","(v -- min max) the smallest and largest items in a vector\n Both are none if the vector is empty.",_word__minmax},
+    {"scale","(v k -- v2) multiply each item of a vector by a number\n For integer vectors each item is multiplied in double precision and the\n result truncated, so 0.5 halves the items.",_word__scale},
+    {"axpy","(alpha x y --) set y to y + alpha*x, in place\n The vectors must be of the same type and length.",_word__axpy},
+    {"simd","(-- name) the SIMD instruction set used by the float vector words\n This is one of \"avx\", \"sse2\" or \"scalar\" (no SIMD).",_word__simd},
+    {"setsimd","(name --) set the SIMD instruction set used by the float vector words\n The name is \"avx\", \"sse2\" or \"scalar\". If the processor doesn't support\n the set requested, the best one it does support is used. This is mostly\n useful for testing.",_word__setsimd},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_vec 
+
+angort::LibraryDef _angortlib_vec = {
+    "vec",
+    _angortlib_ns_vec::_wordlist_,
+    _angortlib_ns_vec::_binoplist_,
+    NULL,NULL
+};
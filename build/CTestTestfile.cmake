@@ -0,0 +1,71 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/build
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(cpptests "tests/tests" "/root/repo/tests")
+set_tests_properties(cpptests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;34;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(basic "cli/angort" "/root/repo/testfiles/basic.ang")
+set_tests_properties(basic PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;38;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(strings "cli/angort" "/root/repo/testfiles/strings.ang")
+set_tests_properties(strings PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;39;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(cond "cli/angort" "/root/repo/testfiles/cond.ang")
+set_tests_properties(cond PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;40;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(loop "cli/angort" "/root/repo/testfiles/loop.ang")
+set_tests_properties(loop PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;41;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(closure "cli/angort" "/root/repo/testfiles/closure.ang")
+set_tests_properties(closure PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;43;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(recurse "cli/angort" "/root/repo/testfiles/recurse.ang")
+set_tests_properties(recurse PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;44;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(range "cli/angort" "/root/repo/testfiles/range.ang")
+set_tests_properties(range PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;45;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(list "cli/angort" "/root/repo/testfiles/list.ang")
+set_tests_properties(list PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;46;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(hash "cli/angort" "/root/repo/testfiles/hash.ang")
+set_tests_properties(hash PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;47;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(cycle "cli/angort" "/root/repo/testfiles/cycle.ang")
+set_tests_properties(cycle PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;48;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(constexpr "cli/angort" "/root/repo/testfiles/constexpr.ang")
+set_tests_properties(constexpr PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;49;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(exception "cli/angort" "/root/repo/testfiles/exception.ang")
+set_tests_properties(exception PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;50;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(incdec "cli/angort" "/root/repo/testfiles/incdec.ang")
+set_tests_properties(incdec PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;51;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(generator "cli/angort" "/root/repo/testfiles/generator.ang")
+set_tests_properties(generator PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;52;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(format "cli/angort" "/root/repo/testfiles/format.ang")
+set_tests_properties(format PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;54;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(vec "cli/angort" "/root/repo/testfiles/vec.ang")
+set_tests_properties(vec PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;55;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(stat "cli/angort" "/root/repo/testfiles/stat.ang")
+set_tests_properties(stat PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;56;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(lazy "cli/angort" "/root/repo/testfiles/lazy.ang")
+set_tests_properties(lazy PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;57;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(lazythread "cli/angort" "/root/repo/testfiles/lazythread.ang")
+set_tests_properties(lazythread PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(omapthread "cli/angort" "/root/repo/testfiles/omapthread.ang")
+set_tests_properties(omapthread PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;60;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(persist "cli/angort" "/root/repo/testfiles/persist.ang")
+set_tests_properties(persist PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;62;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(omap "cli/angort" "/root/repo/testfiles/omap.ang")
+set_tests_properties(omap PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;63;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(strbuild "cli/angort" "/root/repo/testfiles/strbuild.ang")
+set_tests_properties(strbuild PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;64;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(file "cli/angort" "/root/repo/testfiles/file.ang")
+set_tests_properties(file PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;65;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(fileexit "cli/angort" "/root/repo/testfiles/fileexit.ang")
+set_tests_properties(fileexit PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;66;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(fileexitcheck "cli/angort" "/root/repo/testfiles/fileexitcheck.ang")
+set_tests_properties(fileexitcheck PROPERTIES  DEPENDS "fileexit" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;67;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(json "cli/angort" "/root/repo/testfiles/json.ang")
+set_tests_properties(json PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;69;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(ser "cli/angort" "/root/repo/testfiles/ser.ang")
+set_tests_properties(ser PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;70;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(output "cli/angort" "/root/repo/testfiles/output.ang")
+set_tests_properties(output PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;71;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(prof "cli/angort" "/root/repo/testfiles/prof.ang")
+set_tests_properties(prof PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;72;add_test;/root/repo/CMakeLists.txt;0;")
+subdirs("cli")
+subdirs("tests")
+subdirs("lib")
@@ -0,0 +1,166 @@
+#include "angort.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+using namespace angort;
+
+namespace _angortlib_ns_file {
+static void __shutdown__(angort::Runtime *a)
+{
+    // streams which were never closed would otherwise lose whatever
+    // is still in their buffers
+    FileObject::flushAll();
+}
+
+static void _word__open(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"ss");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+const StringBuffer &_sb1 = _parms[1]->toString();
+const char *p1 = _sb1.get();
+    int flags;
+    bool r,w;
+    switch(p1[0]){
+    case 'r':flags=0;r=true;w=false;break;
+    case 'w':flags=O_CREAT|O_TRUNC;r=false;w=true;break;
+    case 'a':flags=O_CREAT|O_APPEND;r=false;w=true;break;
+    default:
+        throw RUNT(EX_BADPARAM,"").set("bad file mode: %s",p1);
+    }
+    if(p1[1]=='+'){
+        r=w=true;
+        flags|=O_RDWR;
+    } else if(p1[1])
+        throw RUNT(EX_BADPARAM,"").set("bad file mode: %s",p1);
+    else
+        flags|=w?O_WRONLY:O_RDONLY;
+
+    int fd = open(p0,flags,0666);
+    if(fd<0)
+        throw RUNT(EX_FAILED,"").set("cannot open %s: %s",p0,strerror(errno));
+    Types::tFile->set(a->pushval(),fd,r,w);
+}
+
+static void _word__stdin(angort::Runtime *a){
+    Types::tFile->set(a->pushval(),0,true,false,false);
+}
+
+static void _word__close(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    Types::tFile->get(p0)->close();
+}
+
+static void _word__flush(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    FileObject *f = Types::tFile->get(p0);
+    if(f->fd>=0)
+        f->flush();
+}
+
+static void _word__eof(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    a->pushInt(Types::tFile->get(p0)->atEOF()?1:0);
+}
+
+static void _word__readline(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    FileObject *f = Types::tFile->get(p0);
+    Value t;
+    if(f->readLine(&t))
+        a->pushval()->copy(&t);
+    else
+        a->pushNone();
+}
+
+static void _word__readbytes(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"iv");
+int p0 = _parms[0]->toInt();
+Value * p1 = _parms[1];
+    if(p0<0)
+        throw RUNT(EX_BADPARAM,"").set("cannot read %d bytes",p0);
+    FileObject *f = Types::tFile->get(p1);
+    Value t;
+    if(p0 && f->readBytes(&t,p0))
+        a->pushval()->copy(&t);
+    else
+        a->pushNone();
+}
+
+static void _word__write(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    FileObject *f = Types::tFile->get(p1);
+    StringBuffer sb;
+    int len;
+    const char *s = Types::tString->getBytes(p0,&len,sb);
+    f->write(s,len);
+}
+
+static void _word__writeln(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    FileObject *f = Types::tFile->get(p1);
+    StringBuffer sb;
+    int len;
+    const char *s = Types::tString->getBytes(p0,&len,sb);
+    f->write(s,len);
+    f->write("\n",1);
+}
+
+static void _word__readfile(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"s");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+    Value t;
+    Types::tFile->readFile(&t,p0);
+    a->pushval()->copy(&t);
+}
+static angort::WordDef _wordlist_[]={
+    {"open","(path mode -- file) open a file\n The mode is \"r\" (read), \"w\" (write, emptying the file or creating it),\n \"a\" (append, creating the file if needed), or one of those followed\n by \"+\" to allow both reading and writing. On fail, throws ex$failed.",_word__open},
+    {"stdin","(-- file) a file stream reading the standard input\n Don't mix this with \"read\", which has its own buffer.",_word__stdin},
+    {"close","(file --) flush and close a file\n Files are also closed when nothing refers to them any more, but errors\n can't be reported then.",_word__close},
+    {"flush","(file --) write out anything waiting in a file's buffer",_word__flush},
+    {"eof","(file -- bool) true if there is no more to read from a file",_word__eof},
+    {"readline","(file -- string|none) read a line from a file\n The newline is removed. At the end of the file, returns none.",_word__readline},
+    {"readbytes","(n file -- string|none) read up to n bytes from a file\n Returns fewer than n bytes only at the end of the file, and none when\n there is nothing left at all.",_word__readbytes},
+    {"write","(val file --) write a value to a file, as a string",_word__write},
+    {"writeln","(val file --) write a value to a file, as a string, followed by a newline",_word__writeln},
+    {"readfile","(path -- string) read a whole file into a string\n Big files are mapped into memory rather than read. On fail, throws\n ex$failed.",_word__readfile},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_file 
+
+angort::LibraryDef _angortlib_file = {
+    "file",
+    _angortlib_ns_file::_wordlist_,
+    _angortlib_ns_file::_binoplist_,
+    NULL,_angortlib_ns_file::__shutdown__
+};
@@ -0,0 +1,263 @@
+#include <math.h>
+#include <limits.h>
+#include <time.h>
+#include "angort.h"
+
+
+using namespace angort;
+/*
+ * Mappings for (some) standard maths library functions
+ */
+
+
+// macro for helping generate unary float functions
+#define FN(f) a->pushDouble(f(a->popDouble()))
+
+namespace _angortlib_ns_math {
+
+
+
+static void _word__atan2(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"dd");
+double p0 = _parms[0]->toDouble();
+double p1 = _parms[1]->toDouble();
+    a->pushDouble(atan2(p0,p1));
+}
+
+static void _word__floor(angort::Runtime *a){
+    FN(floor);
+}
+static void _word__ceil(angort::Runtime *a){
+    FN(ceil);
+}
+
+
+static void _word__round(angort::Runtime *a){
+    FN(round);
+}
+static void _word__cos(angort::Runtime *a){
+    FN(cos);
+}
+static void _word__sin(angort::Runtime *a){
+    FN(sin);
+}
+static void _word__tan(angort::Runtime *a){
+    FN(tan);
+}
+static void _word__acos(angort::Runtime *a){
+    FN(acos);
+}
+static void _word__asin(angort::Runtime *a){
+    FN(asin);
+}
+static void _word__atan(angort::Runtime *a){
+    FN(atan);
+}
+static void _word__ln(angort::Runtime *a){
+    FN(log);
+}
+static void _word__log(angort::Runtime *a){
+    FN(log10);
+}
+static void _word__log2(angort::Runtime *a){
+    FN(log2);
+}
+static void _word__sqrt(angort::Runtime *a){
+    FN(sqrt);
+}
+
+static void _word__exp(angort::Runtime *a){
+    FN(exp);
+}
+
+static void _word__pow(angort::Runtime *a){
+    double y = a->popDouble();
+    double x = a->popDouble();
+    a->pushDouble(pow(x,y));
+}
+
+#define ABS(x) ((x)<0 ? -(x) : (x))
+
+static void _word__abs(angort::Runtime *a){
+    Value *v = a->popval();
+    if(v->t == Types::tInteger)
+        a->pushInt(ABS(v->toInt()));
+    else if(v->t == Types::tDouble)
+        a->pushDouble(ABS(v->toDouble()));
+    else if(v->t == Types::tLong)
+        a->pushLong(ABS(v->toLong()));
+    else if(v->t == Types::tFloat)
+        a->pushFloat(ABS(v->toFloat()));
+    else 
+        throw RUNT(EX_TYPE,"").set("Bad type for abs(): %s",v->t->name);
+}
+
+static void _word__fmod(angort::Runtime *a){
+    double y = a->popDouble();
+    double x = a->popDouble();
+    a->pushDouble(fmod(x,y));
+}
+
+
+static void _word__srand(angort::Runtime *a){
+    Value *v = a->popval();
+    long t;
+    if(v->isNone())
+        time(&t);
+    else
+        t = v->toInt();
+    srand48_r(t,&a->rnd);
+}
+
+
+static void _word__rand(angort::Runtime *a){
+    long r;
+    lrand48_r(&a->rnd,&r);
+    a->pushInt(r & UINT_MAX);
+}
+
+static void _word__frand(angort::Runtime *a){
+    double r;
+    drand48_r(&a->rnd,&r);
+    a->pushDouble(r);
+}
+
+static void _word__shuffle(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"l");
+ArrayList<Value> *p0 = Types::tList->get(_parms[0]);
+    WriteLock lock = WL(p0);
+    int ct = p0->count();
+    if(ct<=1)return; // no point..
+    Value t;
+    for(int i=ct-1;i>=1;i--){
+        long lr;
+        lrand48_r(&a->rnd,&lr);
+        int j = lr%(i+1);
+        // swap i and j
+        t.copy(p0->get(i));
+        p0->get(i)->copy(p0->get(j));
+        p0->get(j)->copy(&t);
+    }
+}
+
+
+
+
+// Knuth, TAOCP vol2 p.122
+inline double rand_gauss (Runtime *a,double mean,double sigma) {
+    double v1,v2,s;
+    do {
+        drand48_r(&a->rnd,&v1);
+        v1 = v1*2-1;
+        drand48_r(&a->rnd,&v2);
+        v2 = v2*2-1;
+        s = v1*v1 + v2*v2;
+    } while ( s >= 1.0 );
+    
+    if (s == 0.0)
+        s=0.0;
+    else
+        s=(v1*sqrt(-2.0 * log(s) / s));
+    return (s*sigma)+mean;
+}
+
+// http://azzalini.stat.unipd.it/SN/
+inline double skewnormal(Runtime *a,double location,double scale, double shape){
+    double p = rand_gauss(a,0,1);
+    double q = rand_gauss(a,0,1);
+    if(q>shape*p)
+        p*=-1;
+    return location+scale*p;
+}
+
+static void _word__normrand(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"nn");
+float p0 = _parms[0]->toFloat();
+float p1 = _parms[1]->toFloat();
+    a->pushDouble(rand_gauss(a,p0,p1));
+}
+
+static void _word__skewnormrand(angort::Runtime *a)
+{
+Value *_parms[3];
+a->popParams(_parms,"nnn");
+float p0 = _parms[0]->toFloat();
+float p1 = _parms[1]->toFloat();
+float p2 = _parms[2]->toFloat();
+    a->pushDouble(skewnormal(a,p0,p1,p2));
+}
+
+static void _word__tointbase(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"si");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+int p1 = _parms[1]->toInt();
+    a->pushInt(strtol(p0,NULL,p1));
+}
+static void _word__tolongbase(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"si");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+int p1 = _parms[1]->toInt();
+    a->pushLong(strtol(p0,NULL,p1));
+}
+
+static void __init__(angort::Runtime *a,bool showinit)
+{
+    // set up a constant PI
+    Namespace *ns = a->ang->names.getSpaceByName("math");
+    if(ns->get("PI")<0){
+        int n = ns->addConst("PI",false);
+        Value *v = ns->getVal(n);
+        Types::tDouble->set(v,3.14159265358979323846);
+    }
+    
+}
+static angort::WordDef _wordlist_[]={
+    {"atan2","(y x -- atan2(y,x))",_word__atan2},
+    {"floor","(x -- floor of x)",_word__floor},
+    {"ceil","(x -- ceiling of x)",_word__ceil},
+    {"round","(x -- x to nearest int, as a double)",_word__round},
+    {"cos","(x -- cos x)",_word__cos},
+    {"sin","(x -- sin x)",_word__sin},
+    {"tan","(x -- tan x)",_word__tan},
+    {"acos","(x -- cos x)",_word__acos},
+    {"asin","(x -- sin x)",_word__asin},
+    {"atan","(x -- tan x)",_word__atan},
+    {"ln","(x -- ln x)",_word__ln},
+    {"log","(x -- ln x)",_word__log},
+    {"log2","(x -- log2 x)",_word__log2},
+    {"sqrt","(x -- sqrt x)",_word__sqrt},
+    {"exp","(x -- exp x)",_word__exp},
+    {"pow","(x y -- x^y)",_word__pow},
+    {"abs","(x -- abs(x))",_word__abs},
+    {"fmod","(x y -- fmod(x,y))",_word__fmod},
+    {"srand","(time/none --) set the random number generator seed. \n Sets the random number generator seed. If none, use the timestamp.",_word__srand},
+    {"rand","(-- i) stack an integer random number\n Stacks an integer random number from 0 to the maximum integer. Typically\n used in \"rand N %\" to give a number from 0 to N-1.",_word__rand},
+    {"frand","(-- random double [0.1])\n Uses drand48 to generate a random number from 0 to 1.",_word__frand},
+    {"shuffle","(list --) perform a Fisher-Yates shuffle on a list in place",_word__shuffle},
+    {"normrand","(mean sigma -- normally distributed random number)\n Generate a normally-distributed random number, as a double.",_word__normrand},
+    {"skewnormrand","(location scale shape -- n) Skew-normal random number\n Generate a skew-normal distributed random number as a double.",_word__skewnormrand},
+    {"tointbase","(string base -- n) convert string to int given the base",_word__tointbase},
+    {"tolongbase","(string base -- n) convert string to long given the base",_word__tolongbase},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_math 
+
+angort::LibraryDef _angortlib_math = {
+    "math",
+    _angortlib_ns_math::_wordlist_,
+    _angortlib_ns_math::_binoplist_,
+    _angortlib_ns_math::__init__,NULL
+};
@@ -0,0 +1,54 @@
+#include "angort.h"
+
+
+using namespace angort;
+
+namespace _angortlib_ns_sb {
+
+static void _word__new(angort::Runtime *a){
+    Types::tStrBuild->set(a->pushval());
+}
+
+static void _word__append(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    Types::tStrBuild->get(p1)->append(p0);
+}
+
+static void _word__tostr(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    StringBuilder *b = Types::tStrBuild->get(p0);
+    Value t;
+    Types::tString->setwithlen(&t,b->get(),b->length());
+    a->pushval()->copy(&t);
+}
+
+static void _word__clear(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    Types::tStrBuild->get(p0)->clear();
+}
+static angort::WordDef _wordlist_[]={
+    {"new","(-- sb) make a new, empty string builder",_word__new},
+    {"append","(val sb --) append a value, converted to a string, to a builder",_word__append},
+    {"tostr","(sb -- string) get the contents of a builder as a string",_word__tostr},
+    {"clear","(sb --) empty a builder, so that it can be reused",_word__clear},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_sb 
+
+angort::LibraryDef _angortlib_sb = {
+    "sb",
+    _angortlib_ns_sb::_wordlist_,
+    _angortlib_ns_sb::_binoplist_,
+    NULL,NULL
+};
@@ -0,0 +1,440 @@
+/**
+ * @file stdString.cpp
+ * @brief  Brief description of file.
+ *
+ */
+
+
+#include "angort.h"
+#include "strkernels.h"
+#include <wchar.h>
+#include <wctype.h>
+
+using namespace angort;
+
+namespace angort {
+void format(Value *out,Value *formatVal,ArrayList<Value> *items);
+
+inline int wstrlen(const char *s){
+    return mbstowcs(NULL,s,0);
+}
+
+/// split a string wherever there's a byte from a set, up to limit
+/// times if limit is positive, pushing a list of the pieces. Long
+/// pieces are views into the string.
+static void splitOn(Runtime *a,Value *v,const strk::ByteSet& delims,int limit){
+    // keep our own reference to the string, because pushing the
+    // list may overwrite the parameter.
+    Value tmp,str;
+    str.copy(Types::tString->coerce(v,&tmp));
+    const char *s = Types::tString->getBytes(&str);
+    int len = Types::tString->getByteLength(&str);
+    // if it's all ASCII, we know how many characters each piece has
+    bool ascii = Types::tString->isASCII(&str);
+    
+    ArrayList<Value> *list = Types::tList->set(a->pushval());
+    WriteLock lock=WL(list);
+    
+    for(int p=0,splitct=0;;){
+        // the rest of the string if we've done enough splits
+        int e = (limit<=0 || splitct<limit) ? p+strk::findAny(s+p,len-p,delims) : len;
+        Types::tString->substringBytes(list->append(),&str,p,e,ascii ? e-p : -1);
+        if(e==len)break;
+        splitct++;
+        p=e+1;
+    }
+}
+
+/// get the delimiter and limit for split and splitany, from either
+/// a string or [delims,limit].
+static const char *getDelims(Value *v,int *limit,StringBuffer& sb){
+    if(v->t == Types::tList){
+        ArrayList<Value> *lst = Types::tList->get(v);
+        sb.set(lst->get(0));
+        *limit = lst->get(1)->toInt();
+    } else {
+        sb.set(v);
+        *limit = -1;
+    }
+    return sb.get();
+}
+
+}
+
+namespace _angortlib_ns_string {
+
+// turn a byte offset into the bytes of a value into a character
+// index. Strings cache their length in characters, so once we know
+// one is ASCII there's no counting to do.
+static int charIndex(Value *v,const char *h,int off){
+    if(StringType::isString(v) && Types::tString->isASCII(v))
+        return off;
+    return StringType::countUTF8(h,off);
+}
+
+static void _word__stridx(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    StringBuffer hsb,nsb;
+    int hlen,nlen;
+    const char *h = Types::tString->getBytes(p0,&hlen,hsb);
+    const char *n = Types::tString->getBytes(p1,&nlen,nsb);
+    const char *p = strk::find(h,hlen,n,nlen);
+    if(!p)
+        a->pushval()->clr();
+    else
+        a->pushInt(charIndex(p0,h,p-h));
+}
+static void _word__istridx(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    StringBuffer hsb,nsb;
+    int hlen,nlen;
+    const char *h = Types::tString->getBytes(p0,&hlen,hsb);
+    const char *n = Types::tString->getBytes(p1,&nlen,nsb);
+    const char *p = strk::ifind(h,hlen,n,nlen);
+    if(!p)
+        a->pushval()->clr();
+    else
+        a->pushInt(charIndex(p0,h,p-h));
+}
+
+static void _word__strsimd(angort::Runtime *a){
+    a->pushString(strk::getLevelName(strk::getLevel()));
+}
+
+static void _word__setstrsimd(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"s");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+    for(int i=strk::SK_SCALAR;i<=strk::SK_AVX2;i++){
+        if(!strcmp(p0,strk::getLevelName((strk::Level)i))){
+            strk::setLevel((strk::Level)i);
+            return;
+        }
+    }
+    throw RUNT(EX_BADPARAM,"").set("unknown SIMD set: %s",p0);
+}
+
+
+static void _word__chr(angort::Runtime *a){
+    Value *s = a->stack.peekptr();
+    int i = s->toInt();
+    char out[2];
+    out[0]=i;
+    out[1]=0;
+    Types::tString->set(s,out);
+    
+}
+
+static void _word__asc(angort::Runtime *a){
+    Value *s = a->stack.peekptr();
+    const StringBuffer& str = s->toString();
+    Types::tInteger->set(s,*str.get());
+}
+
+static void _word__lowercase(angort::Runtime *a){
+    Value *v = a->stack.peekptr();
+    const StringBuffer &s = v->toString();
+    int len = wstrlen(s.get());
+    wchar_t *buf = (wchar_t *)alloca((len+1)*sizeof(wchar_t));
+    mbstowcs(buf,s.get(),len+1);
+    for(int i=0;i<len;i++){
+        buf[i]=towlower(buf[i]);
+    }
+    buf[len]=0;
+    int reqd = wcstombs(NULL,buf,0);
+    char *s2 = (char *)alloca(sizeof(char)*(reqd+1));
+    wcstombs(s2,buf,reqd+1);
+    Types::tString->set(v,s2);
+}
+
+static void _word__uppercase(angort::Runtime *a){
+    Value *v = a->stack.peekptr();
+    const StringBuffer &s = v->toString();
+    int len = wstrlen(s.get());
+    wchar_t *buf = (wchar_t *)alloca((len+1)*sizeof(wchar_t));
+    mbstowcs(buf,s.get(),len+1);
+    
+    for(int i=0;i<len;i++){
+        buf[i]=towupper(buf[i]);
+    }
+    buf[len]=0;
+    int reqd = wcstombs(NULL,buf,0);
+    char *s2 = (char *)alloca(sizeof(char)*(reqd+1));
+    wcstombs(s2,buf,reqd+1);
+    Types::tString->set(v,s2);
+}
+
+static void _word__format(angort::Runtime *a){
+    Value f,l;
+    f.copy(a->popval());
+    l.copy(a->popval());
+    
+    ArrayList<Value> *lst = Types::tList->get(&l); // format() will lock
+    format(a->pushval(),&f,lst);
+}
+
+static void _word__sx(angort::Runtime *a){
+    Value *s = a->stack.peekptr();
+    int x = s->toInt();
+    char buf[256];
+    snprintf(buf,255,"%x",x);
+    Types::tString->set(s,buf);
+}
+static void _word__sf(angort::Runtime *a){
+    Value *s = a->stack.peekptr();
+    double x = s->toDouble();
+    char buf[256];
+    snprintf(buf,255,"%g",x);
+    Types::tString->set(s,buf);
+}
+
+static void _word__nsf(angort::Runtime *a){
+    int nsf = a->popInt();
+    Value *s = a->stack.peekptr();
+    double x = s->toDouble();
+    char buf[256];
+    char tmp[32];
+    snprintf(tmp,32,"%%.%df",nsf);
+    snprintf(buf,255,tmp,x);
+    Types::tString->set(s,buf);
+}
+
+
+static void _word__padleft(angort::Runtime *a){
+    int padding = a->popInt();
+    Value *v = a->stack.peekptr();
+    Value tmp,r;
+    Value *s = Types::tString->coerce(v,&tmp);
+    
+    int len = Types::tString->getCount(s);
+    if(len>=padding)
+        return;
+    
+    int bytes = Types::tString->getByteLength(s);
+    char *out = Types::tString->setAllocateOnly(&r,bytes+padding-len);
+    memset(out,' ',padding-len);
+    // views aren't null-terminated, so write our own
+    memcpy(out+padding-len,Types::tString->getBytes(s),bytes);
+    out[bytes+padding-len]=0;
+    v->copy(&r);
+}
+
+static void _word__padright(angort::Runtime *a){
+    int padding = a->popInt();
+    Value *v = a->stack.peekptr();
+    Value tmp,r;
+    Value *s = Types::tString->coerce(v,&tmp);
+    
+    int len = Types::tString->getCount(s);
+    if(len>=padding)
+        return;
+    
+    int bytes = Types::tString->getByteLength(s);
+    char *out = Types::tString->setAllocateOnly(&r,bytes+padding-len);
+    memcpy(out,Types::tString->getBytes(s),bytes);
+    memset(out+bytes,' ',padding-len);
+    out[bytes+padding-len]=0;
+    v->copy(&r);
+}
+
+
+static void _word__trunc(angort::Runtime *a){
+    int maxlen = a->popInt();
+    Value *v = a->stack.peekptr();
+    Value tmp;
+    Value *s = Types::tString->coerce(v,&tmp);
+    
+    if(maxlen<0 || Types::tString->getCount(s)<maxlen)
+        return;
+    
+    // might not actually be a string.
+    Types::tString->substring(v,s,0,maxlen);
+}
+
+inline int wordlen(const wchar_t * s){
+    const wchar_t *p;
+    for(p = s; *s && *s!=' ' && *s!='\t' && *s!='\n'; s++){}
+    return(s-p);
+}
+static void _word__wrap(angort::Runtime *a){
+    int maxlen = a->popInt();
+    Value *v = a->stack.peekptr();
+    const StringBuffer &sb = v->toString();
+    const char *src = sb.get();
+    int len = wstrlen(src);
+    
+    wchar_t *s = (wchar_t *)alloca((len+1)*sizeof(wchar_t));
+    int rv = mbstowcs(s,src,len+1);
+    if(rv<0){
+        a->pushNone();
+        return;
+    }
+    int llen=0;
+    for(wchar_t *p = s;*p;p++,llen++){
+        if(*p=='\n'){
+            llen=0;
+        } else if(*p==' ' || *p=='\t'){
+            if(llen + wordlen(p+1) > maxlen){
+                *p='\n';
+                llen=0;
+            }
+        }
+    }
+    
+    char *ss = (char *)malloc(len+1);
+    rv=wcstombs(ss,s,len+1);
+    Types::tString->set(v,ss);
+}
+
+static void _word__split(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    StringBuffer sb;
+    int limit;
+    const char *d = getDelims(p1,&limit,sb);
+    // only the first byte of the delimiter is used
+    splitOn(a,p0,strk::ByteSet(d,*d ? 1 : 0),limit);
+}
+
+static void _word__splitany(angort::Runtime *a)
+{
+Value *_parms[2];
+a->popParams(_parms,"vv");
+Value * p0 = _parms[0];
+Value * p1 = _parms[1];
+    StringBuffer sb;
+    int limit;
+    const char *d = getDelims(p1,&limit,sb);
+    for(const char *q=d;*q;q++){
+        if(*q&0x80)
+            throw RUNT(EX_BADPARAM,"splitany delimiters must be ASCII");
+    }
+    splitOn(a,p0,strk::ByteSet(d,strlen(d)),limit);
+}
+
+static void _word__splitwhitespace(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"v");
+Value * p0 = _parms[0];
+    Value tmp,str;
+    str.copy(Types::tString->coerce(p0,&tmp));
+    const char *s = Types::tString->getBytes(&str);
+    int len = Types::tString->getByteLength(&str);
+    bool ascii = Types::tString->isASCII(&str);
+    
+    ArrayList<Value> *list = Types::tList->set(a->pushval());
+    WriteLock lock=WL(list);
+    
+    // UTF-8 continuation bytes are never whitespace, so we can just
+    // scan the bytes.
+    int p=0;
+    for(;;){
+        // skip initial whitespace
+        p += strk::skipAny(s+p,len-p,strk::whitespace);
+        if(p==len)break;
+        // find the end of the word (or string)
+        int e = p+strk::findAny(s+p,len-p,strk::whitespace);
+        Types::tString->substringBytes(list->append(),&str,p,e,ascii ? e-p : -1);
+        p=e;
+    }
+}
+
+static void _word__substr(angort::Runtime *a)
+{
+Value *_parms[3];
+a->popParams(_parms,"vii");
+Value * p0 = _parms[0];
+int p1 = _parms[1]->toInt();
+int p2 = _parms[2]->toInt();
+    Value tmp,r;
+    Value *s = Types::tString->coerce(p0,&tmp);
+    int len = Types::tString->getCount(s);
+    if(p1<0)
+        p1 = len+p1;
+    if(p1>len || p1<0){
+        a->pushString("");
+    } else {
+        if(p2<=0){
+            p2=len+p2-p1;
+        }
+        // a count which is still not positive, or runs past the
+        // end, gives the rest of the string.
+        int end = (p2>0 && p1+p2<len) ? p1+p2 : len;
+        Types::tString->substring(&r,s,p1,end);
+        a->pushval()->copy(&r);
+    }
+}        
+
+static void _word__trim(angort::Runtime *a)
+{
+Value *_parms[1];
+a->popParams(_parms,"s");
+const StringBuffer &_sb0 = _parms[0]->toString();
+const char *p0 = _sb0.get();
+    int len = wstrlen(p0);
+    wchar_t *buf = (wchar_t *)alloca((len+1)*sizeof(wchar_t));
+    mbstowcs(buf,p0,len+1);
+    
+    
+    wchar_t *s = buf;  // start of string
+    while(*s && iswspace(*s))s++; // move first non-whitespace
+    
+    wchar_t *end = buf+len-1; // end of string (last char)
+    // now move end of string back to first non whitespace
+    if(iswspace(*end)){
+        while(end>s && iswspace(*end))end--;
+        end[1] = 0;
+    }
+    end++; // make room for terminator
+    char *s2 = (char *)alloca(end-s+1);
+    
+    wcstombs(s2,s,end-s+1);
+    a->pushString(s2);
+}
+static angort::WordDef _wordlist_[]={
+    {"stridx","(haystack needle -- int) return index if haystack contains needle, else none\n The index is in characters, as for \"substr\" and \"slice\".",_word__stridx},
+    {"istridx","(haystack needle -- int) return index if haystack contains needle, else none\n As \"stridx\", but ignoring the case of the ASCII letters.",_word__istridx},
+    {"strsimd","(-- name) the SIMD instruction set used by the string searching words\n This is one of \"avx2\", \"sse2\" or \"scalar\" (no SIMD), and is used by\n \"stridx\", \"istridx\", \"split\", \"splitany\" and \"splitwhitespace\".",_word__strsimd},
+    {"setstrsimd","(name --) set the SIMD instruction set used by the string searching words\n The name is \"avx2\", \"sse2\" or \"scalar\". If the processor doesn't support\n the set requested, the best one it does support is used. This is mostly\n useful for testing.",_word__setstrsimd},
+    {"chr","(integer -- string) convert integer to ASCII char (as single-character string)",_word__chr},
+    {"asc","(string -- integer) convert first character in string to ASCII integer",_word__asc},
+    {"lowercase","(string -- string) lowercase a string ",_word__lowercase},
+    {"uppercase","(string -- string) uppercase a string ",_word__uppercase},
+    {"format","(list string -- string) string formatting\n Format a string using a subset of printf semantics. The types supported\n are: d, u, x (which take an l flag for longs), f, g, e, s and c. Precision\n and width are supported for numeric types, and width for strings. The list\n contains the items to be substituted into the string. Formats are compiled\n the first time they are used and cached, so using the same format many\n times is cheap.",_word__format},
+    {"sx","(v -- s) convert a value to hex string",_word__sx},
+    {"sf","(v -- s) convert a float to a string with minimum sig figs",_word__sf},
+    {"nsf","(v n -- s) convert a float to a string with given sig figs",_word__nsf},
+    {"padleft","(string padding -- string) insert spaces at left to pad out string",_word__padleft},
+    {"padright","(string padding -- string) insert spaces at right to pad out string",_word__padright},
+    {"trunc","(string maxlen -- string) truncate a string if longer than maxlen",_word__trunc},
+    {"wrap","(string maxlen -- string) word wrap to max characters, inserting breaks. Tabs are one space!",_word__wrap},
+    {"split","(string delim/max -- list) split a string on a single-character delimiter or with limit\n delim can be either a delimiter or [delim,max] where max is the maximum\n number of splits. Long pieces are views into the original string rather\n than copies.",_word__split},
+    {"splitany","(string delims/max -- list) split a string wherever there is any of a set of characters\n delims is a string of the characters to split on, which must all be\n ASCII. As with \"split\", it can be [delims,max] where max is the maximum\n number of splits, and long pieces are views into the original string.",_word__splitany},
+    {"splitwhitespace","(str -- list) split string by whitespace\n Whitespace is as for isspace() in the C library: the ASCII space, tab,\n newline, vertical tab, form feed and carriage return. Long pieces are\n views into the original string rather than copies.",_word__splitwhitespace},
+    {"substr","(str start count -- str) get a substring.\n If count less than or equal to 0 calculate count from end, \n if start negative calculate start from end. See also \"slice\".",_word__substr},
+    {"trim","(s --) trim surrounding whitespace",_word__trim},
+    {NULL,NULL,NULL} };
+static angort::BinopDef _binoplist_[]={
+    {NULL,NULL,NULL} };
+} // end namespace _angortlib_ns_string 
+
+angort::LibraryDef _angortlib_string = {
+    "string",
+    _angortlib_ns_string::_wordlist_,
+    _angortlib_ns_string::_binoplist_,
+    NULL,NULL
+};
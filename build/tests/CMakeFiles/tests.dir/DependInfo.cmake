@@ -0,0 +1,25 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/hash.cpp" "tests/CMakeFiles/tests.dir/hash.cpp.o" "gcc" "tests/CMakeFiles/tests.dir/hash.cpp.o.d"
+  "/root/repo/tests/linetable.cpp" "tests/CMakeFiles/tests.dir/linetable.cpp.o" "gcc" "tests/CMakeFiles/tests.dir/linetable.cpp.o.d"
+  "/root/repo/tests/main.cpp" "tests/CMakeFiles/tests.dir/main.cpp.o" "gcc" "tests/CMakeFiles/tests.dir/main.cpp.o.d"
+  "/root/repo/tests/null.cpp" "tests/CMakeFiles/tests.dir/null.cpp.o" "gcc" "tests/CMakeFiles/tests.dir/null.cpp.o.d"
+  "/root/repo/tests/range.cpp" "tests/CMakeFiles/tests.dir/range.cpp.o" "gcc" "tests/CMakeFiles/tests.dir/range.cpp.o.d"
+  "/root/repo/tests/strview.cpp" "tests/CMakeFiles/tests.dir/strview.cpp.o" "gcc" "tests/CMakeFiles/tests.dir/strview.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/build/lib/CMakeFiles/angort.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
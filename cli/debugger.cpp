@@ -70,7 +70,7 @@ static void process(const char *line,Runtime *a){
         try{
             switch(tok.getnext()){
             case T_BREAK:
-                ((Instruction *)a->ip)->brk= !a->ip->brk;
+                a->ang->toggleBreakpoint(a->ip);
                 break;
             case T_INT:
                 Types::tInteger->set(stack.pushptr(),tok.getint());
@@ -104,13 +104,14 @@ static void process(const char *line,Runtime *a){
                     const StringBuffer& b = stack.popptr()->toString();
                     // find the global
                     Value *v = a->ang->findOrCreateGlobalVal(b.get());
-                    Instruction *ip;
+                    const Instruction *ip=NULL;
                     if(v->t == Types::tCode){
-                        ip = (Instruction*)v->v.cb->ip;
+                        ip = v->v.cb->ip;
                     } else if(v->t == Types::tClosure){
-                        ip = (Instruction*)v->v.closure->cb->ip;
+                        ip = v->v.closure->cb->ip;
                     } else printf("expected the name of a function\n");
-                    ip->brk = !ip->brk;
+                    if(ip)
+                        a->ang->toggleBreakpoint(ip);
                 }
                 break;
             case T_PRINT:
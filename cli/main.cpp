@@ -9,19 +9,21 @@
 #include <stdio.h>
 #include <signal.h>
 #include <stdlib.h>
+#include <unistd.h>
 #if !NOLINEEDITING
 #include <histedit.h>
 #include "completer.h"
 #endif
 
 #include "angort.h"
+#include "profiler.h"
 
 
 // keep this up to date!
 static const char *copyString="(c) Jim Finnis 2012-2020";
 static const char *usageString=
 "\nUsage: angort [-?] [-n] [-e] [-d] [-D] [-b] [-if] [-in]\n"
-"        [-llib] [-llib]..\n\n"
+"        [-P file] [-llib] [-llib]..\n\n"
 "-?    : this string\n"
 "-n    : execute command-line script in loop, requires two args: init\n"
 "        and loop (the latter reads lines from stdin)\n"
@@ -33,6 +35,8 @@ static const char *usageString=
 "-if   : import symbols from future namespace, mutually exclusive with...\n"
 "-if   : import symbols from deprecated namespace\n"
 "-llib : import named library\n"
+"-P file : profile Angort words, writing folded stacks to file and\n"
+"        per-word times to file.words on exit\n"
 ;
 
 using namespace angort;
@@ -50,6 +54,8 @@ Runtime *runtime; // default angort runtime
 static void showException(Exception& e){
     WriteLock lock=WL(&globalLock);
     printf("Error in thread %d: %s\n",e.run?e.run->id:-1,e.what());
+    if(e.srcFile)
+        printf("Thrown at %s:%d\n",e.srcFile,e.srcLine);
     if(e.ip){
         printf("Error at:");
         runtime->showop(e.ip);
@@ -92,6 +98,13 @@ public:
 
 bool debugOnSignal=false;
 
+// write the profile if -P was given; this handles exits which
+// don't shut angort down (a normal shutdown does it in the prof
+// library).
+static void profileAtExit(){
+    Profiler::finish(runtime->ang);
+}
+
 // this symbol needs to be defined if editline wasn't compiled with
 // UNICODE support, as it wasn't on earlier versions of Ubuntu.
 
@@ -282,6 +295,19 @@ int main(int argc,char *argv[]){
             case 'l':
                 a->plugin(arg+2);
                 break;
+            case 'P':
+                // filename can be attached or the next argument
+                if(!arg[2]){
+                    if(++i==argc){
+                        printf("-P requires a filename\n");
+                        exit(1);
+                    }
+                    Profiler::setOutputFile(argv[i]);
+                } else
+                    Profiler::setOutputFile(arg+2);
+                Profiler::start();
+                atexit(profileAtExit);
+                break;
             default:
                 // unrecognised option
                 Types::tString->set(strippedArgs->append(),argv[i]);
@@ -300,6 +326,11 @@ int main(int argc,char *argv[]){
         }
     }
     
+    // if the output isn't going to a terminal, write it in big
+    // blocks (this must be done before anything is written).
+    if(!isatty(fileno(stdout)))
+        setvbuf(stdout,NULL,_IOFBF,OUTPUT_BUFSIZE);
+    
     // either the filename to run or a command (depending on opts)
     if(filename){
         try {
@@ -310,28 +341,21 @@ int main(int argc,char *argv[]){
                     exit(1);
                     }
                     a->feed(filename); // do initial part
-                    // looping is done with an egregious hack. Rather
-                    // than muck around inside Angort, we actually
-                    // fake up a function by feeding a colon definition
-                    // into Angort. Then, for each line, we stack the
-                    // line and then feed a line to run that function.
+                    // the loop body is compiled once, as a word,
+                    // and then run for each line with the line
+                    // stacked.
                     a->feed(":TMPLOOP");
                     a->feed(extradata);
                     a->feed(";");
-                    // then iterate over stdin, executing this
-                    // word for each line
-                    while(!feof(stdin)){
-                        char *buf=NULL;
-                        size_t size;
-                        int rv = getline(&buf,&size,stdin);
-                        if(rv<=0)
-                            break;
-                        else{
-                            buf[rv-1]=0;
-                            runtime->pushString(buf);
-                            a->feed("TMPLOOP");
-                        }
-                        if(buf)free(buf);
+                    Value loop;
+                    loop.copy(a->findOrCreateGlobalVal("TMPLOOP"));
+                    // read stdin through a file stream's buffer (see
+                    // the file library) rather than line by line
+                    Value in,line;
+                    FileObject *f = Types::tFile->set(&in,0,true,false,false);
+                    while(f->readLine(&line)){
+                        runtime->pushval()->copy(&line);
+                        runtime->runValue(&loop);
                     }
                 } else 
                     a->feed(filename);
@@ -30,6 +30,7 @@ typedef void (*InitFunc)(class Runtime *a,bool showinit);
 #include "value.h"
 #include "namespace.h"
 #include "lock.h"
+#include "serialise.h"
 
 namespace angort {
 
@@ -43,6 +44,8 @@ namespace angort {
 #define VBLOCKSIZE 4096
 /// depth of return stack
 #define RSTACKSIZE 256
+/// total number of active try-catch blocks across all frames
+#define CATCHSTACKSIZE (RSTACKSIZE*4)
 
 extern TokenRegistry tokens[];
 
@@ -103,18 +106,14 @@ struct Property {
 };
 
 
-/// all code is a sequence of these - an opcode and some data
+/// all code is a sequence of these - an opcode and some data. Source
+/// positions are not stored here, but in side tables (see LineTable).
 struct Instruction {
     
-    /// for debugging
-    const char *getDetails(char *buf,int len) const;
+    /// for debugging: the opcode and the source position (if not NULL)
+    const char *getDetails(char *buf,int len,const struct SourcePos *sp) const;
     
     int opcode;
-#if SOURCEDATA
-    const char *file;
-    int line,pos;
-    bool brk;
-#endif
     union {
         int i;
         float f;
@@ -126,9 +125,36 @@ struct Instruction {
         Property *prop;
         class Value *constexprval;
         IntKeyedHash<int> *catches; // for OP_TRY
+        /// operands for the register-form binops OP_LOCALBINOP
+        /// (two locals) and OP_LOCALLITBINOP (local and literal int)
+        struct {
+            int16_t a,b; //!< local indices, or local and literal
+            int op; //!< the stack-form binop opcode
+        } reg;
     }d;
 };
 
+/// the source position of an instruction, for debugging
+struct SourcePos {
+    const char *file;
+    int line,pos;
+};
+
+/// Source positions are kept out of the instructions in side tables,
+/// one per codeblock (and one per compile context, for immediate code).
+/// A codeblock finds positions in its own table (see CodeBlock::getPos);
+/// this is the registry of the compile contexts' tables, of which there
+/// are only ever a few.
+class LineTable {
+public:
+    /// register a table of positions for n instructions from start
+    static void add(const Instruction *start,int n,const SourcePos *pos);
+    /// unregister the table for instructions from start
+    static void remove(const Instruction *start);
+    /// get the position of an instruction, or NULL if unknown
+    static const SourcePos *find(const Instruction *ip);
+};
+
 /// structure used in compiling exceptions, generated
 /// for each "catch" clause. Consists of the symbols caught,
 /// and the start and end offsets of the catch clause.
@@ -181,8 +207,13 @@ struct ClosureTableEnt {
 class CompileContext {
     int compileCt; //!< words so far in compile buffer
     Instruction compileBuf[1024]; //!< compile buffer
+#if SOURCEDATA
+    SourcePos compileSrc[1024]; //!< source positions of the compile buffer
+#endif
     Stack<int,8> cstack; //!< location stack for loops etc.
     Stack<int,8> leaveListStack; //!< stack of leave instruction lists - linked through the d.i field, this is a list of OP_LEAVE etc. which must be resolved when a loop ends.
+    Stack<int,8> literalStack; //!< the OP_NEWLIST/OP_NEWHASH instructions of the list and hash literals being compiled, which count their items in the d.i field.
+    int literalDepth; //!< how deeply those literals are nested, which may be more than literalStack holds
     
     char localTokens[MAXLOCALS][64]; //!< locals in the word currently being defined
     int localTokenCt; //!< number of locals in the word currently being defined
@@ -280,12 +311,22 @@ public:
     CompileContext(){
         cstack.setName("compile");
         leaveListStack.setName("leavelist");
+        literalStack.setName("literal");
     
         closureListCt=0;
         spec=NULL;
         closureList=NULL;closureListTail=NULL;
         cb=NULL;
         reset(NULL,NULL);
+#if SOURCEDATA
+        LineTable::add(compileBuf,1024,compileSrc);
+#endif
+    }
+    
+    ~CompileContext(){
+#if SOURCEDATA
+        LineTable::remove(compileBuf);
+#endif
     }
     
     
@@ -375,6 +416,15 @@ public:
         return buf;
     }
     
+#if SOURCEDATA
+    /// make a copy of the source positions of the instructions
+    SourcePos *copySourcePositions(){
+        SourcePos *buf = new SourcePos[compileCt];
+        memcpy(buf,compileSrc,compileCt*sizeof(SourcePos));
+        return buf;
+    }
+#endif
+    
     /// add a new local, initially just a stack variable.
     /// Type checking is only for parameters currently.
     int addLocalToken(const char *s,Type *typ){
@@ -431,6 +481,28 @@ public:
             
     
     
+    /// start a list or hash literal, whose creating instruction is
+    /// the one just compiled. That instruction counts the items
+    /// appended to the literal, so that it can be made big enough.
+    void startLiteral(){
+        compileBuf[compileCt-1].d.i = 0;
+        if(literalDepth++ < 8)
+            literalStack.push(compileCt-1);
+    }
+    
+    /// count an item appended to the innermost literal, if there's
+    /// one we're tracking
+    void countLiteralItem(){
+        if(literalDepth>0 && literalDepth<=8)
+            compileBuf[literalStack.peek()].d.i++;
+    }
+    
+    /// end the innermost literal
+    void endLiteral(){
+        if(literalDepth>0 && literalDepth-- <= 8)
+            literalStack.pop();
+    }
+    
     Instruction *compile(int opcode){
         if(compileCt==1024)
             throw SyntaxException("word too long");
@@ -438,10 +510,10 @@ public:
         compileCt++;
         i->opcode = opcode;
 #if SOURCEDATA
-        i->file = tokeniser->getname();
-        i->line = tokeniser->getline();
-        i->pos = tokeniser->getpos();
-        i->brk = false;
+        SourcePos *sp = compileSrc+(compileCt-1);
+        sp->file = tokeniser->getname();
+        sp->line = tokeniser->getline();
+        sp->pos = tokeniser->getpos();
 #endif
         return i;
     }
@@ -514,6 +586,11 @@ struct CodeBlock {
     
     CodeBlock(){
         used=false;
+        lines=NULL;
+    }
+    
+    ~CodeBlock(){
+        delete [] lines;
     }
     
     void setFromContext(CompileContext *con);
@@ -549,6 +626,22 @@ struct CodeBlock {
     /// parameter types (which each may be null for no checking)
     Type **paramTypes; 
     
+    /// true if none of the parameters are typed or closed, and they
+    /// map directly onto the first locals - in which case call() can
+    /// just move them off the stack in one go.
+    bool simpleParams;
+    
+    /// source positions of each instruction (NULL if there aren't any)
+    SourcePos *lines;
+    
+    /// the source position of an instruction, or NULL if it isn't
+    /// one of ours or there are no positions
+    const SourcePos *getPos(const Instruction *i) const {
+        if(!lines || i<ip || i>=ip+size)
+            return NULL;
+        return lines+(i-ip);
+    }
+    
     bool used; //!< true if the codeblock ends up being used (so the context mustn't delete it)
     
     void dump(){
@@ -622,6 +715,12 @@ public:
 //                printf("popping state: state now %d - %d/%d\n",baseStack.ct,base,next);
     }
     
+    /// discard the current frame's locals, ready for alloc() - used
+    /// for tail calls, which reuse the frame.
+    void reuse(){
+        next=base;
+    }
+    
     /// allocate space after push()
     void alloc(int localct){
         next+=localct;
@@ -632,6 +731,14 @@ public:
         vars[base+n].copy(v);
     }
     
+    /// move n values into the first n local slots, leaving the
+    /// sources as NONE without touching any reference counts.
+    void moveIn(Value *src,int n){
+        Value *dest = vars+base;
+        for(int i=0;i<n;i++)
+            (dest++)->move(src++);
+    }
+    
     
     
     Value *get(int n){
@@ -640,30 +747,84 @@ public:
 };
 
 /// this is a stack frame; we push this every time we go into
-/// a function and pop every time we return.
+/// a function and pop every time we return. It's plain data, so
+/// pushing and popping it costs nothing beyond the stores; the
+/// only reference it can hold is the caller's closure.
 struct Frame {
     const Instruction *ip; //!< the return address
     const Instruction *base; //!< the address of the start of the function
-    Value rec; //!< the recursion data (i.e. "this function")
-    Value clos; //!< stores any closure created at this level
+    const CodeBlock *cb; //!< the codeblock running in this frame (for recursion)
+    /// the caller's closure (or NULL), whose reference is handed over to
+    /// the frame on call and back to the runtime on return
+    class Closure *clos;
     /// how many loop iterators are stacked for loops in this
     /// frame. This number is popped off if the function runs OP_STOP.
     int loopIterCt; 
     
-    ~Frame(){
-        rec.clr();
-        clos.clr();
-    }
+    /// release the closure reference, if any
+    void clear();
+};
+
+/// an active try-catch block, tagged with the depth of the return
+/// stack at which it was entered.
+struct CatchEntry {
+    IntKeyedHash<int> *h; //!< the catch table (symbols to handler offsets)
+    int depth; //!< the rstack depth of the frame which owns it
+};
+
+/// the kinds of loop on the loop iterator stack
+enum LoopIterKind {
+    LI_NONE, //!< an infinite loop, with no iterator
+    LI_OBJECT, //!< an iterator object made by the iterable's type
+    LI_LIST,LI_HASH,LI_IRANGE,LI_FRANGE,LI_STRING,LI_NUMVEC
+};
+
+/// the state of a loop, kept in the loop iterator stack. Lists, numeric
+/// vectors, hashes, ranges, integers and strings are iterated by "each" with the
+/// state held here, without creating an iterator object;
+/// anything else gets an IteratorObject (as made by "mkiter").
+struct LoopIter {
+    int kind; //!< a LoopIterKind
+    Value iterable; //!< the thing we're iterating over
+    /// the current item; we stash it here because our loops go
+    /// "leaveifdone next ... getcurrent..."
+    Value current;
+    Value obj; //!< the iterator object, for LI_OBJECT
+    int idx; //!< index of the current item, -1 before the first
+    int pos; //!< list/vector index, hash slot or string byte offset
+    union {
+        int i;
+        float f;
+    } cur,end,step; //!< for ranges and integers
+    ReadLock lock; //!< held on a list or hash while we go through it
     
-    void clear(){
-        rec.clr();
-        clos.clr();
-        loopIterCt=0;
+    LoopIter(){
+        kind=LI_NONE;
+    }
+    ~LoopIter(){
+        clr();
     }
+    
+    /// start iterating over a value
+    void start(Value *v);
+    /// fetch the next item into current, returning false if there
+    /// are none left.
+    bool next();
+    /// the number of times the iterator has moved forwards
+    int index();
+    /// release everything and make this an infinite loop
+    void clr();
 };
 
 /// runtime data
 
+/// output buffering modes for Runtime::setOutputBuffering()
+#define OUTPUT_NONE 0
+#define OUTPUT_LINE 1
+#define OUTPUT_FULL 2
+/// the size of the output buffer unless set otherwise
+#define OUTPUT_BUFSIZE 65536
+
 class Runtime {
     friend class Angort;
 public:
@@ -680,19 +841,25 @@ public:
     const char *name;
     drand48_data rnd; // this one is GCC specific!
 private:
+    /// how output is buffered (OUTPUT_ constants) and the buffer size,
+    /// or -1 if it hasn't been set and the stdio default is used
+    int outputMode,outputBufSize;
+    /// the buffer for redirected output, if we made one
+    char *redirBuf;
+    /// apply the output buffering to the output stream
+    void bufferOutput();
+    
     Stack<Frame,RSTACKSIZE> rstack; //!< the return stack
     Value currClosure; //!< the closure block of the current level
     /// how many loop iterators are stacked for loops in this
     /// frame. This number is popped off if the function runs OP_STOP.
     int loopIterCt; 
-    /// stack of stacks of exception handlers. The outer stack
-    /// matches the rstack (annoyingly I can't put it in there without
-    /// lots of copy operations), while the inner one is the stack
-    /// for within the function. This is big and inefficient,
-    /// as it contains loads of empty hashes!
-    Stack<Stack<IntKeyedHash<int>*,4>,RSTACKSIZE+1> catchstack;
-    
-    Stack<Value,RSTACKSIZE> loopIterStack; // stack of loop iterators
+    /// stack of active exception handlers for all frames. Only
+    /// functions which actually run a try push anything here; each
+    /// entry records which frame it belongs to.
+    Stack<CatchEntry,CATCHSTACKSIZE> catchstack;
+    
+    Stack<LoopIter,RSTACKSIZE> loopIterStack; // stack of loop iterators
     VarStack locals;
     /// this will push the locals stack
     /// and push the rstack. The new IP
@@ -700,6 +867,20 @@ private:
     /// (which could be NULL for top level).
     const Instruction *call(const Value *v, const Instruction *returnip);
     
+    /// the guts of call(), once the codeblock and closure (which may
+    /// be NULL) have been extracted from the value.
+    const Instruction *callBlock(const CodeBlock *cb, class Closure *clos,
+                                 const Instruction *returnip);
+    
+    /// like callBlock(), but for a call in tail position: the current
+    /// frame and locals block are reused rather than pushed, so the
+    /// return goes straight back to our caller.
+    const Instruction *tailCallBlock(const CodeBlock *cb, class Closure *clos);
+    
+    /// pop a codeblock's parameters off the stack into the current
+    /// locals frame, or into the closure for closed parameters.
+    void bindParams(const CodeBlock *cb, class Closure *clos);
+    
     
     /// called at the end of a block of code,
     /// or by emergency stop invocation. May set the IP to NULL.
@@ -711,16 +892,32 @@ public:
     bool debuggerNextIP; // stop at the next IP?
     bool debuggerStepping; // don't clear debuggerNextIP after stop
     int autoCycleCount; //!< current auto GC count
+    int profTick; //!< last profiler tick we sampled at
+    
+    /// record the current call stack in the profiler
+    void profile();
     
      
     /// show an instruction (might seem weird that it's in Runtime, but it
-    /// uses wordbase).
+    /// uses wordbase). If the codeblock isn't given, the instruction's
+    /// position is looked for with getSourcePos().
     void showop(const Instruction *ip,int indent=0,const Instruction *base=NULL,
-                const Instruction *curr=NULL);
+                const Instruction *curr=NULL,const CodeBlock *cb=NULL);
+    
+    /// get the source position of an instruction in the code this
+    /// runtime is running, looking in the codeblocks on the return
+    /// stack from the given frame down, and then in the compile
+    /// contexts for immediate code. NULL if it can't be found.
+    const SourcePos *getSourcePos(const Instruction *ip,int frame=0);
     /// used to run a codeblock - works by doing call() and then run() until exit.
     /// Will not push return stack.
     void runValue(const class Value *v);
     
+    /// the runtime running code on the calling thread, or NULL if
+    /// there isn't one. Values which run functions but don't know who
+    /// is using them, such as lazy pipelines, run them in this.
+    static Runtime *getCurrent();
+    
     /// store a stack trace into an arraylist of allocated strings,
     /// which should be deleted. We do this to stash the trace before
     /// we start unwinding the stack as part of exception handling.
@@ -756,13 +953,26 @@ public:
     
     /// stream used for output in redirection
     FILE *outputStream;
-    void endredir(){
-        if(outputStream != stdout){
-            fclose(outputStream);
-            outputStream=stdout;
-        }
-    }
-    
+    /// open a file and send output to it instead of stdout
+    void redir(const char *filename);
+    void endredir();
+
+    /// write a value to the output stream as "." and "p" do, followed
+    /// by a newline if nl is set. Numbers and strings are written
+    /// without making a string from them first, and the value and the
+    /// newline are written together even if other threads are printing.
+    void print(const Value *v,bool nl=false);
+    /// write out anything waiting in the output stream's buffer
+    void flushOutput(){
+        fflush(outputStream);
+    }
+    /// set how output is buffered: mode is OUTPUT_NONE (every print
+    /// is written immediately), OUTPUT_LINE (written at the end of
+    /// each line) or OUTPUT_FULL (written when the buffer fills);
+    /// size is the buffer size. Redirected output is buffered the
+    /// same way.
+    void setOutputBuffering(int mode,int size);
+
     /// dump the stack to stdout
     void dumpStack(const char *s);
     
@@ -771,11 +981,11 @@ public:
     
     
     /// get the top iterator on the iterator stack (or the nth)
-    IteratorObject *getTopIterator(int i=0){
-        Value *v = loopIterStack.peekptr(i);
-        if(v->t != Types::tIter)
+    LoopIter *getTopIterator(int i=0){
+        LoopIter *l = loopIterStack.peekptr(i);
+        if(l->kind == LI_NONE)
             throw RUNT(EX_NOITERLOOP,"attempt to get i,j,k or iter when not in an iterable loop");
-        return v->v.iter;
+        return l;
     }
     
     /// clear the runtime
@@ -1048,6 +1258,30 @@ public:
         debuggerHook = f;
     }
     
+    /// instructions which have debugger breakpoints set on them,
+    /// kept out of the instructions themselves
+    ArrayList<const Instruction *> breakpoints;
+    
+    /// set or clear a breakpoint on an instruction
+    void toggleBreakpoint(const Instruction *ip){
+        for(int i=0;i<breakpoints.count();i++){
+            if(*breakpoints.get(i)==ip){
+                breakpoints.remove(i);
+                return;
+            }
+        }
+        *breakpoints.append()=ip;
+    }
+    
+    /// is there a breakpoint set on this instruction?
+    bool isBreakpoint(const Instruction *ip){
+        for(int i=0;i<breakpoints.count();i++){
+            if(*breakpoints.get(i)==ip)
+                return true;
+        }
+        return false;
+    }
+    
     /// find a global or create one if it doesn't exist;
     /// used for autoglobals.
     int findOrCreateGlobal(const char *name){
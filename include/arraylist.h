@@ -18,8 +18,12 @@ template <class T> struct ArrayListComparator {
 };
     
 
-/// array list with random access get at  O(1). Insertion at O(n)
-/// except at the end of the list where it's O(1). List will occasionally
+/// array list with random access get at  O(1). Insertion and removal
+/// are O(1) (amortised) at either end of the list, and O(n) elsewhere.
+/// The items are kept contiguous in a block which has a gap at
+/// the front as well as the end, so that lists can be used as queues
+/// or deques; the front gap is only made when an item is inserted
+/// at the start. List will occasionally
 /// resize, more often on grow than on shrink. Docs need improving.
 /// Another hideousness - we actually use malloc and free here,
 /// because of the resizing issue. Bad things happen to garbage
@@ -33,7 +37,8 @@ template <class T> class ArrayList : public Lockable {
         capacity = n;
         baseCapacity = n;
         ct = 0;
-        data = (T*)malloc(sizeof(T)*n);
+        head = 0;
+        mem = data = (T*)malloc(sizeof(T)*n);
         locks=0;
         // don't run constructors until there are items there!
     }
@@ -53,7 +58,7 @@ public:
         // which exist
         for(int i=0;i<ct;i++)
             data[i].~T();
-        free(data);
+        free(mem);
         
     }
     
@@ -67,26 +72,38 @@ public:
     }
     
     /// insert an item before position n, returning a pointer to
-    /// fill in the item. Runs in O(n) time unless n==-1, in which
-    /// case it's O(1)
+    /// fill in the item. Runs in O(1) time at either end of the
+    /// list (n==0, or n==-1 for append), otherwise in O(n) time.
     T *insert(int n=-1){
         if(n<0 || n>=ct)
             return append();
-        reallocateifrequired(ct+1);
-        memmove(data+n+1,data+n,(ct-n)*sizeof(T));
+        if(n < (ct>>1)){
+            // nearer the start, so move the items before n down
+            makefrontgap();
+            head--;data--;
+            memmove(data,data+1,n*sizeof(T));
+        } else {
+            reallocateifrequired(ct+1);
+            memmove(data+n+1,data+n,(ct-n)*sizeof(T));
+        }
         ct++;
         new (data+n) T(); // inplace construction of new item
         return data+n;
     }
     
-    /// remove an item from somewhere in the list in O(n) time
+    /// remove an item from somewhere in the list, in O(1) time
+    /// at either end and O(n) time elsewhere
     bool remove(int n=-1){
         if(n<0||n>=ct)
             return false;
         ct--;
         // destruct the item we're about to remove
         data[n].~T();
-        if(n!=ct)
+        if(n < (ct>>1)){
+            // nearer the start, so move the items before n up
+            memmove(data+1,data,n*sizeof(T));
+            head++;data++;
+        } else if(n!=ct)
             memmove(data+n,data+n+1,(ct-n)*sizeof(T));
         reallocateifrequired(ct-1);
         return true;
@@ -104,6 +121,8 @@ public:
     /// destructors, just sets the size to zero.
     void clear(){
         ct=0;
+        head=0;
+        data=mem;
     }
     
     /// return the size of the list
@@ -116,21 +135,19 @@ public:
         return capacity;
     }
     
+    /// make sure there is room for at least n items, so that
+    /// appending up to that many doesn't reallocate again.
+    void reserve(int n){
+        if(n<ct)n=ct;
+        if(head+n>=capacity)
+            resize(n+1,0);
+    }
+    
     /// set a value in the list
     void set(int n,T *v){
         if(locks)
             throw RUNT(EX_MODITER,"cannot modify list as it is iterated");
-        if(n<0)
-            throw RUNT(EX_OUTOFRANGE,"list set index out of range");
-        if(n>=ct){
-            reallocateifrequired(n+10); // allocate a bit more
-            // initialise the new values!
-            for (int i=ct;i<capacity;i++){
-                new (data+i)T();
-            }
-            ct=n+1;
-        }
-        data[n].copy(v);
+        set(n)->copy(v);
     }
     
     /// get a slot to copy a value into
@@ -140,7 +157,7 @@ public:
         if(n>=ct){
             reallocateifrequired(n+10); // allocate a bit more
             // initialise the new values!
-            for (int i=ct;i<capacity;i++){
+            for (int i=ct;i<capacity-head;i++){
                 new (data+i)T();
             }
             ct=n+1;
@@ -165,36 +182,72 @@ public:
 private:
     
     /// reallocate the list if required by the given new count and copy
-    /// all items over. Will NOT change ct.
+    /// all items over. Will NOT change ct. Room is made at the end
+    /// of the list.
     void reallocateifrequired(int newct){
-        T *newdata;
-        if(newct>=capacity){
+        if(head+newct>=capacity){
+            if(head && newct < (capacity>>1)){
+                // plenty of room, it's just at the front (we're being
+                // used as a queue) so slide the items down.
+                memmove(mem,data,sizeof(T)*ct);
+                head=0;data=mem;
+                return;
+            }
             // need to grow the list
 //            printf("oldct %d, newct %d, cap %d\n",ct,newct,capacity);
-            capacity = newct + (newct>>3) + (newct<9?3:6);
-        } else if(capacity>baseCapacity && newct<(capacity>>1)) {
-            // need to shrink the list. New capacity should still
-            // have at least one empty space left at the end, for popped
-            // items!
+            int c = newct + (newct>>3) + (newct<9?3:6);
+            // if items have been removed from the front, grow more so
+            // that we don't slide too often.
+            if(head && c<newct*2)c=newct*2;
+            resize(c,0);
+        } else if(newct<ct && capacity>baseCapacity && newct<(capacity>>2)) {
+            // items have been removed and we need to shrink the list
+            // (never on append, which would undo a reserve()). New
+            // capacity should still have at least one empty space left
+            // at the end, for popped items!
 //            printf("oldct %d, newct %d, cap %d\n",ct,newct,capacity);
-            capacity = capacity>>1;
+            resize(capacity>>1,0);
 //            printf("SHRINK to %d\n",capacity);
+        }
+    }
+    
+    /// make sure there is at least one free slot before the first item,
+    /// making a gap in proportion to the size of the list so that
+    /// prepending is O(1) amortised.
+    void makefrontgap(){
+        if(head)return;
+        int gap = (ct>>1)+4;
+        if(ct+gap < capacity){
+            // room enough already, just move the items up
+            memmove(mem+gap,mem,sizeof(T)*ct);
+            head=gap;data=mem+gap;
         } else
-            return;
-        
+            resize(ct+gap*2,gap);
+    }
+    
+    /// reallocate the data area with the given capacity, placing
+    /// the items at the given offset.
+    void resize(int newcap,int newhead){
         // do the resize; don't run ctors - they've already been run on
         // the data
-        newdata = (T*)malloc(sizeof(T)*capacity);
-        memcpy(newdata,data,sizeof(T)*ct);
-        free(data); // without running dtors because they've been moved
-        data = newdata;
+        T *newmem = (T*)malloc(sizeof(T)*newcap);
+        memcpy(newmem+newhead,data,sizeof(T)*ct);
+        free(mem); // without running dtors because they've been moved
+        mem = newmem;
+        capacity = newcap;
+        head = newhead;
+        data = mem+head;
     }
     
-    /// the data area
+    /// the allocated block
+    T *mem;
+    /// the first item, which is head items into the block
     T *data;
+    /// the offset of the first item in the block
+    int head;
     /// the number of items currently stored in the list
     int ct;
-    /// the capacity of the list
+    /// the capacity of the list (i.e. the size of the block)
     int capacity;
     /// the initial capacity of the list, lower than which we never go
     int baseCapacity;
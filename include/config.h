@@ -0,0 +1,5 @@
+// Automatically generated!
+
+#define ANGORT_POSIXLOCKS 1
+#define EDITLINE_NOUNICODE 0
+#define NOLINEEDITING 1
@@ -26,9 +26,15 @@ class Exception : public std::exception {
 public:
     const class Runtime *run; // the runtime environment (thread) we were in
     const class Instruction *ip; // instruction pointer
+    /// where the exception was thrown, if it was thrown by running
+    /// code with source positions (otherwise srcFile is NULL)
+    const char *srcFile;
+    int srcLine;
     Exception(const char *xid,const char *e){
         run = NULL;
         ip = NULL;
+        srcFile = NULL;
+        srcLine = 0;
         id = getSymbolID(xid);
         if(e)
             strncpy(error,e,1024);
@@ -41,6 +47,8 @@ public:
     Exception(const char *xid){
         run = NULL;
         ip = NULL;
+        srcFile = NULL;
+        srcLine = 0;
         fatal=false;
         id = getSymbolID(xid);
         strcpy(error,xid);
@@ -53,6 +61,8 @@ public:
     Exception(const char *xid,const char *e,const char *arg){
         run = NULL;
         ip = NULL;
+        srcFile = NULL;
+        srcLine = 0;
         fatal=false;
         id = getSymbolID(xid);
         snprintf(error,1024,e,arg);
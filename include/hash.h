@@ -14,6 +14,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <new>
 
 #include "angort.h"
 #include "lock.h"
@@ -24,6 +25,17 @@ namespace angort {
 #define PERTURB_SHIFT 5
 // 32 in original
 #define INITIAL_SIZE 32
+/// tables of at least this many slots are resized incrementally
+#define INCREMENTAL_SIZE 4096
+/// how many slots of the old table each set() moves during an
+/// incremental resize
+#define INCREMENTAL_STEP 16
+/// how many slots of the next table each set() initialises before
+/// an incremental resize
+#define SPARE_STEP 32
+/// the most keys reserve() will make room for, which also keeps its
+/// arithmetic inside an int
+#define MAX_RESERVE (1<<29)
 
 //#define DEBUG 1
 
@@ -64,6 +76,14 @@ struct HashEnt {
 /// in Beautiful Code. There's also a good description of the Python
 /// implementation at http://www.laurentluce.com/?p=249
 /// Also the original source code is in dictobject.c
+///
+/// Large tables are resized incrementally, so that no single set()
+/// has to move every key. Once the table is half full, each set()
+/// initialises a few slots of a spare table of the size it will
+/// probably need next. When it is resized, each set() then moves a
+/// few slots of the old table into the new one until it is empty.
+/// Until then a key may be in either table (but never both), so
+/// lookups try the new table and then the old one.
 
 class Hash : public Lockable {
 public:
@@ -73,7 +93,9 @@ public:
         miss=0;
 #endif
         mask = INITIAL_SIZE-1;
-        table = new HashEnt[mask+1];
+        table = allocTable(mask+1);
+        oldtable = NULL;
+        spare = NULL;
         used=0;
         fill=0;
         locks=0;
@@ -83,8 +105,46 @@ public:
         return used;
     }
     
+    /// return the index of the first used slot at or after slot i,
+    /// or -1 if there are none. Used with keyAt() by each loops,
+    /// which iterate hashes without creating an iterator.
+    /// During an incremental resize the slots of the old table are
+    /// numbered after those of the new one.
+    int nextUsed(int i){
+        int size = mask+1;
+        while(i<size && !table[i].isUsed())i++;
+        if(i<size)
+            return i;
+        if(oldtable){
+            int oldsize = oldmask+1;
+            for(i-=size;i<oldsize;i++){
+                if(oldtable[i].isUsed())
+                    return i+size;
+            }
+        }
+        return -1;
+    }
+    
+    /// return a slot found by nextUsed()
+    HashEnt *entAt(int i){
+        return i<=mask ? table+i : oldtable+(i-mask-1);
+    }
+    
+    /// return the key in a slot found by nextUsed()
+    Value *keyAt(int i){
+        return &entAt(i)->k;
+    }
+    
+    /// return the value in a slot found by nextUsed()
+    Value *valAt(int i){
+        return &entAt(i)->v;
+    }
+    
     virtual ~Hash(){
-        delete [] table;
+        freeTable(table,mask+1);
+        if(oldtable)
+            freeTable(oldtable,oldmask+1);
+        free(spare);
 #ifdef DEBUG
         //        fprintf(stderr,"misses : %d, size %d\n",miss,mask+1);
 #endif
@@ -97,6 +157,17 @@ public:
             throw RUNT(EX_HASHMOD,"").set("hash cannot be modified while it is being iterated");
         
         uint32_t hash = k->getHash();
+        if(oldtable){
+            moveSlots(INCREMENTAL_STEP);
+            // if the key is still in the old table, just replace its value
+            if(oldtable){
+                HashEnt *ent = lookIn(oldtable,oldmask,k,hash);
+                if(ent->isUsed()){
+                    ent->v.copy(val);
+                    return;
+                }
+            }
+        }
         HashEnt *ent = look(k,hash);
         int n_used = used;
         
@@ -128,8 +199,23 @@ public:
 //        printf("used:%d nused:%d\n",used,n_used);
 //        printf("fill*3:%d (mask+1)*2:%d\n",fill*3,(mask+1)*2);
 
-        if((used > n_used && fill*3 >= (mask+1)*2))
-            resize((used>50000 ? 2:4)*used);
+        if(used > n_used){
+            if(fill*3 >= (mask+1)*2)
+                resize((used>50000 ? 2:4)*used);
+            else if(!spare && !oldtable && mask+1>=INCREMENTAL_SIZE &&
+                    fill*2 >= mask+1){
+                // start on the table we'll probably resize to, which
+                // would be too slow to initialise all at once
+                int size;
+                int minused = (used>50000 ? 2:4)*((mask+1)*2/3);
+                for(size=mask+1;size<=minused && size>0;size<<=1){}
+                spare = (HashEnt *)malloc(sizeof(HashEnt)*size);
+                sparesize = size;
+                built = 0;
+            }
+        }
+        if(spare)
+            buildSpare(SPARE_STEP);
     }
     
     /// finds a value in the hash table, returning true and setting
@@ -137,7 +223,7 @@ public:
     /// can then be retrieved with getval().
     
     virtual bool find(Value *k){
-        HashEnt *ent = look(k,k->getHash());
+        HashEnt *ent = lookBoth(k,k->getHash());
         if(ent->isUsed()) {
             storedVal = &ent->v;
             return true;
@@ -153,7 +239,7 @@ public:
     
     /// delete an item with a given key, returning true if we did it
     bool del(Value *k) {
-        HashEnt *ent = look(k,k->getHash());
+        HashEnt *ent = lookBoth(k,k->getHash());
         if(!ent->isUsed())
             return false;
         ent->k.clr();
@@ -177,6 +263,8 @@ public:
     // because then that would have to be above this class. And *that* wouldn't work,
     // because it needs things in *this* class. The joy of templates.
     HashEnt *table;
+    HashEnt *oldtable; //!< table being emptied by an incremental resize, or NULL
+    HashEnt *spare; //!< next table, partly initialised, or NULL
     Value *storedVal; //!< last value fetched
     
     // these are ints, because the resize code relies on them being
@@ -184,48 +272,127 @@ public:
     int used; //!< number of slots occupied by keys
     int fill; //!< number of slots occupied by keys or dummies (used only if we implement deletion)
     int mask; //!< hashtable contains mask+1 slots
+    int oldmask; //!< old table contains oldmask+1 slots
+    int moved; //!< slots of the old table moved so far
+    int sparesize; //!< spare table contains this many slots
+    int built; //!< slots of the spare table initialised so far
     int locks; //!< used to lock the hash if it is being iterated
     
+    /// make room for at least n keys, so that adding up to that many
+    /// won't resize the table again. Does nothing while the hash is
+    /// being iterated.
+    void reserve(int n){
+        if(n>MAX_RESERVE)
+            n=MAX_RESERVE;
+        // set() resizes when the table is two thirds full
+        if(!locks && n*3 >= (mask+1)*2)
+            resize(n*3/2+1);
+    }
+    
     void resize(int minused){
-        HashEnt *oldtable = table;
+        // finish any resize still going on
+        if(oldtable)
+            moveSlots(oldmask+1);
+        
         int oldsize = mask+1;
         
         int newsize;
         for(newsize = oldsize; newsize<=minused && newsize>0;newsize<<=1){}
 //        printf("resizing to %d\n",newsize);
         
-        table = new HashEnt[newsize];
+        oldtable = table;
+        oldmask = mask;
+        moved = 0;
+        if(spare && sparesize==newsize){
+            buildSpare(newsize);
+            table = spare;
+        } else {
+            free(spare);
+            table = allocTable(newsize);
+        }
+        spare = NULL;
         mask = newsize-1;
-        used = 0;
         fill = 0;
-        // iterate values, reinserting into new table
-        HashEnt *ent=oldtable;
         
-        for(int i=0;i<oldsize;i++,ent++){
+        // small tables are moved in one go
+        moveSlots(oldsize<INCREMENTAL_SIZE ? oldsize : INCREMENTAL_STEP);
+    }
+    
+    /// move up to n slots of the old table into the new one, deleting
+    /// the old table when it is empty. Moved keys are marked as deleted
+    /// in the old table, so it can still be searched past them.
+    void moveSlots(int n){
+        int oldsize = oldmask+1;
+        HashEnt *ent = oldtable+moved;
+        for(;n>0 && moved<oldsize;n--,moved++,ent++){
             if(ent->isUsed()){
-                HashEnt *newent = look(&ent->k,ent->k.getHash());
-                if(newent->k.t==Types::tNone){
+                HashEnt *newent = look(&ent->k,ent->hash);
+                if(newent->isUsed())
+                    throw Exception("invalid in resize");
+                if(newent->isFree())
                     fill++;
-                    used++;
-                    newent->k.copy(&ent->k);
-                    newent->v.copy(&ent->v);
-                    newent->hash = ent->hash;
-                    
-//                    printf("RESIZE SET\n");
-                }
-                else throw Exception("invalid in resize");
+                newent->k.copy(&ent->k);
+                newent->v.copy(&ent->v);
+                newent->hash = ent->hash;
+                ent->k.clr();
+                ent->k.t = Types::tDeleted;
+                ent->v.clr();
             }
         }
-        delete [] oldtable;
-//        printf("RESIZE END!\n");
+        if(moved==oldsize){
+            // everything has been moved out, so there's nothing to clear
+            free(oldtable);
+            oldtable = NULL;
+        }
+    }
+    
+    /// initialise up to n more slots of the spare table
+    void buildSpare(int n){
+        for(;n>0 && built<sparesize;n--,built++)
+            new(spare+built) HashEnt();
+    }
+    
+    /// tables are allocated and freed by hand, so that a spare can be
+    /// initialised a bit at a time and an emptied table freed without
+    /// running through it again
+    static HashEnt *allocTable(int n){
+        HashEnt *t = (HashEnt *)malloc(sizeof(HashEnt)*n);
+        for(int i=0;i<n;i++)
+            new(t+i) HashEnt();
+        return t;
+    }
+    
+    /// clear the keys and values left in a table and free it
+    static void freeTable(HashEnt *t,int n){
+        for(int i=0;i<n;i++){
+            t[i].k.clr();
+            t[i].v.clr();
+        }
+        free(t);
     }
     
     /// scan, looking for either a slot with this key or the
     /// slot where this key would go
-    
     HashEnt *look(Value *k,uint32_t hash){
-        register unsigned int slot = hash & mask;
-        register HashEnt *ent = table+slot;
+        return lookIn(table,mask,k,hash);
+    }
+    
+    /// look for a key in the new table and then the old one,
+    /// returning an unused slot if it is in neither.
+    HashEnt *lookBoth(Value *k,uint32_t hash){
+        HashEnt *ent = look(k,hash);
+        if(!ent->isUsed() && oldtable){
+            HashEnt *oldent = lookIn(oldtable,oldmask,k,hash);
+            if(oldent->isUsed())
+                return oldent;
+        }
+        return ent;
+    }
+    
+    /// look for a key in either table
+    HashEnt *lookIn(HashEnt *t,int m,Value *k,uint32_t hash){
+        register unsigned int slot = hash & m;
+        register HashEnt *ent = t+slot;
         register HashEnt *freeslot;
         
         if(ent->isFree())
@@ -242,7 +409,7 @@ public:
             miss++;
 #endif
             slot = (slot<<2)+slot+1+perturb;
-            ent = table+(slot&mask);
+            ent = t+(slot&m);
             if(ent->isFree())
                 return freeslot==NULL ? ent : freeslot;
             if(!ent->isDeleted() && ent->k.equalForHashTable(k))
@@ -327,7 +494,7 @@ class HashValueIterator : public Iterator<Value *> {
 public:
     HashValueIterator(Hash *h){
         hash = h;
-        ent = NULL;
+        started = false;
         hash->locks++;
     }
     
@@ -336,24 +503,21 @@ public:
     }
     
     virtual void first(){
-        size=hash->mask+1;
-        ent=hash->table;
         iteridx=0;
-        idx=0;
-        while(idx<size && !ent->isUsed()) {idx++;ent++;}
+        idx=hash->nextUsed(0);
+        started=true;
     }
     virtual void next(){
-        ent++;idx++;
-        while(idx<size && !ent->isUsed()) {idx++;ent++;}
+        idx=hash->nextUsed(idx+1);
         iteridx++;
     }
     virtual bool isDone() const {
-        return idx>=size;
+        return idx<0;
     }
     virtual Value *current() {
-        if(!ent)
+        if(!started)
             throw Exception("first() not called on iterator");
-        return &ent->v;
+        return &hash->entAt(idx)->v;
     }
     virtual int index() const {
         return iteridx;
@@ -361,8 +525,8 @@ public:
 private:
     Value key; //!< temporary for currentKey()
     Hash *hash;
-    int idx,size,iteridx;
-    HashEnt *ent;
+    int idx,iteridx;
+    bool started; //!< whether first() has been called
 };
 
 /// Hash iterator - you probably won't access this
@@ -372,7 +536,7 @@ class HashKeyIterator : public Iterator<Value *> {
 public:
     HashKeyIterator(Hash *h){
         hash = h;
-        ent = NULL;
+        started = false;
         hash->locks++;
     }
     
@@ -381,29 +545,26 @@ public:
     }
     
     virtual void first(){
-        size=hash->mask+1;
-        ent=hash->table;
-        idx=0;
+        idx=hash->nextUsed(0);
+        started=true;
         iteridx=0;
-        while(idx<size && !ent->isUsed()) {idx++;ent++;}
     }
     virtual void next(){
-        ent++;idx++;
-        while(idx<size && !ent->isUsed()) {idx++;ent++;}
+        idx=hash->nextUsed(idx+1);
         iteridx++;
     }
     virtual bool isDone() const {
-        return idx>=size;
+        return idx<0;
     }
     virtual Value *current() {
-        if(!ent)
+        if(!started)
             throw Exception("first() not called on iterator");
-        return &ent->k;
+        return &hash->entAt(idx)->k;
     }
     Value *curval(){
-        if(!ent)
+        if(!started)
             throw Exception("first() not called on iterator");
-        return &ent->v;
+        return &hash->entAt(idx)->v;
     }
     virtual int index() const {
         return iteridx;
@@ -411,8 +572,8 @@ public:
         
 private:
     Hash *hash;
-    int idx,size,iteridx;
-    HashEnt *ent;
+    int idx,iteridx;
+    bool started; //!< whether first() has been called
 };
 
 inline Iterator<Value *> *Hash::createIterator(bool iskeyiterator) {
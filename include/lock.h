@@ -83,14 +83,20 @@ public:
 #endif
     }
     
-    ~ReadLock(){
+    /// release the lock early, if it is held
+    void unlock(){
 #if ANGORT_POSIXLOCKS
         if(t){
             lockprintf("READLOCK END on %s %p\n",t->getLockableName(),&t->lock);
             pthread_rwlock_unlock(&t->lock);
+            t=NULL;
         }
 #endif
     }
+    
+    ~ReadLock(){
+        unlock();
+    }
 };
 
 #define WL(a) WriteLock(a,__FILE__,__LINE__)
@@ -0,0 +1,70 @@
+/**
+ * @file profiler.h
+ * @brief Sampling profiler for Angort words.
+ *
+ * A SIGPROF timer bumps a tick counter, and each Runtime checks it
+ * in its run loop; when it changes, the runtime records its current
+ * call stack (the codeblocks in the return stack) into a call tree.
+ * The tree can then be written out as folded stacks, for flamegraph
+ * tools, together with a table of self/total samples per word.
+ */
+
+#ifndef __ANGORTPROFILER_H
+#define __ANGORTPROFILER_H
+
+#include <signal.h>
+
+namespace angort {
+
+/// default sampling rate in Hz
+#define PROFILER_DEFAULT_HZ 100
+
+/// a node in the profiler's call tree: one for each distinct
+/// path of calls seen in the samples.
+struct ProfNode {
+    const struct CodeBlock *cb; //!< the word at this level (NULL at the root)
+    int self; //!< samples taken with this as the top of the stack
+    ProfNode *child; //!< first child
+    ProfNode *sibling; //!< next sibling
+
+    ProfNode(const struct CodeBlock *c){
+        cb=c;
+        self=0;
+        child=sibling=NULL;
+    }
+    ~ProfNode(){
+        delete child;
+        delete sibling;
+    }
+};
+
+class Profiler {
+public:
+    /// incremented by the SIGPROF handler, and watched by the run loop
+    static volatile sig_atomic_t ticks;
+
+    /// clear any previous data and start sampling at the given rate
+    static void start(int hz=PROFILER_DEFAULT_HZ);
+    /// stop sampling; the data is kept until the next start()
+    static void stop();
+    /// are we sampling?
+    static bool isRunning();
+
+    /// record a sample: a call stack of n codeblocks, outermost first
+    static void record(const struct CodeBlock **cbs,int n);
+
+    /// write folded stacks to a file, and a table of self/total samples
+    /// per word to the same name with ".words" appended. Returns false
+    /// if a file couldn't be opened.
+    static bool write(class Angort *a,const char *filename);
+
+    /// set a file to write the profile to when finish() is called
+    static void setOutputFile(const char *filename);
+    /// stop sampling and write to the output file, if there is one;
+    /// called at shutdown and exit. Only writes once.
+    static void finish(class Angort *a);
+};
+
+}
+
+#endif /* __ANGORTPROFILER_H */
@@ -0,0 +1,145 @@
+/**
+ * @file serialise.h
+ * @brief  Binary serialisation of values, for ser$dump and ser$load.
+ *
+ * The data starts with SER_MAGIC and a version byte, followed by a
+ * single value. Each value is a tag followed by the data its type writes
+ * with Type::serialise(). The first time a type appears the tag is 1,
+ * followed by the type's 4-byte ID; after that values of the type
+ * have the tag n+2, where n is the order in which the type first
+ * appeared. Types are looked up by ID when the data is read, so
+ * the data can be loaded by anything with the same types registered,
+ * including those added by plugins.
+ *
+ * Garbage-collected objects (lists, hashes and so on) are only written
+ * once. They are numbered in the order they are first written, and
+ * when one is met again the tag is 0 followed by its number, so shared
+ * structure and cycles survive the round trip.
+ *
+ * Integers, lengths and counts are written as varints (7 bits a
+ * byte, least significant first), with signed numbers zigzag encoded
+ * so small negative numbers are short too. Floats and doubles are
+ * written as their bytes, which are assumed to be little-endian IEEE.
+ */
+
+#ifndef __ANGORTSERIALISE_H
+#define __ANGORTSERIALISE_H
+
+namespace angort {
+
+/// the first bytes of serialised data
+#define SER_MAGIC "ANGS"
+/// the version of the format, which follows the magic
+#define SER_VERSION 1
+/// values can't be nested deeper than this, which stops both writing
+/// and reading from running out of C stack.
+#define SER_MAXDEPTH 1000
+/// the most data which can be written
+#define SER_MAXSIZE (1<<30)
+
+/// writes values into a string builder
+class Serialiser {
+public:
+    /// start writing, which writes the magic and version
+    Serialiser(StringBuilder& sb);
+    ~Serialiser();
+
+    /// write a value with its type (or a back-reference to it)
+    void write(Value *v);
+
+    /// write an unsigned integer as a varint
+    void writeUInt(unsigned long u);
+    /// write a signed integer as a zigzag varint
+    void writeInt(long i){
+        writeUInt(((unsigned long)i<<1)^(unsigned long)(i>>(sizeof(long)*8-1)));
+    }
+    /// write some bytes as they are
+    void writeBytes(const void *p,int n){
+        // the builder's length is an int, and it grows by doubling
+        if(n > SER_MAXSIZE-b.length())
+            throw RUNT(EX_OUTOFRANGE,"ser: data too big");
+        b.append((const char *)p,n);
+    }
+    /// write a length followed by that many bytes
+    void writeString(const char *s,int len){
+        writeUInt(len);
+        writeBytes(s,len);
+    }
+
+private:
+    StringBuilder& b;
+    /// the number used for each type written so far, by type ID
+    IntKeyedHash<int> types;
+    int ntypes;
+
+    /// the objects written so far, in an open-addressed table keyed
+    /// by address (which IntKeyedHash's 32-bit keys can't hold)
+    struct ObjEnt {
+        const void *p;
+        int n;
+    };
+    ObjEnt *objs;
+    int objcap,nobjs;
+    int depth;
+
+    /// return the number of an object if it has been written already,
+    /// otherwise give it the next number and return -1.
+    int addObject(const void *p);
+};
+
+/// reads values written by a Serialiser
+class Deserialiser {
+public:
+    /// start reading, checking the magic and version
+    Deserialiser(const char *data,int len);
+
+    /// read a value
+    void read(Value *out);
+    /// true if all the data has been read
+    bool atEnd()const{
+        return p==end;
+    }
+
+    /// read a varint
+    unsigned long readUInt();
+    /// read a zigzag varint
+    long readInt(){
+        unsigned long u = readUInt();
+        return (long)(u>>1)^-(long)(u&1);
+    }
+    /// return the next n bytes and skip over them
+    const char *readBytes(int n){
+        if(n<0 || n>end-p)
+            fail("data ends early");
+        const char *r=p;
+        p+=n;
+        return r;
+    }
+    /// read a string written by writeString(), setting len to its
+    /// length; the bytes aren't null-terminated.
+    const char *readString(int *len){
+        *len = readCount(1);
+        return readBytes(*len);
+    }
+    /// read a count of items, each of which takes at least itemsize
+    /// bytes, so that corrupt data can't make us allocate vast amounts.
+    int readCount(int itemsize);
+
+    /// record a new object, so that later back-references can find it.
+    /// Must be called before reading any values the object holds.
+    void added(Value *v);
+
+    /// throw ex$corrupt, giving the position in the data
+    void fail(const char *msg);
+
+private:
+    const char *start,*p,*end;
+    /// the types read so far, in the order they appeared
+    ArrayList<const Type *> types;
+    /// the objects read so far, in the order they were written
+    ArrayList<Value> objects;
+    int depth;
+};
+
+}
+#endif /* __ANGORTSERIALISE_H */
@@ -18,6 +18,7 @@ typedef void (*BinopFunction)(class Runtime *a,Value *lhs, Value *rhs);
 
 #define TF_ITERABLE 1
 #define TF_NUMBER 2
+#define TF_NUMVEC 4 //!< a packed numeric vector (see NumVecTypeBase)
 
 /// Each Value has a pointer to one of these, which exist as a set of
 /// singletons describing each type's allocation behaviour etc.
@@ -232,6 +233,12 @@ public:
     virtual int getCount(Value *coll)const{
         throw RUNT(EX_NOTCOLL,"cannot get count of non-collection");
     }
+    /// get the number of items iterating over a value will give, if
+    /// that's cheap to find out, or -1; used to presize lists built
+    /// from iterables.
+    virtual int getSizeHint(Value *v)const{
+        return -1;
+    }
     virtual void removeAndReturn(Value *coll,Value *k,Value *result)const{
         throw RUNT(EX_NOTCOLL,"cannot remove from non-collection");
     }
@@ -285,18 +292,50 @@ public:
     virtual void increment(Value *v,int step) const {
         throw RUNT(EX_TYPE,"cannot increment/decrement this type of value");
     }
-    
+
+    /// write the value's data (but not its type, which the serialiser
+    /// has already written) - see serialise.h. Types which plugins add
+    /// can be serialised by overriding this and deserialise().
+    /// The default throws ex$notsup.
+    virtual void serialise(class Serialiser *s,Value *v)const;
+
+    /// read data written by serialise() into a new value. Types whose
+    /// values hold other values must call Deserialiser::added() on the
+    /// new value before reading them.
+    virtual void deserialise(class Deserialiser *d,Value *out)const;
+
 };
 
 /// this is the start of a BlockAllocType piece of data.
 struct BlockAllocHeader {
-    unsigned short refct;
+    /// 32 bits, because every view of a string holds a reference
+    /// to it, and a string can be split into a great many pieces
+    uint32_t refct;
+    unsigned short flags; //!< BAH_ flags
+    /// details of the data cached by strings (see StringType). The
+    /// data is written after it is allocated, so these are only worked
+    /// out when first needed; -1 means not known yet.
+    int bytes; //!< length in bytes, not including the terminator
+    int chars; //!< number of UTF-8 code points
+    /// byte offsets of every STRING_INDEX_STEP'th code point, built
+    /// for long strings which aren't all ASCII; NULL if not built.
+    int *index;
+    /// the first of the views of this string (see StrViewType), which
+    /// get their own copy of it before it is changed; NULL if none.
+    BlockAllocHeader *views;
     // actual data follows
 };
 
+/// the block's data is a file mapped into memory, rather than part of
+/// the same allocation - see BlockAllocType::mapFile.
+#define BAH_MAPPED 1
+
+/// a block whose reference count reaches this is never freed
+#define BAH_MAXREF 0xffffffffU
+
 
 /// this is for values where the s field is a pointer to a block of
-/// memory which consists of a 16bit refcount followed by the data itself
+/// memory which consists of a header (with a refcount) followed by the data itself
 
 class BlockAllocType : public Type {
 public:
@@ -311,11 +350,18 @@ public:
     virtual void decRef(Value *v)const;
     
     
-    /// allocate a block of memory plus 16 bits for refcount, 
+    /// allocate a block of memory plus the header, 
     /// setting the refcount to 1, setting v.s to the start of the whole block,
     /// returning a pointer to just after the header.
     /// Also clears the value type and sets the new type.
     char *allocate(Value *v,int len,const Type *t)const;
+    /// map len bytes of an open file into memory, read-only, and
+    /// return a block with a refcount of 1 whose data is the file.
+    /// The header goes at the end of an extra page just before the
+    /// mapping, so the data follows it as usual, but the block has
+    /// no terminator and must not be written to. Returns NULL if the
+    /// file can't be mapped.
+    static BlockAllocHeader *mapFile(int fd,int len);
     /// return a pointer to the allocated data (AFTER the header)
     const char *getData(const Value *v) const;
 };
@@ -365,6 +411,13 @@ public:
 #include "types/long.h"
 #include "types/double.h"
 #include "types/nsid.h"
+#include "types/numvec.h"
+#include "types/lazy.h"
+#include "types/persist.h"
+#include "types/omap.h"
+#include "types/strbuild.h"
+#include "types/strview.h"
+#include "types/file.h"
 
 
 namespace angort {
@@ -417,6 +470,31 @@ struct Types {
     static DoubleType *tDouble;
     /// the d.i value gives the namespace ID
     static NSIDType *tNSID;
+    /// v.gc is a NumVec<int>, a packed vector of 32-bit ints
+    static NumVecType<int> *tI32;
+    /// v.gc is a NumVec<long>, a packed vector of 64-bit ints
+    static NumVecType<long> *tI64;
+    /// v.gc is a NumVec<float>, a packed vector of floats
+    static NumVecType<float> *tF32;
+    /// v.gc is a NumVec<double>, a packed vector of doubles
+    static NumVecType<double> *tF64;
+    /// v.gc is a LazyObject, a stage in a lazy iterator pipeline
+    static LazyType *tLazy;
+    /// v.gc is a PVecObject, a persistent vector
+    static PVecType *tPVec;
+    /// v.gc is a PMapObject, a persistent map
+    static PMapType *tPMap;
+    /// v.gc is an OMapObject, an ordered map
+    static OMapType *tOMap;
+    /// v.gc is an OMapRangeObject, a range of keys in an ordered map
+    static OMapRangeType *tOMapRange;
+    /// v.gc is a StrBuildObject, a string builder
+    static StrBuildType *tStrBuild;
+    /// v.block is a BlockAllocHeader followed by StrViewData, a view
+    /// of part of a string
+    static StrViewType *tStrView;
+    /// v.gc is a FileObject, a buffered file
+    static FileType *tFile;
     
     
     
@@ -41,6 +41,8 @@ public:
     virtual double toDouble(const Value *v) const;
     virtual void toSelf(Value *out,const Value *v) const;
     virtual void increment(Value *v,int step) const;
+    virtual void serialise(class Serialiser *s,Value *v)const;
+    virtual void deserialise(class Deserialiser *d,Value *out)const;
 
     char formatString[64]; // used for toString()
 
@@ -0,0 +1,112 @@
+/**
+ * @file file.h
+ * @brief  Buffered files, for the file library.
+ *
+ * A file stream wraps a file descriptor with its own read and write
+ * buffers, so reading a line is a memchr over the buffer rather than a
+ * system call, and writes are only passed to the OS when the buffer
+ * fills or the file is flushed or closed (or Angort shuts down, when
+ * everything still open for writing is flushed). Iterating over a file stream
+ * gives the lines remaining in it, so "each" can process a file at
+ * about the speed it can be read.
+ */
+
+#ifndef __ANGORTFILE_H
+#define __ANGORTFILE_H
+
+namespace angort {
+
+/// the initial size of the read buffer (which grows to hold the
+/// longest line read) and the size of the write buffer
+#define FILE_BUFSIZE 65536
+
+struct FileObject : public GarbageCollected {
+    int fd; //!< the descriptor, or -1 once closed
+    bool canRead,canWrite;
+    bool ownsFD; //!< close the descriptor when done (not for stdin)
+    bool eof; //!< the last read hit the end of the file
+
+    char *rbuf; //!< read buffer
+    int rcap; //!< its size
+    int rpos,rlen; //!< the unread data is from rpos up to rlen
+
+    char *wbuf; //!< write buffer, allocated when first needed
+    int wlen; //!< bytes waiting to be written
+    
+    /// the list of files open for writing, so they can be flushed at
+    /// shutdown
+    FileObject *prevWriter,*nextWriter;
+
+    FileObject(int fd,bool r,bool w,bool owns);
+    ~FileObject();
+
+    /// flush and close, which does nothing if already closed
+    void close();
+    /// write out the write buffer
+    void flush();
+    /// flush every file still open for writing, as is done when
+    /// Angort shuts down
+    static void flushAll();
+
+    /// read a line, without its newline, into out; false at the end
+    /// of the file.
+    bool readLine(class Value *out);
+    /// as readLine, but set line and len to the line in the read
+    /// buffer, which is only valid until the next read.
+    bool nextLine(const char **line,int *len);
+    /// read up to n bytes into out as a string; false at the end of
+    /// the file.
+    bool readBytes(class Value *out,int n);
+    /// write some bytes, through the buffer
+    void write(const char *s,int n);
+    /// true if there's nothing more to read, which may mean reading
+    /// to find out
+    bool atEOF();
+
+    /// iterates over the lines left in the file
+    virtual Iterator<class Value *> *makeValueIterator()const;
+    virtual Iterator<class Value *> *makeKeyIterator()const{
+        return makeValueIterator();
+    }
+
+    /// the lines aren't values held by the file, so there's nothing
+    /// for the cycle detector
+    virtual Iterator<class Value *> *makeGCValueIterator(){
+        return NULL;
+    }
+    virtual Iterator<class Value *> *makeGCKeyIterator(){
+        return NULL;
+    }
+private:
+    /// throw unless the file is open and can do this
+    void check(bool ok,const char *what);
+    /// read more data into the read buffer, growing it if it's full;
+    /// sets eof if there's no more.
+    void fill();
+    /// drop any buffered read data before writing, moving the file
+    /// position back to where the reader had got to
+    void dropReadBuffer();
+};
+
+class FileType : public GCType {
+public:
+    FileType(){
+        // "file" is the IO plugin's type
+        add("filestream","FSTR");
+        flags |= TF_ITERABLE;
+    }
+
+    /// get the file, throwing if it's not one
+    FileObject *get(Value *v)const;
+    /// set a value to a new file stream on a descriptor
+    FileObject *set(Value *v,int fd,bool r,bool w,bool owns=true)const;
+
+    /// set out to the whole of a file, which is mapped into memory
+    /// rather than read if it's big enough to be worth it (see
+    /// BlockAllocType::mapFile). The result is a string view, so
+    /// substrings and split pieces of it aren't copies either.
+    void readFile(Value *out,const char *path)const;
+};
+
+}
+#endif /* __ANGORTFILE_H */
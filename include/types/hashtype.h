@@ -47,6 +47,7 @@ public:
     virtual void setValue(Value *coll,Value *k,Value *v)const;
     virtual void getValue(Value *coll,Value *k,Value *result)const;
     virtual int getCount(Value *coll)const;
+    virtual int getSizeHint(Value *v)const{ return getCount(v); }
     virtual int getIndexOfContainedItem(Value *v,Value *item)const;
     virtual bool contains(Value *v,Value *item) const;
     virtual void removeAndReturn(Value *coll,Value *k,Value *result)const;
@@ -54,6 +55,8 @@ public:
         throw RUNT("ex$nocol","cannot get slice of hash");
     }
     virtual void clone(Value *out,const Value *in,bool deep=false)const;
+    virtual void serialise(class Serialiser *s,Value *v)const;
+    virtual void deserialise(class Deserialiser *d,Value *out)const;
     virtual class Lockable *getLockable(Value *v) const;
 };
 
@@ -40,6 +40,9 @@ public:
     virtual void increment(Value *v,int step) const;
 
     virtual Iterator<Value *> *makeValueIterator(Value *v)const;
+    virtual int getSizeHint(Value *v)const;
+    virtual void serialise(class Serialiser *s,Value *v)const;
+    virtual void deserialise(class Deserialiser *d,Value *out)const;
 
 protected:
     virtual const char *toString(bool *allocated,const Value *v) const ;
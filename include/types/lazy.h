@@ -0,0 +1,65 @@
+/**
+ * @file lazy.h
+ * @brief  Lazy iterator pipelines.
+ *
+ * A lazy value describes one stage of a pipeline - map, filter, take,
+ * drop, zip, chain or enumerate - over some other iterable, which may
+ * itself be lazy. Nothing is evaluated until the value is iterated over
+ * (by each, reduce, map, vec$tolist and so on), and then each item is
+ * pulled through all the stages in turn, so no intermediate lists are
+ * made. The same lazy value can be iterated over more than once.
+ */
+
+#ifndef __ANGORTLAZY_H
+#define __ANGORTLAZY_H
+
+namespace angort {
+
+/// the kinds of pipeline stage
+enum LazyKind {
+    LZ_MAP,LZ_FILTER,LZ_TAKE,LZ_DROP,LZ_ZIP,LZ_CHAIN,LZ_ENUMERATE
+};
+
+struct LazyObject : public GarbageCollected {
+    int kind; //!< a LazyKind
+    // these are pointers because Value isn't defined yet, as with
+    // IteratorObject.
+    Value *src; //!< the iterable this stage pulls from
+    Value *src2; //!< the second iterable, for zip and chain
+    Value *func; //!< the function, for map and filter
+    int n; //!< the count, for take and drop
+    
+    LazyObject();
+    ~LazyObject();
+    
+    /// iterates over the results of the pipeline
+    virtual Iterator<class Value *> *makeValueIterator()const;
+    /// the same as the value iterator
+    virtual Iterator<class Value *> *makeKeyIterator()const{
+        return makeValueIterator();
+    }
+    
+    /// for the cycle detector, iterate over the values we hold rather
+    /// than running the pipeline
+    virtual Iterator<class Value *> *makeGCValueIterator();
+    virtual Iterator<class Value *> *makeGCKeyIterator(){
+        return NULL;
+    }
+    virtual void wipeContents();
+};
+
+class LazyType : public GCType {
+public:
+    LazyType(){
+        add("lazy","LAZY");
+        flags |= TF_ITERABLE;
+    }
+    
+    /// create a new pipeline stage of a given kind over an iterable
+    /// (or two), throwing if they can't be iterated over, and return it
+    /// to be filled in.
+    LazyObject *set(Value *v,int kind,Value *src,Value *src2=NULL)const;
+};
+
+}
+#endif /* __LAZY_H */
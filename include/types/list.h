@@ -16,6 +16,8 @@ struct ListObject : public GarbageCollected {
     virtual void wipeContents();
     
     ListObject();
+    /// create with room for capacity items
+    ListObject(int capacity);
     ~ListObject();
 };
 
@@ -32,17 +34,23 @@ public:
     /// create a new list
     ArrayList<Value> *set(Value *v)const;
     
+    /// create a new list with room for at least capacity items
+    ArrayList<Value> *set(Value *v,int capacity)const;
+    
     /// set a value to an existing list
     void set(Value *v,ListObject *lo)const;
     
     virtual void setValue(Value *coll,Value *k,Value *v)const;
     virtual void getValue(Value *coll,Value *k,Value *result)const;
     virtual int getCount(Value *coll)const;
+    virtual int getSizeHint(Value *v)const{ return getCount(v); }
     virtual void removeAndReturn(Value *coll,Value *k,Value *result)const;
     virtual void slice(Value *out,Value *coll,int start,int len)const;
     virtual void slice_dep(Value *out,Value *coll,int start,int len)const;
     
     virtual void clone(Value *out,const Value *in,bool deep=false)const;
+    virtual void serialise(class Serialiser *s,Value *v)const;
+    virtual void deserialise(class Deserialiser *d,Value *out)const;
     virtual class Lockable *getLockable(Value *v) const { return get(v); }
     
 };
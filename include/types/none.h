@@ -22,6 +22,9 @@ public:
     virtual int toInt(const Value *v) const {
         return 0;
     }
+    /// none has no data
+    virtual void serialise(class Serialiser *s,Value *v)const{}
+    virtual void deserialise(class Deserialiser *d,Value *out)const;
 protected:
     virtual const char *toString(bool *allocated,const Value *v) const
     {
@@ -0,0 +1,93 @@
+/**
+ * @file numvec.h
+ * @brief  Packed vectors of native numbers: i32, i64, f32 and f64.
+ *
+ * These hold their items as a contiguous array of ints, longs, floats
+ * or doubles rather than as Values, so they take a fraction of the
+ * memory of a list and can be handed straight to numeric code. Items
+ * are converted to and from Values as they are read and written.
+ */
+
+#ifndef __ANGORTNUMVEC_H
+#define __ANGORTNUMVEC_H
+
+namespace angort {
+
+/// the GC object for a numeric vector
+template <class T> struct NumVec : public GarbageCollected {
+    ArrayList<T> list;
+
+    NumVec() : GarbageCollected("numvec"), list(32) {}
+
+    virtual Iterator<class Value *> *makeValueIterator()const;
+    virtual Iterator<class Value *> *makeKeyIterator()const;
+
+    /// there are no values inside, so nothing for the cycle detector
+    virtual Iterator<class Value *> *makeGCKeyIterator(){
+        return NULL;
+    }
+    virtual Iterator<class Value *> *makeGCValueIterator(){
+        return NULL;
+    }
+};
+
+/// the operations common to all numeric vector types, so that words
+/// can deal with them without knowing the item type. All these types
+/// have the TF_NUMVEC flag.
+class NumVecTypeBase : public GCType {
+public:
+    NumVecTypeBase(){
+        flags |= TF_ITERABLE|TF_NUMVEC;
+    }
+
+    /// make a new vector of this type from any iterable of numbers;
+    /// out and in may be the same value.
+    virtual void fromIterable(Value *out,Value *in)const=0;
+
+    /// make a new vector of this type, of n zeroes
+    virtual void create(Value *out,int n)const=0;
+
+    /// sort the vector in place
+    virtual void sort(Value *v,bool reverse)const=0;
+
+    /// get the nth item as a value, without locking or range checks
+    virtual void getItem(Value *coll,int n,Value *out)const=0;
+};
+
+template <class T> class NumVecType : public NumVecTypeBase {
+public:
+    NumVecType();
+
+    /// get this value's array, throwing if it's not of this type
+    ArrayList<T> *get(Value *v)const;
+
+    /// create a new, empty vector
+    ArrayList<T> *set(Value *v)const;
+
+    /// set a value to an existing vector
+    void set(Value *v,NumVec<T> *nv)const;
+
+    /// convert an item to a value of the corresponding numeric type
+    static void toValue(Value *out,T x);
+    /// convert a numeric value to an item
+    static T fromValue(Value *v);
+
+    virtual void setValue(Value *coll,Value *k,Value *v)const;
+    virtual void getValue(Value *coll,Value *k,Value *result)const;
+    virtual int getCount(Value *coll)const;
+    virtual int getSizeHint(Value *v)const{ return getCount(v); }
+    virtual void removeAndReturn(Value *coll,Value *k,Value *result)const;
+    virtual void slice(Value *out,Value *coll,int start,int end)const;
+    virtual void clone(Value *out,const Value *in,bool deep=false)const;
+    virtual void serialise(class Serialiser *s,Value *v)const;
+    virtual void deserialise(class Deserialiser *d,Value *out)const;
+    virtual class Lockable *getLockable(Value *v) const { return get(v); }
+
+    virtual void fromIterable(Value *out,Value *in)const;
+    virtual void create(Value *out,int n)const;
+    virtual void sort(Value *v,bool reverse)const;
+    virtual void getItem(Value *coll,int n,Value *out)const;
+};
+
+}
+#endif /* __NUMVEC_H */
@@ -0,0 +1,164 @@
+/**
+ * @file omap.h
+ * @brief  Ordered maps, held in B+ trees.
+ *
+ * An omap maps keys to values like a hash, but keeps the keys in order,
+ * using the same comparison as sort and cmp. The entries are held in
+ * the leaves of a B+ tree, which are linked so that iterating is just
+ * walking along them; the inner nodes hold a lower bound for the keys
+ * in each child, and every node knows how many entries are below it,
+ * so that finding the nth key, or how many keys are less than a given
+ * one, is O(log n) too.
+ *
+ * An omaprange is a view of the keys in an omap between two bounds,
+ * which doesn't copy anything; iterating over it starts at the first
+ * key in the range and stops at the end of it.
+ *
+ * The node types are defined in omap.cpp because Value isn't defined yet.
+ */
+
+#ifndef __ANGORTOMAP_H
+#define __ANGORTOMAP_H
+
+namespace angort {
+
+struct OMapNode;
+struct OMapLeaf;
+
+/// a place in an ordered map: an entry in a leaf, or the end if
+/// leaf is NULL.
+struct OMapPos {
+    OMapLeaf *leaf;
+    int pos;
+};
+
+struct OMapObject : public GarbageCollected {
+    OMapNode *root;
+    OMapLeaf *first; //!< the leftmost leaf, which is never removed
+    OMapLeaf *last; //!< the rightmost leaf
+    /// the number of iterations running over us, during which we
+    /// can't be changed.
+    int locks;
+    /// locked while the tree is read or changed; as with lists and
+    /// hashes this isn't the object's own lock, which guards the
+    /// reference count.
+    Lockable tree;
+
+    OMapObject();
+    ~OMapObject();
+
+    /// the number of entries
+    int count()const;
+    /// compare two keys, as cmp does, in the runtime running on
+    /// this thread
+    int compare(Value *a,Value *b)const;
+
+    /// return the value for a key, or NULL
+    Value *find(Value *k)const;
+    /// set a key to a value
+    void set(Value *k,Value *v);
+    /// remove a key, copying its value into out (if not NULL) and
+    /// returning false if it wasn't there.
+    bool del(Value *k,Value *out=NULL);
+
+    /// find the first entry whose key isn't less than k, returning
+    /// its index (i.e. the number of keys less than k).
+    int lowerBound(Value *k,OMapPos *p)const;
+    /// find the entry with a given index, returning false if out of range
+    bool select(int i,OMapPos *p)const;
+    /// the position of the first entry
+    OMapPos begin()const;
+    /// move to the next or previous entry
+    void next(OMapPos *p)const;
+    void prev(OMapPos *p)const;
+    /// the key or value at a position, which must not be the end
+    Value *keyAt(const OMapPos &p)const;
+    Value *valAt(const OMapPos &p)const;
+
+    /// iterate over all the keys or values
+    virtual Iterator<class Value *> *makeKeyIterator()const;
+    virtual Iterator<class Value *> *makeValueIterator()const;
+    /// iterate over the keys from lo up to (but not including) hi;
+    /// either bound can be NULL.
+    Iterator<class Value *> *makeRangeIterator(Value *lo,Value *hi)const;
+    virtual void wipeContents();
+
+private:
+    void checkUnlocked()const;
+    OMapNode *insert(OMapNode *node,Value *k,Value *v,bool *added);
+    bool remove(OMapNode *node,Value *k,Value *out);
+    void rebalance(struct OMapInner *in,int i);
+    void merge(struct OMapInner *in,int i);
+};
+
+/// a view of the keys in an omap between two bounds
+struct OMapRangeObject : public GarbageCollected {
+    Value *map;
+    Value *lo; //!< none if there's no lower bound
+    Value *hi; //!< none if there's no upper bound
+
+    OMapRangeObject();
+    ~OMapRangeObject();
+
+    virtual Iterator<class Value *> *makeKeyIterator()const;
+    virtual Iterator<class Value *> *makeValueIterator()const{
+        return makeKeyIterator();
+    }
+    /// for the cycle detector, iterate over the three values we hold
+    virtual Iterator<class Value *> *makeGCValueIterator();
+    virtual Iterator<class Value *> *makeGCKeyIterator(){
+        return NULL;
+    }
+    virtual void wipeContents();
+};
+
+class OMapType : public GCType {
+public:
+    OMapType(){
+        add("omap","OMAP");
+        flags |= TF_ITERABLE;
+    }
+
+    /// get the map, throwing if it's not one
+    OMapObject *get(Value *v)const;
+    /// set a value to a new, empty map
+    OMapObject *set(Value *v)const;
+
+    /// as with hashes, the default iterator is the key iterator
+    virtual Iterator<Value *> *makeIterator(Value *v) const{
+        return makeKeyIterator(v);
+    }
+
+    virtual void setValue(Value *coll,Value *k,Value *v)const;
+    virtual void getValue(Value *coll,Value *k,Value *result)const;
+    virtual int getCount(Value *coll)const;
+    virtual int getSizeHint(Value *v)const{ return getCount(v); }
+    /// the index is the key's place in the order
+    virtual int getIndexOfContainedItem(Value *v,Value *item)const;
+    virtual bool contains(Value *v,Value *item) const;
+    virtual void removeAndReturn(Value *coll,Value *k,Value *result)const;
+    virtual void clone(Value *out,const Value *in,bool deep=false)const;
+};
+
+class OMapRangeType : public GCType {
+public:
+    OMapRangeType(){
+        add("omaprange","OMRG");
+        flags |= TF_ITERABLE;
+    }
+
+    /// set a value to a new range over a map; the bounds can be none.
+    void set(Value *v,Value *map,Value *lo,Value *hi)const;
+
+    virtual Iterator<Value *> *makeIterator(Value *v) const{
+        return makeKeyIterator(v);
+    }
+    /// gets the value from the map, so that ival works
+    virtual void getValue(Value *coll,Value *k,Value *result)const;
+    virtual int getCount(Value *coll)const;
+    virtual int getSizeHint(Value *v)const{ return getCount(v); }
+    virtual bool contains(Value *v,Value *item) const;
+};
+
+}
+#endif /* __ANGORTOMAP_H */
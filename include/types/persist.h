@@ -0,0 +1,174 @@
+/**
+ * @file persist.h
+ * @brief  Persistent (immutable, structurally shared) vectors and maps.
+ *
+ * A pvec is a 32-way trie of leaves holding the items, with the last
+ * (up to) 32 items kept in a separate tail leaf so that pushing is
+ * usually just a copy of that. A pmap is a hash array mapped trie: each
+ * node has a 32-bit bitmap saying which of the 32 possible slots for
+ * the next 5 bits of the hash are present, and each slot is either a
+ * key/value pair or another node. Keys whose hashes are identical end
+ * up in collision nodes, which are just searched.
+ *
+ * Neither is ever changed once made. "Changing" one makes a new version
+ * which copies only the O(log n) nodes on the path to the change and
+ * shares all the others with the old version, so old versions stay
+ * valid and taking a snapshot is just copying the value. The nodes are
+ * reference counted separately from the garbage collector, and
+ * defined in persist.cpp because Value isn't defined yet.
+ */
+
+#ifndef __ANGORTPERSIST_H
+#define __ANGORTPERSIST_H
+
+namespace angort {
+
+/// the number of bits of index or hash used at each level
+#define PERSIST_BITS 5
+/// the number of children in each node
+#define PERSIST_WIDTH (1<<PERSIST_BITS)
+#define PERSIST_MASK (PERSIST_WIDTH-1)
+
+struct PVecLeaf;
+struct PVecBranch;
+struct PMapNode;
+
+struct PVecObject : public GarbageCollected {
+    int count; //!< number of items
+    int shift; //!< the number of index bits below the root
+    PVecBranch *root; //!< the trie, holding all the items before the tail
+    PVecLeaf *tail; //!< the last (up to) 32 items
+
+    /// create an empty vector
+    PVecObject();
+    /// create a vector from parts, taking over a reference to each node
+    PVecObject(int count,int shift,PVecBranch *root,PVecLeaf *tail);
+    ~PVecObject();
+
+    /// get an item, throwing if out of range
+    Value *get(int i)const;
+    /// return a new version with an item added at the end
+    PVecObject *push(Value *v)const;
+    /// return a new version with the last item removed
+    PVecObject *pop()const;
+    /// return a new version with an item replaced; i can be the
+    /// count, in which case it's a push.
+    PVecObject *set(int i,Value *v)const;
+    /// add an item to the end of a vector we've just made and
+    /// which nothing else can see yet, without making a new version.
+    void append(Value *v);
+
+    /// the leaf holding an item, or the tail
+    PVecLeaf *leafFor(int i)const;
+    /// the index of the first item in the tail
+    int tailOffset()const{
+        return count<PERSIST_WIDTH ? 0 : ((count-1)>>PERSIST_BITS)<<PERSIST_BITS;
+    }
+
+    virtual Iterator<class Value *> *makeValueIterator()const;
+    virtual Iterator<class Value *> *makeKeyIterator()const;
+
+    /// The nodes are shared between versions, so walking the values
+    /// in each version would count the same reference more than once.
+    /// Instead we don't show the cycle detector anything: values held
+    /// in persistent collections are always taken to be reachable,
+    /// and cycles through them aren't collected.
+    virtual Iterator<class Value *> *makeGCValueIterator(){
+        return NULL;
+    }
+    virtual Iterator<class Value *> *makeGCKeyIterator(){
+        return NULL;
+    }
+private:
+    /// make a new root which holds everything including the (full)
+    /// tail, setting the new shift
+    PVecBranch *rootWithTail(int *newshift)const;
+    PVecBranch *pushTail(int level,PVecBranch *parent,PVecLeaf *leaf)const;
+    PVecBranch *popTail(int level,PVecBranch *node)const;
+};
+
+struct PMapObject : public GarbageCollected {
+    int count; //!< number of keys
+    PMapNode *root; //!< NULL if there are no keys
+
+    /// create an empty map
+    PMapObject();
+    /// create a map from a root, taking over a reference to it
+    PMapObject(int count,PMapNode *root);
+    ~PMapObject();
+
+    /// return the value for a key, or NULL
+    Value *find(Value *k)const;
+    /// return a new version with a key set to a value
+    PMapObject *set(Value *k,Value *v)const;
+    /// return a new version without a key, or NULL if the key wasn't there
+    PMapObject *del(Value *k)const;
+    /// set a key in a map we've just made and which nothing else can
+    /// see yet, changing nodes which aren't shared rather than copying.
+    void put(Value *k,Value *v);
+
+    virtual Iterator<class Value *> *makeValueIterator()const;
+    virtual Iterator<class Value *> *makeKeyIterator()const;
+
+    /// see PVecObject
+    virtual Iterator<class Value *> *makeGCValueIterator(){
+        return NULL;
+    }
+    virtual Iterator<class Value *> *makeGCKeyIterator(){
+        return NULL;
+    }
+};
+
+class PVecType : public GCType {
+public:
+    PVecType(){
+        add("pvec","PVEC");
+        flags |= TF_ITERABLE;
+    }
+
+    /// get the vector, throwing if it's not one
+    PVecObject *get(Value *v)const;
+    /// set a value to a new, empty vector and return it
+    PVecObject *set(Value *v)const;
+    /// set a value to a vector
+    void set(Value *v,PVecObject *o)const;
+
+    virtual void setValue(Value *coll,Value *k,Value *v)const;
+    virtual void getValue(Value *coll,Value *k,Value *result)const;
+    virtual int getCount(Value *coll)const;
+    virtual int getSizeHint(Value *v)const{ return getCount(v); }
+    virtual void removeAndReturn(Value *coll,Value *k,Value *result)const;
+    virtual void clone(Value *out,const Value *in,bool deep=false)const;
+};
+
+class PMapType : public GCType {
+public:
+    PMapType(){
+        add("pmap","PMAP");
+        flags |= TF_ITERABLE;
+    }
+
+    /// get the map, throwing if it's not one
+    PMapObject *get(Value *v)const;
+    /// set a value to a new, empty map and return it
+    PMapObject *set(Value *v)const;
+    /// set a value to a map
+    void set(Value *v,PMapObject *o)const;
+
+    /// as with hashes, the default iterator is the key iterator
+    virtual Iterator<Value *> *makeIterator(Value *v) const{
+        return makeKeyIterator(v);
+    }
+
+    virtual void setValue(Value *coll,Value *k,Value *v)const;
+    virtual void getValue(Value *coll,Value *k,Value *result)const;
+    virtual int getCount(Value *coll)const;
+    virtual int getSizeHint(Value *v)const{ return getCount(v); }
+    virtual int getIndexOfContainedItem(Value *v,Value *item)const;
+    virtual bool contains(Value *v,Value *item) const;
+    virtual void removeAndReturn(Value *coll,Value *k,Value *result)const;
+    virtual void clone(Value *out,const Value *in,bool deep=false)const;
+};
+
+}
+#endif /* __ANGORTPERSIST_H */
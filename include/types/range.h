@@ -20,6 +20,15 @@ template <class T> struct Range : public GarbageCollected {
         return makeValueIterator();
     }
     
+    /// a range holds no values, so there's nothing for the cycle
+    /// detector (which would otherwise step through every number)
+    virtual Iterator<class Value *> *makeGCKeyIterator(){
+        return NULL;
+    }
+    virtual Iterator<class Value *> *makeGCValueIterator(){
+        return NULL;
+    }
+    
 //    virtual ~Range(){
 //        printf("%lu Delete range at %p\n",pthread_self(),this);
 //    }
@@ -46,11 +55,14 @@ public:
     
     virtual int getIndexOfContainedItem(Value *v,Value *item)const;
     virtual bool contains(Value *v,Value *item) const;
+    virtual int getSizeHint(Value *v)const;
     
     /// are these two equal
     virtual bool equalForHashTable(Value *a,Value *b)const;
     
     virtual void clone(Value *out,const Value *in,bool deep=false)const;
+    virtual void serialise(class Serialiser *s,Value *v)const;
+    virtual void deserialise(class Deserialiser *d,Value *out)const;
 };
 
 }
@@ -0,0 +1,91 @@
+/**
+ * @file strbuild.h
+ * @brief  String builders, for making long strings a piece at a time.
+ *
+ * Adding strings together with + makes a new string and copies both
+ * sides into it, so building a string by adding to it in a loop is
+ * O(n^2). A string builder is a mutable buffer which grows by doubling,
+ * so appending to it is O(1) on average; once it's done, it can be
+ * turned into an ordinary string.
+ */
+
+#ifndef __ANGORTSTRBUILD_H
+#define __ANGORTSTRBUILD_H
+
+namespace angort {
+
+/// a growable, null-terminated character buffer, also used internally
+/// by words which build strings from many pieces.
+class StringBuilder {
+    char *buf;
+    int len,cap;
+    /// make sure there's room for n more bytes and the terminator
+    void reserve(int n);
+public:
+    StringBuilder(){
+        buf=NULL;
+        len=cap=0;
+    }
+    ~StringBuilder(){
+        free(buf);
+    }
+
+    void append(const char *s,int n);
+    void append(const char *s){
+        append(s,strlen(s));
+    }
+    /// append the string representation of a value
+    void append(const class Value *v);
+    /// empty the buffer, keeping the memory
+    void clear(){
+        len=0;
+        if(buf)*buf=0;
+    }
+
+    /// the contents, which are always null-terminated
+    const char *get()const{
+        return buf ? buf : "";
+    }
+    /// the length in bytes
+    int length()const{
+        return len;
+    }
+};
+
+/// the GC object for a string builder
+struct StrBuildObject : public GarbageCollected {
+    StringBuilder b;
+
+    StrBuildObject() : GarbageCollected("strbuild") {}
+
+    /// there are no values inside, so nothing for the cycle detector
+    virtual Iterator<class Value *> *makeGCKeyIterator(){
+        return NULL;
+    }
+    virtual Iterator<class Value *> *makeGCValueIterator(){
+        return NULL;
+    }
+};
+
+class StrBuildType : public GCType {
+public:
+    StrBuildType(){
+        add("strbuild","STRB");
+    }
+
+    /// get the builder, throwing if it's not one
+    StringBuilder *get(Value *v)const;
+    /// set a value to a new, empty builder
+    StringBuilder *set(Value *v)const;
+
+    /// the length in characters, as for strings
+    virtual int getCount(Value *coll)const;
+    /// a copy of the builder's contents is taken
+    virtual void clone(Value *out,const Value *in,bool deep=false)const;
+protected:
+    /// the contents, copied so that they survive further appends
+    virtual const char *toString(bool *allocated,const Value *v) const;
+};
+
+}
+#endif /* __ANGORTSTRBUILD_H */
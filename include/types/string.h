@@ -11,7 +11,21 @@
 
 namespace angort {
 
+/// long strings which aren't all ASCII get an index of the byte offset
+/// of every this-many code points, so finding a code point never
+/// means scanning more than this many of them.
+#define STRING_INDEX_STEP 64
+
+/// Strings are held as UTF-8. The header caches their length in bytes
+/// and in code points (and so whether they are all ASCII, when the two
+/// are the same), so that len, indexing and slicing don't need to scan
+/// the string or convert it to wide characters.
 class StringType : public BlockAllocType {
+protected:
+    /// for string views, which add themselves
+    StringType(bool){
+        makeStringable();
+    }
 public:
     StringType() {
         add("string","STRN");
@@ -30,8 +44,52 @@ public:
     // just allocate and return ptr to head (will add 1 for terminator)
     char *setAllocateOnly(Value *v,int len) const;
     
-    /// get length of string
+    /// true if the value is a string or a string view
+    static bool isString(const Value *v);
+    /// the bytes of a string or a string view, which are only
+    /// null-terminated for strings; use getByteLength for the length.
+    const char *getBytes(const Value *v)const;
+    /// get the bytes of any value as a string, converting it into
+    /// the buffer if it's not a string or a view; the length in bytes
+    /// is written to len.
+    const char *getBytes(const Value *v,int *len,class StringBuffer& sb)const;
+    
+    /// get length of string in code points (cached)
     virtual int getCount(Value *coll)const;
+    /// get length of string in bytes (cached)
+    int getByteLength(const Value *v)const;
+    /// true if all the characters are ASCII, so that code points
+    /// and bytes are the same thing
+    bool isASCII(const Value *v)const;
+    /// byte offset of the nth code point, which is clipped to the
+    /// range 0 to the number of code points.
+    int getByteOffset(const Value *v,int n)const;
+    /// set out to the code points from start up to (not including) end,
+    /// which must already be in range; out may be v. Long substrings
+    /// are views into the same data rather than copies (see strview.h).
+    void substring(Value *out,const Value *v,int start,int end)const;
+    /// as substring, but with byte offsets which must lie on
+    /// character boundaries; chars is the number of code points in
+    /// the result if known, or -1.
+    void substringBytes(Value *out,const Value *v,int so,int eo,int chars=-1)const;
+    /// return v if it's a string or a view, otherwise set tmp to v
+    /// converted to a string and return that.
+    Value *coerce(Value *v,Value *tmp)const;
+    
+    /// count the code points in some UTF-8 bytes, for strings which
+    /// aren't string values and so have nothing cached
+    static int countUTF8(const char *s,int bytes);
+    /// find the byte offset of the nth code point in some UTF-8 bytes,
+    /// or the length if there are fewer than n.
+    static int offsetUTF8(const char *s,int bytes,int n);
+    /// the number of bytes in the UTF-8 character at s, which
+    /// mustn't be the terminator
+    static int charBytesUTF8(const char *s){
+        int n=1;
+        while((s[n]&0xc0)==0x80)
+            n++;
+        return n;
+    }
     
     virtual float toFloat(const Value *v) const;
     virtual int toInt(const Value *v) const;
@@ -61,6 +119,9 @@ public:
     virtual void clone(Value *out,const Value *in,bool deep=false)const;
 
     virtual void toSelf(Value *out,const Value *v) const;
+    /// writes the bytes; views are read back as strings
+    virtual void serialise(class Serialiser *s,Value *v)const;
+    virtual void deserialise(class Deserialiser *d,Value *out)const;
 protected:
     virtual const char *toString(bool *allocated,const Value *v) const;
 };
@@ -0,0 +1,97 @@
+/**
+ * @file strview.h
+ * @brief  String views, which are substrings sharing their parent's data.
+ *
+ * Taking a substring - with substr, slice, head, tail, split and so on -
+ * used to copy the characters into a new string. A string view instead
+ * refers to the block of the string it was taken from, with an offset
+ * and a length, and holds a reference to that block so it stays alive.
+ * Views behave as strings everywhere (and "type" says they are strings),
+ * but their data isn't null-terminated, so they are copied into a new
+ * string when something needs a C string. Note that even a small view
+ * keeps all of its parent alive; clone it to get an independent string.
+ *
+ * Strings can be changed in place with "set", but a substring taken
+ * earlier shouldn't change with them. Each string keeps a list of its
+ * views, and before it is first changed they are all moved onto a
+ * copy of its old contents.
+ */
+
+#ifndef __ANGORTSTRVIEW_H
+#define __ANGORTSTRVIEW_H
+
+namespace angort {
+
+/// substrings shorter than this many bytes are copied rather than
+/// made into views: the copy is no bigger than the view would be, and
+/// doesn't keep the parent string alive.
+#define STRVIEW_MIN 16
+
+/// the data in a string view's block, after the header. The header's
+/// bytes, chars and index fields are those of the view itself.
+struct StrViewData {
+    /// the block of the string this is a view of, which is never
+    /// itself a view.
+    BlockAllocHeader *parent;
+    /// byte offset of the start of the view in the parent's data
+    int offset;
+    /// the blocks of the views before and after this one in the
+    /// parent's list of views
+    BlockAllocHeader *prev,*next;
+};
+
+/// get the data of a view from its block
+inline StrViewData *getStrViewData(BlockAllocHeader *h){
+    return (StrViewData *)(h+1);
+}
+
+class StrViewType : public StringType {
+public:
+    StrViewType() : StringType(true) {
+        add("strview","STRV");
+    }
+
+    /// set out to a view of the given bytes of a string's block,
+    /// taking a reference to it; chars is the number of code points
+    /// or -1 if not known.
+    void set(Value *out,BlockAllocHeader *parent,int offset,int len,int chars)const;
+    /// get the view's data, which isn't null-terminated
+    const char *getBytes(const Value *v)const{
+        const StrViewData *d = (const StrViewData *)getData(v);
+        return (const char *)(d->parent+1)+d->offset;
+    }
+    /// the block of the string this is a view of
+    BlockAllocHeader *getParent(const Value *v)const{
+        return ((const StrViewData *)getData(v))->parent;
+    }
+    /// the offset of the view in that string
+    int getOffset(const Value *v)const{
+        return ((const StrViewData *)getData(v))->offset;
+    }
+
+    /// also releases the parent when the view goes
+    virtual void decRef(Value *v)const;
+    
+    /// move all the views of a string onto a new copy of its data,
+    /// which has the given length, so it can be changed without
+    /// changing them.
+    void detach(BlockAllocHeader *parent,int bytes)const;
+
+    virtual float toFloat(const Value *v) const;
+    virtual int toInt(const Value *v) const;
+    virtual long toLong(const Value *v) const;
+    virtual double toDouble(const Value *v) const;
+
+    /// views can't be changed, because that would change the parent
+    virtual void setValue(Value *coll,Value *k,Value *v)const{
+        throw RUNT(EX_TYPE,"cannot change a string view - clone it first");
+    }
+    /// makes an ordinary string with a copy of the data
+    virtual void clone(Value *out,const Value *in,bool deep=false)const;
+protected:
+    /// copies the data, to add the terminator
+    virtual const char *toString(bool *allocated,const Value *v) const;
+};
+
+}
+#endif /* __ANGORTSTRVIEW_H */
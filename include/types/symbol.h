@@ -45,6 +45,9 @@ public:
     /// are these two equal
     virtual bool equalForHashTable(Value *a,Value *b)const;
     virtual int toInt(const Value *v) const;
+    /// written as the name, since symbol IDs differ between runs
+    virtual void serialise(class Serialiser *s,Value *v)const;
+    virtual void deserialise(class Deserialiser *d,Value *out)const;
 protected:    
     virtual const char *toString(bool *allocated,const Value *v) const;
 };
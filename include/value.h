@@ -187,6 +187,16 @@ struct Value {
         
     }
     
+    /// move a value from another, leaving that one as NONE. No
+    /// reference counts change, since the reference itself moves.
+    /// The source must not be this value.
+    inline void move(Value *src){
+        clr();
+        t = src->t;
+        v = src->v;
+        src->t = Types::tNone;
+    }
+    
     /// copy of a type but this time a true copy, rather than a copy
     /// of the reference. Compare copy().
     void clone(const Value *src){
@@ -201,9 +211,12 @@ struct Value {
     /// are these two equal (considered as keys for hashes?)
     bool equalForHashTable(Value *other){
         if(t != other->t)
-            return false;
+            return equalStringAndView(other);
         return t->equalForHashTable(this,other);
     }
+    /// values of different types are never equal as keys, except
+    /// that a string and a string view can be.
+    bool equalStringAndView(Value *other);
     
     /// debugging method - dump a value to string stream (but I'm
     /// not using stringstream), using the string
@@ -21,10 +21,13 @@
 #include <stdio.h>
 #include <ctype.h>
 #include <time.h>
+#include <wchar.h>
+#include <limits.h>
 
 #include "angort.h"
 #define DEFOPCODENAMES 1
 #include "opcodes.h"
+#include "profiler.h"
 #include "tokens.h"
 #include "hash.h"
 #include "cycle.h"
@@ -34,7 +37,7 @@
 #define CATCHALLKEY 0xdeadbeef
 
 extern angort::LibraryDef LIBNAME(coll),LIBNAME(string),LIBNAME(std),
-LIBNAME(math),LIBNAME(env),LIBNAME(future),LIBNAME(deprecated);
+LIBNAME(math),LIBNAME(env),LIBNAME(prof),LIBNAME(vec),LIBNAME(stat),LIBNAME(lazy),LIBNAME(persist),LIBNAME(omap),LIBNAME(sb),LIBNAME(file),LIBNAME(json),LIBNAME(ser),LIBNAME(future),LIBNAME(deprecated);
 
 
 #if ANGORT_POSIXLOCKS
@@ -66,6 +69,9 @@ Runtime::Runtime(Angort *angort,const char *_name){
     ip = NULL;
     traceOnException=true;
     outputStream = stdout;
+    outputMode = OUTPUT_FULL;
+    outputBufSize = -1;
+    redirBuf = NULL;
     debuggerNextIP=false;
     debuggerStepping=false;
     rstack.setName("return");
@@ -78,6 +84,7 @@ Runtime::Runtime(Angort *angort,const char *_name){
     assertNegated=false;
     loopIterCt=0;
     autoCycleCount = AUTOGCINTERVAL;
+    profTick=0;
     
     long t;
     time(&t);
@@ -88,6 +95,26 @@ Runtime::~Runtime(){
     endredir();
 }
 
+/// the runtime which is running code on this thread
+static __thread Runtime *currentRuntime=NULL;
+
+Runtime *Runtime::getCurrent(){
+    return currentRuntime;
+}
+
+/// makes a runtime the thread's current one for the life of a run(),
+/// putting back the previous one when it goes.
+struct CurrentRuntime {
+    Runtime *prev;
+    CurrentRuntime(Runtime *r){
+        prev = currentRuntime;
+        currentRuntime = r;
+    }
+    ~CurrentRuntime(){
+        currentRuntime = prev;
+    }
+};
+
 void Runtime::gc(){
     WriteLock lock = WL(&globalLock);
     GarbageCollected::gc();
@@ -141,6 +168,17 @@ Angort::Angort() {
     registerLibrary(&LIBNAME(thread),false);
 #endif    
     
+    registerLibrary(&LIBNAME(prof),false);
+    registerLibrary(&LIBNAME(vec),false);
+    registerLibrary(&LIBNAME(stat),false);
+    registerLibrary(&LIBNAME(lazy),false);
+    registerLibrary(&LIBNAME(persist),false);
+    registerLibrary(&LIBNAME(omap),false);
+    registerLibrary(&LIBNAME(sb),false);
+    registerLibrary(&LIBNAME(file),false);
+    registerLibrary(&LIBNAME(json),false);
+    registerLibrary(&LIBNAME(ser),false);
+    
     // future and deprecated are not imported
     registerLibrary(&LIBNAME(future),false);
     registerLibrary(&LIBNAME(deprecated),false);
@@ -227,7 +265,7 @@ void Angort::shutdown(){
 }
 
 void Runtime::showop(const Instruction *ip,int indent,const Instruction *base,
-                     const Instruction *curr){
+                     const Instruction *curr,const CodeBlock *cb){
     ReadLock lock(&ang->names);
     if(!base)base=wordbase;
     char buf[128],indentStr[32];
@@ -237,21 +275,15 @@ void Runtime::showop(const Instruction *ip,int indent,const Instruction *base,
         memset(indentStr,' ',indent);
     indentStr[indent]=0;
     
+    const SourcePos *sp = cb ? cb->getPos(ip) : getSourcePos(ip);
+    
     // print the start of the string
     printf("%s%s%s %3d %8p [%s:%d] : %04d : %s (%d) ",indentStr,
-#if SOURCEDATA
-           ip->brk ? "B " : "  ",
-#else
-           "  ",
-#endif
+           ang->isBreakpoint(ip) ? "B " : "  ",
            ip == curr ? "* " : "  ",
            id,
            base,
-#if SOURCEDATA
-           ip->file,ip->line,
-#else
-           "?",0,
-#endif
+           sp ? sp->file : "?",sp ? sp->line : 0,
            (int)(ip-base),
            opcodenames[ip->opcode],
            ip->opcode);
@@ -269,6 +301,7 @@ void Runtime::showop(const Instruction *ip,int indent,const Instruction *base,
         printf("(offset %d)",ip->d.i);
         break;
     case OP_GLOBALDO:
+    case OP_TAILGLOBALDO:
     case OP_GLOBALSET:
     case OP_GLOBALGET:
     case OP_GLOBALINC:
@@ -299,6 +332,14 @@ void Runtime::showop(const Instruction *ip,int indent,const Instruction *base,
     case OP_LITERALINT:
         printf("(%d)",ip->d.i);
         break;
+    case OP_LOCALBINOP:
+        printf("(%s idx %d, idx %d)",opcodenames[ip->d.reg.op],
+               ip->d.reg.a,ip->d.reg.b);
+        break;
+    case OP_LOCALLITBINOP:
+        printf("(%s idx %d, %d)",opcodenames[ip->d.reg.op],
+               ip->d.reg.a,ip->d.reg.b);
+        break;
     case OP_LITERALFLOAT:
         printf("(%f)",ip->d.f);
         break;
@@ -328,7 +369,6 @@ void Runtime::showop(const Instruction *ip,int indent,const Instruction *base,
 }
 
 const Instruction *Runtime::call(const Value *a,const Instruction *returnip){
-    const CodeBlock *cb;
     const Type *t;
     
     if(a->isNone())return returnip; // NONE does nothing when called
@@ -341,24 +381,24 @@ const Instruction *Runtime::call(const Value *a,const Instruction *returnip){
         return returnip;
     }
     
-    locals.push(); // switch to new locals frame
     // get the codeblock, check the type, and in
     // the case of a closure, bind the closed locals
     
-    Closure *clos;
-    if(t==Types::tCode){
-        clos = NULL;
-        cb = a->v.cb;
-    } else if(t == Types::tClosure){
-        clos = a->v.closure;
-        cb = clos->cb;
-    } else {
+    if(t==Types::tCode)
+        return callBlock(a->v.cb,NULL,returnip);
+    else if(t == Types::tClosure)
+        return callBlock(a->v.closure->cb,a->v.closure,returnip);
+    else
         throw RUNT(EX_NOTFUNC,"").set("attempt to 'call' something that isn't code, it's a %s",t->name);
-    }
-    
+}
+
+const Instruction *Runtime::callBlock(const CodeBlock *cb,Closure *clos,
+                                      const Instruction *returnip){
     if(!cb->ip)
         throw RUNT(EX_DEFCALL,"call to a word with a deferred definition");
     
+    locals.push(); // switch to new locals frame
+    
 #if DEBCLOSURES
     printf("Locals = %d of which closures = %d\n",cb->locals,cb->closureBlockSize);
     printf("Allocating %d stack spaces\n",cb->locals - cb->closureBlockSize);
@@ -366,63 +406,25 @@ const Instruction *Runtime::call(const Value *a,const Instruction *returnip){
     // allocate true locals (stack locals)
     locals.alloc(cb->locals - cb->closureBlockSize);
     
-    // now pop parameters, in reverse order, by
-    // peeking them and then dropping the whole
-    // lot in one go.
-    
-    uint8_t *pidx = cb->paramIndices;
-    
-    Value tmpval;
-    for(int i=0;i<cb->params;i++,pidx++){
-        Value *paramval = stack.peekptr((cb->params-1)-i);
-        
-        Type *tp = cb->paramTypes[i];
-        Value *valptr=paramval; // the value we'll actually store
-        if(tp){
-            if(tp == Types::tNumber || tp == Types::tStringStrict){
-                if(paramval->t->supertype != tp){
-                    throw RUNT(EX_BADPARAM,"").set("Type mismatch: argument %d is %s, expected a %s",
-                                                   i,paramval->t->name,tp->name);
-                }
-            } else if(tp != paramval->t){
-                // type check with possible conversion
-                try {
-                    tp->toSelf(&tmpval,paramval);
-                } catch(BadConversionException e){
-                    throw RUNT(EX_BADPARAM,"").set("Type mismatch: argument %d is %s, expected %s",
-                                                   i,paramval->t->name,tp->name);
-                }
-                valptr = &tmpval;
-            }
-        }                          
-        
-        
-        
-        if(cb->localsClosed & (1<<i)){
-            //                        printf("Param %d is closed: %s, into closure %d\n",i,paramval->toString().get(),*pidx);
-            clos->map[*pidx]->copy(valptr);
-        } else {
-            //                        printf("Param %d is open: %s, into local %d\n",i,paramval->toString().get(),*pidx);
-            locals.store(*pidx,valptr);
-        }
-    }
-    stack.drop(cb->params);
+    bindParams(cb,clos);
     //        if(clos)clos->show("VarStorePostParams");
     
     
     // do the push
     Frame *f = rstack.pushptr();
-    catchstack.pushptr()->clear();
     // This might be null, and in that case we ignore it when we pop it.
     f->ip = returnip;
     f->base = wordbase;
-    f->rec.copy(a); // and also stack the value itself
-    // stack the current level's closure
-    f->clos.copy(&currClosure);
+    f->cb = cb; // and also stack the codeblock itself
+    // stack the current level's closure, handing its reference
+    // over to the frame rather than copying it.
+    if(currClosure.t == Types::tClosure){
+        f->clos = currClosure.v.closure;
+        currClosure.t = Types::tNone;
+    } else
+        f->clos = NULL;
     if(clos)
         Types::tClosure->set(&currClosure,clos);
-    else
-        currClosure.clr();
     
 #if DEBCLOSURES
     printf("PUSHED closure %s\n",currClosure.toString().get());
@@ -443,11 +445,283 @@ const Instruction *Runtime::call(const Value *a,const Instruction *returnip){
     return ip;
 }
 
+void Runtime::bindParams(const CodeBlock *cb,Closure *clos){
+    if(cb->simpleParams){
+        // the common case - the parameters go straight into the
+        // first locals, so just move the lot across.
+        if(cb->params){
+            locals.moveIn(stack.peekptr(cb->params-1),cb->params);
+            stack.drop(cb->params);
+        }
+    } else {
+        // now pop parameters, in reverse order, by
+        // peeking them and then dropping the whole
+        // lot in one go.
+        
+        uint8_t *pidx = cb->paramIndices;
+        
+        Value tmpval;
+        for(int i=0;i<cb->params;i++,pidx++){
+            Value *paramval = stack.peekptr((cb->params-1)-i);
+            
+            Type *tp = cb->paramTypes[i];
+            Value *valptr=paramval; // the value we'll actually store
+            if(tp){
+                if(tp == Types::tNumber || tp == Types::tStringStrict){
+                    if(paramval->t->supertype != tp){
+                        throw RUNT(EX_BADPARAM,"").set("Type mismatch: argument %d is %s, expected a %s",
+                                                       i,paramval->t->name,tp->name);
+                    }
+                } else if(tp != paramval->t){
+                    // type check with possible conversion
+                    try {
+                        tp->toSelf(&tmpval,paramval);
+                    } catch(BadConversionException e){
+                        throw RUNT(EX_BADPARAM,"").set("Type mismatch: argument %d is %s, expected %s",
+                                                       i,paramval->t->name,tp->name);
+                    }
+                    valptr = &tmpval;
+                }
+            }                          
+            
+            if(cb->localsClosed & (1<<i)){
+                //                        printf("Param %d is closed: %s, into closure %d\n",i,paramval->toString().get(),*pidx);
+                clos->map[*pidx]->copy(valptr);
+            } else {
+                //                        printf("Param %d is open: %s, into local %d\n",i,paramval->toString().get(),*pidx);
+                locals.store(*pidx,valptr);
+            }
+        }
+        stack.drop(cb->params);
+    }
+}
+
+const Instruction *Runtime::tailCallBlock(const CodeBlock *cb,Closure *clos){
+    if(!cb->ip)
+        throw RUNT(EX_DEFCALL,"call to a word with a deferred definition");
+    
+    Frame *f = rstack.peekptr();
+    
+    // we're finished with the current function, so drop its
+    // loop iterators and handlers as ret() would
+    for(int i=0;i<loopIterCt;i++){
+        loopIterStack.popptr()->clr();
+    }
+    loopIterCt=0;
+    while(!catchstack.isempty() && catchstack.peekptr()->depth>=rstack.ct)
+        catchstack.drop(1);
+    
+    // reuse the locals block, and pop the parameters into it
+    locals.reuse();
+    locals.alloc(cb->locals - cb->closureBlockSize);
+    bindParams(cb,clos);
+    
+    // change the closure if it's not the one we're already running
+    // in (it will be for recursion).
+    if(!clos)
+        currClosure.clr();
+    else if(currClosure.t != Types::tClosure || currClosure.v.closure!=clos)
+        Types::tClosure->set(&currClosure,clos);
+    
+    // the return address, base and caller's closure all stay
+    // in the frame.
+    f->cb = cb;
+    
+    struct Instruction *ip;
+    if(clos && clos->ip)
+        ip=clos->ip;
+    else
+        ip = (Instruction *)cb->ip;
+    
+    wordbase = ip;
+    return ip;
+}
+
+void Frame::clear(){
+    if(clos && clos->decRefCt())
+        delete clos;
+    clos=NULL;
+    loopIterCt=0;
+}
+
+void LoopIter::start(Value *v){
+    clr();
+    iterable.copy(v);
+    idx=-1;
+    pos=0;
+    
+    const Type *t = v->t;
+    if(t==Types::tList){
+        kind=LI_LIST;
+        lock.lock(&v->v.list->list);
+        if(!v->v.list->list.count())
+            lock.unlock();
+    } else if(t==Types::tHash){
+        kind=LI_HASH;
+        Hash *h = v->v.hash->hash;
+        lock.lock(h);
+        h->locks++;
+        pos = h->nextUsed(0);
+        if(pos<0)
+            lock.unlock();
+    } else if(t==Types::tInteger){
+        // iterate from 0 to n-1, or down to n+1 if negative
+        kind=LI_IRANGE;
+        cur.i=0;
+        end.i=v->v.i;
+        step.i=end.i<0 ? -1 : 1;
+    } else if(t==Types::tIRange){
+        kind=LI_IRANGE;
+        cur.i=v->v.irange->start;
+        end.i=v->v.irange->end;
+        step.i=v->v.irange->step;
+    } else if(t==Types::tFRange){
+        kind=LI_FRANGE;
+        cur.f=v->v.frange->start;
+        end.f=v->v.frange->end;
+        step.f=v->v.frange->step;
+    } else if(StringType::isString(v)){
+        kind=LI_STRING;
+    } else if(t->flags & TF_NUMVEC){
+        kind=LI_NUMVEC;
+    } else {
+        // anything else (which may throw if it's not iterable)
+        t->createIterator(&obj,v);
+        kind=LI_OBJECT;
+    }
+}
+
+bool LoopIter::next(){
+    switch(kind){
+    case LI_LIST:{
+        ArrayList<Value> *list = &iterable.v.list->list;
+        if(pos>=list->count())
+            return false;
+        current.copy(list->get(pos++));
+        // like the list iterator, drop the lock after the last item
+        if(pos>=list->count())
+            lock.unlock();
+        break;
+    }
+    case LI_NUMVEC:{
+        // unlike lists, we only lock while fetching the item, so
+        // the vector can be written to inside the loop.
+        const NumVecTypeBase *t = (const NumVecTypeBase *)iterable.t;
+        ReadLock l(t->getLockable(&iterable));
+        if(pos>=t->getCount(&iterable))
+            return false;
+        t->getItem(&iterable,pos++,&current);
+        break;
+    }
+    case LI_HASH:{
+        if(pos<0)
+            return false;
+        Hash *h = iterable.v.hash->hash;
+        current.copy(h->keyAt(pos));
+        pos = h->nextUsed(pos+1);
+        if(pos<0)
+            lock.unlock();
+        break;
+    }
+    case LI_IRANGE:
+        if(step.i<0 ? cur.i<=end.i : cur.i>=end.i)
+            return false;
+        Types::tInteger->set(&current,cur.i);
+        cur.i+=step.i;
+        break;
+    case LI_FRANGE:
+        if(step.f<0 ? cur.f<=end.f : cur.f>=end.f)
+            return false;
+        Types::tFloat->set(&current,cur.f);
+        cur.f+=step.f;
+        break;
+    case LI_STRING:{
+        // step through the UTF-8 characters
+        // (views aren't null-terminated, so check the length)
+        if(pos>=Types::tString->getByteLength(&iterable))
+            return false;
+        const char *s = Types::tString->getBytes(&iterable)+pos;
+        int n = StringType::charBytesUTF8(s);
+        Types::tString->setwithlen(&current,s,n);
+        pos+=n;
+        break;
+    }
+    case LI_OBJECT:{
+        Iterator<Value *> *iter = obj.v.iter->iterator;
+        if(iter->isDone())
+            return false;
+        current.copy(iter->current());
+        iter->next();
+        break;
+    }
+    default:
+        return false;
+    }
+    idx++;
+    return true;
+}
+
+int LoopIter::index(){
+    // iterator objects have already moved on past the current item
+    if(kind==LI_OBJECT)
+        return obj.v.iter->iterator->index()-1;
+    return idx;
+}
+
+void LoopIter::clr(){
+    lock.unlock();
+    if(kind==LI_HASH)
+        iterable.v.hash->hash->locks--;
+    kind=LI_NONE;
+    iterable.clr();
+    current.clr();
+    obj.clr();
+}
+
 void CodeBlock::setFromContext(CompileContext *con){
-    ip = con->copyInstructions();
+    Instruction *code = con->copyInstructions();
     locals = con->getLocalCount();
     params = con->getParamCount();
     size = con->getCodeSize();
+    
+    // calls in tail position (just before the end) can reuse the
+    // current frame rather than pushing a new one.
+    for(int i=0;i<size-1;i++){
+        if(code[i+1].opcode == OP_END){
+            if(code[i].opcode == OP_RECURSE)
+                code[i].opcode = OP_TAILRECURSE;
+            else if(code[i].opcode == OP_GLOBALDO)
+                code[i].opcode = OP_TAILGLOBALDO;
+        }
+    }
+    
+    // binops whose operands are both locals, or a local and a small
+    // integer literal, get a register-form instruction which reads
+    // the operands in place. This goes in the slot of the first
+    // operand and skips the other two instructions, which are left
+    // alone so that anything jumping into the middle still works.
+    for(int i=0;i<size-2;i++){
+        Instruction *p = code+i;
+        if(p[0].opcode != OP_LOCALGET || !isBinopOpcode(p[2].opcode))
+            continue;
+        if(p[1].opcode == OP_LOCALGET)
+            p[0].opcode = OP_LOCALBINOP;
+        else if(p[1].opcode == OP_LITERALINT &&
+                p[1].d.i>=INT16_MIN && p[1].d.i<=INT16_MAX)
+            p[0].opcode = OP_LOCALLITBINOP;
+        else
+            continue;
+        int a = p[0].d.i;
+        p[0].d.reg.a = a;
+        p[0].d.reg.b = p[1].d.i;
+        p[0].d.reg.op = p[2].opcode;
+    }
+    ip = code;
+    
+#if SOURCEDATA
+    lines = con->copySourcePositions();
+#endif
+    
     closureTable = con->makeClosureTable(&closureTableSize);
     closureBlockSize = con->closureCt;
     localsClosed = con->localsClosed;
@@ -456,9 +730,12 @@ void CodeBlock::setFromContext(CompileContext *con){
     paramIndices = new uint8_t[params];
     paramTypes = new Type * [params];
     
+    simpleParams = true;
     for(int i=0;i<params;i++){
         paramIndices[i] = con->getLocalIndex(i);
         paramTypes[i] = con->getLocalType(i);
+        if(paramTypes[i] || (localsClosed & (1<<i)) || paramIndices[i]!=i)
+            simpleParams = false;
     }
     
     used=true;
@@ -500,23 +777,20 @@ void Runtime::ret()
     if(rstack.isempty()){
         ip=NULL;
     } else {
+        // discard any handlers left by returning from inside a try
+        while(!catchstack.isempty() && catchstack.peekptr()->depth>=rstack.ct)
+            catchstack.drop(1);
+        
         Frame *f = rstack.popptr();
-        catchstack.pop();
         ip = f->ip;
         wordbase = f->base;
-        f->rec.clr();
-        // copy the current closure back in
-        
-        //        printf("RETURNING. CurrClosure currently %s\n",
-        //               currClosure.toString().get());
-        
-        currClosure.copy(&f->clos);
-        
-        //        printf("           CurrClosure now       %s\n",
-        //               currClosure.toString().get());
-        
-        
-        f->clos.clr();
+        // release the current closure and take back the caller's
+        // from the frame
+        currClosure.clr();
+        if(f->clos){
+            currClosure.t = Types::tClosure;
+            currClosure.v.closure = f->clos;
+        }
         loopIterCt = f->loopIterCt;
         locals.pop();
     }
@@ -525,16 +799,14 @@ void Runtime::ret()
 bool Runtime::throwAngortException(int symbol, Value *data){
     storeTrace(); // store a trace to print if we need to
     
-    // we go up the exception stack, inner (intrafunction) stack
-    // first - if that doesn't find a handler, we pop the outer
-    // stack by performing a return.
+    // we go up the exception stack, looking at the handlers
+    // for the current frame first - if that doesn't find one,
+    // we pop the frame by performing a return.
     
     while(!rstack.isempty()){
-        // get the current intrafunction catch stack
-        Stack<IntKeyedHash<int>*,4> *cs = catchstack.peekptr();
-        // now go through it
-        while(!cs->isempty()){
-            IntKeyedHash<int> *h = cs->pop();
+        // go through the handlers which belong to this frame
+        while(!catchstack.isempty() && catchstack.peekptr()->depth==rstack.ct){
+            IntKeyedHash<int> *h = catchstack.popptr()->h;
             int *offset = h->ffind(symbol);
             if(offset){
                 // FOUND IT - deal with it and return, stacking
@@ -565,13 +837,13 @@ bool Runtime::throwAngortException(int symbol, Value *data){
 }
 
 void Runtime::run(const Instruction *startip){
+    CurrentRuntime current(this);
     ip=startip;
     
     Value *a, *b, *c;
+    Value lit; // literal operand for register-form binops
     wordbase = ip;
     const CodeBlock *cb;
-    // push initial catchstack
-    catchstack.pushptr()->clear();
     
     try {
         for(;;){
@@ -597,12 +869,15 @@ void Runtime::run(const Instruction *startip){
                     autoCycleCount = ang->autoCycleInterval;
                     gc();
                 }
-#if SOURCEDATA
-                // breakpoint set on instruction, invoke debugger. This somewhat
-                // clumsy logic is here because SOURCEDATA might conceivably be
-                // false.
-                if(ip->brk)debuggerNextIP=true;
-#endif  
+                // the profiler's timer has ticked, take a sample
+                if(Profiler::ticks != profTick){
+                    profTick = Profiler::ticks;
+                    profile();
+                }
+                // breakpoint set on instruction, invoke debugger. The
+                // count check keeps this cheap when there are none.
+                if(ang->breakpoints.count() && ang->isBreakpoint(ip))
+                    debuggerNextIP=true;
                 if(debuggerNextIP && ang->debuggerHook){
                     if(!debuggerStepping)
                         debuggerNextIP = false;
@@ -620,7 +895,22 @@ void Runtime::run(const Instruction *startip){
                     binop(a,b,opcode);
                     ip++;
                     break;
+                case OP_LOCALBINOP:
+                    // register form: both operands are locals, which
+                    // we don't need to copy onto the stack.
+                    binop(locals.get(ip->d.reg.a),locals.get(ip->d.reg.b),
+                          ip->d.reg.op);
+                    ip+=3; // skip the stack form
+                    break;
+                case OP_LOCALLITBINOP:
+                    Types::tInteger->set(&lit,ip->d.reg.b);
+                    binop(locals.get(ip->d.reg.a),&lit,ip->d.reg.op);
+                    ip+=3; // skip the stack form
+                    break;
                 case OP_NOP:
+                    // a NOP with nonzero data is a compiled breakpoint
+                    if(ip->d.i && ang->debuggerHook)
+                        (*ang->debuggerHook)(this);
                     ip++;
                     break;
                 case OP_INC:
@@ -742,6 +1032,7 @@ void Runtime::run(const Instruction *startip){
                     ip++;
                     break;
                 case OP_GLOBALDO:
+                case OP_TAILGLOBALDO:
                     {
                         ReadLock lock(&ang->names);
                         a = ang->names.getVal(ip->d.i);
@@ -774,8 +1065,17 @@ void Runtime::run(const Instruction *startip){
                                      */
                                 }
                             }
-                            // we call this value.
-                            ip = call(a,ip+1);
+                            // we call this value, reusing the frame if it's
+                            // a tail call into Angort code.
+                            if(ip->opcode == OP_TAILGLOBALDO && !rstack.isempty()){
+                                if(a->t == Types::tCode)
+                                    ip = tailCallBlock(a->v.cb,NULL);
+                                else if(a->t == Types::tClosure)
+                                    ip = tailCallBlock(a->v.closure->cb,a->v.closure);
+                                else
+                                    ip = call(a,ip+1);
+                            } else
+                                ip = call(a,ip+1);
                         } else if(a->t == Types::tNone) {
                             // if it's NONE we drop it
                             ip++;
@@ -804,12 +1104,23 @@ void Runtime::run(const Instruction *startip){
                     ip=call(popval(),ip+1); // this JUST CHANGES THE IP AND STACKS STUFF.
                     break;
                 case OP_SELF:
-                    stack.pushptr()->copy(&(rstack.peekptr()->rec));
+                    // if we're running a closure, that's us; otherwise
+                    // it's the frame's codeblock.
+                    if(currClosure.t == Types::tClosure)
+                        stack.pushptr()->copy(&currClosure);
+                    else
+                        Types::tCode->set(stack.pushptr(),rstack.peekptr()->cb);
                     ip++;
                     break;
                 case OP_RECURSE:
-                    a = &(rstack.peekptr()->rec);
-                    ip=call(a,ip+1);
+                    ip=callBlock(rstack.peekptr()->cb,
+                                 currClosure.t == Types::tClosure ?
+                                 currClosure.v.closure : NULL,ip+1);
+                    break;
+                case OP_TAILRECURSE:
+                    ip=tailCallBlock(rstack.peekptr()->cb,
+                                     currClosure.t == Types::tClosure ?
+                                     currClosure.v.closure : NULL);
                     break;
                 case OP_END:
                 case OP_STOP:
@@ -859,36 +1170,30 @@ void Runtime::run(const Instruction *startip){
                     break;
                 case OP_LOOPSTART:
                     // start of an infinite loop, so push a None iterator
-                    a = loopIterStack.pushptr();
+                    loopIterStack.pushptr()->clr();
                     loopIterCt++;
-                    a->clr();
                     ip++;
                     break;
                 case OP_ITERSTART:{
                     a = stack.popptr(); // the iterable object
-                    // we make an iterator and push it onto the iterator stack
-                    b = loopIterStack.pushptr();
+                    // we start an iterator on the iterator stack
+                    LoopIter *l = loopIterStack.pushptr();
                     loopIterCt++;
-                    a->t->createIterator(b,a);
+                    l->start(a);
                     ip++;
                     break;
                 }
                 case OP_ITERLEAVEIFDONE:{
-                    a = loopIterStack.peekptr(); // the iterator object
-                    Iterator<Value *> *iter = a->v.iter->iterator;
-                    if(iter->isDone()){
+                    // stash the next item away as the current, or
+                    // leave if there are none.
+                    if(!loopIterStack.peekptr()->next()){
                         // and pop the iterator off and clear it, for GC.
                         loopIterStack.popptr()->clr();
                         loopIterCt--;
                         // and jump out
                         ip += ip->d.i;
-                    } else {
-                        // stash the current away, we're about to change it
-                        // because we need to put the 'next' in here.
-                        a->v.iter->current->copy(iter->current());
-                        iter->next();
+                    } else
                         ip++;
-                    }
                     break;
                 }
                 case OP_NOT:
@@ -931,20 +1236,17 @@ void Runtime::run(const Instruction *startip){
                     locals.get(ip->d.i)->increment(-1);
                     ip++;
                     break;
-                case OP_DOT:{
-                    a = popval();
-                    const StringBuffer &sb = a->toString();
-                    fputs(sb.get(),outputStream);
-                    fputc('\n',outputStream);
-                }
+                case OP_DOT:
+                    print(popval(),true);
                     ip++;
                     break;
                 case OP_NEWLIST:
-                    Types::tList->set(pushval());
+                    // d.i is the number of items in the literal
+                    Types::tList->set(pushval(),ip->d.i);
                     ip++;
                     break;
                 case OP_NEWHASH:
-                    Types::tHash->set(pushval());
+                    Types::tHash->set(pushval())->reserve(ip->d.i);
                     ip++;
                     break;
                 case OP_HASHGETSYMB:
@@ -1015,12 +1317,16 @@ void Runtime::run(const Instruction *startip){
                     break;
                 case OP_TRY:
                     // make us ready to catch a throw
-                    catchstack.peekptr()->push(ip->d.catches);
+                    {
+                        CatchEntry *ce = catchstack.pushptr();
+                        ce->h = ip->d.catches;
+                        ce->depth = rstack.ct;
+                    }
                     ip++;
                     break;
                 case OP_ENDTRY:
                     // and pop the catches
-                    catchstack.peekptr()->pop();
+                    catchstack.drop(1);
                     ip++;
                     break;
                 case OP_THROW:
@@ -1030,21 +1336,36 @@ void Runtime::run(const Instruction *startip){
                     b = popval();
                     
                     if(!throwAngortException(a->v.i,b)){
-                        ReadLock lock(Types::tSymbol);
-                        // we couldn't find an Angort handler - print msg and reset IP
+                        // we couldn't find an Angort handler - print msg and reset IP.
+                        // Copy the symbol's name rather than holding the symbol
+                        // lock, because making the exception needs the write lock.
+                        char name[256];
+                        {
+                            ReadLock lock(Types::tSymbol);
+                            snprintf(name,sizeof(name),"%s",
+                                     Types::tSymbol->getString(a->v.i));
+                        }
                         const StringBuffer &sbuf = b->toString();
-                        printf("unhandled throw instruction: %s (%s)\n",
-                               Types::tSymbol->getString(a->v.i),sbuf.get());
+                        printf("unhandled throw instruction: %s (%s)\n",name,sbuf.get());
                         if(ip && ang->debuggerHook)(*ang->debuggerHook)(this);
                         ip=NULL;
                         throw RUNT(EX_UNHANDLED,"").set("Angort exception: %s (%s)\n",
-                                                        Types::tSymbol->getString(a->v.i),sbuf.get());
+                                                        name,sbuf.get());
                     }
                     break;
                 default:
                     throw RUNT(EX_BADOP,"unknown opcode");
                 }
             } catch(Exception e){
+                // note where it happened (if an inner run() hasn't)
+                // before the handler search unwinds the stack
+                if(ip && !e.srcFile){
+                    const SourcePos *sp = getSourcePos(ip);
+                    if(sp){
+                        e.srcFile = sp->file;
+                        e.srcLine = sp->line;
+                    }
+                }
                 Value vvv;
                 Types::tString->set(&vvv,e.what());
                 
@@ -1078,9 +1399,8 @@ void Runtime::run(const Instruction *startip){
         // set IP and runtime
         e.ip = ip;
         e.run = this;
-        // clear the catchstack, but push another empty entry on there
+        // clear the catchstack
         catchstack.clear();
-        catchstack.pushptr()->clear();
         // destroy any iterators left lying around
         while(!loopIterStack.isempty()){
             loopIterStack.popptr()->clr();
@@ -1090,13 +1410,13 @@ void Runtime::run(const Instruction *startip){
         locals.clear();
         // before we delete the rstack, print it
         printAndDeleteStoredTrace();
-        rstack.clear();
+        while(!rstack.isempty())
+            rstack.popptr()->clear();
         throw e; // and rethrow upstairs.
     }
     
 leaverun:
     ip=NULL;
-    catchstack.pop();
 }
 
 void Angort::startDefine(const char *name){
@@ -1265,6 +1585,8 @@ void CompileContext::reset(CompileContext *p,Tokeniser *tok){
     }
     leaveListHead = -1;
     cstack.clear();
+    literalStack.clear();
+    literalDepth=0;
 }
 
 ClosureTableEnt *CompileContext::makeClosureTable(int *count){
@@ -1316,7 +1638,7 @@ void CompileContext::convertOp(int oldlocalidx,int newlocalidx,int fromcode,int
     char buf[1024];
     Instruction *inst=compileBuf;
     for(int i=0;i<compileCt;i++,inst++){
-        cdprintf("   %s  %d",inst->getDetails(buf,1024),inst->d.i);
+        cdprintf("   %s  %d",inst->getDetails(buf,1024,LineTable::find(inst)),inst->d.i);
         if(inst->opcode == fromcode && inst->d.i == oldlocalidx){
             cdprintf("Rehashing to %d",newlocalidx);
             inst->opcode = tocode;
@@ -1398,7 +1720,7 @@ void CompileContext::convertToClosure(const char *name){
     cdprintf("Now decrementing local accesses in generated code");
     for(int i=0;i<compileCt;i++,inst++){
         char buf[1024];
-        cdprintf("scanning instruction   %s  %d",inst->getDetails(buf,1024),inst->d.i);
+        cdprintf("scanning instruction   %s  %d",inst->getDetails(buf,1024,LineTable::find(inst)),inst->d.i);
         if((
             inst->opcode == OP_LOCALGET || 
             inst->opcode == OP_LOCALINC || 
@@ -1976,11 +2298,7 @@ void Angort::feed(const char *buf){
             case T_GT:compile(OP_GT);break;
             case T_LE:compile(OP_LE);break;
             case T_GE:compile(OP_GE);break;
-#if SOURCEDATA
-            case T_BRK:compile(OP_NOP)->brk=true;break; // nop breakpoint
-#else
-            case T_BRK:compile(OP_NOP);break; // nop breakpoint
-#endif
+            case T_BRK:compile(OP_NOP)->d.i=1;break; // nop breakpoint
             case T_IDENT:
                 {
                     WriteLock lock=WL(&names);
@@ -2138,18 +2456,25 @@ void Angort::feed(const char *buf){
                 break;
             case T_OSQB: // create a new list or hash, depending on the next token
                 if(tok.getnext()==T_PERC) {
-                    compile(OP_NEWHASH);
+                    compile(OP_NEWHASH)->d.i=0;
                 } else {
                     tok.rewind();
-                    compile(OP_NEWLIST);
+                    compile(OP_NEWLIST)->d.i=0;
                 }
                 // if the next token is a close, just swallow it.
-                if(tok.getnext()!=T_CSQB)
+                if(tok.getnext()!=T_CSQB){
                     tok.rewind();
+                    context->startLiteral();
+                }
                 break;
             case T_CSQB:
+                compile(OP_APPENDLIST);
+                context->countLiteralItem();
+                context->endLiteral();
+                break;
             case T_COMMA:
                 compile(OP_APPENDLIST);
+                context->countLiteralItem();
                 break;
             case T_STOP:
                 compile(OP_STOP);
@@ -2325,7 +2650,6 @@ void Angort::feed(const char *buf){
 void Runtime::clearAtEOF(){
     while(!rstack.isempty()){
         rstack.popptr()->clear();
-        catchstack.pop();
     }
     // destroy any iterators left lying around
     while(!loopIterStack.isempty()){
@@ -2359,7 +2683,7 @@ void Angort::disasm(const CodeBlock *cb, int indent){
     const Instruction *base = ip;
     for(;;){
         int opcode = ip->opcode;
-        run->showop(ip++,indent,base);
+        run->showop(ip++,indent,base,NULL,cb);
         if(opcode != OP_END || indent==0)
             printf("\n");
         if(opcode == OP_END)break;
@@ -2377,16 +2701,70 @@ void Angort::disasm(const char *name){
     disasm(v->v.cb);
 }
 
-const char *Instruction::getDetails(char *buf,int len) const{
-#if SOURCEDATA
-    snprintf(buf,len,"[%s] %s:%d/%d",opcodenames[opcode],
-             file,line,pos);
-#else
-    snprintf(buf,len,"[%s]",opcodenames[opcode]);
-#endif
+const char *Instruction::getDetails(char *buf,int len,const SourcePos *sp) const{
+    if(sp)
+        snprintf(buf,len,"[%s] %s:%d/%d",opcodenames[opcode],
+                 sp->file,sp->line,sp->pos);
+    else
+        snprintf(buf,len,"[%s]",opcodenames[opcode]);
     return buf;
 }
 
+/// an entry in the line table registry
+struct LineTableEnt {
+    const Instruction *start;
+    int n;
+    const SourcePos *pos;
+};
+
+static Lockable lineTableLock("linetable");
+static ArrayList<LineTableEnt> *lineTables=NULL;
+
+void LineTable::add(const Instruction *start,int n,const SourcePos *pos){
+    WriteLock lock=WL(&lineTableLock);
+    if(!lineTables)
+        lineTables = new ArrayList<LineTableEnt>();
+    LineTableEnt *e = lineTables->append();
+    e->start = start;
+    e->n = n;
+    e->pos = pos;
+}
+
+void LineTable::remove(const Instruction *start){
+    WriteLock lock=WL(&lineTableLock);
+    if(!lineTables)return;
+    for(int i=0;i<lineTables->count();i++){
+        if(lineTables->get(i)->start == start){
+            lineTables->remove(i);
+            return;
+        }
+    }
+}
+
+const SourcePos *Runtime::getSourcePos(const Instruction *ip,int frame){
+    // the instruction is usually in the codeblock running in the
+    // frame, but it may be in one further down (or in immediate code
+    // run by a word like eval).
+    for(int i=frame;i<rstack.ct;i++){
+        const CodeBlock *cb = rstack.peekptr(i)->cb;
+        const SourcePos *sp = cb ? cb->getPos(ip) : NULL;
+        if(sp)
+            return sp;
+    }
+    return LineTable::find(ip);
+}
+
+const SourcePos *LineTable::find(const Instruction *ip){
+    ReadLock lock(&lineTableLock);
+    if(!lineTables)return NULL;
+    for(int i=0;i<lineTables->count();i++){
+        LineTableEnt *e = lineTables->get(i);
+        if(ip>=e->start && ip<e->start+e->n)
+            return e->pos+(ip-e->start);
+    }
+    return NULL;
+}
+
 const char *Angort::getSpec(const char *s){
     int idx = names.get(s);
     if(idx<0)
@@ -2398,15 +2776,20 @@ void Angort::list(){
     names.list();
 }
 
+void Runtime::profile(){
+    const CodeBlock *cbs[RSTACKSIZE];
+    for(int i=0;i<rstack.ct;i++)
+        cbs[i] = rstack.stack[i].cb;
+    Profiler::record(cbs,rstack.ct);
+}
+
 void Runtime::dumpFrame(){
     printf("Frame data:\n");
     printf("  Curclosure: %s\n",currClosure.toString().get());
     printf("  Ret stack:\n");
     for(int i=0;i<rstack.ct;i++){
         Frame *f = rstack.peekptr(i);
-        printf("   Rec:-%30s   Clos:%s\n",
-               f->rec.toString().get(),
-               f->clos.toString().get());
+        printf("   CB:-%30p   Clos:%p\n",f->cb,f->clos);
     }
     CycleDetector::getInstance()->dump();
 }
@@ -2520,15 +2903,16 @@ void Runtime::printTrace(){
     char buf[1024]; // buffer to write instruction details
     // first put the current frame on
     if(ip)
-        ip->getDetails(buf,1024);
+        ip->getDetails(buf,1024,getSourcePos(ip));
     else
         strcpy(buf,"unknown");
     printf("%s\n",buf);
     
     for(int i=0;i<rstack.ct;i++){
         Frame *p = rstack.peekptr(i);
+        // the return address is in the caller, the next frame down
         if(p->ip)
-            p->ip->getDetails(buf,1024);
+            p->ip->getDetails(buf,1024,getSourcePos(p->ip,i+1));
         else
             strcpy(buf,"unknown");
     }
@@ -2546,7 +2930,7 @@ void Runtime::storeTrace(){
     }
     // first put the current frame on
     if(ip)
-        ip->getDetails(buf,1024);
+        ip->getDetails(buf,1024,getSourcePos(ip));
     else
         strcpy(buf,"unknown");
     ptr = storedTrace.append();
@@ -2555,8 +2939,9 @@ void Runtime::storeTrace(){
     
     for(int i=0;i<rstack.ct;i++){
         Frame *p = rstack.peekptr(i);
+        // the return address is in the caller, the next frame down
         if(p->ip)
-            p->ip->getDetails(buf,1024);
+            p->ip->getDetails(buf,1024,getSourcePos(p->ip,i+1));
         else
             strcpy(buf,"unknown");
         ptr = storedTrace.append();
@@ -120,65 +120,73 @@ void Runtime::binop(Value *a,Value *b,int opcode){
         default:
             throw RUNT(EX_TYPE,"invalid operation with a list operand");
         }
-    } else if((at == Types::tString || at == Types::tSymbol) &&
+    } else if((StringType::isString(a) || at == Types::tSymbol) &&
               bt == Types::tInteger &&
               opcode == OP_MUL){
         /**
          * Special case for multiplying a string/symbol by a number
          */
-        const StringBuffer& p = a->toString();
+        StringBuffer sb;
+        int len;
+        const char *p = Types::tString->getBytes(a,&len,sb);
         
         int reps = b->toInt();
-        int len = strlen(p.get());
         Value t; // temp value
         // allocate a new result
         char *q = Types::tString->allocate(&t,len*reps+1,Types::tString);
         for(int i=0;i<reps;i++){
-            memcpy(q+i*len,p.get(),len);
+            memcpy(q+i*len,p,len);
         }
         q[len*reps]=0;
         stack.pushptr()->copy(&t);
-    } else if(at == Types::tString || bt == Types::tString){
+    } else if(StringType::isString(a) || StringType::isString(b)){
         /**
          * 
-         * One of the value is a string; coerce the other to a string and then
-         * perform a string operation.
+         * One of the value is a string (or a string view); coerce the other
+         * to a string and then perform a string operation. We work with
+         * the bytes and their lengths, so views don't need copying.
          *
          */
-        const StringBuffer& p = a->toString();
-        const StringBuffer& q = b->toString();
-        switch(opcode){
-        case OP_ADD:{
+        StringBuffer psb,qsb;
+        int plen,qlen;
+        const char *p = Types::tString->getBytes(a,&plen,psb);
+        const char *q = Types::tString->getBytes(b,&qlen,qsb);
+        if(opcode == OP_ADD){
             Value t; // we use a temp, otherwise allocate() will clear the type
-            int len = strlen(p.get())+strlen(q.get());
-            char *r = Types::tString->allocate(&t,len+1,Types::tString);
-            strcpy(r,p.get());
-            strcat(r,q.get());
+            char *r = Types::tString->allocate(&t,plen+qlen+1,Types::tString);
+            memcpy(r,p,plen);
+            memcpy(r+plen,q,qlen);
+            r[plen+qlen]=0;
+            t.v.block->bytes = plen+qlen;
             stack.pushptr()->copy(&t);
-            break;
-        }
-        case OP_EQUALS:
-            pushInt(!strcmp(p.get(),q.get()));
-            break;
-        case OP_NEQUALS:
-            pushInt(strcmp(p.get(),q.get()));
-            break;
-        case OP_GT:
-            pushInt(strcmp(p.get(),q.get())>0);
-            break;
-        case OP_LT:
-            pushInt(strcmp(p.get(),q.get())<0);
-            break;
-        case OP_GE:
-            pushInt(strcmp(p.get(),q.get())>=0);
-            break;
-        case OP_LE:
-            pushInt(strcmp(p.get(),q.get())<=0);
-            break;
-        case OP_CMP:
-            pushInt(strcmp(p.get(),q.get()));
-            break;
-        default:throw RUNT(EX_TYPE,"bad operation for strings");
+        } else {
+            // compare as strcmp would
+            int c = memcmp(p,q,plen<qlen ? plen : qlen);
+            if(!c)c = plen-qlen;
+            switch(opcode){
+            case OP_EQUALS:
+                pushInt(plen==qlen && !c);
+                break;
+            case OP_NEQUALS:
+                pushInt(c!=0);
+                break;
+            case OP_GT:
+                pushInt(c>0);
+                break;
+            case OP_LT:
+                pushInt(c<0);
+                break;
+            case OP_GE:
+                pushInt(c>=0);
+                break;
+            case OP_LE:
+                pushInt(c<=0);
+                break;
+            case OP_CMP:
+                pushInt(c);
+                break;
+            default:throw RUNT(EX_TYPE,"bad operation for strings");
+            }
         }
     }else if(at == Types::tDouble || bt == Types::tDouble){
         /**
@@ -1,251 +1,362 @@
 /**
  * @file
  * String formatting code.
- * Much of this code was adapted from Python's string formatting
- * code, but the actual formatting of individual items is done
- * by constructing printf formats and using them. Ugly, but easy.
- * There may be some dodgy assumptions about lengths here.
+ * The format string is compiled into a list of steps - runs of literal
+ * text and conversions with their flags, width and precision - which is
+ * kept in a small cache keyed by the format's contents, so a format used
+ * in a loop is only parsed once. Integers (and most %f conversions) are
+ * written straight into the output; %g, %e and the %f cases which can't
+ * be rounded exactly in double arithmetic use a printf format built when
+ * the format was compiled.
  */
 
 #include "angort.h"
 #include <ctype.h>
-#define max(a,b) ((a)>(b)?(a):(b))
+#include <math.h>
 
 namespace angort {
 
-static void formatSignedInt(char *s,int i,int width,int precision, bool zeropad, bool negpad){
-    char format[32];
-    sprintf(format,"%%%s%dd",zeropad?"0":"",negpad?-width:width);
-    sprintf(s,format,i);
-}
-
-static void formatUnsignedInt(char *s,unsigned int i,int width,int precision, bool zeropad, bool negpad){
-    char format[32];
-    sprintf(format,"%%%s%du",zeropad?"0":"",negpad?-width:width);
-    sprintf(s,format,i);
-}
-
-static void formatSignedLong(char *s,long i,int width,int precision, bool zeropad, bool negpad){
-    char format[32];
-    sprintf(format,"%%%s%dld",zeropad?"0":"",negpad?-width:width);
-    sprintf(s,format,i);
-}
-
-static void formatUnsignedLong(char *s,unsigned long i,int width,int precision, bool zeropad, bool negpad){
-    char format[32];
-    sprintf(format,"%%%s%dlu",zeropad?"0":"",negpad?-width:width);
-    sprintf(s,format,i);
-}
-
-static void formatHexInt(char *s,unsigned int i,int width,int precision, bool zeropad, bool negpad){
-    char format[32];
-    sprintf(format,"%%%s%dx",zeropad?"0":"",negpad?-width:width);
-    sprintf(s,format,i);
-}
-static void formatHexLong(char *s,unsigned long i,int width,int precision, bool zeropad, bool negpad){
-    char format[32];
-    sprintf(format,"%%%s%dlx",zeropad?"0":"",negpad?-width:width);
-    sprintf(s,format,i);
-}
+/// one step of a compiled format
+struct FormatOp {
+    /// the conversion character ('d','u','x','f','g','e','s' or 'c'),
+    /// or zero for literal text
+    char conv;
+    bool isLong,zeropad,negpad;
+    int width;
+    int precision; //!< -1 if none was given
+    int start,len; //!< for literal text, where it is in the format
+    char printfFormat[32]; //!< for conversions done by snprintf
+};
 
-static void formatFloat(char *s,double f,int width,int precision, bool zeropad, bool negpad){
-    char format[32];
-    if(precision!=-9999)
-        sprintf(format,"%%%s%d.%df",zeropad?"0":"",negpad?-width:width,precision);
-    else
-        sprintf(format,"%%%s%df",zeropad?"0":"",negpad?-width:width);
-    sprintf(s,format,f);
-}
-
-static void formatFloat2(char *s,double f,int width,int precision, bool zeropad, bool negpad){
-    char format[32];
-    if(precision!=-9999)
-        sprintf(format,"%%%s%d.%dg",zeropad?"0":"",negpad?-width:width,precision);
-    else
-        sprintf(format,"%%%s%dg",zeropad?"0":"",negpad?-width:width);
-    sprintf(s,format,f);
-}
-
-static void formatScientific(char *s,double f,int width,int precision, bool zeropad, bool negpad){
-    char format[32];
-    if(precision!=-9999)
-        sprintf(format,"%%%s%d.%de",zeropad?"0":"",negpad?-width:width,precision);
-    else
-        sprintf(format,"%%%s%de",zeropad?"0":"",negpad?-width:width);
-    sprintf(s,format,f);
-}
-
-static void formatString(char *s,const char *in,int width,int precision, bool negpad){
-    char format[32];
-    snprintf(format,20,"%%%ds",negpad?-width:width);
-    sprintf(s,format,in);
-}
+/// a format string compiled into steps
+struct CompiledFormat {
+    char *text; //!< a copy of the format, which literals point into
+    int len;
+    uint32_t hash;
+    FormatOp *ops;
+    int nops;
 
+    CompiledFormat(const char *s,int n,uint32_t h);
+    ~CompiledFormat(){
+        free(text);
+        free(ops);
+    }
+private:
+    FormatOp *addOp(){
+        ops = (FormatOp *)realloc(ops,sizeof(FormatOp)*(nops+1));
+        return ops+nops++;
+    }
+    void literal(int start,int n){
+        // extend the previous literal if this follows straight on
+        if(nops && !ops[nops-1].conv && ops[nops-1].start+ops[nops-1].len==start){
+            ops[nops-1].len+=n;
+            return;
+        }
+        FormatOp *op = addOp();
+        op->conv=0;
+        op->start=start;
+        op->len=n;
+    }
+};
 
+CompiledFormat::CompiledFormat(const char *s,int n,uint32_t h){
+    text = (char *)malloc(n+1);
+    memcpy(text,s,n);
+    text[n]=0;
+    len=n;
+    hash=h;
+    ops=NULL;
+    nops=0;
 
-void format(Value *out,Value *formatVal,ArrayList<Value> *items){
-    
-    // sorry, it actually has to be a string.
-    if(formatVal->t != Types::tString)
-        throw RUNT(EX_TYPE,"format must be a string");
-    
-    const char *format = Types::tString->getData(formatVal);
-    
-    ArrayListIterator<Value> iter(items);
-    ReadLock lock(items);
-    iter.first();
-    
-    unsigned int width,precision;
-    
-    // pass 1, work out the buffer size
-    int size=0;
-    int strsz;
-    for(const char *f = format;*f;f++){
-        precision=0;
-        width=0;
-        if(*f=='%'){
-            ++f;
-            if(*f=='-')f++;
-            while(isdigit(*f))
-                width = (width*10) + (*f++ - '0');
-            if(*f=='.'){
-                f++;
-                while(isdigit(*f))
-                    precision = (precision*10) + (*f++ - '0');
-            }
-            if((*f=='l' || *f=='z') && (f[1]=='d' || f[1]=='u' || f[1]=='x'))
-                ++f; // skip length flag (dealt with in pass 2)
-            switch(*f){
-            case 'c':
-                // fall through
-            case '%':
-                size++;
-                break;
-            case 'd':case 'u':case 'x':
-                // 50 should be plenty
-                iter.next();
-                size+=max(50,width);
-                break;
-            case 'f':
-            case 'g':
-            case 'e':
-                iter.next();
-                size+=50; // got to draw the line somewhere.
-                break;
-            case 's':{
-                const StringBuffer& b = iter.current()->toString();
-                strsz = max(strlen(b.get()),width);
-                size+=strsz;
-                iter.next();
-                break;
-            }
-            default://unknown code; throw.
-                throw RUNT(EX_BADPARAM,"").set("unknown format in format specification: %c",*f);
-            }
-        } else
-            size++;
-    }
-    
-    // now allocate a temporary buffer
-    char *base=(char *)malloc(size+2);
-    memset(base,0,size+1);
-    char *s = base;
-    
-    // pass 2 - do the formatting
-    iter.first();
-    for(const char *f = format;*f;f++){
-        if(*f=='%'){
+    try {
+        int litstart=0;
+        const char *f;
+        for(f=text;*f;f++){
+            if(*f!='%')
+                continue;
+            if(f>text+litstart)
+                literal(litstart,f-text-litstart);
             f++;
-            bool isLong=false;
-            bool zeropad=false;
-            bool negpad=false;
-            precision=-9999; // rogue value for "no precision"
-            width=0;
+            if(*f=='%'){
+                literal(f-text,1);
+                litstart=f-text+1;
+                continue;
+            }
+            FormatOp op;
+            op.isLong=op.zeropad=op.negpad=false;
+            op.width=0;
+            op.precision=-1;
             if(*f=='-'){
-                negpad=true;
+                op.negpad=true;
                 f++;
             }
             if(*f=='0')
-                zeropad=true;
+                op.zeropad=true;
             while(isdigit(*f))
-                width = (width*10) + (*f++ - '0');
+                op.width = (op.width*10) + (*f++ - '0');
             if(*f=='.'){
-                precision=0;
+                op.precision=0;
                 f++;
                 while(isdigit(*f))
-                    precision = (precision*10) + (*f++ - '0');
+                    op.precision = (op.precision*10) + (*f++ - '0');
             }
-            while(*f && *f!='%' && !isalpha(*f))
-                f++;
             // length flags
             if((*f=='l' || *f=='z') && (f[1]=='d' || f[1]=='u' || f[1]=='x')){
-                if(*f=='l')isLong=true;
+                if(*f=='l')op.isLong=true;
                 ++f;
             }
-            
             switch(*f){
-            case '%':
-                *s++ = '%';
-                break;
-            case 'c':
-                *s++ = iter.current()->toInt();
-                iter.next();
+            case 'd':case 'u':case 'x':case 'c':case 's':
                 break;
-            case 'd':
-                if(isLong)
-                    formatSignedLong(s,iter.current()->toLong(),width,precision,zeropad,negpad);
+            case 'f':case 'g':case 'e':
+                if(op.precision>=0)
+                    snprintf(op.printfFormat,sizeof(op.printfFormat),"%%%s%d.%d%c",
+                             op.zeropad?"0":"",op.negpad?-op.width:op.width,
+                             op.precision,*f);
                 else
-                    formatSignedInt(s,iter.current()->toInt(),width,precision,zeropad,negpad);
-                s+=strlen(s);
-                iter.next();
-                break;
-            case 'u':
-                if(isLong)
-                    formatUnsignedLong(s,iter.current()->toLong(),width,precision,zeropad,negpad);
-                else
-                    formatUnsignedInt(s,iter.current()->toInt(),width,precision,zeropad,negpad);
-                s+=strlen(s);
-                iter.next();
-                break;
-            case 'x':
-                if(isLong)
-                    formatHexInt(s,iter.current()->toInt(),width,precision,zeropad,negpad);
-                else
-                    formatHexLong(s,iter.current()->toInt(),width,precision,zeropad,negpad);
-                s+=strlen(s);
-                iter.next();
-                break;
-            case 'f':
-                formatFloat(s,iter.current()->toDouble(),width,precision,zeropad,negpad);
-                s+=strlen(s);
-                iter.next();
-                break;
-            case 'g':
-                formatFloat2(s,iter.current()->toDouble(),width,precision,zeropad,negpad);
-                s+=strlen(s);
-                iter.next();
-                break;
-            case 'e':
-                formatScientific(s,iter.current()->toDouble(),width,precision,zeropad,negpad);
-                s+=strlen(s);
-                iter.next();
-                break;
-            case 's':{
-                const StringBuffer& b = iter.current()->toString();
-                formatString(s,b.get(),width,precision,negpad);
-                s+=strlen(s);
-                iter.next();
+                    snprintf(op.printfFormat,sizeof(op.printfFormat),"%%%s%d%c",
+                             op.zeropad?"0":"",op.negpad?-op.width:op.width,*f);
                 break;
+            default://unknown code; throw.
+                throw RUNT(EX_BADPARAM,"").set("unknown format in format specification: %c",*f);
             }
-            default:
-                throw RUNT(EX_WTF,"unknown spec char in pass 2 of format - should have been caught in pass 1");
+            op.conv=*f;
+            *addOp() = op;
+            litstart=f-text+1;
+        }
+        if(f>text+litstart)
+            literal(litstart,f-text-litstart);
+    } catch(Exception& e){
+        free(text);
+        free(ops);
+        throw;
+    }
+}
+
+/// the number of formats cached; the cache is direct-mapped on
+/// the hash of the format.
+#define FORMAT_CACHE_SIZE 64
+
+/// the compiled format cache. Formats are rendered while holding the
+/// read lock, so an entry can't be replaced while it's in use.
+static struct FormatCache : public Lockable {
+    CompiledFormat *ents[FORMAT_CACHE_SIZE];
+    FormatCache() : Lockable("format cache") {
+        memset(ents,0,sizeof(ents));
+    }
+    ~FormatCache(){
+        for(int i=0;i<FORMAT_CACHE_SIZE;i++)
+            delete ents[i];
+    }
+} cache;
+
+static const char spaces[]="                                ";
+static const char zeroes[]="00000000000000000000000000000000";
+
+static void pad(StringBuilder& b,const char *with,int n){
+    while(n>0){
+        int k = n<32 ? n : 32;
+        b.append(with,k);
+        n-=k;
+    }
+}
+
+/// append the sign and digits of a number, padded to the width
+static void padded(StringBuilder& b,const FormatOp& op,bool neg,const char *digits,int n){
+    int padding = op.width-n-(neg?1:0);
+    if(padding<=0){
+        if(neg)b.append("-",1);
+        b.append(digits,n);
+    } else if(op.negpad){
+        if(neg)b.append("-",1);
+        b.append(digits,n);
+        pad(b,spaces,padding);
+    } else if(op.zeropad){
+        if(neg)b.append("-",1);
+        pad(b,zeroes,padding);
+        b.append(digits,n);
+    } else {
+        pad(b,spaces,padding);
+        if(neg)b.append("-",1);
+        b.append(digits,n);
+    }
+}
+
+/// write the digits of u in a base (10 or 16) to the end of a buffer,
+/// returning where they start
+static char *digits(char *end,unsigned long u,unsigned int base){
+    char *q = end;
+    do {
+        *--q = "0123456789abcdef"[u%base];
+        u/=base;
+    } while(u);
+    return q;
+}
+
+static void formatInt(StringBuilder& b,const FormatOp& op,unsigned long u,bool neg,int base){
+    char buf[24];
+    char *q = digits(buf+sizeof(buf),u,base);
+    padded(b,op,neg,q,buf+sizeof(buf)-q);
+}
+
+static const double dpow10[] = {
+    1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,
+    1e10,1e11,1e12,1e13,1e14,1e15,1e16,1e17
+};
+
+/// %f without snprintf: the value is scaled up by the precision and
+/// rounded to an integer. The multiplication is out by at most half a
+/// unit in the last place, so unless the fraction is that close to a
+/// half the rounding is the same as printf's; if it is, or the number
+/// is too big, return false so snprintf can do it.
+static bool formatFixed(StringBuilder& b,const FormatOp& op,double f){
+    int prec = op.precision<0 ? 6 : op.precision;
+    if(prec>17)
+        return false;
+    double scaled = fabs(f)*dpow10[prec];
+    if(!(scaled<9e15)) // also catches NaN and infinity
+        return false;
+    double fl = floor(scaled);
+    double frac = scaled-fl;
+    if(fabs(frac-0.5) <= scaled*2.3e-16)
+        return false;
+    unsigned long r = (unsigned long)fl + (frac>0.5 ? 1:0);
+
+    char buf[48];
+    char *end = buf+sizeof(buf);
+    char *q = end;
+    if(prec){
+        for(int i=0;i<prec;i++){
+            *--q = '0'+r%10;
+            r/=10;
+        }
+        *--q = '.';
+    }
+    q = digits(q,r,10);
+    padded(b,op,signbit(f),q,end-q);
+    return true;
+}
+
+static void formatPrintf(StringBuilder& b,const FormatOp& op,double f){
+    char buf[512];
+    int n = snprintf(buf,sizeof(buf),op.printfFormat,f);
+    if(n<(int)sizeof(buf))
+        b.append(buf,n);
+    else {
+        char *big = (char *)malloc(n+1);
+        snprintf(big,n+1,op.printfFormat,f);
+        b.append(big,n);
+        free(big);
+    }
+}
+
+static void render(StringBuilder& b,const CompiledFormat *cf,ArrayList<Value> *items){
+    int item=0;
+    for(int i=0;i<cf->nops;i++){
+        const FormatOp& op = cf->ops[i];
+        if(!op.conv){
+            b.append(cf->text+op.start,op.len);
+            continue;
+        }
+        Value *v = items->get(item++);
+        switch(op.conv){
+        case 'c':{
+            char c = v->toInt();
+            b.append(&c,1);
+            break;
+        }
+        case 'd':
+            if(op.isLong){
+                long l = v->toLong();
+                formatInt(b,op,l<0 ? -(unsigned long)l : l,l<0,10);
+            } else {
+                int n = v->toInt();
+                formatInt(b,op,n<0 ? -(unsigned long)n : n,n<0,10);
+            }
+            break;
+        case 'u':
+            if(op.isLong)
+                formatInt(b,op,(unsigned long)v->toLong(),false,10);
+            else
+                formatInt(b,op,(unsigned int)v->toInt(),false,10);
+            break;
+        case 'x':
+            if(op.isLong)
+                formatInt(b,op,(unsigned long)v->toLong(),false,16);
+            else
+                formatInt(b,op,(unsigned int)v->toInt(),false,16);
+            break;
+        case 'f':{
+            double f = v->toDouble();
+            if(!formatFixed(b,op,f))
+                formatPrintf(b,op,f);
+            break;
+        }
+        case 'g':case 'e':
+            formatPrintf(b,op,v->toDouble());
+            break;
+        case 's':{
+            // the width is in bytes, as it is for printf
+            if(StringType::isString(v)){
+                int n = Types::tString->getByteLength(v);
+                int padding = op.width-n;
+                if(padding>0 && !op.negpad)pad(b,spaces,padding);
+                b.append(Types::tString->getBytes(v),n);
+                if(padding>0 && op.negpad)pad(b,spaces,padding);
+            } else {
+                const StringBuffer& sb = v->toString();
+                int n = strlen(sb.get());
+                int padding = op.width-n;
+                if(padding>0 && !op.negpad)pad(b,spaces,padding);
+                b.append(sb.get(),n);
+                if(padding>0 && op.negpad)pad(b,spaces,padding);
             }
-        } else
-            *s++ = *f;
+            break;
+        }
+        default:
+            throw RUNT(EX_WTF,"unknown conversion in compiled format");
+        }
+    }
+}
+
+
+void format(Value *out,Value *formatVal,ArrayList<Value> *items){
+
+    if(!StringType::isString(formatVal))
+        throw RUNT(EX_TYPE,"format must be a string");
+
+    const char *fs = Types::tString->getBytes(formatVal);
+    int len = Types::tString->getByteLength(formatVal);
+    uint32_t hash = Types::tString->getHash(formatVal);
+    CompiledFormat **ent = cache.ents+(hash%FORMAT_CACHE_SIZE);
+
+    ReadLock lock(items);
+    StringBuilder b;
+    {
+        ReadLock cachelock(&cache);
+        CompiledFormat *cf = *ent;
+        if(cf && cf->hash==hash && cf->len==len && !memcmp(cf->text,fs,len)){
+            render(b,cf,items);
+            Types::tString->setwithlen(out,b.get(),b.length());
+            return;
+        }
+    }
+
+    // not in the cache; compile it and use it, then put it in the cache
+    // (replacing whatever was there) for next time.
+    CompiledFormat *cf = new CompiledFormat(fs,len,hash);
+    try {
+        render(b,cf,items);
+    } catch(Exception& e){
+        delete cf;
+        throw;
+    }
+    {
+        WriteLock cachelock=WL(&cache);
+        delete *ent;
+        *ent = cf;
     }
-    *s=0;
-    Types::tString->set(out,base);
-    free(base);
+    Types::tString->setwithlen(out,b.get(),b.length());
 }
 
 }
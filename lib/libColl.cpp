@@ -14,14 +14,6 @@ for some functions (such as head and tail) strings are collections.
 #include "hash.h"
 #include "opcodes.h"
 
-#include <wchar.h>
-#include <wctype.h>
-
-inline int wstrlen(const char *s){
-    return mbstowcs(NULL,s,0);
-}
-
-
 using namespace angort;
 
 namespace angort {
@@ -93,33 +85,16 @@ requested is 1. (See also "fst".) In the case of a string, returns the first n c
         }
         a->pushval()->copy(&r);
     } else {
-        const StringBuffer &b = p0->toString();
-        const char *strin = b.get();
+        Value tmp,r;
+        Value *s = Types::tString->coerce(p0,&tmp);
         
         if(p1<=0){
             a->pushString("");
             return;
         }
-        int len = wstrlen(strin);
-        
-        // this is how many chars we convert
-        p1 = p1<len ? p1 : len;
-        
-        // convert that many characters
-        wchar_t *s = (wchar_t *)alloca((p1+1)*sizeof(wchar_t));
-        int rv = mbstowcs(s,strin,p1+1);
-        if(rv<0){
-            a->pushNone();
-            return;
-        }
-        // terminate
-        s[p1]=0;
-        
-        // now convert back
-        int l2 = wcstombs(NULL,s,0)+1;
-        char *s2 = (char *)alloca(l2);
-        wcstombs(s2,s,l2);
-        a->pushString(s2);
+        int len = Types::tString->getCount(s);
+        Types::tString->substring(&r,s,0,p1<len ? p1 : len);
+        a->pushval()->copy(&r);
     }
 }
 
@@ -142,33 +117,15 @@ requested is 1. (See also "last".) In the case of a string, returns the last n c
         }
         a->pushval()->copy(&r);
     } else {
-        const StringBuffer &b = p0->toString();
-        const char *strin = b.get();
+        Value tmp,r;
+        Value *s = Types::tString->coerce(p0,&tmp);
         if(p1<=0){
             a->pushString("");
             return;
         }
-        int len = wstrlen(strin);
-        
-        // this is how many chars we convert
-        p1 = p1<len ? p1 : len;
-        
-        // we need to convert the entire string
-        wchar_t *s = (wchar_t *)alloca((len+1)*sizeof(wchar_t));
-        int rv = mbstowcs(s,strin,len+1);
-        if(rv<0){
-            a->pushNone();
-            return;
-        }
-        
-        // work out the start 
-        int start = len-p1;
-        
-        // now convert back
-        int l2 = wcstombs(NULL,s+start,0)+1;
-        char *s2 = (char *)alloca(l2);
-        wcstombs(s2,s+start,l2);
-        a->pushString(s2);
+        int len = Types::tString->getCount(s);
+        Types::tString->substring(&r,s,p1<len ? len-p1 : 0,len);
+        a->pushval()->copy(&r);
     }
 }
 
@@ -357,8 +314,11 @@ usage is "reverse explode" (but this is slow).
 %word gather (a b c d .. n -- [a,b,c,d]) turn N items on stack into a list
 {
     Value out;
-    ArrayList<Value> *outlist = Types::tList->set(&out);
     int n = a->popInt();
+    // make sure the items are there before making room for them
+    if(n>0)
+        a->stack.peekptr(n-1);
+    ArrayList<Value> *outlist = Types::tList->set(&out,n);
     
     for(int i=0;i<n;i++){
         Value *v = a->stack.peekptr((n-1)-i);
@@ -580,6 +540,70 @@ Adds an item to the end of a list.
 }
 
 
+%wordargs listcap i (n -- list) create an empty list with room for n items
+Appending up to n items to the list won't need it to be reallocated.
+{
+    Types::tList->set(a->pushval(),p0);
+}
+
+%wordargs hashcap i (n -- hash) create an empty hash with room for n keys
+Adding up to n keys to the hash won't need it to be resized.
+{
+    Types::tHash->set(a->pushval())->reserve(p0);
+}
+
+%wordargs extend vv (iterable list --) append all the items of an iterable to a list
+If the number of items is known (for lists, hashes, vectors and integer
+ranges) room is made for them all first.
+{
+    Value listv,in;
+    // hold references, because running a lazy pipeline can
+    // overwrite the stack
+    listv.copy(p1);
+    in.copy(p0);
+    ArrayList<Value> *list = Types::tList->get(&listv);
+    int n = in.t->getSizeHint(&in);
+    
+    if(in.t==Types::tList && Types::tList->get(&in)==list){
+        // extending a list with itself; there's no need to iterate.
+        WriteLock lock=WL(list);
+        n = list->count();
+        list->reserve(n*2);
+        for(int i=0;i<n;i++){
+            // there's room for them all, so append() won't move v
+            Value *v = list->get(i);
+            list->append()->copy(v);
+        }
+        return;
+    }
+    
+    Iterator<Value *> *iter = in.t->makeIterator(&in);
+    WriteLock lock=WL(list); // append() doesn't lock
+    if(n>0)
+        list->reserve(list->count()+n);
+    try {
+        for(iter->first();!iter->isDone();iter->next())
+            list->append()->copy(iter->current());
+    } catch(Exception& e){
+        delete iter;
+        throw;
+    }
+    delete iter;
+}
+
+%wordargs hashupdate hh (hash2 hash --) copy all the keys and values of one hash into another
+Existing keys in the second hash are overwritten. Room is made for all
+the new keys first.
+{
+    if(p0==p1)
+        return;
+    ReadLock lock0(p0);
+    WriteLock lock1=WL(p1);
+    p1->reserve(p1->count()+p0->count());
+    for(int i=p0->nextUsed(0);i>=0;i=p0->nextUsed(i+1))
+        p1->set(p0->keyAt(i),p0->valAt(i));
+}
+
 %wordargs map Ic (iter func -- list) apply a function to an iterable, giving a list
 For each item in the iterable (list, range  or hash) apply a function,
 creating a new list containing the results. In the case of hashes, the
@@ -588,8 +612,9 @@ hash key is passed to the function.
     Value func;
     func.copy(p1); // need a local copy
     
+    int n = p0->t->getSizeHint(p0);
     Iterator<Value *> *iter = p0->t->makeIterator(p0);
-    ArrayList<Value> *list = Types::tList->set(a->pushval());
+    ArrayList<Value> *list = Types::tList->set(a->pushval(),n);
     
     WriteLock lock=WL(list);
     
@@ -759,11 +784,17 @@ lists.
 
 %word sort (in --) sort a list in place using default comparator
 Reorders the list using a standard comparison, which will fail if
-the types of the items are not comparable.
+the types of the items are not comparable. Numeric vectors (i32 etc.)
+can also be sorted.
 {
     Value listv;
     // need copy because comparators use the stack
     listv.copy(a->popval());
+    if(listv.t->flags & TF_NUMVEC){
+        // numeric vectors sort themselves
+        ((NumVecTypeBase *)listv.t)->sort(&listv,false);
+        return;
+    }
     ArrayList<Value> *list = Types::tList->get(&listv);
     
     StdComparator cmp(a);
@@ -773,11 +804,17 @@ the types of the items are not comparable.
 
 %word rsort (in --) reverse sort a list in place using default comparator
 Reorders the list using a standard comparison, which will fail if
-the types of the items are not comparable.
+the types of the items are not comparable. Numeric vectors (i32 etc.)
+can also be sorted.
 {
     Value listv;
     // need copy because comparators use the stack
     listv.copy(a->popval());
+    if(listv.t->flags & TF_NUMVEC){
+        // numeric vectors sort themselves
+        ((NumVecTypeBase *)listv.t)->sort(&listv,true);
+        return;
+    }
     ArrayList<Value> *list = Types::tList->get(&listv);
     
     RevStdComparator cmp(a);
@@ -930,31 +967,19 @@ result. Thus, '[1,2,3] "," intercalate' will return "1,2,3".
     const char *sep = s.get();
     int seplen = strlen(sep);
     
-    int count = v->t->getCount(v);
-    
-    // first pass to get the lengths
-    int len=0;
-    int n=0;
-    for(n=0,iter->first();!iter->isDone();iter->next(),n++){
-        len += strlen(iter->current()->toString().get());
-        if(n!=count-1)
-            len += seplen;
-    }
-    
-    // allocate the result in a new string value on the stack
-    char *out = Types::tString->allocate(a->pushval(),len+1,Types::tString);
-    // second pass to write the value
-    *out = 0;
+    // build in one pass, so each item is only converted once
+    StringBuilder out;
+    int n;
     for(n=0,iter->first();!iter->isDone();iter->next(),n++){
-        const StringBuffer& b = iter->current()->toString();
-        strcpy(out,b.get());
-        out += strlen(b.get());
-        if(n!=count-1){
-            strcpy(out,sep);
-            out+=seplen;
-        }
+        if(n)
+            out.append(sep,seplen);
+        out.append(iter->current());
     }
     delete iter;
+    
+    Value t;
+    Types::tString->setwithlen(&t,out.get(),out.length());
+    a->pushval()->copy(&t);
 }
 
 
@@ -0,0 +1,140 @@
+#include "angort.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+%doc
+Buffered file input and output. A file stream reads and writes through
+its own buffers, so reading a line or writing a short string doesn't
+need a system call each time. Iterating over a file stream with each
+(or anything else which iterates) gives the lines left in it without
+their newlines, which is much faster than running a script with -n:
+
+    "log" "r" file$open each {i "ERROR" stridx isnone not if i. then}
+
+Streams still open for writing when Angort exits are flushed, but it's
+better to close them.
+
+file$readfile reads a whole file into a string; big files are mapped
+into memory rather than copied, so this is fast and doesn't use memory
+for the parts of the file which aren't looked at. The string is a view
+of the mapped file (see "String views"), as are its substrings and
+split pieces. Changing the file while it is mapped is a bad idea.
+%doc
+
+using namespace angort;
+
+%name file
+%shutdown
+{
+    // streams which were never closed would otherwise lose whatever
+    // is still in their buffers
+    FileObject::flushAll();
+}
+
+%wordargs open ss (path mode -- file) open a file
+The mode is "r" (read), "w" (write, emptying the file or creating it),
+"a" (append, creating the file if needed), or one of those followed
+by "+" to allow both reading and writing. On fail, throws ex$failed.
+{
+    int flags;
+    bool r,w;
+    switch(p1[0]){
+    case 'r':flags=0;r=true;w=false;break;
+    case 'w':flags=O_CREAT|O_TRUNC;r=false;w=true;break;
+    case 'a':flags=O_CREAT|O_APPEND;r=false;w=true;break;
+    default:
+        throw RUNT(EX_BADPARAM,"").set("bad file mode: %s",p1);
+    }
+    if(p1[1]=='+'){
+        r=w=true;
+        flags|=O_RDWR;
+    } else if(p1[1])
+        throw RUNT(EX_BADPARAM,"").set("bad file mode: %s",p1);
+    else
+        flags|=w?O_WRONLY:O_RDONLY;
+
+    int fd = open(p0,flags,0666);
+    if(fd<0)
+        throw RUNT(EX_FAILED,"").set("cannot open %s: %s",p0,strerror(errno));
+    Types::tFile->set(a->pushval(),fd,r,w);
+}
+
+%word stdin (-- file) a file stream reading the standard input
+Don't mix this with "read", which has its own buffer.
+{
+    Types::tFile->set(a->pushval(),0,true,false,false);
+}
+
+%wordargs close v (file --) flush and close a file
+Files are also closed when nothing refers to them any more, but errors
+can't be reported then.
+{
+    Types::tFile->get(p0)->close();
+}
+
+%wordargs flush v (file --) write out anything waiting in a file's buffer
+{
+    FileObject *f = Types::tFile->get(p0);
+    if(f->fd>=0)
+        f->flush();
+}
+
+%wordargs eof v (file -- bool) true if there is no more to read from a file
+{
+    a->pushInt(Types::tFile->get(p0)->atEOF()?1:0);
+}
+
+%wordargs readline v (file -- string|none) read a line from a file
+The newline is removed. At the end of the file, returns none.
+{
+    FileObject *f = Types::tFile->get(p0);
+    Value t;
+    if(f->readLine(&t))
+        a->pushval()->copy(&t);
+    else
+        a->pushNone();
+}
+
+%wordargs readbytes iv (n file -- string|none) read up to n bytes from a file
+Returns fewer than n bytes only at the end of the file, and none when
+there is nothing left at all.
+{
+    if(p0<0)
+        throw RUNT(EX_BADPARAM,"").set("cannot read %d bytes",p0);
+    FileObject *f = Types::tFile->get(p1);
+    Value t;
+    if(p0 && f->readBytes(&t,p0))
+        a->pushval()->copy(&t);
+    else
+        a->pushNone();
+}
+
+%wordargs write vv (val file --) write a value to a file, as a string
+{
+    FileObject *f = Types::tFile->get(p1);
+    StringBuffer sb;
+    int len;
+    const char *s = Types::tString->getBytes(p0,&len,sb);
+    f->write(s,len);
+}
+
+%wordargs writeln vv (val file --) write a value to a file, as a string, followed by a newline
+{
+    FileObject *f = Types::tFile->get(p1);
+    StringBuffer sb;
+    int len;
+    const char *s = Types::tString->getBytes(p0,&len,sb);
+    f->write(s,len);
+    f->write("\n",1);
+}
+
+%wordargs readfile s (path -- string) read a whole file into a string
+Big files are mapped into memory rather than read. On fail, throws
+ex$failed.
+{
+    Value t;
+    Types::tFile->readFile(&t,p0);
+    a->pushval()->copy(&t);
+}
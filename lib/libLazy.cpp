@@ -0,0 +1,65 @@
+#include "angort.h"
+
+%doc
+Lazy iterator pipelines. Each of these words takes an iterable (a list,
+range, hash, vector, another lazy value and so on) and returns a lazy
+value, which does nothing until it is iterated over by each, reduce,
+map, vec$tolist or anything else which takes an iterable. Then the
+items are pulled through all the stages one at a time, so that
+ "0 1000000 range (dup*) lazy$map (3 % 0 =) lazy$filter 0 swap (+) reduce"
+never builds a list. Pipelines can be iterated over more than once,
+and functions in map and filter stages are run again each time, in
+whichever thread is doing the iterating.
+%doc
+
+using namespace angort;
+
+%name lazy
+
+%wordargs map vc (iterable func -- lazy) lazily apply a function to each item
+{
+    Value func;
+    func.copy(p1);
+    LazyObject *o = Types::tLazy->set(a->pushval(),LZ_MAP,p0);
+    o->func->copy(&func);
+}
+
+%wordargs filter vc (iterable func -- lazy) lazily pass on those items for which a function is true
+{
+    Value func;
+    func.copy(p1);
+    LazyObject *o = Types::tLazy->set(a->pushval(),LZ_FILTER,p0);
+    o->func->copy(&func);
+}
+
+%wordargs take vi (iterable n -- lazy) lazily pass on the first n items
+Nothing after the nth item is pulled from the iterable, so functions in
+earlier stages are not run on the rest.
+{
+    LazyObject *o = Types::tLazy->set(a->pushval(),LZ_TAKE,p0);
+    o->n = p1;
+}
+
+%wordargs drop vi (iterable n -- lazy) lazily skip the first n items
+{
+    LazyObject *o = Types::tLazy->set(a->pushval(),LZ_DROP,p0);
+    o->n = p1;
+}
+
+%wordargs zip vv (iterable1 iterable2 -- lazy) lazily pair items from two iterables
+Each item is a two-item list [a,b], and the pipeline ends when either
+of the iterables does.
+{
+    Types::tLazy->set(a->pushval(),LZ_ZIP,p0,p1);
+}
+
+%wordargs chain vv (iterable1 iterable2 -- lazy) lazily run through one iterable and then another
+{
+    Types::tLazy->set(a->pushval(),LZ_CHAIN,p0,p1);
+}
+
+%wordargs enumerate v (iterable -- lazy) lazily pair each item with its index
+Each item is a two-item list [index,item], starting at zero.
+{
+    Types::tLazy->set(a->pushval(),LZ_ENUMERATE,p0);
+}
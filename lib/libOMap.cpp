@@ -0,0 +1,127 @@
+#include "angort.h"
+#include "hash.h"
+
+%doc
+Ordered maps. An omap works like a hash with get, set, remove, len, in
+and each, but iterating over it gives the keys in order, using the same
+comparison as sort and cmp, and it can find the keys either side of a
+given key, the nth key, or all the keys in a range, without sorting.
+Finding, adding and removing keys are all O(log n). Iterating over an
+omap gives its keys, and ival gives the value for each one.
+%doc
+
+using namespace angort;
+
+%name omap
+
+%word new (-- omap) make a new, empty ordered map
+{
+    Types::tOMap->set(a->pushval());
+}
+
+%wordargs fromhash v (hash -- omap) make an ordered map holding the keys and values of a hash
+{
+    Value in;
+    in.copy(p0);
+    Hash *h = Types::tHash->get(&in);
+    OMapObject *o = Types::tOMap->set(a->pushval());
+    ReadLock lock(h);
+    for(int i=h->nextUsed(0);i>=0;i=h->nextUsed(i+1))
+        o->set(h->keyAt(i),h->valAt(i));
+}
+
+/// push the key at a position, or none if it's the end
+static void pushKey(Runtime *a,OMapObject *o,OMapPos *p){
+    Value *k = p->leaf ? o->keyAt(*p) : NULL;
+    if(k)
+        a->pushval()->copy(k);
+    else
+        a->pushNone();
+}
+
+%wordargs floor vv (key omap -- key) the greatest key no greater than a key, or none
+{
+    Value k,m;
+    k.copy(p0);
+    m.copy(p1);
+    OMapObject *o = Types::tOMap->get(&m);
+    ReadLock lock(&o->tree);
+    OMapPos p;
+    o->lowerBound(&k,&p);
+    if(!p.leaf || o->compare(o->keyAt(p),&k))
+        o->prev(&p);
+    pushKey(a,o,&p);
+}
+
+%wordargs ceil vv (key omap -- key) the least key no less than a key, or none
+{
+    Value k,m;
+    k.copy(p0);
+    m.copy(p1);
+    OMapObject *o = Types::tOMap->get(&m);
+    ReadLock lock(&o->tree);
+    OMapPos p;
+    o->lowerBound(&k,&p);
+    pushKey(a,o,&p);
+}
+
+%wordargs first v (omap -- key) the least key, or none if empty
+{
+    Value m;
+    m.copy(p0);
+    OMapObject *o = Types::tOMap->get(&m);
+    ReadLock lock(&o->tree);
+    OMapPos p = o->begin();
+    pushKey(a,o,&p);
+}
+
+%wordargs last v (omap -- key) the greatest key, or none if empty
+{
+    Value m;
+    m.copy(p0);
+    OMapObject *o = Types::tOMap->get(&m);
+    ReadLock lock(&o->tree);
+    OMapPos p;
+    p.leaf=NULL;
+    o->prev(&p);
+    pushKey(a,o,&p);
+}
+
+%wordargs rank vv (key omap -- n) the number of keys less than a key
+If the key is in the map, this is its index in the order (as given by
+index).
+{
+    Value k,m;
+    k.copy(p0);
+    m.copy(p1);
+    OMapObject *o = Types::tOMap->get(&m);
+    ReadLock lock(&o->tree);
+    OMapPos p;
+    a->pushInt(o->lowerBound(&k,&p));
+}
+
+%wordargs select iv (n omap -- key) the nth key in order, starting from zero
+Throws ex$outofrange if there aren't that many keys.
+{
+    Value m;
+    m.copy(p1);
+    OMapObject *o = Types::tOMap->get(&m);
+    ReadLock lock(&o->tree);
+    OMapPos p;
+    if(!o->select(p0,&p))
+        throw RUNT(EX_OUTOFRANGE,"omap select out of range");
+    pushKey(a,o,&p);
+}
+
+%wordargs range vvv (lo hi omap -- range) the keys from lo up to but not including hi
+This doesn't copy anything; the range can be iterated over with each
+(where ival gives the value for each key), and len and in work on it.
+It always reflects the current contents of the map. Either bound can be
+none, in which case the range is unbounded at that end.
+{
+    Value lo,hi,m;
+    lo.copy(p0);
+    hi.copy(p1);
+    m.copy(p2);
+    Types::tOMapRange->set(a->pushval(),&m,&lo,&hi);
+}
@@ -0,0 +1,108 @@
+#include "angort.h"
+#include "hash.h"
+
+%doc
+Persistent vectors and maps. These are never changed once they have been
+made: words like persist$push and persist$set return a new version and
+leave the old one as it was. The new version shares all but O(log n) of
+its memory with the old one, so making it is cheap, and because nothing
+can change a persistent value there is never any need to clone one
+before handing it on. A pvec works like a list and a pmap like a hash
+with get, len, in, each, map and so on (iterating over a pmap gives its
+keys), but set and remove will throw ex$notsup.
+%doc
+
+using namespace angort;
+
+%name persist
+
+%wordargs vec v (iterable -- pvec) make a persistent vector holding the items of an iterable
+{
+    Value in;
+    in.copy(p0);
+    Iterator<Value *> *iter = in.t->makeIterator(&in);
+    PVecObject *o = Types::tPVec->set(a->pushval());
+    try {
+        for(iter->first();!iter->isDone();iter->next())
+            o->append(iter->current());
+    } catch(Exception& e){
+        delete iter;
+        throw;
+    }
+    delete iter;
+}
+
+%wordargs map v (hash -- pmap) make a persistent map holding the keys and values of a hash
+{
+    Value in;
+    in.copy(p0);
+    Hash *h = Types::tHash->get(&in);
+    PMapObject *o = Types::tPMap->set(a->pushval());
+    ReadLock lock(h);
+    for(int i=h->nextUsed(0);i>=0;i=h->nextUsed(i+1))
+        o->put(h->keyAt(i),h->valAt(i));
+}
+
+%wordargs push vv (item pvec -- pvec) a new vector with an item added to the end
+{
+    PVecObject *o = Types::tPVec->get(p1)->push(p0);
+    Types::tPVec->set(a->pushval(),o);
+}
+
+%wordargs pop v (pvec -- pvec) a new vector with the last item removed
+Throws ex$outofrange if the vector is empty.
+{
+    PVecObject *o = Types::tPVec->get(p0)->pop();
+    Types::tPVec->set(a->pushval(),o);
+}
+
+%wordargs set vvv (val key coll -- coll) a new vector or map with an item set
+For a vector, the key can be the length of the vector, which adds
+the item to the end; any other index out of range throws ex$outofrange.
+{
+    if(p2->t == Types::tPVec){
+        PVecObject *o = Types::tPVec->get(p2)->set(p1->toInt(),p0);
+        Types::tPVec->set(a->pushval(),o);
+    } else {
+        PMapObject *o = Types::tPMap->get(p2)->set(p1,p0);
+        Types::tPMap->set(a->pushval(),o);
+    }
+}
+
+%wordargs del vv (key pmap -- pmap) a new map without a key
+If the key isn't in the map, the same map is returned.
+{
+    PMapObject *o = Types::tPMap->get(p1)->del(p0);
+    if(o)
+        Types::tPMap->set(a->pushval(),o);
+    else
+        a->pushval()->copy(p1);
+}
+
+%wordargs tolist v (pvec -- list) make a new list holding the items of a vector
+{
+    Value in;
+    in.copy(p0);
+    PVecObject *o = Types::tPVec->get(&in);
+    ArrayList<Value> *list = Types::tList->set(a->pushval(),o->count);
+    WriteLock lock=WL(list);
+    for(int i=0;i<o->count;i++)
+        list->append()->copy(o->get(i));
+}
+
+%wordargs tohash v (pmap -- hash) make a new hash holding the keys and values of a map
+{
+    Value in;
+    in.copy(p0);
+    PMapObject *o = Types::tPMap->get(&in);
+    Hash *h = Types::tHash->set(a->pushval());
+    WriteLock lock=WL(h);
+    h->reserve(o->count);
+    Iterator<Value *> *iter = o->makeKeyIterator();
+    Iterator<Value *> *viter = o->makeValueIterator();
+    viter->first();
+    for(iter->first();!iter->isDone();iter->next(),viter->next())
+        h->set(iter->current(),viter->current());
+    delete iter;
+    delete viter;
+}
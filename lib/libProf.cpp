@@ -0,0 +1,43 @@
+#include "angort.h"
+#include "profiler.h"
+
+%doc
+This library controls the built-in sampling profiler, which records
+the Angort call stack of each running thread at regular intervals
+(of CPU time). The profile is written as folded stacks, suitable
+for flamegraph tools, with a table of self and total samples per word
+in a second file of the same name with ".words" appended. The profiler
+can also be run for a whole program with the "-P file" command line
+option.
+%doc
+
+using namespace angort;
+
+%name prof
+%shutdown
+{
+    // write any profile requested from the command line
+    Profiler::finish(a->ang);
+}
+
+%wordargs start i (hz --) start sampling at a given rate
+Any previous profile data is discarded. A rate of zero or less
+uses the default of 100Hz.
+{
+    Profiler::start(p0);
+}
+
+%wordargs stop s (filename --) stop sampling and write the profile
+Folded stacks are written to the given file, and the table of
+self/total samples (and times) per word to the file with ".words"
+appended.
+{
+    Profiler::stop();
+    if(!Profiler::write(a->ang,p0))
+        throw RUNT(EX_NOTFOUND,"").set("cannot write profile to %s",p0);
+}
+
+%word running (-- bool) is the profiler currently sampling?
+{
+    a->pushInt(Profiler::isRunning()?1:0);
+}
@@ -0,0 +1,57 @@
+#include "angort.h"
+
+%doc
+Binary serialisation of values, which is much faster and more compact
+than writing values out with "show" and reading them back with "eval",
+and doesn't lose anything: types are kept exactly (longs stay longs,
+doubles keep all their digits, symbols stay symbols), and lists and
+hashes which appear more than once - including those which contain
+themselves - are written once and come back shared in the same way.
+
+ser$dump turns a value into a string of bytes, which can be written to
+a file with file$write or sent to another process, and ser$load turns
+those bytes back into the value:
+
+    "checkpoint" "w" file$open !F
+    ?State ser$dump ?F file$write
+    ?F file$close
+    "checkpoint" file$readfile ser$load !State
+
+Integers, longs, floats, doubles, strings, symbols, none, lists, hashes,
+ranges and numeric vectors can be serialised. Trying to serialise
+anything else (such as a function or a file) throws ex$notsup. Types
+added by plugins can be serialised if they provide the methods for it
+(see serialise.h).
+%doc
+
+using namespace angort;
+
+%name ser
+
+%wordargs dump v (value -- string) serialise a value into a string of bytes
+Throws ex$notsup if the value is or contains something which can't be
+serialised.
+{
+    StringBuilder b;
+    Serialiser s(b);
+    s.write(p0);
+    Value t;
+    Types::tString->setwithlen(&t,b.get(),b.length());
+    a->pushval()->copy(&t);
+}
+
+%wordargs load v (string -- value) turn a string made by ser$dump back into a value
+Throws ex$corrupt if the data is damaged or not from ser$dump, or
+ex$notfound if it contains a type which doesn't exist here (such as
+one from a plugin which isn't loaded).
+{
+    if(!StringType::isString(p0))
+        throw RUNT(EX_TYPE,"ser$load needs a string");
+    Deserialiser d(Types::tString->getBytes(p0),
+                   Types::tString->getByteLength(p0));
+    Value t;
+    d.read(&t);
+    if(!d.atEnd())
+        d.fail("unexpected data after the value");
+    a->pushval()->copy(&t);
+}
@@ -257,7 +257,7 @@ for other items.
 Prints a string representation of a value to stdout without a
 trailing newline.
 {
-    fputs(a->popString().get(),a->outputStream);
+    a->print(a->popval());
 }
 
 %word x (v -- ) print a value in hex
@@ -281,11 +281,7 @@ trailing newline.
 For more complex file output, use the IO library. On fail, throws
 ex$failed.
 {
-    a->endredir();
-    FILE *f = fopen(p0,"w");
-     if(!f)
-        throw RUNT(EX_FAILED,"").set("redir unable to open file %s",p0);
-    a->outputStream=f;
+    a->redir(p0);
 }
 
 %word endredir (--) close a redirected output stream
@@ -296,7 +292,38 @@ ex$failed.
 
 %word nl ( -- ) print a new line
 {
-    fputc('\n',a->outputStream);
+    putc('\n',a->outputStream);
+}
+
+%word flush (--) write out any output waiting in the buffer
+Output to a terminal is normally written a line at a time, while output
+to a pipe or file is collected into a large buffer and only written when
+the buffer fills or the program ends. Use this to make sure that what
+has been printed so far has gone out, for example before a long
+computation when another program is reading the output.
+{
+    a->flushOutput();
+}
+
+%wordargs outbuf Si (mode size --) set how output is buffered
+The mode is `none (every print is written immediately), `line (output
+is written at the end of each line) or `full (output is written when
+the buffer fills, or on flush). The size is the buffer size in bytes,
+or 0 for the default of 64K. This applies to the current output and to
+any later redirected output. For example, to make a script printing
+millions of lines to a terminal run faster:
+    `full 1048576 outbuf
+{
+    int mode;
+    if(!strcmp(p0,"none"))
+        mode=OUTPUT_NONE;
+    else if(!strcmp(p0,"line"))
+        mode=OUTPUT_LINE;
+    else if(!strcmp(p0,"full"))
+        mode=OUTPUT_FULL;
+    else
+        throw RUNT(EX_BADPARAM,"").set("outbuf: unknown mode %s",p0);
+    a->setOutputBuffering(mode,p1);
 }
 
 %word errp ( s -- ) print a string to stdout
@@ -343,8 +370,8 @@ Print to stdout the instructions for a named Angort function.
     a->checkzerothread();
     
     Value *v = a->popval();
-    if(v->t == Types::tString)
-        a->ang->disasm(v->v.s);
+    if(StringType::isString(v))
+        a->ang->disasm(v->toString().get());
     else if(v->t == Types::tClosure)
         a->ang->disasm(v->v.closure->cb);
     else if(v->t == Types::tCode)
@@ -546,29 +573,29 @@ If in an iterator ("each") loop, return the current value. For hashes,
 this will return the key.
 {
     Value *p = a->pushval();
-    p->copy(a->getTopIterator()->current);
+    p->copy(&a->getTopIterator()->current);
 }
 %word j (-- current) get nested iterator value (key if hash)
 If in an 2-deep iterator ("each") loop, return the current value of
 the outer loop. For hashes, this will return the key.
 {
     Value *p = a->pushval();
-    p->copy(a->getTopIterator(1)->current);
+    p->copy(&a->getTopIterator(1)->current);
 }
 %word k (-- current) get nested iterator value (key if hash)
 If in an 3-deep iterator ("each") loop, return the current value of
 the outer loop. For hashes, this will return the key.
 {
     Value *p = a->pushval();
-    p->copy(a->getTopIterator(2)->current);
+    p->copy(&a->getTopIterator(2)->current);
 }
 
 %word ival (-- current) get current iterator value (value if hash)
 If in an iterator ("each") loop, return the current value. For hashes,
 this will return the value (as opposed to "i").
 {
-    Value *iterable = a->getTopIterator()->iterable;
-    Value *cur = a->getTopIterator()->current;
+    Value *iterable = &a->getTopIterator()->iterable;
+    Value *cur = &a->getTopIterator()->current;
     Value *p = a->pushval();
     iterable->t->getValue(iterable,cur,p);
 }
@@ -577,8 +604,8 @@ this will return the value (as opposed to "i").
 If in an 2-deep iterator ("each") loop, return the current value of
 the outer loop. For hashes, this will return the value (as opposed to "j").
 {
-    Value *iterable = a->getTopIterator(1)->iterable;
-    Value *cur = a->getTopIterator(1)->current;
+    Value *iterable = &a->getTopIterator(1)->iterable;
+    Value *cur = &a->getTopIterator(1)->current;
     Value *p = a->pushval();
     iterable->t->getValue(iterable,cur,p);
 }
@@ -587,8 +614,8 @@ the outer loop. For hashes, this will return the value (as opposed to "j").
 If in an 3-deep iterator ("each") loop, return the current value of
 the outer loop. For hashes, this will return the value (as opposed to "k").
 {
-    Value *iterable = a->getTopIterator(2)->iterable;
-    Value *cur = a->getTopIterator(2)->current;
+    Value *iterable = &a->getTopIterator(2)->iterable;
+    Value *cur = &a->getTopIterator(2)->current;
     Value *p = a->pushval();
     iterable->t->getValue(iterable,cur,p);
 }
@@ -597,30 +624,21 @@ the outer loop. For hashes, this will return the value (as opposed to "k").
 The iterator index counts how many times the iterator has moved forwards
 in the iterable.
 {
-    // this subtracts 1 because OP_ITERLEAVEIFDONE advances the
-    // iterator at the start of the loop code, after stashing the
-    // current value away.
-    a->pushInt(a->getTopIterator()->iterator->index()-1);
+    a->pushInt(a->getTopIterator()->index());
 }    
 
 %word jidx (-- index) get nested iterator index integer.
 The iterator index counts how many times the iterator has moved forwards
 in the iterable.
 {
-    // this subtracts 1 because OP_ITERLEAVEIFDONE advances the
-    // iterator at the start of the loop code, after stashing the
-    // current value away.
-    a->pushInt(a->getTopIterator(1)->iterator->index()-1);
+    a->pushInt(a->getTopIterator(1)->index());
 }    
 
 %word kidx (-- index) get 2nd nested iterator index integer.
 The iterator index counts how many times the iterator has moved forwards
 in the iterable.
 {
-    // this subtracts 1 because OP_ITERLEAVEIFDONE advances the
-    // iterator at the start of the loop code, after stashing the
-    // current value away.
-    a->pushInt(a->getTopIterator(2)->iterator->index()-1);
+    a->pushInt(a->getTopIterator(2)->index());
 }    
 
 
@@ -629,8 +647,7 @@ Return the actual iterable object which is being iterated over inside an
 "each" loop.
 {
     Value *p = a->pushval();
-    IteratorObject *iterator = a->getTopIterator();
-    p->copy(iterator->iterable);
+    p->copy(&a->getTopIterator()->iterable);
 }
 
 %word mkiter (iterable -- iterator) make an iterator object
@@ -763,7 +780,9 @@ of them.
 %word type (v -- symb) get the type of the item as a symbol
 {
     Value *v = a->stack.peekptr();
-    Types::tSymbol->set(v,v->t->nameSymb);
+    // views are strings as far as anyone outside should be concerned
+    const Type *t = v->t == Types::tStrView ? Types::tString : v->t;
+    Types::tSymbol->set(v,t->nameSymb);
 }
 
 %word listtypes ( -- ) print the types
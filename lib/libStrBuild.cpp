@@ -0,0 +1,37 @@
+#include "angort.h"
+
+%doc
+String builders. Adding strings with + copies both of them into a new
+string, so building a long string by adding pieces to it one at a time
+takes time proportional to the square of its length. A string builder
+is a buffer which grows as needed, so appending to it only copies the
+new piece. Use sb$tostr to get the result as a string. A builder can
+also be printed directly, and len gives its length in characters.
+%doc
+
+using namespace angort;
+
+%name sb
+
+%word new (-- sb) make a new, empty string builder
+{
+    Types::tStrBuild->set(a->pushval());
+}
+
+%wordargs append vv (val sb --) append a value, converted to a string, to a builder
+{
+    Types::tStrBuild->get(p1)->append(p0);
+}
+
+%wordargs tostr v (sb -- string) get the contents of a builder as a string
+{
+    StringBuilder *b = Types::tStrBuild->get(p0);
+    Value t;
+    Types::tString->setwithlen(&t,b->get(),b->length());
+    a->pushval()->copy(&t);
+}
+
+%wordargs clear v (sb --) empty a builder, so that it can be reused
+{
+    Types::tStrBuild->get(p0)->clear();
+}
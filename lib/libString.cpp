@@ -10,44 +10,118 @@ way.
 %doc
 
 #include "angort.h"
+#include "strkernels.h"
 #include <wchar.h>
 #include <wctype.h>
 
 using namespace angort;
 
 namespace angort {
-static char sbuf[1024];
 void format(Value *out,Value *formatVal,ArrayList<Value> *items);
 
 inline int wstrlen(const char *s){
     return mbstowcs(NULL,s,0);
 }
 
+/// split a string wherever there's a byte from a set, up to limit
+/// times if limit is positive, pushing a list of the pieces. Long
+/// pieces are views into the string.
+static void splitOn(Runtime *a,Value *v,const strk::ByteSet& delims,int limit){
+    // keep our own reference to the string, because pushing the
+    // list may overwrite the parameter.
+    Value tmp,str;
+    str.copy(Types::tString->coerce(v,&tmp));
+    const char *s = Types::tString->getBytes(&str);
+    int len = Types::tString->getByteLength(&str);
+    // if it's all ASCII, we know how many characters each piece has
+    bool ascii = Types::tString->isASCII(&str);
+    
+    ArrayList<Value> *list = Types::tList->set(a->pushval());
+    WriteLock lock=WL(list);
+    
+    for(int p=0,splitct=0;;){
+        // the rest of the string if we've done enough splits
+        int e = (limit<=0 || splitct<limit) ? p+strk::findAny(s+p,len-p,delims) : len;
+        Types::tString->substringBytes(list->append(),&str,p,e,ascii ? e-p : -1);
+        if(e==len)break;
+        splitct++;
+        p=e+1;
+    }
+}
+
+/// get the delimiter and limit for split and splitany, from either
+/// a string or [delims,limit].
+static const char *getDelims(Value *v,int *limit,StringBuffer& sb){
+    if(v->t == Types::tList){
+        ArrayList<Value> *lst = Types::tList->get(v);
+        sb.set(lst->get(0));
+        *limit = lst->get(1)->toInt();
+    } else {
+        sb.set(v);
+        *limit = -1;
+    }
+    return sb.get();
+}
+
 }
 
 %name string
 
-%word stridx (haystack needle -- int) return index if haystack contains needle, else none
+// turn a byte offset into the bytes of a value into a character
+// index. Strings cache their length in characters, so once we know
+// one is ASCII there's no counting to do.
+static int charIndex(Value *v,const char *h,int off){
+    if(StringType::isString(v) && Types::tString->isASCII(v))
+        return off;
+    return StringType::countUTF8(h,off);
+}
+
+%wordargs stridx vv (haystack needle -- int) return index if haystack contains needle, else none
+The index is in characters, as for "substr" and "slice".
 {
-    const StringBuffer &needle = a->popString();
-    const StringBuffer &haystack = a->popString();
-    
-    const char *p = strstr(haystack.get(),needle.get());
+    StringBuffer hsb,nsb;
+    int hlen,nlen;
+    const char *h = Types::tString->getBytes(p0,&hlen,hsb);
+    const char *n = Types::tString->getBytes(p1,&nlen,nsb);
+    const char *p = strk::find(h,hlen,n,nlen);
     if(!p)
         a->pushval()->clr();
     else
-        a->pushInt(p-haystack.get());
+        a->pushInt(charIndex(p0,h,p-h));
 }
-%word istridx (haystack needle -- int) return index if haystack contains needle, else none
+%wordargs istridx vv (haystack needle -- int) return index if haystack contains needle, else none
+As "stridx", but ignoring the case of the ASCII letters.
 {
-    const StringBuffer &needle = a->popString();
-    const StringBuffer &haystack = a->popString();
-    
-    const char *p = strcasestr(haystack.get(),needle.get());
+    StringBuffer hsb,nsb;
+    int hlen,nlen;
+    const char *h = Types::tString->getBytes(p0,&hlen,hsb);
+    const char *n = Types::tString->getBytes(p1,&nlen,nsb);
+    const char *p = strk::ifind(h,hlen,n,nlen);
     if(!p)
         a->pushval()->clr();
     else
-        a->pushInt(p-haystack.get());
+        a->pushInt(charIndex(p0,h,p-h));
+}
+
+%word strsimd (-- name) the SIMD instruction set used by the string searching words
+This is one of "avx2", "sse2" or "scalar" (no SIMD), and is used by
+"stridx", "istridx", "split", "splitany" and "splitwhitespace".
+{
+    a->pushString(strk::getLevelName(strk::getLevel()));
+}
+
+%wordargs setstrsimd s (name --) set the SIMD instruction set used by the string searching words
+The name is "avx2", "sse2" or "scalar". If the processor doesn't support
+the set requested, the best one it does support is used. This is mostly
+useful for testing.
+{
+    for(int i=strk::SK_SCALAR;i<=strk::SK_AVX2;i++){
+        if(!strcmp(p0,strk::getLevelName((strk::Level)i))){
+            strk::setLevel((strk::Level)i);
+            return;
+        }
+    }
+    throw RUNT(EX_BADPARAM,"").set("unknown SIMD set: %s",p0);
 }
 
 
@@ -106,8 +180,11 @@ inline int wstrlen(const char *s){
 
 %word format (list string -- string) string formatting
 Format a string using a subset of printf semantics. The types supported
-are: d, f, g, x, u, s. Precision and width are supported for
-numeric types. The list contains the items to be substituted into the string.
+are: d, u, x (which take an l flag for longs), f, g, e, s and c. Precision
+and width are supported for numeric types, and width for strings. The list
+contains the items to be substituted into the string. Formats are compiled
+the first time they are used and cached, so using the same format many
+times is cheap.
 {
     Value f,l;
     f.copy(a->popval());
@@ -149,77 +226,56 @@ numeric types. The list contains the items to be substituted into the string.
 
 %word padleft (string padding -- string) insert spaces at left to pad out string
 {
-    wchar_t buf[1024];
-    
     int padding = a->popInt();
     Value *v = a->stack.peekptr();
-    const StringBuffer &s = v->toString();
-    mbstowcs(buf,s.get(),1023);
+    Value tmp,r;
+    Value *s = Types::tString->coerce(v,&tmp);
     
-    int len = wstrlen(s.get());
+    int len = Types::tString->getCount(s);
     if(len>=padding)
         return;
-    if(len<0)
-        return; // invalid length - do nothing
-    
-    wchar_t *newstr = (wchar_t *)malloc(sizeof(wchar_t)*(padding+1));
-    int i;
-    for(i=0;i<padding-len;i++)
-        newstr[i]=L' ';
-    wcscpy(newstr+i,buf);
     
-    wcstombs(sbuf,newstr,1023);
-    Types::tString->set(v,sbuf);
-    free(newstr);
+    int bytes = Types::tString->getByteLength(s);
+    char *out = Types::tString->setAllocateOnly(&r,bytes+padding-len);
+    memset(out,' ',padding-len);
+    // views aren't null-terminated, so write our own
+    memcpy(out+padding-len,Types::tString->getBytes(s),bytes);
+    out[bytes+padding-len]=0;
+    v->copy(&r);
 }
 
 %word padright (string padding -- string) insert spaces at right to pad out string
 {
-    wchar_t buf[1024];
-    
-    
     int padding = a->popInt();
     Value *v = a->stack.peekptr();
-    const StringBuffer &s = v->toString();
-    mbstowcs(buf,s.get(),1023);
+    Value tmp,r;
+    Value *s = Types::tString->coerce(v,&tmp);
     
-    
-    int len = wstrlen(s.get());
+    int len = Types::tString->getCount(s);
     if(len>=padding)
         return;
-    if(len<0)
-        return; // invalid length - do nothing
     
-    wchar_t *newstr = (wchar_t *)malloc(sizeof(wchar_t)*(padding+1));
-    int i;
-    wcscpy(newstr,buf);
-    for(i=0;i<padding-len;i++)
-        newstr[len+i]=L' ';
-    newstr[padding]=0;
-    
-    wcstombs(sbuf,newstr,1023);
-    Types::tString->set(v,sbuf);
-    
-    free(newstr);
+    int bytes = Types::tString->getByteLength(s);
+    char *out = Types::tString->setAllocateOnly(&r,bytes+padding-len);
+    memcpy(out,Types::tString->getBytes(s),bytes);
+    memset(out+bytes,' ',padding-len);
+    out[bytes+padding-len]=0;
+    v->copy(&r);
 }
 
 
 %word trunc (string maxlen -- string) truncate a string if longer than maxlen
 {
-    wchar_t buf[1024];
     int maxlen = a->popInt();
     Value *v = a->stack.peekptr();
-    const StringBuffer &s = v->toString();
-    const char *src = s.get();
-    int rv = mbstowcs(buf,src,1023);
+    Value tmp;
+    Value *s = Types::tString->coerce(v,&tmp);
     
-    if(rv<0 || maxlen>1024 || maxlen<0 || wcslen(buf)<(unsigned int)maxlen)
+    if(maxlen<0 || Types::tString->getCount(s)<maxlen)
         return;
     
     // might not actually be a string.
-    buf[maxlen]=0;
-    wcstombs(sbuf,buf,1023);
-    Types::tString->set(v,sbuf);
+    Types::tString->substring(v,s,0,maxlen);
 }
 
 inline int wordlen(const wchar_t * s){
@@ -258,112 +314,81 @@ inline int wordlen(const wchar_t * s){
     Types::tString->set(v,ss);
 }
 
-%word split (string delim/max -- list) split a string on a single-character delimiter or with limit
+%wordargs split vv (string delim/max -- list) split a string on a single-character delimiter or with limit
 delim can be either a delimiter or [delim,max] where max is the maximum
-number of splits.
+number of splits. Long pieces are views into the original string rather
+than copies.
 {
-    Value *params[2];
-    a->popParams(params,"sv");
-    const StringBuffer& strb=params[0]->toString();
-    const char *s = strdup(strb.get());
-    char delim;
-    int limit = -1;
-    ArrayList<Value> *list = Types::tList->set(a->pushval());
-    
-    WriteLock lock=WL(list);
-    // param 1 is either a string or a list - if the latter, we split into delim and max splits
-    
-    if(params[1]->t == Types::tList){
-        ArrayList<Value> *lst = Types::tList->get(params[1]);
-        delim = lst->get(0)->toString().get()[0];
-        limit = lst->get(1)->toInt();
-    } else {
-        delim = params[1]->toString().get()[0];
-    }
-    
-    
-    // must be the size of the longest string
-    char *buf = (char *)malloc(strlen(s)+1);
-    const char *p=s;
-    const char *base=s;
-    
-    for(int splitct=0;;){
-        if(*s==delim || !*s){
-            memcpy(buf,p,s-p);
-            buf[s-p]=0;
-            Types::tString->set(list->append(),buf);
-            if(!*s)break;//{free((void *)base);return;}
-            if(++splitct == limit){
-                // turn off the delimiter, avoiding more splits
-                delim=0;
-            }
-            s++;
-            p=s;
-        } else
-            s++;
+    StringBuffer sb;
+    int limit;
+    const char *d = getDelims(p1,&limit,sb);
+    // only the first byte of the delimiter is used
+    splitOn(a,p0,strk::ByteSet(d,*d ? 1 : 0),limit);
+}
+
+%wordargs splitany vv (string delims/max -- list) split a string wherever there is any of a set of characters
+delims is a string of the characters to split on, which must all be
+ASCII. As with "split", it can be [delims,max] where max is the maximum
+number of splits, and long pieces are views into the original string.
+{
+    StringBuffer sb;
+    int limit;
+    const char *d = getDelims(p1,&limit,sb);
+    for(const char *q=d;*q;q++){
+        if(*q&0x80)
+            throw RUNT(EX_BADPARAM,"splitany delimiters must be ASCII");
     }
-    free((void *)buf);
-    free((void *)base);
+    splitOn(a,p0,strk::ByteSet(d,strlen(d)),limit);
 }
 
-%wordargs splitwhitespace s (str -- list) split string by whitespace
+%wordargs splitwhitespace v (str -- list) split string by whitespace
+Whitespace is as for isspace() in the C library: the ASCII space, tab,
+newline, vertical tab, form feed and carriage return. Long pieces are
+views into the original string rather than copies.
 {
-    int len = wstrlen(p0);
-    wchar_t *buf = (wchar_t *)alloca((len+1)*sizeof(wchar_t));
-    mbstowcs(buf,p0,len+1);
+    Value tmp,str;
+    str.copy(Types::tString->coerce(p0,&tmp));
+    const char *s = Types::tString->getBytes(&str);
+    int len = Types::tString->getByteLength(&str);
+    bool ascii = Types::tString->isASCII(&str);
+    
     ArrayList<Value> *list = Types::tList->set(a->pushval());
     WriteLock lock=WL(list);
     
-    wchar_t *s = buf;
-    wchar_t *outbuf = (wchar_t *)alloca(len+1);
-    char *outbufc = (char *)alloca(len*2+1); // a bit big, but there we go.
-    wchar_t *outp = outbuf;
-    
-    while(*s){
+    // UTF-8 continuation bytes are never whitespace, so we can just
+    // scan the bytes.
+    int p=0;
+    for(;;){
         // skip initial whitespace
-        while(*s && iswspace(*s))s++;
-        if(!*s)break;
-        // copy to end of word (or string)
-        while(*s && !iswspace(*s)){
-            *outp++ = *s++;
-        }
-        // terminate
-        *outp++ = 0;
-        // convert
-        wcstombs(outbufc,outbuf,outp-outbuf);
-        // append
-        Types::tString->set(list->append(),outbufc);
-        // reset
-        outp=outbuf;
+        p += strk::skipAny(s+p,len-p,strk::whitespace);
+        if(p==len)break;
+        // find the end of the word (or string)
+        int e = p+strk::findAny(s+p,len-p,strk::whitespace);
+        Types::tString->substringBytes(list->append(),&str,p,e,ascii ? e-p : -1);
+        p=e;
     }
 }
 
-%wordargs substr sii (str start count -- str) get a substring.
+%wordargs substr vii (str start count -- str) get a substring.
 If count less than or equal to 0 calculate count from end, 
 if start negative calculate start from end. See also "slice".
 {
-    int len = wstrlen(p0);
+    Value tmp,r;
+    Value *s = Types::tString->coerce(p0,&tmp);
+    int len = Types::tString->getCount(s);
     if(p1<0)
         p1 = len+p1;
     if(p1>len || p1<0){
         a->pushString("");
     } else {
-        wchar_t *s = (wchar_t *)alloca((len+1)*sizeof(wchar_t));
-        int rv = mbstowcs(s,p0,len+1);
-        if(rv<0){
-            a->pushNone();
-            return;
-        }
-        s+=p1;
         if(p2<=0){
             p2=len+p2-p1;
         }
-        
-        if(p2>len)p2=len;
-        if(p2>0 && p1+p2<len)s[p2]=0;
-        char *s2 = (char *)alloca(rv-p1+1);
-        wcstombs(s2,s,rv-p1+1);
-        a->pushString(s2);
+        // a count which is still not positive, or runs past the
+        // end, gives the rest of the string.
+        int end = (p2>0 && p1+p2<len) ? p1+p2 : len;
+        Types::tString->substring(&r,s,p1,end);
+        a->pushval()->copy(&r);
     }
 }        
 
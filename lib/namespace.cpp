@@ -151,6 +151,8 @@ const char *NamespaceManager::getNameByValue(Value *v,char *out,int len){
                     cmp = v->v.list == c->v.list;
                 else if(v->t == Types::tHash)
                     cmp = v->v.hash == c->v.hash;
+                else if(v->t == Types::tCode)
+                    cmp = v->v.cb == c->v.cb;
                 else cmp = v->equalForHashTable(c);
             }
             if(cmp){
@@ -32,7 +32,8 @@ const char *opcodenames[]=
     "self","dummycase","le","ge","constexpr",
     "yield","try","endtry","throw","litdouble",
     "litlong","closureinc","closuredec","inc","nop",
-    "compileif"
+    "compileif","tailrecurse","tailglobaldo","localbinop",
+    "locallitbinop"
     
 };
 
@@ -129,6 +130,25 @@ const char *opcodenames[]=
 #define OP_INC 70
 #define OP_NOP 71
 #define OP_COMPILEIF 72
+#define OP_TAILRECURSE 73
+#define OP_TAILGLOBALDO 74
+#define OP_LOCALBINOP 75
+#define OP_LOCALLITBINOP 76
+
+/// is this one of the stack-form binary operators, which
+/// Runtime::binop() handles?
+inline bool isBinopOpcode(int op){
+    switch(op){
+    case OP_EQUALS:      case OP_ADD:            case OP_MUL:
+    case OP_DIV:         case OP_SUB:            case OP_NEQUALS:
+    case OP_AND:         case OP_OR:             case OP_GT:
+    case OP_LT:          case OP_MOD:            case OP_CMP:
+    case OP_LE:          case OP_GE:
+        return true;
+    default:
+        return false;
+    }
+}
 
 
 #endif /* __OPCODES_H */
@@ -0,0 +1,122 @@
+/**
+ * @file output.cpp
+ * @brief  Printing values and buffering the output stream.
+ *
+ * Output goes through stdio, so it stays in order with the messages
+ * written with printf elsewhere; what's done here is to make the
+ * buffer big (so a script printing millions of lines makes one system
+ * call per buffer rather than one per line or per few lines) and to
+ * write numbers and strings straight into it.
+ */
+
+#include "angort.h"
+
+namespace angort {
+
+/// the buffer we gave stdout, if any. It's shared by all runtimes,
+/// and only changed while holding stdout's lock.
+static char *stdoutBuf=NULL;
+
+void Runtime::print(const Value *v,bool nl){
+    char buf[128];
+    const char *s=NULL;
+    int n=0;
+    StringBuffer sb;
+    const Type *t = v->t;
+    if(t==Types::tInteger || t==Types::tLong){
+        long l = t==Types::tInteger ? v->v.i : v->v.l;
+        unsigned long u = l<0 ? -(unsigned long)l : l;
+        char *q = buf+sizeof(buf);
+        do {
+            *--q = '0'+u%10;
+            u/=10;
+        } while(u);
+        if(l<0)*--q='-';
+        s=q;
+        n=buf+sizeof(buf)-q;
+    } else if(t==Types::tFloat || t==Types::tDouble){
+        if(t==Types::tFloat)
+            n = snprintf(buf,sizeof(buf),Types::tFloat->formatString,v->v.f);
+        else
+            n = snprintf(buf,sizeof(buf),Types::tDouble->formatString,v->v.df);
+        if(n<(int)sizeof(buf))
+            s=buf;
+    } else if(StringType::isString(v)){
+        // strings and views, without copying the view
+        s = Types::tString->getBytes(v);
+        n = Types::tString->getByteLength(v);
+    }
+    if(!s){
+        sb.set(v);
+        s = sb.get();
+        n = strlen(s);
+    }
+    
+    // holding the lock keeps the value and the newline together
+    // when other threads are printing
+    FILE *f = outputStream;
+    flockfile(f);
+    fwrite_unlocked(s,1,n,f);
+    if(nl)
+        putc_unlocked('\n',f);
+    funlockfile(f);
+}
+
+void Runtime::bufferOutput(){
+    if(outputBufSize<0)
+        return; // leave the stdio defaults alone
+    FILE *f = outputStream;
+    char **owned = f==stdout ? &stdoutBuf : &redirBuf;
+
+    // C only promises that setvbuf works before the stream has been
+    // used, but glibc flushes the stream and then switches buffers,
+    // so this is only done with the old buffer emptied and locked.
+    flockfile(f);
+    fflush(f);
+    char *old = *owned;
+    char *buf=NULL;
+    if(outputMode==OUTPUT_NONE)
+        setvbuf(f,NULL,_IONBF,0);
+    else {
+        buf = (char *)malloc(outputBufSize);
+        setvbuf(f,buf,outputMode==OUTPUT_LINE?_IOLBF:_IOFBF,outputBufSize);
+    }
+    *owned=buf;
+    free(old);
+    funlockfile(f);
+}
+
+void Runtime::setOutputBuffering(int mode,int size){
+    if(mode<OUTPUT_NONE || mode>OUTPUT_FULL)
+        throw RUNT(EX_BADPARAM,"").set("bad output buffering mode %d",mode);
+    if(size<=0)
+        size=OUTPUT_BUFSIZE;
+    outputMode=mode;
+    outputBufSize=size;
+    bufferOutput();
+}
+
+void Runtime::redir(const char *filename){
+    endredir();
+    FILE *f = fopen(filename,"w");
+    if(!f)
+        throw RUNT(EX_FAILED,"").set("redir unable to open file %s",filename);
+    outputStream=f;
+    if(outputBufSize<0){
+        // not set, so use a big buffer (files are never line buffered)
+        redirBuf = (char *)malloc(OUTPUT_BUFSIZE);
+        setvbuf(f,redirBuf,_IOFBF,OUTPUT_BUFSIZE);
+    } else
+        bufferOutput();
+}
+
+void Runtime::endredir(){
+    if(outputStream != stdout){
+        fclose(outputStream);
+        outputStream=stdout;
+        free(redirBuf);
+        redirBuf=NULL;
+    }
+}
+
+}
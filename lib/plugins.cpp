@@ -38,11 +38,11 @@ void Runtime::popParams(Value **out,const char *spec,const Type *type0,
                 throw ParameterTypeException(i,"number or none",v->t->name);
             break;
         case 'y':
-            if(v->t != Types::tString && v->t != Types::tSymbol && !v->isNone())
+            if(!StringType::isString(v) && v->t != Types::tSymbol && !v->isNone())
                 throw ParameterTypeException(i,"string",v->t->name);
             break;
         case 's':
-            if(v->t != Types::tString && v->t != Types::tSymbol )
+            if(!StringType::isString(v) && v->t != Types::tSymbol )
                 throw ParameterTypeException(i,"string",v->t->name);
             break;
         case 'S':
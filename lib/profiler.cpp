@@ -0,0 +1,206 @@
+/**
+ * @file profiler.cpp
+ * @brief Sampling profiler for Angort words - see profiler.h.
+ *
+ */
+
+#include "angort.h"
+#include "profiler.h"
+#include <sys/time.h>
+
+namespace angort {
+
+volatile sig_atomic_t Profiler::ticks=0;
+
+static Lockable profLock("profiler");
+static ProfNode *root=NULL; //!< the call tree
+static int totalSamples=0;
+static int sampleHz=PROFILER_DEFAULT_HZ;
+static bool running=false;
+static const char *outputFile=NULL; //!< written by finish()
+
+static void profSighandler(int s){
+    Profiler::ticks++;
+}
+
+void Profiler::start(int hz){
+    if(hz<=0)hz=PROFILER_DEFAULT_HZ;
+    {
+        WriteLock lock=WL(&profLock);
+        delete root;
+        root = new ProfNode(NULL);
+        totalSamples=0;
+        sampleHz=hz;
+    }
+
+    struct sigaction sa;
+    memset(&sa,0,sizeof(sa));
+    sa.sa_handler = profSighandler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGPROF,&sa,NULL);
+
+    struct itimerval t;
+    t.it_interval.tv_sec = 0;
+    t.it_interval.tv_usec = 1000000/hz;
+    t.it_value = t.it_interval;
+    setitimer(ITIMER_PROF,&t,NULL);
+    running=true;
+}
+
+void Profiler::stop(){
+    struct itimerval t;
+    memset(&t,0,sizeof(t));
+    setitimer(ITIMER_PROF,&t,NULL);
+    running=false;
+}
+
+bool Profiler::isRunning(){
+    return running;
+}
+
+void Profiler::record(const CodeBlock **cbs,int n){
+    WriteLock lock=WL(&profLock);
+    if(!root || !running)return;
+
+    // walk down the tree, creating nodes as we go
+    ProfNode *node = root;
+    for(int i=0;i<n;i++){
+        ProfNode *c;
+        for(c=node->child;c;c=c->sibling){
+            if(c->cb == cbs[i])break;
+        }
+        if(!c){
+            c = new ProfNode(cbs[i]);
+            c->sibling = node->child;
+            node->child = c;
+        }
+        node = c;
+    }
+    node->self++;
+    totalSamples++;
+}
+
+/// per-word counts, built while walking the tree
+struct ProfWord {
+    const CodeBlock *cb;
+    int self,total;
+    char name[128];
+};
+
+/// state used while writing the profile
+struct ProfWriter {
+    Angort *ang;
+    FILE *folded;
+    ArrayList<ProfWord> words;
+    const CodeBlock *path[RSTACKSIZE];
+
+    /// find (or create and name) the entry for a codeblock
+    ProfWord *getWord(const CodeBlock *cb){
+        for(int i=0;i<words.count();i++){
+            ProfWord *w = words.get(i);
+            if(w->cb == cb)return w;
+        }
+        ProfWord *w = words.append();
+        w->cb = cb;
+        w->self = w->total = 0;
+
+        // try to find a global with this code, failing
+        // that use the source position.
+        Value v;
+        Types::tCode->set(&v,cb);
+        ang->names.getNameByValue(&v,w->name,128);
+        if(!strcmp(w->name,"??")){
+            const SourcePos *sp = cb->getPos(cb->ip);
+            if(sp)
+                snprintf(w->name,128,"anon@%s:%d",sp->file,sp->line);
+            else
+                snprintf(w->name,128,"anon@%p",cb);
+        }
+        return w;
+    }
+
+    void walk(ProfNode *node,int depth){
+        for(ProfNode *c=node->child;c;c=c->sibling){
+            path[depth]=c->cb;
+            if(c->self){
+                // output the folded stack for this path
+                for(int i=0;i<=depth;i++){
+                    fputs(getWord(path[i])->name,folded);
+                    fputc(i==depth ? ' ' : ';',folded);
+                }
+                fprintf(folded,"%d\n",c->self);
+
+                getWord(c->cb)->self += c->self;
+                // add to the total for each word on the path,
+                // only once for recursive words.
+                for(int i=0;i<=depth;i++){
+                    int j;
+                    for(j=0;j<i;j++)
+                        if(path[j]==path[i])break;
+                    if(j==i)
+                        getWord(path[i])->total += c->self;
+                }
+            }
+            walk(c,depth+1);
+        }
+    }
+};
+
+static int cmpWords(const void *a,const void *b){
+    return ((const ProfWord *)b)->self - ((const ProfWord *)a)->self;
+}
+
+bool Profiler::write(Angort *a,const char *filename){
+    WriteLock lock=WL(&profLock);
+
+    char wordsName[1024];
+    snprintf(wordsName,1024,"%s.words",filename);
+
+    ProfWriter w;
+    w.ang = a;
+    if(!(w.folded = fopen(filename,"w")))
+        return false;
+    FILE *wf = fopen(wordsName,"w");
+    if(!wf){
+        fclose(w.folded);
+        return false;
+    }
+
+    if(root){
+        // samples in immediate code, outside any word
+        if(root->self)
+            fprintf(w.folded,"(top) %d\n",root->self);
+        ReadLock nameLock(&a->names);
+        w.walk(root,0);
+    }
+    fclose(w.folded);
+
+    // and the per-word table, sorted by self samples
+    if(w.words.count())
+        qsort(w.words.get(0),w.words.count(),sizeof(ProfWord),cmpWords);
+    fprintf(wf,"# %d samples at %d Hz\n",totalSamples,sampleHz);
+    fprintf(wf,"# %8s %8s %8s %8s  word\n","self","total","self(s)","total(s)");
+    for(int i=0;i<w.words.count();i++){
+        ProfWord *p = w.words.get(i);
+        fprintf(wf,"  %8d %8d %8.3f %8.3f  %s\n",p->self,p->total,
+                (double)p->self/sampleHz,(double)p->total/sampleHz,p->name);
+    }
+    fclose(wf);
+    return true;
+}
+
+void Profiler::setOutputFile(const char *filename){
+    if(outputFile)free((void *)outputFile);
+    outputFile = filename ? strdup(filename) : NULL;
+}
+
+void Profiler::finish(Angort *a){
+    if(!outputFile)return;
+    stop();
+    if(!write(a,outputFile))
+        fprintf(stderr,"cannot write profile to %s\n",outputFile);
+    setOutputFile(NULL);
+}
+
+}
@@ -0,0 +1,174 @@
+/**
+ * @file serialise.cpp
+ * @brief  Binary serialisation of values - see serialise.h.
+ *
+ */
+
+#include "angort.h"
+
+namespace angort {
+
+Serialiser::Serialiser(StringBuilder& sb) : b(sb) {
+    ntypes=0;
+    objs=NULL;
+    objcap=nobjs=0;
+    depth=0;
+    b.append(SER_MAGIC,4);
+    char v = SER_VERSION;
+    b.append(&v,1);
+}
+
+Serialiser::~Serialiser(){
+    free(objs);
+}
+
+void Serialiser::writeUInt(unsigned long u){
+    char buf[10];
+    int n=0;
+    while(u>=0x80){
+        buf[n++] = (u&0x7f)|0x80;
+        u>>=7;
+    }
+    buf[n++]=u;
+    writeBytes(buf,n);
+}
+
+static inline unsigned int hashPtr(const void *p,int mask){
+    uint64_t h = (uint64_t)(uintptr_t)p * 0x9e3779b97f4a7c15ULL;
+    return (h>>32)&mask;
+}
+
+int Serialiser::addObject(const void *p){
+    if(nobjs*2>=objcap){
+        // grow and rehash
+        int oldcap = objcap;
+        ObjEnt *old = objs;
+        objcap = oldcap ? oldcap*2 : 64;
+        objs = (ObjEnt *)calloc(objcap,sizeof(ObjEnt));
+        for(int i=0;i<oldcap;i++){
+            if(old[i].p){
+                unsigned int h = hashPtr(old[i].p,objcap-1);
+                while(objs[h].p)
+                    h=(h+1)&(objcap-1);
+                objs[h]=old[i];
+            }
+        }
+        free(old);
+    }
+    unsigned int h = hashPtr(p,objcap-1);
+    while(objs[h].p){
+        if(objs[h].p==p)
+            return objs[h].n;
+        h=(h+1)&(objcap-1);
+    }
+    objs[h].p = p;
+    objs[h].n = nobjs++;
+    return -1;
+}
+
+void Serialiser::write(Value *v){
+    const Type *t = v->t;
+    GarbageCollected *gc = t->getGC(v);
+    if(gc){
+        int n = addObject(gc);
+        if(n>=0){
+            writeUInt(0);
+            writeUInt(n);
+            return;
+        }
+    }
+
+    int *tn = types.ffind(t->id);
+    if(tn)
+        writeUInt(*tn+2);
+    else {
+        writeUInt(1);
+        unsigned char id[4];
+        for(int i=0;i<4;i++)
+            id[i] = (t->id>>(i*8))&0xff;
+        writeBytes(id,4);
+        *types.set(t->id) = ntypes++;
+    }
+
+    if(++depth>SER_MAXDEPTH)
+        throw RUNT(EX_OUTOFRANGE,"ser: values nested too deeply");
+    t->serialise(this,v);
+    depth--;
+}
+
+
+Deserialiser::Deserialiser(const char *data,int len){
+    start=p=data;
+    end=data+len;
+    depth=0;
+    if(len<5 || memcmp(data,SER_MAGIC,4))
+        fail("not serialised data");
+    if(data[4]!=SER_VERSION)
+        fail("unknown version");
+    p+=5;
+}
+
+void Deserialiser::fail(const char *msg){
+    throw RUNT(EX_CORRUPT,"").set("ser: %s at byte %d",msg,(int)(p-start));
+}
+
+unsigned long Deserialiser::readUInt(){
+    unsigned long u=0;
+    for(int shift=0;shift<64;shift+=7){
+        if(p==end)
+            fail("data ends early");
+        unsigned char c = *p++;
+        u |= (unsigned long)(c&0x7f)<<shift;
+        if(!(c&0x80))
+            return u;
+    }
+    fail("bad number");
+    return 0;
+}
+
+int Deserialiser::readCount(int itemsize){
+    unsigned long n = readUInt();
+    if(n > (unsigned long)(end-p)/itemsize)
+        fail("bad length");
+    return (int)n;
+}
+
+void Deserialiser::added(Value *v){
+    objects.append()->copy(v);
+}
+
+void Deserialiser::read(Value *out){
+    unsigned long tag = readUInt();
+    if(!tag){
+        unsigned long n = readUInt();
+        if(n>=(unsigned long)objects.count())
+            fail("bad back-reference");
+        out->copy(objects.get(n));
+        return;
+    }
+
+    const Type *t;
+    if(tag==1){
+        const char *id = readBytes(4);
+        t = Type::getByID(id);
+        if(!t)
+            throw RUNT(EX_NOTFOUND,"").set("ser: unknown type ID %.4s at byte %d",
+                                           id,(int)(p-start));
+        *types.append() = t;
+    } else {
+        if(tag-2 >= (unsigned long)types.count())
+            fail("bad type");
+        t = *types.get(tag-2);
+    }
+
+    if(++depth>SER_MAXDEPTH)
+        fail("values nested too deeply");
+    int n = objects.count();
+    t->deserialise(this,out);
+    // objects which hold no values needn't have added themselves
+    if(objects.count()==n && t->getGC(out))
+        added(out);
+    depth--;
+}
+
+}
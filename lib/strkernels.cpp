@@ -0,0 +1,156 @@
+/** @file
+ * Run-time dispatch of the string kernels - see strkernels.h.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "strkernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SK_X86 1
+#else
+#define SK_X86 0
+#endif
+
+namespace angort {
+namespace strk {
+
+#if SK_X86
+// the SIMD versions, each compiled from strkernels_simd.h
+// in its own file with the right compiler flags.
+#define DECLARE_KERNELS \
+    const char *find(const char *h,int hlen,const char *n,int nlen); \
+    const char *ifind(const char *h,int hlen,const char *n,int nlen); \
+    int findAny(const char *s,int len,const ByteSet& set); \
+    int skipAny(const char *s,int len,const ByteSet& set);
+
+namespace sse2 {
+DECLARE_KERNELS
+}
+namespace avx2 {
+DECLARE_KERNELS
+}
+#endif
+
+static Level detect(){
+#if SK_X86
+    __builtin_cpu_init();
+    // checks the OS saves the AVX state, too.
+    if(__builtin_cpu_supports("avx2"))
+        return SK_AVX2;
+    if(__builtin_cpu_supports("sse2"))
+        return SK_SSE2;
+#endif
+    return SK_SCALAR;
+}
+
+static Level maxLevel = detect();
+static Level level = maxLevel;
+
+Level getLevel(){
+    return level;
+}
+
+Level getMaxLevel(){
+    return maxLevel;
+}
+
+void setLevel(Level l){
+    level = l>maxLevel ? maxLevel : l;
+}
+
+const char *getLevelName(Level l){
+    switch(l){
+    case SK_SCALAR:return "scalar";
+    case SK_SSE2:return "sse2";
+    case SK_AVX2:return "avx2";
+    default:return NULL;
+    }
+}
+
+ByteSet::ByteSet(const char *s,int len){
+    memset(in,0,sizeof(in));
+    n=0;
+    for(int i=0;i<len;i++){
+        unsigned char ch = s[i];
+        if(!in[ch]){
+            in[ch]=true;
+            if(n<SK_MAXSET)
+                c[n]=ch;
+            n++;
+        }
+    }
+}
+
+const ByteSet whitespace(" \t\n\v\f\r",6);
+
+// each of these calls the SIMD version for the current level,
+// or falls through to the scalar code.
+
+#if SK_X86
+#define DISPATCH(call) \
+    switch(level){ \
+    case SK_AVX2:return avx2::call; \
+    case SK_SSE2:return sse2::call; \
+    default:break; \
+    }
+#else
+#define DISPATCH(call)
+#endif
+
+const char *find(const char *h,int hlen,const char *n,int nlen){
+    if(!nlen)
+        return h;
+    if(nlen>hlen)
+        return NULL;
+    // the C library's memchr is already about as fast as it gets
+    if(nlen==1)
+        return (const char *)memchr(h,*n,hlen);
+    DISPATCH(find(h,hlen,n,nlen));
+    return (const char *)memmem(h,hlen,n,nlen);
+}
+
+const char *ifind(const char *h,int hlen,const char *n,int nlen){
+    if(!nlen)
+        return h;
+    if(nlen>hlen)
+        return NULL;
+    if(nlen>1){
+        DISPATCH(ifind(h,hlen,n,nlen));
+    }
+    char f = foldASCII(*n);
+    for(int i=0;i+nlen<=hlen;i++){
+        if(foldASCII(h[i])==f){
+            int k=1;
+            while(k<nlen && foldASCII(h[i+k])==foldASCII(n[k]))k++;
+            if(k==nlen)
+                return h+i;
+        }
+    }
+    return NULL;
+}
+
+int findAny(const char *s,int len,const ByteSet& set){
+    if(set.n==1){
+        const char *p = (const char *)memchr(s,set.c[0],len);
+        return p ? p-s : len;
+    }
+    if(set.n && set.n<=SK_MAXSET){
+        DISPATCH(findAny(s,len,set));
+    }
+    int i=0;
+    while(i<len && !set.in[(unsigned char)s[i]])i++;
+    return i;
+}
+
+int skipAny(const char *s,int len,const ByteSet& set){
+    if(set.n && set.n<=SK_MAXSET){
+        DISPATCH(skipAny(s,len,set));
+    }
+    int i=0;
+    while(i<len && set.in[(unsigned char)s[i]])i++;
+    return i;
+}
+
+}
+}
@@ -0,0 +1,67 @@
+/** @file
+ * Byte-scanning kernels used by the string words: substring search
+ * (with and without ASCII case folding) and finding the first byte
+ * which is, or isn't, in a small set. There are SSE2 and AVX2
+ * implementations (in strkernels_simd.h), and the best one the CPU
+ * supports is chosen at run time, as for the vector kernels.
+ * None of these need the data to be null-terminated, and none read
+ * past the lengths they are given.
+ */
+
+#ifndef __STRKERNELS_H
+#define __STRKERNELS_H
+
+namespace angort {
+namespace strk {
+
+/// SIMD levels, in increasing order of capability
+enum Level {
+    SK_SCALAR,SK_SSE2,SK_AVX2
+};
+
+/// the level currently in use
+Level getLevel();
+/// the best level this CPU supports
+Level getMaxLevel();
+/// use a given level (or the best there is, if that's lower); mostly
+/// for testing the fallbacks.
+void setLevel(Level l);
+/// the name of a level, or NULL if it's not a level
+const char *getLevelName(Level l);
+
+/// sets with more bytes than this are only scanned with the
+/// lookup table
+#define SK_MAXSET 16
+
+/// a set of bytes to search for, as a list of the bytes (which the SIMD
+/// versions compare against one by one) and as a lookup table.
+struct ByteSet {
+    bool in[256];
+    char c[SK_MAXSET];
+    int n; //!< number of bytes in the set, which may be more than SK_MAXSET
+
+    ByteSet(const char *s,int len);
+};
+
+/// the bytes isspace() counts as whitespace in the C locale
+extern const ByteSet whitespace;
+
+/// lowercase an ASCII letter, leaving everything else alone
+inline char foldASCII(char c){
+    return (c>='A' && c<='Z') ? c+('a'-'A') : c;
+}
+
+/// find a needle in a haystack, returning a pointer to the first
+/// match or NULL.
+const char *find(const char *h,int hlen,const char *n,int nlen);
+/// as find, but ignoring the case of ASCII letters
+const char *ifind(const char *h,int hlen,const char *n,int nlen);
+/// return the index of the first byte which is in the set, or len
+int findAny(const char *s,int len,const ByteSet& set);
+/// return the index of the first byte which isn't in the set, or len
+int skipAny(const char *s,int len,const ByteSet& set);
+
+}
+}
+
+#endif /* __STRKERNELS_H */
@@ -0,0 +1,29 @@
+/** @file
+ * AVX2 versions of the string kernels - see strkernels_simd.h.
+ * This file is compiled with -mavx2, so nothing in it may be called
+ * unless the CPU has been found to support AVX2.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <string.h>
+#include <alloca.h>
+#include <immintrin.h>
+#include "strkernels.h"
+
+#define SK_NS avx2
+#define SK_W 32
+#define SK_FULL 0xffffffffU
+#define SK_VEC __m256i
+#define SK_LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define SK_SET1 _mm256_set1_epi8
+#define SK_CMPEQ _mm256_cmpeq_epi8
+#define SK_CMPGT _mm256_cmpgt_epi8
+#define SK_AND _mm256_and_si256
+#define SK_OR _mm256_or_si256
+#define SK_ADD8 _mm256_add_epi8
+#define SK_MOVEMASK(v) ((unsigned int)_mm256_movemask_epi8(v))
+
+#include "strkernels_simd.h"
+
+#endif
@@ -0,0 +1,135 @@
+/** @file
+ * The SIMD string kernels, written once in terms of the SK_ macros
+ * and compiled by strkernels_sse2.cpp and strkernels_avx2.cpp, each of
+ * which defines the macros for its instruction set and the namespace
+ * (SK_NS) to put the kernels in. Only whole blocks of SK_W bytes are
+ * loaded, and the bytes left over at the end are done one by one.
+ *
+ * Substring search compares the first and last bytes of the needle
+ * with a block of the haystack at once, and only checks the rest of
+ * the needle at the positions where both match (W. Mula's "generic
+ * SIMD" algorithm). The dispatcher deals with needles of fewer than
+ * two bytes, and with sets of more than SK_MAXSET bytes.
+ */
+
+namespace angort {
+namespace strk {
+namespace SK_NS {
+
+/// ASCII-lowercase every byte in a block: bytes from 'A' to 'Z' get
+/// 0x20 added. The comparisons are signed, so bytes with the top bit
+/// set are never letters.
+static inline SK_VEC fold(SK_VEC v){
+    SK_VEC upper = SK_AND(SK_CMPGT(v,SK_SET1('A'-1)),SK_CMPGT(SK_SET1('Z'+1),v));
+    return SK_ADD8(v,SK_AND(upper,SK_SET1(0x20)));
+}
+
+static inline bool equalFolded(const char *a,const char *b,int n){
+    for(int i=0;i<n;i++)
+        if(foldASCII(a[i])!=b[i])return false;
+    return true;
+}
+
+const char *find(const char *h,int hlen,const char *n,int nlen){
+    SK_VEC first = SK_SET1(n[0]);
+    SK_VEC last = SK_SET1(n[nlen-1]);
+    int i=0;
+    // the block of last bytes is the furthest we read. Two blocks are
+    // tested at a time while we can, since matches of both bytes are
+    // usually rare.
+    for(;i+nlen-1+2*SK_W<=hlen;i+=2*SK_W){
+        SK_VEC m0 = SK_AND(SK_CMPEQ(SK_LOAD(h+i),first),
+                           SK_CMPEQ(SK_LOAD(h+i+nlen-1),last));
+        SK_VEC m1 = SK_AND(SK_CMPEQ(SK_LOAD(h+i+SK_W),first),
+                           SK_CMPEQ(SK_LOAD(h+i+SK_W+nlen-1),last));
+        if(!SK_MOVEMASK(SK_OR(m0,m1)))
+            continue;
+        unsigned long long m = SK_MOVEMASK(m0) |
+              ((unsigned long long)SK_MOVEMASK(m1)<<SK_W);
+        for(;m;m&=m-1){
+            int b = __builtin_ctzll(m);
+            if(!memcmp(h+i+b+1,n+1,nlen-2))
+                return h+i+b;
+        }
+    }
+    for(;i+nlen-1+SK_W<=hlen;i+=SK_W){
+        SK_VEC bf = SK_LOAD(h+i);
+        SK_VEC bl = SK_LOAD(h+i+nlen-1);
+        unsigned int m = SK_MOVEMASK(SK_AND(SK_CMPEQ(bf,first),SK_CMPEQ(bl,last)));
+        for(;m;m&=m-1){
+            int b = __builtin_ctz(m);
+            if(!memcmp(h+i+b+1,n+1,nlen-2))
+                return h+i+b;
+        }
+    }
+    for(;i+nlen<=hlen;i++)
+        if(h[i]==n[0] && !memcmp(h+i+1,n+1,nlen-1))
+            return h+i;
+    return NULL;
+}
+
+const char *ifind(const char *h,int hlen,const char *n,int nlen){
+    // the needle is folded once, and the haystack as we go
+    char *fn = (char *)alloca(nlen);
+    for(int k=0;k<nlen;k++)
+        fn[k]=foldASCII(n[k]);
+    SK_VEC first = SK_SET1(fn[0]);
+    SK_VEC last = SK_SET1(fn[nlen-1]);
+    int i=0;
+    for(;i+nlen-1+SK_W<=hlen;i+=SK_W){
+        SK_VEC bf = fold(SK_LOAD(h+i));
+        SK_VEC bl = fold(SK_LOAD(h+i+nlen-1));
+        unsigned int m = SK_MOVEMASK(SK_AND(SK_CMPEQ(bf,first),SK_CMPEQ(bl,last)));
+        for(;m;m&=m-1){
+            int b = __builtin_ctz(m);
+            if(equalFolded(h+i+b+1,fn+1,nlen-2))
+                return h+i+b;
+        }
+    }
+    for(;i+nlen<=hlen;i++)
+        if(equalFolded(h+i,fn,nlen))
+            return h+i;
+    return NULL;
+}
+
+/// a mask of the bytes in a block which are in the set
+static inline unsigned int inSet(SK_VEC b,const SK_VEC *sv,int n){
+    SK_VEC m = SK_CMPEQ(b,sv[0]);
+    for(int k=1;k<n;k++)
+        m = SK_OR(m,SK_CMPEQ(b,sv[k]));
+    return SK_MOVEMASK(m);
+}
+
+int findAny(const char *s,int len,const ByteSet& set){
+    SK_VEC sv[SK_MAXSET];
+    for(int k=0;k<set.n;k++)
+        sv[k]=SK_SET1(set.c[k]);
+    int i=0;
+    for(;i+SK_W<=len;i+=SK_W){
+        unsigned int m = inSet(SK_LOAD(s+i),sv,set.n);
+        if(m)
+            return i+__builtin_ctz(m);
+    }
+    for(;i<len;i++)
+        if(set.in[(unsigned char)s[i]])break;
+    return i;
+}
+
+int skipAny(const char *s,int len,const ByteSet& set){
+    SK_VEC sv[SK_MAXSET];
+    for(int k=0;k<set.n;k++)
+        sv[k]=SK_SET1(set.c[k]);
+    int i=0;
+    for(;i+SK_W<=len;i+=SK_W){
+        unsigned int m = ~inSet(SK_LOAD(s+i),sv,set.n) & SK_FULL;
+        if(m)
+            return i+__builtin_ctz(m);
+    }
+    for(;i<len;i++)
+        if(!set.in[(unsigned char)s[i]])break;
+    return i;
+}
+
+}
+}
+}
@@ -0,0 +1,27 @@
+/** @file
+ * SSE2 versions of the string kernels - see strkernels_simd.h.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <string.h>
+#include <alloca.h>
+#include <emmintrin.h>
+#include "strkernels.h"
+
+#define SK_NS sse2
+#define SK_W 16
+#define SK_FULL 0xffffU
+#define SK_VEC __m128i
+#define SK_LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+#define SK_SET1 _mm_set1_epi8
+#define SK_CMPEQ _mm_cmpeq_epi8
+#define SK_CMPGT _mm_cmpgt_epi8
+#define SK_AND _mm_and_si128
+#define SK_OR _mm_or_si128
+#define SK_ADD8 _mm_add_epi8
+#define SK_MOVEMASK _mm_movemask_epi8
+
+#include "strkernels_simd.h"
+
+#endif
@@ -1,6 +1,9 @@
 #include "angort.h"
 #include "cycle.h"
 
+#include <unistd.h>
+#include <sys/mman.h>
+
 namespace angort {
 
 Type *Type::head=NULL;
@@ -57,6 +60,18 @@ void Type::clone(Value *out,const Value *in,bool deep)const{
     out->copy(in);
 }
 
+void Type::serialise(Serialiser *s,Value *v)const{
+    throw RUNT(EX_NOTSUP,"").set("cannot serialise values of type %s",name);
+}
+
+void Type::deserialise(Deserialiser *d,Value *out)const{
+    throw RUNT(EX_NOTSUP,"").set("cannot deserialise values of type %s",name);
+}
+
+void NoneType::deserialise(Deserialiser *d,Value *out)const{
+    out->clr();
+}
+
 void Type::add(const char *_name,const char *_id){
     if(getByName(_name))
         throw Exception(EX_DEFINED).set("type already exists: %s",name);
@@ -112,11 +127,47 @@ char *BlockAllocType::allocate(Value *v,int len,const Type *type)const{
     v->clr();
     BlockAllocHeader *h = (BlockAllocHeader *)malloc(len+sizeof(BlockAllocHeader));
     h->refct=1;
+    h->flags=0;
+    h->bytes=h->chars=-1;
+    h->index=NULL;
+    h->views=NULL;
     v->v.block = h;
     v->t = type;
     return (char *)(h+1);
 }
 
+BlockAllocHeader *BlockAllocType::mapFile(int fd,int len){
+    long page = sysconf(_SC_PAGESIZE);
+    // reserve room for the header page and the file, then map the
+    // file over all but the first page.
+    char *base = (char *)mmap(NULL,page+len,PROT_READ|PROT_WRITE,
+                              MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+    if(base==MAP_FAILED)
+        return NULL;
+    if(mmap(base+page,len,PROT_READ,MAP_PRIVATE|MAP_FIXED,fd,0)==MAP_FAILED){
+        munmap(base,page+len);
+        return NULL;
+    }
+    BlockAllocHeader *h = (BlockAllocHeader *)(base+page)-1;
+    h->refct=1;
+    h->flags=BAH_MAPPED;
+    h->bytes=len;
+    h->chars=-1;
+    h->index=NULL;
+    h->views=NULL;
+    return h;
+}
+
+/// free a block whose refcount has reached zero
+static void freeBlock(BlockAllocHeader *h){
+    free(h->index);
+    if(h->flags & BAH_MAPPED){
+        long page = sysconf(_SC_PAGESIZE);
+        munmap((char *)(h+1)-page,page+h->bytes);
+    } else
+        free(h);
+}
+
 int Type::getIndexOfContainedItem(Value *v,Value *item)const{
     Iterator<Value *> *iter = makeIterator(v); // will throw for non-iterables
     int i=0;
@@ -141,18 +192,17 @@ void BlockAllocType::incRef(Value *v)const{
     h->refct++;
     tdprintf("INCREF STR to %d: %p%s\n",h->refct,getData(v),getData(v));
     if(!h->refct)
-        h->refct=0xffff; // MAX REFCOUNT is never freed!
+        h->refct=BAH_MAXREF; // MAX REFCOUNT is never freed!
     //        throw RUNT("reference count too large");
 }
     
 void BlockAllocType::decRef(Value *v)const{
     WriteLock lock=WL(&globalLock);
     BlockAllocHeader *h = v->v.block;
-    if(h->refct!=0xffff)h->refct--; // MAX REFCOUNT is never freed!
+    if(h->refct!=BAH_MAXREF)h->refct--; // MAX REFCOUNT is never freed!
     tdprintf("DECREF STR to %d: %p%s\n",h->refct,getData(v),getData(v));
-    if(h->refct==0){
-        free(h);
-    }
+    if(h->refct==0)
+        freeBlock(h);
 }
 
 void GCType::incRef(Value *v)const{
@@ -273,6 +323,35 @@ LongType *Types::tLong = &_Long;
 static DoubleType _Double;
 DoubleType *Types::tDouble = &_Double;
 
+static NumVecType<int> _I32;
+NumVecType<int> *Types::tI32 = &_I32;
+static NumVecType<long> _I64;
+NumVecType<long> *Types::tI64 = &_I64;
+static NumVecType<float> _F32;
+NumVecType<float> *Types::tF32 = &_F32;
+static NumVecType<double> _F64;
+NumVecType<double> *Types::tF64 = &_F64;
+
+static LazyType _Lazy;
+LazyType *Types::tLazy = &_Lazy;
+
+static PVecType _PVec;
+PVecType *Types::tPVec = &_PVec;
+static PMapType _PMap;
+PMapType *Types::tPMap = &_PMap;
+
+static OMapType _OMap;
+OMapType *Types::tOMap = &_OMap;
+static OMapRangeType _OMapRange;
+OMapRangeType *Types::tOMapRange = &_OMapRange;
+
+static StrBuildType _StrBuild;
+StrBuildType *Types::tStrBuild = &_StrBuild;
+static StrViewType _StrView;
+StrViewType *Types::tStrView = &_StrView;
+static FileType _File;
+FileType *Types::tFile = &_File;
+
 
 
 static IteratorType _Iterator;
@@ -75,4 +75,14 @@ void DoubleType::increment(Value *v,int step) const {
     v->v.df += step;
 }
 
+void DoubleType::serialise(Serialiser *s,Value *v)const{
+    s->writeBytes(&v->v.df,sizeof(double));
+}
+
+void DoubleType::deserialise(Deserialiser *d,Value *out)const{
+    double f;
+    memcpy(&f,d->readBytes(sizeof(double)),sizeof(double));
+    set(out,f);
+}
+
 }
@@ -0,0 +1,322 @@
+/**
+ * @file file.cpp
+ * @brief  Buffered files - see file.h.
+ *
+ */
+
+#include "angort.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace angort {
+
+/// files smaller than this are read rather than mapped, as mapping
+/// costs more than copying them.
+#define FILE_MAPMIN 65536
+
+/// files open for writing, most recently opened first
+static FileObject *writers=NULL;
+/// not globalLock, which is held while a file is deleted
+static Lockable writersLock("writers");
+
+class FileLineIterator : public Iterator<Value *> {
+    FileObject *f;
+    Value line;
+    bool done;
+    int idx;
+public:
+    FileLineIterator(FileObject *file){
+        f=file;
+        done=false;
+        idx=0;
+    }
+    // a file can't be rewound (it may be a pipe), so "first" just
+    // gets the next line.
+    virtual void first(){
+        idx=0;
+        done = !f->readLine(&line);
+    }
+    virtual void next(){
+        idx++;
+        done = !f->readLine(&line);
+    }
+    virtual bool isDone() const {
+        return done;
+    }
+    virtual Value *current(){
+        return &line;
+    }
+    virtual int index() const {
+        return idx;
+    }
+};
+
+FileObject::FileObject(int _fd,bool r,bool w,bool owns) : GarbageCollected("file"){
+    fd=_fd;
+    canRead=r;
+    canWrite=w;
+    ownsFD=owns;
+    eof=false;
+    rbuf=NULL;
+    rcap=rpos=rlen=0;
+    wbuf=NULL;
+    wlen=0;
+    
+    prevWriter=NULL;
+    nextWriter=NULL;
+    if(canWrite){
+        WriteLock lock=WL(&writersLock);
+        nextWriter=writers;
+        if(writers)
+            writers->prevWriter=this;
+        writers=this;
+    }
+}
+
+FileObject::~FileObject(){
+    try {
+        close();
+    } catch(Exception& e){
+        // can't throw from here, so the data is lost
+        fprintf(stderr,"error closing file: %s\n",e.what());
+    }
+    free(rbuf);
+    free(wbuf);
+}
+
+void FileObject::check(bool ok,const char *what){
+    if(fd<0)
+        throw RUNT(EX_FAILED,"").set("cannot %s: file is closed",what);
+    if(!ok)
+        throw RUNT(EX_FAILED,"").set("cannot %s: file is not open for it",what);
+}
+
+void FileObject::close(){
+    if(fd<0)
+        return;
+    if(canWrite){
+        WriteLock lock=WL(&writersLock);
+        if(prevWriter)
+            prevWriter->nextWriter=nextWriter;
+        else
+            writers=nextWriter;
+        if(nextWriter)
+            nextWriter->prevWriter=prevWriter;
+    }
+    int f = fd;
+    try {
+        flush();
+    } catch(Exception& e){
+        fd=-1;
+        if(ownsFD)::close(f);
+        throw;
+    }
+    fd=-1;
+    if(ownsFD && ::close(f)<0)
+        throw RUNT(EX_FAILED,"").set("close failed: %s",strerror(errno));
+}
+
+void FileObject::flush(){
+    int done=0;
+    while(done<wlen){
+        int n = ::write(fd,wbuf+done,wlen-done);
+        if(n<0){
+            if(errno==EINTR)continue;
+            wlen=0;
+            throw RUNT(EX_FAILED,"").set("write failed: %s",strerror(errno));
+        }
+        done+=n;
+    }
+    wlen=0;
+}
+
+void FileObject::flushAll(){
+    WriteLock lock=WL(&writersLock);
+    for(FileObject *f=writers;f;f=f->nextWriter){
+        try {
+            f->flush();
+        } catch(Exception& e){
+            fprintf(stderr,"error flushing file: %s\n",e.what());
+        }
+    }
+}
+
+void FileObject::fill(){
+    if(rpos==rlen)
+        rpos=rlen=0;
+    else if(rpos>0){
+        // move what's left to the start
+        memmove(rbuf,rbuf+rpos,rlen-rpos);
+        rlen-=rpos;
+        rpos=0;
+    }
+    if(rlen==rcap){
+        rcap = rcap ? rcap*2 : FILE_BUFSIZE;
+        rbuf = (char *)realloc(rbuf,rcap);
+    }
+    for(;;){
+        int n = ::read(fd,rbuf+rlen,rcap-rlen);
+        if(n<0){
+            if(errno==EINTR)continue;
+            throw RUNT(EX_FAILED,"").set("read failed: %s",strerror(errno));
+        }
+        if(!n)
+            eof=true;
+        rlen+=n;
+        return;
+    }
+}
+
+void FileObject::dropReadBuffer(){
+    if(rpos<rlen)
+        lseek(fd,rpos-rlen,SEEK_CUR);
+    rpos=rlen=0;
+    eof=false;
+}
+
+bool FileObject::nextLine(const char **line,int *len){
+    check(canRead,"read");
+    if(wlen)flush();
+    int scanned=0; // bytes after rpos already known not to be newlines
+    for(;;){
+        const char *s = rbuf+rpos;
+        const char *nl = rlen-rpos>scanned ?
+              (const char *)memchr(s+scanned,'\n',rlen-rpos-scanned) : NULL;
+        if(nl){
+            *line = s;
+            *len = nl-s;
+            rpos += (nl-s)+1;
+            return true;
+        }
+        scanned = rlen-rpos;
+        if(eof){
+            // the last line may not have a newline
+            if(!scanned)
+                return false;
+            *line = s;
+            *len = scanned;
+            rpos=rlen;
+            return true;
+        }
+        fill();
+    }
+}
+
+bool FileObject::readLine(Value *out){
+    const char *s;
+    int len;
+    if(!nextLine(&s,&len))
+        return false;
+    Types::tString->setwithlen(out,s,len);
+    return true;
+}
+
+bool FileObject::readBytes(Value *out,int n){
+    check(canRead,"read");
+    if(wlen)flush();
+    while(rlen-rpos<n && !eof)
+        fill();
+    int len = rlen-rpos;
+    if(len>n)
+        len=n;
+    if(!len)
+        return false;
+    Types::tString->setwithlen(out,rbuf+rpos,len);
+    rpos+=len;
+    return true;
+}
+
+void FileObject::write(const char *s,int n){
+    check(canWrite,"write");
+    if(rlen)dropReadBuffer();
+    if(!wbuf)
+        wbuf = (char *)malloc(FILE_BUFSIZE);
+    if(wlen+n > FILE_BUFSIZE){
+        flush();
+        // big writes don't go through the buffer at all
+        if(n >= FILE_BUFSIZE){
+            while(n>0){
+                int w = ::write(fd,s,n);
+                if(w<0){
+                    if(errno==EINTR)continue;
+                    throw RUNT(EX_FAILED,"").set("write failed: %s",strerror(errno));
+                }
+                s+=w;
+                n-=w;
+            }
+            return;
+        }
+    }
+    memcpy(wbuf+wlen,s,n);
+    wlen+=n;
+}
+
+bool FileObject::atEOF(){
+    check(canRead,"read");
+    if(wlen)flush();
+    if(rpos==rlen && !eof)
+        fill();
+    return rpos==rlen;
+}
+
+Iterator<Value *> *FileObject::makeValueIterator()const{
+    return new FileLineIterator(const_cast<FileObject *>(this));
+}
+
+FileObject *FileType::get(Value *v)const{
+    if(v->t != this)
+        throw RUNT(EX_TYPE,"").set("not a file stream, is a %s",v->t->name);
+    return (FileObject *)v->v.gc;
+}
+
+FileObject *FileType::set(Value *v,int fd,bool r,bool w,bool owns)const{
+    FileObject *o = new FileObject(fd,r,w,owns);
+    v->clr();
+    v->t = this;
+    v->v.gc = o;
+    incRef(v);
+    return o;
+}
+
+void FileType::readFile(Value *out,const char *path)const{
+    int fd = open(path,O_RDONLY);
+    if(fd<0)
+        throw RUNT(EX_FAILED,"").set("cannot open %s: %s",path,strerror(errno));
+    struct stat st;
+    if(!fstat(fd,&st) && S_ISREG(st.st_mode) && st.st_size>=FILE_MAPMIN){
+        if(st.st_size>0x7fffffff){
+            ::close(fd);
+            throw RUNT(EX_OUTOFRANGE,"").set("%s is too big to read as a string",path);
+        }
+        BlockAllocHeader *h = BlockAllocType::mapFile(fd,st.st_size);
+        if(h){
+            ::close(fd);
+            Types::tStrView->set(out,h,0,st.st_size,-1);
+            // the view has its own reference, so drop ours
+            Value p;
+            Types::tString->setPreAllocated(&p,h);
+            return;
+        }
+    }
+    // small files, and things like pipes which can't be mapped
+    StringBuilder b;
+    char buf[FILE_BUFSIZE];
+    for(;;){
+        int n = ::read(fd,buf,FILE_BUFSIZE);
+        if(n<0){
+            if(errno==EINTR)continue;
+            int e = errno;
+            ::close(fd);
+            throw RUNT(EX_FAILED,"").set("cannot read %s: %s",path,strerror(e));
+        }
+        if(!n)break;
+        b.append(buf,n);
+    }
+    ::close(fd);
+    Types::tString->setwithlen(out,b.get(),b.length());
+}
+
+}
@@ -81,4 +81,14 @@ void FloatType::increment(Value *v,int step) const {
     v->v.f += step;
 }
 
+void FloatType::serialise(Serialiser *s,Value *v)const{
+    s->writeBytes(&v->v.f,sizeof(float));
+}
+
+void FloatType::deserialise(Deserialiser *d,Value *out)const{
+    float f;
+    memcpy(&f,d->readBytes(sizeof(float)),sizeof(float));
+    set(out,f);
+}
+
 }
@@ -202,4 +202,26 @@ void HashType::clone(Value *out,const Value *in,bool deep)const{
     incRef(out);
 }
 
+void HashType::serialise(Serialiser *s,Value *v)const{
+    Hash *h = get(v);
+    ReadLock lock(h);
+    s->writeUInt(h->count());
+    for(int i=h->nextUsed(0);i>=0;i=h->nextUsed(i+1)){
+        s->write(h->keyAt(i));
+        s->write(h->valAt(i));
+    }
+}
+
+void HashType::deserialise(Deserialiser *d,Value *out)const{
+    int n = d->readCount(2);
+    Hash *h = set(out);
+    d->added(out);
+    Value k,v;
+    for(int i=0;i<n;i++){
+        d->read(&k);
+        d->read(&v);
+        h->set(&k,&v);
+    }
+}
+
 }
@@ -121,5 +121,17 @@ Iterator<Value *> *IntegerType::makeValueIterator(Value *v)const{
     return new IntegerIterator(v);
 }
 
+int IntegerType::getSizeHint(Value *v)const{
+    // n iterates from 0 to n-1, or down to n+1 if negative
+    return v->v.i<0 ? -v->v.i : v->v.i;
+}
+
+void IntegerType::serialise(Serialiser *s,Value *v)const{
+    s->writeInt(v->v.i);
+}
+
+void IntegerType::deserialise(Deserialiser *d,Value *out)const{
+    set(out,(int)d->readInt());
+}
 
 }
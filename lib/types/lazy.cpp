@@ -0,0 +1,333 @@
+/**
+ * @file lazy.cpp
+ * @brief  Lazy iterator pipelines - see lazy.h.
+ *
+ */
+
+#include "angort.h"
+#include "cycle.h"
+
+namespace angort {
+
+LazyObject::LazyObject() : GarbageCollected("lazy") {
+    src = new Value;
+    src2 = new Value;
+    func = new Value;
+}
+
+LazyObject::~LazyObject(){
+    delete src;
+    delete src2;
+    delete func;
+}
+
+/// The base class for the iterators which run each kind of stage.
+/// Each stage only moves its source on when it is asked for its next
+/// item, so no item is worked out before it's needed (take won't run
+/// a map function on the item after the last one it takes, for example).
+class LazyIterator : public Iterator<Value *> {
+protected:
+    LazyObject *obj; //!< the stage we're running
+    Iterator<Value *> *src; //!< iterator over the stage's source
+    Value cur; //!< the current item
+    int idx; //!< the number of items we've moved past
+    bool done;
+    bool started; //!< true once the first item has been fetched
+
+    /// move the source to its next item, unless this is the first
+    /// fetch after first(), in which case it's already on its first.
+    void advanceSource(){
+        if(started)
+            src->next();
+        started=true;
+    }
+
+    /// fetch the next item into cur, returning false if there are none.
+    virtual bool fetch()=0;
+    /// the runtime to run map and filter functions in: that of
+    /// whoever is pulling items through the pipeline, which need not
+    /// be the one which built it.
+    Runtime *getRuntime(){
+        Runtime *a = Runtime::getCurrent();
+        if(!a)
+            throw RUNT(EX_NOTREADY,"lazy pipeline run outside any runtime");
+        return a;
+    }
+    /// reset to the start; the default rewinds the source.
+    virtual void reset(){
+        src->first();
+    }
+
+public:
+    LazyIterator(const LazyObject *o){
+        obj = (LazyObject *)o;
+        obj->incRefCt();
+        src = obj->src->t->makeIterator(obj->src);
+        idx=0;
+        done=true;
+        started=false;
+    }
+    virtual ~LazyIterator(){
+        delete src;
+        cur.clr();
+        if(obj->decRefCt())
+            delete obj;
+    }
+
+    virtual void first(){
+        idx=0;
+        started=false;
+        reset();
+        done = !fetch();
+    }
+    virtual void next(){
+        idx++;
+        done = !fetch();
+    }
+    virtual bool isDone() const{
+        return done;
+    }
+    virtual Value *current(){
+        return &cur;
+    }
+    virtual int index() const {
+        return idx;
+    }
+};
+
+/// applies a function to each item
+class LazyMapIterator : public LazyIterator {
+public:
+    LazyMapIterator(const LazyObject *o) : LazyIterator(o){}
+    virtual bool fetch(){
+        advanceSource();
+        if(src->isDone())
+            return false;
+        Runtime *a = getRuntime();
+        a->pushval()->copy(src->current());
+        a->runValue(obj->func);
+        cur.copy(a->popval());
+        return true;
+    }
+};
+
+/// passes on only those items for which a function returns true
+class LazyFilterIterator : public LazyIterator {
+public:
+    LazyFilterIterator(const LazyObject *o) : LazyIterator(o){}
+    virtual bool fetch(){
+        Runtime *a = getRuntime();
+        for(;;){
+            advanceSource();
+            if(src->isDone())
+                return false;
+            cur.copy(src->current());
+            a->pushval()->copy(&cur);
+            a->runValue(obj->func);
+            if(a->popval()->toBool())
+                return true;
+        }
+    }
+};
+
+/// passes on the first n items
+class LazyTakeIterator : public LazyIterator {
+    int taken;
+public:
+    LazyTakeIterator(const LazyObject *o) : LazyIterator(o){}
+    virtual void reset(){
+        taken=0;
+        // don't even start the source if we're taking nothing
+        if(obj->n>0)
+            src->first();
+    }
+    virtual bool fetch(){
+        if(taken>=obj->n)
+            return false;
+        advanceSource();
+        if(src->isDone())
+            return false;
+        cur.copy(src->current());
+        taken++;
+        return true;
+    }
+};
+
+/// skips the first n items
+class LazyDropIterator : public LazyIterator {
+public:
+    LazyDropIterator(const LazyObject *o) : LazyIterator(o){}
+    virtual void reset(){
+        src->first();
+        for(int i=0;i<obj->n && !src->isDone();i++)
+            src->next();
+    }
+    virtual bool fetch(){
+        advanceSource();
+        if(src->isDone())
+            return false;
+        cur.copy(src->current());
+        return true;
+    }
+};
+
+/// makes [index,item] pairs
+class LazyEnumerateIterator : public LazyIterator {
+public:
+    LazyEnumerateIterator(const LazyObject *o) : LazyIterator(o){}
+    virtual bool fetch(){
+        advanceSource();
+        if(src->isDone())
+            return false;
+        ArrayList<Value> *list = Types::tList->set(&cur);
+        Types::tInteger->set(list->append(),idx);
+        list->append()->copy(src->current());
+        return true;
+    }
+};
+
+/// base for the stages which pull from two sources
+class LazyIterator2 : public LazyIterator {
+protected:
+    Iterator<Value *> *src2;
+public:
+    LazyIterator2(const LazyObject *o) : LazyIterator(o){
+        src2 = obj->src2->t->makeIterator(obj->src2);
+    }
+    virtual ~LazyIterator2(){
+        delete src2;
+    }
+};
+
+/// makes [a,b] pairs from two sources, stopping when either runs out
+class LazyZipIterator : public LazyIterator2 {
+public:
+    LazyZipIterator(const LazyObject *o) : LazyIterator2(o){}
+    virtual void reset(){
+        src->first();
+        src2->first();
+    }
+    virtual bool fetch(){
+        if(started)
+            src2->next();
+        advanceSource();
+        if(src->isDone() || src2->isDone())
+            return false;
+        ArrayList<Value> *list = Types::tList->set(&cur);
+        list->append()->copy(src->current());
+        list->append()->copy(src2->current());
+        return true;
+    }
+};
+
+/// all the items of one source and then all those of another
+class LazyChainIterator : public LazyIterator2 {
+    bool onSecond;
+public:
+    LazyChainIterator(const LazyObject *o) : LazyIterator2(o){}
+    virtual void reset(){
+        onSecond=false;
+        src->first();
+    }
+    virtual bool fetch(){
+        if(!onSecond){
+            advanceSource();
+            if(!src->isDone()){
+                cur.copy(src->current());
+                return true;
+            }
+            // first source is finished, start the second
+            onSecond=true;
+            src2->first();
+        } else
+            src2->next();
+        if(src2->isDone())
+            return false;
+        cur.copy(src2->current());
+        return true;
+    }
+};
+
+Iterator<Value *> *LazyObject::makeValueIterator()const{
+    switch(kind){
+    case LZ_MAP:return new LazyMapIterator(this);
+    case LZ_FILTER:return new LazyFilterIterator(this);
+    case LZ_TAKE:return new LazyTakeIterator(this);
+    case LZ_DROP:return new LazyDropIterator(this);
+    case LZ_ZIP:return new LazyZipIterator(this);
+    case LZ_CHAIN:return new LazyChainIterator(this);
+    case LZ_ENUMERATE:return new LazyEnumerateIterator(this);
+    default:throw WTF;
+    }
+}
+
+/// iterates over the values held by a stage, for the cycle detector
+class LazyGCIterator : public Iterator<Value *> {
+    LazyObject *obj;
+    int idx;
+public:
+    LazyGCIterator(LazyObject *o){
+        obj=o;
+        obj->incRefCt();
+        idx=0;
+    }
+    virtual ~LazyGCIterator(){
+        if(obj->decRefCt())
+            delete obj;
+    }
+    virtual void first(){
+        idx=0;
+    }
+    virtual void next(){
+        idx++;
+    }
+    virtual bool isDone() const{
+        return idx>=3;
+    }
+    virtual Value *current(){
+        switch(idx){
+        case 0:return obj->src;
+        case 1:return obj->src2;
+        default:return obj->func;
+        }
+    }
+    virtual int index() const {
+        return idx;
+    }
+};
+
+Iterator<Value *> *LazyObject::makeGCValueIterator(){
+    return new LazyGCIterator(this);
+}
+
+void LazyObject::wipeContents(){
+    src->wipeIfInGCCycle();
+    src2->wipeIfInGCCycle();
+    func->wipeIfInGCCycle();
+}
+
+/// throw if a value can't be iterated over; this is the only sure way
+/// to tell, since strings (for example) don't have TF_ITERABLE.
+static void checkIterable(Value *v){
+    delete v->t->makeIterator(v);
+}
+
+LazyObject *LazyType::set(Value *v,int kind,Value *src,Value *src2)const{
+    checkIterable(src);
+    if(src2)
+        checkIterable(src2);
+    LazyObject *o = new LazyObject();
+    o->kind = kind;
+    o->n = 0;
+    // copy these before we clear v, which might be one of them
+    o->src->copy(src);
+    if(src2)
+        o->src2->copy(src2);
+    v->clr();
+    v->t = this;
+    v->v.gc = o;
+    incRef(v);
+    return o;
+}
+
+}
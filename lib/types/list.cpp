@@ -13,6 +13,10 @@ ListObject::ListObject() : GarbageCollected("list"), list(32) {
     dprintf("LISTOBJECT create at %p\n",this);
 }
 
+ListObject::ListObject(int capacity) : GarbageCollected("list"), list(capacity) {
+    dprintf("LISTOBJECT create at %p\n",this);
+}
+
 ListObject::~ListObject(){
     dprintf("LISTOBJECT delete at %p\n",this);
 }
@@ -38,6 +42,13 @@ ArrayList<Value> *ListType::set(Value *v)const{
     return &p->list;
 }
 
+ArrayList<Value> *ListType::set(Value *v,int capacity)const{
+    // never smaller than a default list
+    ListObject *p = new ListObject(capacity>32 ? capacity : 32);
+    set(v,p);
+    return &p->list;
+}
+
 ArrayList<Value> *ListType::get(Value *v)const{
     if(v->t != this)
         throw RUNT("ex$nolist","not a list");
@@ -219,4 +230,21 @@ void ListType::clone(Value *out,const Value *in,bool deep)const{
     set(out,p);
 }
 
+void ListType::serialise(Serialiser *s,Value *v)const{
+    ArrayList<Value> *list = get(v);
+    ReadLock lock(list);
+    int n = list->count();
+    s->writeUInt(n);
+    for(int i=0;i<n;i++)
+        s->write(list->get(i));
+}
+
+void ListType::deserialise(Deserialiser *d,Value *out)const{
+    int n = d->readCount(1);
+    ArrayList<Value> *list = set(out,n);
+    d->added(out);
+    for(int i=0;i<n;i++)
+        d->read(list->append());
+}
+
 }
@@ -121,5 +121,12 @@ Iterator<Value *> *LongType::makeValueIterator(Value *v)const{
     return new LongIterator(v);
 }
 
+void LongType::serialise(Serialiser *s,Value *v)const{
+    s->writeInt(v->v.l);
+}
+
+void LongType::deserialise(Deserialiser *d,Value *out)const{
+    set(out,d->readInt());
+}
 
 }
@@ -0,0 +1,252 @@
+/**
+ * @file numvec.cpp
+ * @brief  Packed numeric vector types - see numvec.h.
+ *
+ */
+
+#include "angort.h"
+
+namespace angort {
+
+template<> NumVecType<int>::NumVecType(){
+    add("i32","VI32");
+}
+template<> NumVecType<long>::NumVecType(){
+    add("i64","VI64");
+}
+template<> NumVecType<float>::NumVecType(){
+    add("f32","VF32");
+}
+template<> NumVecType<double>::NumVecType(){
+    add("f64","VF64");
+}
+
+template<> void NumVecType<int>::toValue(Value *out,int x){
+    Types::tInteger->set(out,x);
+}
+template<> void NumVecType<long>::toValue(Value *out,long x){
+    Types::tLong->set(out,x);
+}
+template<> void NumVecType<float>::toValue(Value *out,float x){
+    Types::tFloat->set(out,x);
+}
+template<> void NumVecType<double>::toValue(Value *out,double x){
+    Types::tDouble->set(out,x);
+}
+
+template<> int NumVecType<int>::fromValue(Value *v){
+    return v->toInt();
+}
+template<> long NumVecType<long>::fromValue(Value *v){
+    return v->toLong();
+}
+template<> float NumVecType<float>::fromValue(Value *v){
+    return v->toFloat();
+}
+template<> double NumVecType<double>::fromValue(Value *v){
+    return v->toDouble();
+}
+
+
+/// iterates over a vector, making values from the items
+template <class T> class NumVecIterator : public Iterator<Value *>{
+    Value v; //!< the current value, as an actual value
+    int idx; //!< current index
+    bool isKey;
+    NumVec<T> *vec; //!< the vector we're iterating over
+public:
+    NumVecIterator(const NumVec<T> *nv,bool iskeyiterator){
+        idx=0;
+        isKey = iskeyiterator;
+        vec = (NumVec<T> *)nv;
+        vec->incRefCt();
+    }
+
+    virtual ~NumVecIterator(){
+        if(vec->decRefCt())
+            delete vec;
+    }
+
+    virtual void first(){
+        idx=0;
+    }
+    virtual void next(){
+        idx++;
+    }
+    virtual bool isDone() const{
+        return idx>=vec->list.count();
+    }
+    virtual Value *current(){
+        if(isKey)
+            Types::tInteger->set(&v,idx);
+        else {
+            ReadLock lock(&vec->list);
+            NumVecType<T>::toValue(&v,*vec->list.get(idx));
+        }
+        return &v;
+    }
+    virtual int index() const {
+        return idx;
+    }
+};
+
+template <class T> Iterator<Value *> *NumVec<T>::makeValueIterator()const{
+    return new NumVecIterator<T>(this,false);
+}
+template <class T> Iterator<Value *> *NumVec<T>::makeKeyIterator()const{
+    return new NumVecIterator<T>(this,true);
+}
+
+template <class T> void NumVecType<T>::set(Value *v,NumVec<T> *nv)const{
+    v->clr();
+    v->t = this;
+    v->v.gc = nv;
+    incRef(v);
+}
+
+template <class T> ArrayList<T> *NumVecType<T>::set(Value *v)const{
+    NumVec<T> *nv = new NumVec<T>();
+    set(v,nv);
+    return &nv->list;
+}
+
+template <class T> ArrayList<T> *NumVecType<T>::get(Value *v)const{
+    if(v->t != this)
+        throw RUNT(EX_TYPE,"").set("not a %s vector",name);
+    return &((NumVec<T> *)v->v.gc)->list;
+}
+
+template <class T> void NumVecType<T>::setValue(Value *coll,Value *k,Value *v)const{
+    ArrayList<T> *list = get(coll);
+    WriteLock lock=WL(list);
+    int i = k->toInt();
+    *list->set(i) = fromValue(v);
+}
+
+template <class T> void NumVecType<T>::getValue(Value *coll,Value *k,Value *result)const{
+    ArrayList<T> *list = get(coll);
+    ReadLock lock(list);
+    int i = k->toInt();
+    toValue(result,*list->get(i));
+}
+
+template <class T> void NumVecType<T>::getItem(Value *coll,int n,Value *out)const{
+    toValue(out,*(((NumVec<T> *)coll->v.gc)->list.get(n)));
+}
+
+template <class T> int NumVecType<T>::getCount(Value *coll)const{
+    ArrayList<T> *list = get(coll);
+    ReadLock lock(list);
+    return list->count();
+}
+
+template <class T> void NumVecType<T>::removeAndReturn(Value *coll,Value *k,Value *result)const{
+    ArrayList<T> *list = get(coll);
+    WriteLock lock=WL(list);
+    int i = k->toInt();
+    // will throw if out of range
+    toValue(result,*list->get(i));
+    list->remove(i);
+}
+
+template <class T> void NumVecType<T>::slice(Value *out,Value *coll,int startin,int endin)const{
+    NumVec<T> *nv = new NumVec<T>();
+    ArrayList<T> *list = get(coll);
+    {
+        ReadLock lock(list);
+        int start,end;
+        if(getSliceEndpoints(&start,&end,list->count(),startin,endin)){
+            for(int i=start;i<end;i++)
+                *nv->list.append() = *list->get(i);
+        }
+    }
+    set(out,nv);
+}
+
+template <class T> void NumVecType<T>::clone(Value *out,const Value *in,bool deep)const{
+    // the items aren't references, so deep and shallow are the same
+    NumVec<T> *nv = new NumVec<T>();
+    ArrayList<T> *list = get(const_cast<Value *>(in));
+    {
+        ReadLock lock(list);
+        int n = list->count();
+        if(n){
+            nv->list.set(n-1);
+            memcpy(nv->list.get(0),list->get(0),n*sizeof(T));
+        }
+    }
+    set(out,nv);
+}
+
+template <class T> void NumVecType<T>::serialise(Serialiser *s,Value *v)const{
+    ArrayList<T> *list = get(v);
+    ReadLock lock(list);
+    int n = list->count();
+    if((long)n*sizeof(T) > SER_MAXSIZE)
+        throw RUNT(EX_OUTOFRANGE,"ser: data too big");
+    s->writeUInt(n);
+    if(n)
+        s->writeBytes(list->get(0),n*sizeof(T));
+}
+
+template <class T> void NumVecType<T>::deserialise(Deserialiser *d,Value *out)const{
+    int n = d->readCount(sizeof(T));
+    NumVec<T> *nv = new NumVec<T>();
+    if(n){
+        nv->list.set(n-1);
+        memcpy(nv->list.get(0),d->readBytes(n*sizeof(T)),n*sizeof(T));
+    }
+    set(out,nv);
+}
+
+template <class T> void NumVecType<T>::create(Value *out,int n)const{
+    NumVec<T> *nv = new NumVec<T>();
+    if(n>0)
+        nv->list.set(n-1); // fills with zeroes
+    set(out,nv);
+}
+
+template <class T> void NumVecType<T>::fromIterable(Value *out,Value *in)const{
+    if(in->t == this){
+        clone(out,in);
+        return;
+    }
+
+    Iterator<Value *> *iter = in->t->makeIterator(in);
+    NumVec<T> *nv = new NumVec<T>();
+    try {
+        for(iter->first();!iter->isDone();iter->next())
+            *nv->list.append() = fromValue(iter->current());
+    } catch(Exception& e){
+        delete iter;
+        delete nv;
+        throw;
+    }
+    delete iter;
+    set(out,nv);
+}
+
+template <class T> static int cmpAscending(const void *a,const void *b){
+    T x = *(const T *)a;
+    T y = *(const T *)b;
+    return x<y ? -1 : (x>y ? 1 : 0);
+}
+
+template <class T> static int cmpDescending(const void *a,const void *b){
+    return cmpAscending<T>(b,a);
+}
+
+template <class T> void NumVecType<T>::sort(Value *v,bool reverse)const{
+    ArrayList<T> *list = get(v);
+    WriteLock lock=WL(list);
+    if(list->count())
+        qsort(list->get(0),list->count(),sizeof(T),
+              reverse ? cmpDescending<T> : cmpAscending<T>);
+}
+
+template class NumVecType<int>;
+template class NumVecType<long>;
+template class NumVecType<float>;
+template class NumVecType<double>;
+
+}
@@ -0,0 +1,780 @@
+/**
+ * @file omap.cpp
+ * @brief  Ordered maps - see omap.h.
+ *
+ */
+
+#include <new>
+#include "angort.h"
+#include "opcodes.h"
+
+namespace angort {
+
+/// the most entries in a leaf, or children of an inner node
+#define OMAP_ORDER 32
+/// the fewest, except in the root
+#define OMAP_MIN (OMAP_ORDER/2)
+
+struct OMapNode {
+    bool leaf;
+    int n; //!< number of entries (leaf) or children (inner)
+    int size; //!< number of entries in this subtree
+    /// In a leaf, the keys. In an inner node, keys[i] is no greater
+    /// than any key in the ith child, and greater than any key in the
+    /// one before; keys[0] is never compared against.
+    Value keys[OMAP_ORDER];
+
+    OMapNode(bool l){
+        leaf=l;
+        n=0;
+        size=0;
+    }
+};
+
+struct OMapLeaf : public OMapNode {
+    Value vals[OMAP_ORDER];
+    OMapLeaf *prev,*next;
+    OMapLeaf() : OMapNode(true){
+        prev=next=NULL;
+    }
+};
+
+struct OMapInner : public OMapNode {
+    OMapNode *kids[OMAP_ORDER];
+    OMapInner() : OMapNode(false){}
+
+    /// work out the size from the children
+    void fixSize(){
+        size=0;
+        for(int i=0;i<n;i++)
+            size+=kids[i]->size;
+    }
+};
+
+static void deleteNode(OMapNode *node){
+    if(node->leaf)
+        delete (OMapLeaf *)node;
+    else {
+        OMapInner *in = (OMapInner *)node;
+        for(int i=0;i<in->n;i++)
+            deleteNode(in->kids[i]);
+        delete in;
+    }
+}
+
+// Entries are moved around inside and between nodes with memmove,
+// as ArrayList does, so their reference counts don't change; slots
+// which have been moved out of are reset without clearing them.
+
+/// reset values which have been moved elsewhere
+static void forget(Value *v,int n){
+    for(int i=0;i<n;i++)
+        new (v+i) Value();
+}
+
+/// open a gap at i in an array of n values, leaving none there
+static void openGap(Value *v,int n,int i){
+    memmove((void *)(v+i+1),(void *)(v+i),(n-i)*sizeof(Value));
+    forget(v+i,1);
+}
+
+/// remove the value at i from an array of n values
+static void closeGap(Value *v,int n,int i){
+    v[i].clr();
+    memmove((void *)(v+i),(void *)(v+i+1),(n-i-1)*sizeof(Value));
+    forget(v+n-1,1);
+}
+
+/// move values from one node to another, where the destination
+/// slots are empty.
+static void moveValues(Value *dest,Value *src,int n){
+    memcpy((void *)dest,(void *)src,n*sizeof(Value));
+    forget(src,n);
+}
+
+static void openGap(OMapNode **v,int n,int i){
+    memmove(v+i+1,v+i,(n-i)*sizeof(OMapNode *));
+}
+
+static void closeGap(OMapNode **v,int n,int i){
+    memmove(v+i,v+i+1,(n-i-1)*sizeof(OMapNode *));
+}
+
+int OMapObject::compare(Value *a,Value *b)const{
+    // the commonest case, done here rather than with a binop
+    if(a->t==Types::tInteger && b->t==Types::tInteger){
+        int p=a->v.i,q=b->v.i;
+        return (p>q)-(p<q);
+    }
+    // use the stack of whoever is using the map, which isn't
+    // necessarily the thread which made it.
+    Runtime *r = Runtime::getCurrent();
+    if(!r)
+        throw RUNT(EX_NOTREADY,"omap keys compared outside any runtime");
+    r->binop(a,b,OP_CMP);
+    return r->popInt();
+}
+
+/// the index of the first key in a leaf not less than k, setting
+/// eq if it's equal to k.
+static int leafSearch(const OMapObject *m,OMapNode *l,Value *k,bool *eq){
+    int lo=0,hi=l->n;
+    *eq=false;
+    while(lo<hi){
+        int mid=(lo+hi)/2;
+        int c = m->compare(l->keys+mid,k);
+        if(c<0)
+            lo=mid+1;
+        else {
+            // keys are unique, so this must be where we end up
+            if(!c)*eq=true;
+            hi=mid;
+        }
+    }
+    return lo;
+}
+
+/// the index of the child of an inner node which should hold k
+static int innerSearch(const OMapObject *m,OMapNode *in,Value *k){
+    int lo=1,hi=in->n;
+    while(lo<hi){
+        int mid=(lo+hi)/2;
+        if(m->compare(in->keys+mid,k)<=0)
+            lo=mid+1;
+        else
+            hi=mid;
+    }
+    return lo-1;
+}
+
+OMapObject::OMapObject() : GarbageCollected("omap"), tree("omaptree") {
+    locks=0;
+    first=last=new OMapLeaf();
+    root=first;
+}
+
+OMapObject::~OMapObject(){
+    deleteNode(root);
+}
+
+int OMapObject::count()const{
+    return root->size;
+}
+
+void OMapObject::checkUnlocked()const{
+    if(locks)
+        throw RUNT(EX_MODITER,"cannot modify ordered map as it is iterated");
+}
+
+Value *OMapObject::find(Value *k)const{
+    OMapNode *node = root;
+    while(!node->leaf)
+        node = ((OMapInner *)node)->kids[innerSearch(this,node,k)];
+    bool eq;
+    int i = leafSearch(this,node,k,&eq);
+    return eq ? ((OMapLeaf *)node)->vals+i : NULL;
+}
+
+/// split a full leaf, returning the new right half
+static OMapLeaf *splitLeaf(OMapLeaf *l){
+    OMapLeaf *r = new OMapLeaf();
+    int mid = l->n/2;
+    r->n = l->n-mid;
+    moveValues(r->keys,l->keys+mid,r->n);
+    moveValues(r->vals,l->vals+mid,r->n);
+    l->n = mid;
+    l->size = mid;
+    r->size = r->n;
+    r->next = l->next;
+    if(l->next)
+        l->next->prev = r;
+    l->next = r;
+    r->prev = l;
+    return r;
+}
+
+/// split a full inner node, returning the new right half; the
+/// caller fixes the sizes.
+static OMapInner *splitInner(OMapInner *in){
+    OMapInner *r = new OMapInner();
+    int mid = in->n/2;
+    r->n = in->n-mid;
+    // the separator for the new node becomes its keys[0]
+    moveValues(r->keys,in->keys+mid,r->n);
+    memcpy(r->kids,in->kids+mid,r->n*sizeof(OMapNode *));
+    in->n = mid;
+    return r;
+}
+
+/// insert into a subtree, returning a new right sibling if the
+/// node had to be split.
+OMapNode *OMapObject::insert(OMapNode *node,Value *k,Value *v,bool *added){
+    if(node->leaf){
+        OMapLeaf *l = (OMapLeaf *)node;
+        bool eq;
+        int i = leafSearch(this,l,k,&eq);
+        if(eq){
+            l->vals[i].copy(v);
+            return NULL;
+        }
+        *added=true;
+        OMapLeaf *r=NULL;
+        if(l->n==OMAP_ORDER){
+            r = splitLeaf(l);
+            if(l==last)
+                last=r;
+            if(i>l->n){
+                i-=l->n;
+                l=r;
+            }
+        }
+        openGap(l->keys,l->n,i);
+        openGap(l->vals,l->n,i);
+        l->keys[i].copy(k);
+        l->vals[i].copy(v);
+        l->n++;
+        l->size++;
+        return r;
+    }
+
+    OMapInner *in = (OMapInner *)node;
+    int i = innerSearch(this,in,k);
+    OMapNode *split = insert(in->kids[i],k,v,added);
+    if(*added)
+        in->size++;
+    if(!split)
+        return NULL;
+
+    // the new child goes just after the one which split
+    OMapInner *r=NULL,*target=in;
+    int j=i+1;
+    if(in->n==OMAP_ORDER){
+        r = splitInner(in);
+        if(j>in->n){
+            j-=in->n;
+            target=r;
+        }
+    }
+    openGap(target->keys,target->n,j);
+    target->keys[j].copy(split->keys);
+    openGap(target->kids,target->n,j);
+    target->kids[j]=split;
+    target->n++;
+    if(r){
+        in->fixSize();
+        r->fixSize();
+    }
+    return r;
+}
+
+void OMapObject::set(Value *k,Value *v){
+    checkUnlocked();
+    bool added=false;
+    OMapNode *split = insert(root,k,v,&added);
+    if(split){
+        OMapInner *r = new OMapInner();
+        r->kids[0]=root;
+        r->kids[1]=split;
+        r->keys[1].copy(split->keys);
+        r->n=2;
+        r->fixSize();
+        root=r;
+    }
+}
+
+/// merge the child after i into child i and remove it
+void OMapObject::merge(OMapInner *in,int i){
+    OMapNode *a = in->kids[i];
+    OMapNode *b = in->kids[i+1];
+    if(a->leaf){
+        OMapLeaf *la = (OMapLeaf *)a;
+        OMapLeaf *lb = (OMapLeaf *)b;
+        moveValues(la->keys+la->n,lb->keys,lb->n);
+        moveValues(la->vals+la->n,lb->vals,lb->n);
+        la->next = lb->next;
+        if(lb->next)
+            lb->next->prev = la;
+        if(last==lb)
+            last=la;
+    } else {
+        OMapInner *ia = (OMapInner *)a;
+        OMapInner *ib = (OMapInner *)b;
+        // b's first child now needs a real separator
+        ib->keys[0].copy(in->keys+i+1);
+        moveValues(ia->keys+ia->n,ib->keys,ib->n);
+        memcpy(ia->kids+ia->n,ib->kids,ib->n*sizeof(OMapNode *));
+    }
+    a->n += b->n;
+    a->size += b->size;
+    b->n=0;
+    deleteNode(b);
+    closeGap(in->keys,in->n,i+1);
+    closeGap(in->kids,in->n,i+1);
+    in->n--;
+}
+
+/// child i of an inner node has become too small, so take an entry
+/// from a sibling or merge it with one.
+void OMapObject::rebalance(OMapInner *in,int i){
+    OMapNode *c = in->kids[i];
+    if(i>0 && in->kids[i-1]->n>OMAP_MIN){
+        // borrow the last entry of the left sibling
+        OMapNode *l = in->kids[i-1];
+        openGap(c->keys,c->n,0);
+        if(c->leaf){
+            OMapLeaf *cl = (OMapLeaf *)c;
+            OMapLeaf *ll = (OMapLeaf *)l;
+            openGap(cl->vals,c->n,0);
+            moveValues(cl->keys,ll->keys+l->n-1,1);
+            moveValues(cl->vals,ll->vals+l->n-1,1);
+            c->size++;
+            l->size--;
+        } else {
+            OMapInner *ci = (OMapInner *)c;
+            OMapInner *li = (OMapInner *)l;
+            // the old first child's separator was in the parent
+            ci->keys[1].copy(in->keys+i);
+            moveValues(ci->keys,li->keys+l->n-1,1);
+            openGap(ci->kids,c->n,0);
+            ci->kids[0] = li->kids[l->n-1];
+            c->size += ci->kids[0]->size;
+            l->size -= ci->kids[0]->size;
+        }
+        c->n++;
+        l->n--;
+        in->keys[i].copy(c->keys);
+    } else if(i<in->n-1 && in->kids[i+1]->n>OMAP_MIN){
+        // borrow the first entry of the right sibling
+        OMapNode *r = in->kids[i+1];
+        if(c->leaf){
+            OMapLeaf *cl = (OMapLeaf *)c;
+            OMapLeaf *rl = (OMapLeaf *)r;
+            moveValues(cl->keys+c->n,rl->keys,1);
+            moveValues(cl->vals+c->n,rl->vals,1);
+            closeGap(rl->keys,r->n,0);
+            closeGap(rl->vals,r->n,0);
+            c->size++;
+            r->size--;
+        } else {
+            OMapInner *ci = (OMapInner *)c;
+            OMapInner *ri = (OMapInner *)r;
+            ci->keys[c->n].copy(in->keys+i+1);
+            ci->kids[c->n] = ri->kids[0];
+            closeGap(ri->keys,r->n,0);
+            closeGap(ri->kids,r->n,0);
+            c->size += ci->kids[c->n]->size;
+            r->size -= ci->kids[c->n]->size;
+        }
+        c->n++;
+        r->n--;
+        in->keys[i+1].copy(r->keys);
+    } else if(i>0)
+        merge(in,i-1);
+    else
+        merge(in,i);
+}
+
+bool OMapObject::remove(OMapNode *node,Value *k,Value *out){
+    if(node->leaf){
+        OMapLeaf *l = (OMapLeaf *)node;
+        bool eq;
+        int i = leafSearch(this,l,k,&eq);
+        if(!eq)
+            return false;
+        if(out)
+            out->copy(l->vals+i);
+        closeGap(l->keys,l->n,i);
+        closeGap(l->vals,l->n,i);
+        l->n--;
+        l->size--;
+        return true;
+    }
+    OMapInner *in = (OMapInner *)node;
+    int i = innerSearch(this,in,k);
+    if(!remove(in->kids[i],k,out))
+        return false;
+    in->size--;
+    if(in->kids[i]->n<OMAP_MIN)
+        rebalance(in,i);
+    return true;
+}
+
+bool OMapObject::del(Value *k,Value *out){
+    checkUnlocked();
+    if(!remove(root,k,out))
+        return false;
+    if(!root->leaf && root->n==1){
+        // drop a level
+        OMapInner *in = (OMapInner *)root;
+        root = in->kids[0];
+        in->n=0;
+        deleteNode(in);
+    }
+    return true;
+}
+
+int OMapObject::lowerBound(Value *k,OMapPos *p)const{
+    int rank=0;
+    OMapNode *node = root;
+    while(!node->leaf){
+        OMapInner *in = (OMapInner *)node;
+        int i = innerSearch(this,in,k);
+        for(int j=0;j<i;j++)
+            rank+=in->kids[j]->size;
+        node = in->kids[i];
+    }
+    bool eq;
+    p->leaf = (OMapLeaf *)node;
+    p->pos = leafSearch(this,node,k,&eq);
+    rank += p->pos;
+    if(p->pos==node->n){
+        // it's the first entry of the next leaf, if there is one
+        p->leaf = p->leaf->next;
+        p->pos = 0;
+    }
+    return rank;
+}
+
+bool OMapObject::select(int i,OMapPos *p)const{
+    if(i<0 || i>=count())
+        return false;
+    OMapNode *node = root;
+    while(!node->leaf){
+        OMapInner *in = (OMapInner *)node;
+        int j;
+        for(j=0;j<in->n-1 && i>=in->kids[j]->size;j++)
+            i-=in->kids[j]->size;
+        node = in->kids[j];
+    }
+    p->leaf = (OMapLeaf *)node;
+    p->pos = i;
+    return true;
+}
+
+OMapPos OMapObject::begin()const{
+    OMapPos p;
+    p.leaf = first->n ? first : NULL;
+    p.pos = 0;
+    return p;
+}
+
+void OMapObject::next(OMapPos *p)const{
+    if(++p->pos==p->leaf->n){
+        p->leaf = p->leaf->next;
+        p->pos = 0;
+    }
+}
+
+void OMapObject::prev(OMapPos *p)const{
+    if(!p->leaf){
+        // from the end to the last entry
+        p->leaf = last->n ? last : NULL;
+        p->pos = last->n-1;
+    } else if(p->pos)
+        p->pos--;
+    else {
+        p->leaf = p->leaf->prev;
+        if(p->leaf)
+            p->pos = p->leaf->n-1;
+    }
+}
+
+Value *OMapObject::keyAt(const OMapPos &p)const{
+    return p.leaf->keys+p.pos;
+}
+
+Value *OMapObject::valAt(const OMapPos &p)const{
+    return p.leaf->vals+p.pos;
+}
+
+void OMapObject::wipeContents(){
+    for(OMapLeaf *l=first;l;l=l->next){
+        for(int i=0;i<l->n;i++){
+            l->keys[i].wipeIfInGCCycle();
+            l->vals[i].wipeIfInGCCycle();
+        }
+    }
+}
+
+/// walks the leaves from a starting key (or the start) up to an end
+/// key (or the end). The map can't be changed while this is running.
+class OMapIterator : public Iterator<Value *> {
+    OMapObject *obj;
+    Value lo,hi; //!< none if not bounded
+    OMapPos p;
+    int idx;
+    bool isKey;
+    bool locked;
+
+    void lock(){
+        if(!locked){
+            obj->locks++;
+            locked=true;
+        }
+    }
+    void unlock(){
+        if(locked){
+            obj->locks--;
+            locked=false;
+        }
+    }
+    void checkEnd(){
+        if(p.leaf && !hi.isNone() && obj->compare(obj->keyAt(p),&hi)>=0)
+            p.leaf=NULL;
+        if(!p.leaf)
+            unlock();
+    }
+public:
+    OMapIterator(const OMapObject *o,bool iskeyiterator,Value *l,Value *h){
+        obj = (OMapObject *)o;
+        obj->incRefCt();
+        isKey = iskeyiterator;
+        if(l)lo.copy(l);
+        if(h)hi.copy(h);
+        locked=false;
+        p.leaf=NULL;
+        idx=0;
+    }
+    virtual ~OMapIterator(){
+        unlock();
+        if(obj->decRefCt())
+            delete obj;
+    }
+    virtual void first(){
+        idx=0;
+        lock();
+        if(lo.isNone())
+            p = obj->begin();
+        else
+            obj->lowerBound(&lo,&p);
+        checkEnd();
+    }
+    virtual void next(){
+        idx++;
+        obj->next(&p);
+        checkEnd();
+    }
+    virtual bool isDone() const{
+        return !p.leaf;
+    }
+    virtual Value *current(){
+        return isKey ? obj->keyAt(p) : obj->valAt(p);
+    }
+    virtual int index() const {
+        return idx;
+    }
+};
+
+Iterator<Value *> *OMapObject::makeKeyIterator()const{
+    return new OMapIterator(this,true,NULL,NULL);
+}
+
+Iterator<Value *> *OMapObject::makeValueIterator()const{
+    return new OMapIterator(this,false,NULL,NULL);
+}
+
+Iterator<Value *> *OMapObject::makeRangeIterator(Value *lo,Value *hi)const{
+    return new OMapIterator(this,true,lo,hi);
+}
+
+OMapRangeObject::OMapRangeObject() : GarbageCollected("omaprange") {
+    map = new Value;
+    lo = new Value;
+    hi = new Value;
+}
+
+OMapRangeObject::~OMapRangeObject(){
+    delete map;
+    delete lo;
+    delete hi;
+}
+
+Iterator<Value *> *OMapRangeObject::makeKeyIterator()const{
+    return Types::tOMap->get(map)->makeRangeIterator(lo,hi);
+}
+
+/// iterates over the values held by a range, for the cycle detector
+class OMapRangeGCIterator : public Iterator<Value *> {
+    OMapRangeObject *obj;
+    int idx;
+public:
+    OMapRangeGCIterator(OMapRangeObject *o){
+        obj=o;
+        obj->incRefCt();
+        idx=0;
+    }
+    virtual ~OMapRangeGCIterator(){
+        if(obj->decRefCt())
+            delete obj;
+    }
+    virtual void first(){
+        idx=0;
+    }
+    virtual void next(){
+        idx++;
+    }
+    virtual bool isDone() const{
+        return idx>=3;
+    }
+    virtual Value *current(){
+        switch(idx){
+        case 0:return obj->map;
+        case 1:return obj->lo;
+        default:return obj->hi;
+        }
+    }
+    virtual int index() const {
+        return idx;
+    }
+};
+
+Iterator<Value *> *OMapRangeObject::makeGCValueIterator(){
+    return new OMapRangeGCIterator(this);
+}
+
+void OMapRangeObject::wipeContents(){
+    map->wipeIfInGCCycle();
+    lo->wipeIfInGCCycle();
+    hi->wipeIfInGCCycle();
+}
+
+/*
+ * The types
+ */
+
+OMapObject *OMapType::get(Value *v)const{
+    if(v->t != this)
+        throw RUNT(EX_TYPE,"").set("not an omap, is a %s",v->t->name);
+    return (OMapObject *)v->v.gc;
+}
+
+OMapObject *OMapType::set(Value *v)const{
+    OMapObject *o = new OMapObject();
+    v->clr();
+    v->t = this;
+    v->v.gc = o;
+    incRef(v);
+    return o;
+}
+
+// Comparing keys pushes onto the stack, and the values passed into
+// these may be in slots which have just been popped off it, so they
+// are copied first.
+
+void OMapType::setValue(Value *coll,Value *k,Value *v)const{
+    OMapObject *o = get(coll);
+    Value key,val;
+    key.copy(k);
+    val.copy(v);
+    WriteLock lock=WL(&o->tree);
+    o->set(&key,&val);
+}
+
+void OMapType::getValue(Value *coll,Value *k,Value *result)const{
+    OMapObject *o = get(coll);
+    Value key;
+    key.copy(k);
+    ReadLock lock(&o->tree);
+    Value *v = o->find(&key);
+    if(v)
+        result->copy(v);
+    else
+        result->clr();
+}
+
+int OMapType::getCount(Value *coll)const{
+    return get(coll)->count();
+}
+
+bool OMapType::contains(Value *coll,Value *item)const{
+    OMapObject *o = get(coll);
+    Value key;
+    key.copy(item);
+    ReadLock lock(&o->tree);
+    return o->find(&key)!=NULL;
+}
+
+int OMapType::getIndexOfContainedItem(Value *coll,Value *item)const{
+    OMapObject *o = get(coll);
+    Value key;
+    key.copy(item);
+    ReadLock lock(&o->tree);
+    OMapPos p;
+    int i = o->lowerBound(&key,&p);
+    return (p.leaf && !o->compare(o->keyAt(p),&key)) ? i : -1;
+}
+
+void OMapType::removeAndReturn(Value *coll,Value *k,Value *result)const{
+    OMapObject *o = get(coll);
+    Value key;
+    key.copy(k);
+    WriteLock lock=WL(&o->tree);
+    if(!o->del(&key,result))
+        result->clr();
+}
+
+void OMapType::clone(Value *out,const Value *in,bool deep)const{
+    OMapObject *p = get(const_cast<Value *>(in));
+    Value tmp;
+    OMapObject *o = set(&tmp);
+    ReadLock lock(&p->tree);
+    for(OMapPos i=p->begin();i.leaf;p->next(&i)){
+        Value *v = p->valAt(i);
+        if(deep){
+            // keys can't be collections, so only values are cloned
+            Value deepv;
+            v->t->clone(&deepv,v);
+            o->set(p->keyAt(i),&deepv);
+        } else
+            o->set(p->keyAt(i),v);
+    }
+    out->copy(&tmp);
+}
+
+void OMapRangeType::set(Value *v,Value *map,Value *lo,Value *hi)const{
+    Types::tOMap->get(map); // check it's a map
+    OMapRangeObject *o = new OMapRangeObject();
+    // copy these before we clear v, which might be one of them
+    o->map->copy(map);
+    o->lo->copy(lo);
+    o->hi->copy(hi);
+    v->clr();
+    v->t = this;
+    v->v.gc = o;
+    incRef(v);
+}
+
+void OMapRangeType::getValue(Value *coll,Value *k,Value *result)const{
+    OMapRangeObject *r = (OMapRangeObject *)coll->v.gc;
+    Types::tOMap->getValue(r->map,k,result);
+}
+
+/// true if a key is within a range's bounds
+static bool inRange(OMapRangeObject *r,OMapObject *o,Value *k){
+    if(!r->lo->isNone() && o->compare(k,r->lo)<0)
+        return false;
+    if(!r->hi->isNone() && o->compare(k,r->hi)>=0)
+        return false;
+    return true;
+}
+
+int OMapRangeType::getCount(Value *coll)const{
+    OMapRangeObject *r = (OMapRangeObject *)coll->v.gc;
+    OMapObject *o = Types::tOMap->get(r->map);
+    ReadLock lock(&o->tree);
+    OMapPos p;
+    int start = r->lo->isNone() ? 0 : o->lowerBound(r->lo,&p);
+    int end = r->hi->isNone() ? o->count() : o->lowerBound(r->hi,&p);
+    return end>start ? end-start : 0;
+}
+
+bool OMapRangeType::contains(Value *coll,Value *item)const{
+    OMapRangeObject *r = (OMapRangeObject *)coll->v.gc;
+    OMapObject *o = Types::tOMap->get(r->map);
+    Value key;
+    key.copy(item);
+    ReadLock lock(&o->tree);
+    return inRange(r,o,&key) && o->find(&key);
+}
+
+}
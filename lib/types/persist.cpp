@@ -0,0 +1,837 @@
+/**
+ * @file persist.cpp
+ * @brief  Persistent vectors and maps - see persist.h.
+ *
+ */
+
+#include "angort.h"
+#include "hash.h"
+
+namespace angort {
+
+/// the deepest a map iterator can go: bitmap nodes at shifts 0 to 30,
+/// and then a collision node.
+#define PMAP_MAXDEPTH 8
+
+/// the common part of all the nodes. Nodes can be shared between
+/// versions used by different threads, so the count is atomic.
+struct PNode {
+    int refct;
+    PNode(){
+        refct=1;
+    }
+    void incRef(){
+        __sync_add_and_fetch(&refct,1);
+    }
+    /// return true if the count became zero
+    bool decRef(){
+        return __sync_sub_and_fetch(&refct,1)==0;
+    }
+};
+
+/*
+ * Vectors
+ */
+
+struct PVecLeaf : public PNode {
+    Value v[PERSIST_WIDTH];
+
+    /// a new leaf with the first n items of this one
+    PVecLeaf *copy(int n)const{
+        PVecLeaf *l = new PVecLeaf();
+        for(int i=0;i<n;i++)
+            l->v[i].copy(&v[i]);
+        return l;
+    }
+};
+
+/// the children are branches, or leaves in the bottom level
+struct PVecBranch : public PNode {
+    PNode *kids[PERSIST_WIDTH];
+
+    PVecBranch(){
+        memset(kids,0,sizeof(kids));
+    }
+    PVecBranch *copy()const{
+        PVecBranch *b = new PVecBranch();
+        for(int i=0;i<PERSIST_WIDTH;i++){
+            if((b->kids[i]=kids[i]))
+                kids[i]->incRef();
+        }
+        return b;
+    }
+};
+
+/// drop a reference to a node of a given level, where leaves are level 0
+static void release(PNode *n,int level){
+    if(!n || !n->decRef())
+        return;
+    if(level){
+        PVecBranch *b = (PVecBranch *)n;
+        for(int i=0;i<PERSIST_WIDTH;i++)
+            release(b->kids[i],level-PERSIST_BITS);
+        delete b;
+    } else
+        delete (PVecLeaf *)n;
+}
+
+/// a chain of branches down to a node
+static PNode *newPath(int level,PNode *node){
+    if(!level)
+        return node;
+    PVecBranch *b = new PVecBranch();
+    b->kids[0] = newPath(level-PERSIST_BITS,node);
+    return b;
+}
+
+/// a new version of a node with item i replaced
+static PNode *assoc(int level,PNode *node,int i,Value *v){
+    if(!level){
+        PVecLeaf *l = ((PVecLeaf *)node)->copy(PERSIST_WIDTH);
+        l->v[i&PERSIST_MASK].copy(v);
+        return l;
+    }
+    PVecBranch *b = ((PVecBranch *)node)->copy();
+    int sub = (i>>level)&PERSIST_MASK;
+    PNode *k = assoc(level-PERSIST_BITS,b->kids[sub],i,v);
+    release(b->kids[sub],level-PERSIST_BITS);
+    b->kids[sub]=k;
+    return b;
+}
+
+PVecObject::PVecObject() : GarbageCollected("pvec") {
+    count=0;
+    shift=PERSIST_BITS;
+    root = new PVecBranch();
+    tail = new PVecLeaf();
+}
+
+PVecObject::PVecObject(int c,int s,PVecBranch *r,PVecLeaf *t) : GarbageCollected("pvec") {
+    count=c;
+    shift=s;
+    root=r;
+    tail=t;
+}
+
+PVecObject::~PVecObject(){
+    release(root,shift);
+    release(tail,0);
+}
+
+PVecLeaf *PVecObject::leafFor(int i)const{
+    if(i>=tailOffset())
+        return tail;
+    PNode *n = root;
+    for(int level=shift;level>0;level-=PERSIST_BITS)
+        n = ((PVecBranch *)n)->kids[(i>>level)&PERSIST_MASK];
+    return (PVecLeaf *)n;
+}
+
+Value *PVecObject::get(int i)const{
+    if(i<0 || i>=count)
+        throw RUNT(EX_OUTOFRANGE,"pvec get out of range");
+    return leafFor(i)->v+(i&PERSIST_MASK);
+}
+
+PVecBranch *PVecObject::pushTail(int level,PVecBranch *parent,PVecLeaf *leaf)const{
+    int sub = ((count-1)>>level)&PERSIST_MASK;
+    PVecBranch *b = parent->copy();
+    PNode *n;
+    if(level==PERSIST_BITS)
+        n = leaf;
+    else {
+        PVecBranch *child = (PVecBranch *)parent->kids[sub];
+        n = child ? pushTail(level-PERSIST_BITS,child,leaf) :
+              newPath(level-PERSIST_BITS,leaf);
+    }
+    release(b->kids[sub],level-PERSIST_BITS);
+    b->kids[sub]=n;
+    return b;
+}
+
+PVecBranch *PVecObject::rootWithTail(int *newshift)const{
+    *newshift = shift;
+    tail->incRef();
+    if((count>>PERSIST_BITS) > (1<<shift)){
+        // the trie is full, so add a level
+        PVecBranch *b = new PVecBranch();
+        root->incRef();
+        b->kids[0]=root;
+        b->kids[1]=newPath(shift,tail);
+        *newshift += PERSIST_BITS;
+        return b;
+    } else
+        return pushTail(shift,root,tail);
+}
+
+PVecObject *PVecObject::push(Value *v)const{
+    int n = count-tailOffset();
+    if(n<PERSIST_WIDTH){
+        // room in the tail
+        PVecLeaf *t = tail->copy(n);
+        t->v[n].copy(v);
+        root->incRef();
+        return new PVecObject(count+1,shift,root,t);
+    }
+    int s;
+    PVecBranch *r = rootWithTail(&s);
+    PVecLeaf *t = new PVecLeaf();
+    t->v[0].copy(v);
+    return new PVecObject(count+1,s,r,t);
+}
+
+void PVecObject::append(Value *v){
+    int n = count-tailOffset();
+    if(n==PERSIST_WIDTH){
+        int s;
+        PVecBranch *r = rootWithTail(&s);
+        release(root,shift);
+        release(tail,0);
+        root=r;
+        shift=s;
+        tail = new PVecLeaf();
+        n=0;
+    }
+    tail->v[n].copy(v);
+    count++;
+}
+
+PVecBranch *PVecObject::popTail(int level,PVecBranch *node)const{
+    int sub = ((count-2)>>level)&PERSIST_MASK;
+    PNode *n;
+    if(level>PERSIST_BITS){
+        n = popTail(level-PERSIST_BITS,(PVecBranch *)node->kids[sub]);
+        if(!n && !sub)
+            return NULL;
+    } else if(!sub)
+        return NULL;
+    else
+        n = NULL;
+    PVecBranch *b = node->copy();
+    release(b->kids[sub],level-PERSIST_BITS);
+    b->kids[sub]=n;
+    return b;
+}
+
+PVecObject *PVecObject::pop()const{
+    if(!count)
+        throw RUNT(EX_OUTOFRANGE,"pop from empty pvec");
+    if(count==1)
+        return new PVecObject();
+    int n = count-tailOffset();
+    if(n>1){
+        PVecLeaf *t = tail->copy(n-1);
+        root->incRef();
+        return new PVecObject(count-1,shift,root,t);
+    }
+    // the tail becomes empty, so the last leaf in the trie becomes
+    // the new tail.
+    PVecLeaf *t = leafFor(count-2);
+    t->incRef();
+    PVecBranch *r = popTail(shift,root);
+    int s = shift;
+    if(!r)
+        r = new PVecBranch();
+    if(shift>PERSIST_BITS && !r->kids[1]){
+        // only one child at the top, so drop a level
+        PVecBranch *k = (PVecBranch *)r->kids[0];
+        k->incRef();
+        release(r,shift);
+        r=k;
+        s-=PERSIST_BITS;
+    }
+    return new PVecObject(count-1,s,r,t);
+}
+
+PVecObject *PVecObject::set(int i,Value *v)const{
+    if(i==count)
+        return push(v);
+    if(i<0 || i>count)
+        throw RUNT(EX_OUTOFRANGE,"pvec set out of range");
+    if(i>=tailOffset()){
+        PVecLeaf *t = tail->copy(count-tailOffset());
+        t->v[i&PERSIST_MASK].copy(v);
+        root->incRef();
+        return new PVecObject(count,shift,root,t);
+    }
+    tail->incRef();
+    return new PVecObject(count,shift,
+                          (PVecBranch *)assoc(shift,root,i,v),tail);
+}
+
+/// iterates over the items (or the indices) of a vector, fetching
+/// each leaf once.
+class PVecIterator : public Iterator<Value *> {
+    PVecObject *obj;
+    PVecLeaf *leaf;
+    int idx;
+    bool isKey;
+    Value k; //!< the current index, for key iterators
+
+    void fetch(){
+        if(idx<obj->count && !(idx&PERSIST_MASK))
+            leaf = obj->leafFor(idx);
+    }
+public:
+    PVecIterator(const PVecObject *o,bool iskeyiterator){
+        obj = (PVecObject *)o;
+        obj->incRefCt();
+        isKey = iskeyiterator;
+        idx=0;
+    }
+    virtual ~PVecIterator(){
+        if(obj->decRefCt())
+            delete obj;
+    }
+    virtual void first(){
+        idx=0;
+        fetch();
+    }
+    virtual void next(){
+        idx++;
+        fetch();
+    }
+    virtual bool isDone() const{
+        return idx>=obj->count;
+    }
+    virtual Value *current(){
+        if(isKey){
+            Types::tInteger->set(&k,idx);
+            return &k;
+        }
+        return leaf->v+(idx&PERSIST_MASK);
+    }
+    virtual int index() const {
+        return idx;
+    }
+};
+
+Iterator<Value *> *PVecObject::makeValueIterator()const{
+    return new PVecIterator(this,false);
+}
+
+Iterator<Value *> *PVecObject::makeKeyIterator()const{
+    return new PVecIterator(this,true);
+}
+
+/*
+ * Maps
+ */
+
+struct PMapSlot {
+    Value k,v;
+    uint32_t hash;
+    PMapNode *sub; //!< if not NULL, this slot holds a node and k and v are unused
+
+    PMapSlot(){
+        sub=NULL;
+    }
+    void setKV(uint32_t h,Value *key,Value *val){
+        k.copy(key);
+        v.copy(val);
+        hash=h;
+    }
+};
+
+/// a bitmap node holds a slot for each bit set in the bitmap, in
+/// order; a collision node has no bitmap and holds keys which all
+/// have the same hash.
+struct PMapNode : public PNode {
+    uint32_t bitmap;
+    int n;
+    PMapSlot *slots;
+
+    /// a node with some slots, or new empty ones if s is NULL
+    PMapNode(uint32_t b,int ct,PMapSlot *s=NULL){
+        bitmap=b;
+        n=ct;
+        slots = s ? s : new PMapSlot[ct];
+    }
+    ~PMapNode();
+
+    bool isCollision()const{
+        return !bitmap;
+    }
+    /// replace the slots
+    void setSlots(PMapSlot *s,int ct);
+};
+
+static void release(PMapNode *n){
+    if(n && n->decRef())
+        delete n;
+}
+
+PMapNode::~PMapNode(){
+    setSlots(NULL,0);
+}
+
+void PMapNode::setSlots(PMapSlot *s,int ct){
+    for(int i=0;i<n;i++)
+        release(slots[i].sub);
+    delete [] slots;
+    slots=s;
+    n=ct;
+}
+
+static void copySlot(PMapSlot *dest,PMapSlot *src){
+    dest->k.copy(&src->k);
+    dest->v.copy(&src->v);
+    dest->hash = src->hash;
+    if((dest->sub = src->sub))
+        dest->sub->incRef();
+}
+
+/// a key's hash, mixed with the MurmurHash3 finaliser: integer keys
+/// hash to themselves, and would otherwise fill the trie unevenly.
+static inline uint32_t hashOf(Value *k){
+    uint32_t h = k->getHash();
+    h^=h>>16;
+    h*=0x85ebca6b;
+    h^=h>>13;
+    h*=0xc2b2ae35;
+    h^=h>>16;
+    return h;
+}
+
+static inline uint32_t fragment(uint32_t h,int shift){
+    return (h>>shift)&PERSIST_MASK;
+}
+
+static inline int slotIndex(uint32_t bitmap,uint32_t bit){
+    return __builtin_popcount(bitmap&(bit-1));
+}
+
+/// a node we can change: the node itself if it's ours to change
+/// (we're building a new map and nothing else refers to it) and
+/// the size isn't changing, otherwise one with a new set of slots.
+/// If delta is 1, an empty slot is opened at idx; if -1, the slot
+/// at idx is dropped.
+static PMapNode *resized(PMapNode *node,bool mine,int idx,int delta){
+    if(mine && !delta)
+        return node;
+    int ct = node->n+delta;
+    PMapSlot *s = new PMapSlot[ct];
+    for(int i=0,j=0;i<node->n;i++){
+        if(delta<0 && i==idx)
+            continue;
+        if(delta>0 && j==idx)
+            j++;
+        copySlot(s+j++,node->slots+i);
+    }
+    if(mine){
+        node->setSlots(s,ct);
+        return node;
+    }
+    return new PMapNode(node->bitmap,ct,s);
+}
+
+/// make a node holding an existing key/value slot and a new key,
+/// which are in the same place at the previous level.
+static PMapNode *merge(int shift,PMapSlot *old,uint32_t h,Value *k,Value *v){
+    PMapNode *n;
+    if(old->hash==h){
+        n = new PMapNode(0,2);
+        copySlot(n->slots,old);
+        n->slots[1].setKV(h,k,v);
+        return n;
+    }
+    uint32_t f1 = fragment(old->hash,shift);
+    uint32_t f2 = fragment(h,shift);
+    if(f1==f2){
+        n = new PMapNode(1u<<f1,1);
+        n->slots[0].sub = merge(shift+PERSIST_BITS,old,h,k,v);
+    } else {
+        n = new PMapNode((1u<<f1)|(1u<<f2),2);
+        int i = f1<f2 ? 0 : 1;
+        copySlot(n->slots+i,old);
+        n->slots[1-i].setKV(h,k,v);
+    }
+    return n;
+}
+
+/// set a key in a node (which may be NULL), returning the new node.
+/// If edit is true, nodes which only we can see are changed in place,
+/// in which case the same node may be returned.
+static PMapNode *assoc(PMapNode *node,int shift,uint32_t h,
+                       Value *k,Value *v,bool *added,bool edit){
+    if(!node){
+        node = new PMapNode(1u<<fragment(h,shift),1);
+        node->slots[0].setKV(h,k,v);
+        *added=true;
+        return node;
+    }
+    bool mine = edit && node->refct==1;
+
+    if(node->isCollision()){
+        if(node->slots[0].hash!=h){
+            // a different hash has got here, so put the collision
+            // node inside a bitmap node and add the key to that.
+            PMapNode *b = new PMapNode(1u<<fragment(node->slots[0].hash,shift),1);
+            node->incRef();
+            b->slots[0].sub = node;
+            return assoc(b,shift,h,k,v,added,true);
+        }
+        for(int i=0;i<node->n;i++){
+            if(node->slots[i].k.equalForHashTable(k)){
+                PMapNode *r = resized(node,mine,i,0);
+                r->slots[i].v.copy(v);
+                return r;
+            }
+        }
+        PMapNode *r = resized(node,mine,node->n,1);
+        r->slots[r->n-1].setKV(h,k,v);
+        *added=true;
+        return r;
+    }
+
+    uint32_t bit = 1u<<fragment(h,shift);
+    int idx = slotIndex(node->bitmap,bit);
+    if(!(node->bitmap & bit)){
+        PMapNode *r = resized(node,mine,idx,1);
+        r->bitmap |= bit;
+        r->slots[idx].setKV(h,k,v);
+        *added=true;
+        return r;
+    }
+
+    PMapSlot *s = node->slots+idx;
+    PMapNode *sub;
+    if(s->sub){
+        sub = assoc(s->sub,shift+PERSIST_BITS,h,k,v,added,mine);
+        if(sub==s->sub)
+            return node; // changed in place
+    } else if(s->hash==h && s->k.equalForHashTable(k)){
+        PMapNode *r = resized(node,mine,idx,0);
+        r->slots[idx].v.copy(v);
+        return r;
+    } else {
+        sub = merge(shift+PERSIST_BITS,s,h,k,v);
+        *added=true;
+    }
+    PMapNode *r = resized(node,mine,idx,0);
+    s = r->slots+idx;
+    release(s->sub);
+    s->k.clr();
+    s->v.clr();
+    s->sub = sub;
+    return r;
+}
+
+/// remove a key from a node, returning the new node (NULL if it
+/// became empty) or the same node with its count raised if the key
+/// wasn't found.
+static PMapNode *without(PMapNode *node,int shift,uint32_t h,Value *k,bool *removed){
+    if(node->isCollision()){
+        for(int i=0;i<node->n;i++){
+            if(node->slots[i].hash==h && node->slots[i].k.equalForHashTable(k)){
+                *removed=true;
+                return node->n==1 ? NULL : resized(node,false,i,-1);
+            }
+        }
+        node->incRef();
+        return node;
+    }
+
+    uint32_t bit = 1u<<fragment(h,shift);
+    int idx = slotIndex(node->bitmap,bit);
+    if(node->bitmap & bit){
+        PMapSlot *s = node->slots+idx;
+        if(s->sub){
+            PMapNode *sub = without(s->sub,shift+PERSIST_BITS,h,k,removed);
+            if(sub!=s->sub){
+                if(!sub && node->n==1)
+                    return NULL;
+                PMapNode *r = resized(node,false,idx,sub?0:-1);
+                if(!sub){
+                    r->bitmap &= ~bit;
+                    return r;
+                }
+                s = r->slots+idx;
+                release(s->sub);
+                if(sub->n==1 && !sub->slots[0].sub){
+                    // only a single key left down there, so bring it up
+                    copySlot(s,sub->slots);
+                    release(sub);
+                } else
+                    s->sub = sub;
+                return r;
+            }
+            release(sub);
+        } else if(s->hash==h && s->k.equalForHashTable(k)){
+            *removed=true;
+            if(node->n==1)
+                return NULL;
+            PMapNode *r = resized(node,false,idx,-1);
+            r->bitmap &= ~bit;
+            return r;
+        }
+    }
+    node->incRef();
+    return node;
+}
+
+PMapObject::PMapObject() : GarbageCollected("pmap") {
+    count=0;
+    root=NULL;
+}
+
+PMapObject::PMapObject(int c,PMapNode *r) : GarbageCollected("pmap") {
+    count=c;
+    root=r;
+}
+
+PMapObject::~PMapObject(){
+    release(root);
+}
+
+Value *PMapObject::find(Value *k)const{
+    uint32_t h = hashOf(k);
+    PMapNode *n = root;
+    for(int shift=0;n;shift+=PERSIST_BITS){
+        if(n->isCollision()){
+            for(int i=0;i<n->n;i++){
+                PMapSlot *s = n->slots+i;
+                if(s->hash==h && s->k.equalForHashTable(k))
+                    return &s->v;
+            }
+            return NULL;
+        }
+        uint32_t bit = 1u<<fragment(h,shift);
+        if(!(n->bitmap & bit))
+            return NULL;
+        PMapSlot *s = n->slots+slotIndex(n->bitmap,bit);
+        if(!s->sub)
+            return (s->hash==h && s->k.equalForHashTable(k)) ? &s->v : NULL;
+        n = s->sub;
+    }
+    return NULL;
+}
+
+PMapObject *PMapObject::set(Value *k,Value *v)const{
+    bool added=false;
+    PMapNode *r = assoc(root,0,hashOf(k),k,v,&added,false);
+    return new PMapObject(added?count+1:count,r);
+}
+
+void PMapObject::put(Value *k,Value *v){
+    bool added=false;
+    PMapNode *r = assoc(root,0,hashOf(k),k,v,&added,true);
+    if(r!=root){
+        release(root);
+        root=r;
+    }
+    if(added)count++;
+}
+
+PMapObject *PMapObject::del(Value *k)const{
+    if(!root)
+        return NULL;
+    bool removed=false;
+    PMapNode *r = without(root,0,hashOf(k),k,&removed);
+    if(!removed){
+        release(r);
+        return NULL;
+    }
+    return new PMapObject(count-1,r);
+}
+
+/// walks the trie depth first, yielding keys or values
+class PMapIterator : public Iterator<Value *> {
+    PMapObject *obj;
+    bool isKey;
+    int idx;
+    int depth; //!< -1 when we've finished
+    PMapNode *nodes[PMAP_MAXDEPTH];
+    int pos[PMAP_MAXDEPTH];
+
+    /// move down (or up and along) from the current position
+    /// until we're on a key
+    void settle(){
+        while(depth>=0){
+            if(pos[depth]>=nodes[depth]->n){
+                if(--depth>=0)
+                    pos[depth]++;
+                continue;
+            }
+            PMapSlot *s = nodes[depth]->slots+pos[depth];
+            if(!s->sub)
+                return;
+            depth++;
+            nodes[depth]=s->sub;
+            pos[depth]=0;
+        }
+    }
+public:
+    PMapIterator(const PMapObject *o,bool iskeyiterator){
+        obj = (PMapObject *)o;
+        obj->incRefCt();
+        isKey = iskeyiterator;
+        depth=-1;
+        idx=0;
+    }
+    virtual ~PMapIterator(){
+        if(obj->decRefCt())
+            delete obj;
+    }
+    virtual void first(){
+        idx=0;
+        if(obj->root){
+            depth=0;
+            nodes[0]=obj->root;
+            pos[0]=0;
+            settle();
+        } else
+            depth=-1;
+    }
+    virtual void next(){
+        idx++;
+        pos[depth]++;
+        settle();
+    }
+    virtual bool isDone() const{
+        return depth<0;
+    }
+    virtual Value *current(){
+        PMapSlot *s = nodes[depth]->slots+pos[depth];
+        return isKey ? &s->k : &s->v;
+    }
+    virtual int index() const {
+        return idx;
+    }
+};
+
+Iterator<Value *> *PMapObject::makeValueIterator()const{
+    return new PMapIterator(this,false);
+}
+
+Iterator<Value *> *PMapObject::makeKeyIterator()const{
+    return new PMapIterator(this,true);
+}
+
+/*
+ * The types
+ */
+
+PVecObject *PVecType::get(Value *v)const{
+    if(v->t != this)
+        throw RUNT(EX_TYPE,"").set("not a pvec, is a %s",v->t->name);
+    return (PVecObject *)v->v.gc;
+}
+
+void PVecType::set(Value *v,PVecObject *o)const{
+    v->clr();
+    v->t = this;
+    v->v.gc = o;
+    incRef(v);
+}
+
+PVecObject *PVecType::set(Value *v)const{
+    PVecObject *o = new PVecObject();
+    set(v,o);
+    return o;
+}
+
+void PVecType::setValue(Value *coll,Value *k,Value *v)const{
+    throw RUNT(EX_NOTSUP,"pvecs cannot be changed, use persist$set");
+}
+
+void PVecType::getValue(Value *coll,Value *k,Value *result)const{
+    result->copy(get(coll)->get(k->toInt()));
+}
+
+int PVecType::getCount(Value *coll)const{
+    return get(coll)->count;
+}
+
+void PVecType::removeAndReturn(Value *coll,Value *k,Value *result)const{
+    throw RUNT(EX_NOTSUP,"pvecs cannot be changed, use persist$pop");
+}
+
+void PVecType::clone(Value *out,const Value *in,bool deep)const{
+    PVecObject *p = get(const_cast<Value *>(in));
+    if(!deep){
+        // nothing can change it, so there's no need to copy it
+        out->copy(in);
+        return;
+    }
+    PVecObject *o = new PVecObject();
+    Value tmp;
+    set(&tmp,o);
+    for(int i=0;i<p->count;i++){
+        Value v;
+        Value *item = p->get(i);
+        item->t->clone(&v,item);
+        o->append(&v);
+    }
+    out->copy(&tmp);
+}
+
+PMapObject *PMapType::get(Value *v)const{
+    if(v->t != this)
+        throw RUNT(EX_TYPE,"").set("not a pmap, is a %s",v->t->name);
+    return (PMapObject *)v->v.gc;
+}
+
+void PMapType::set(Value *v,PMapObject *o)const{
+    v->clr();
+    v->t = this;
+    v->v.gc = o;
+    incRef(v);
+}
+
+PMapObject *PMapType::set(Value *v)const{
+    PMapObject *o = new PMapObject();
+    set(v,o);
+    return o;
+}
+
+void PMapType::setValue(Value *coll,Value *k,Value *v)const{
+    throw RUNT(EX_NOTSUP,"pmaps cannot be changed, use persist$set");
+}
+
+void PMapType::getValue(Value *coll,Value *k,Value *result)const{
+    Value *v = get(coll)->find(k);
+    if(v)
+        result->copy(v);
+    else
+        result->clr();
+}
+
+int PMapType::getCount(Value *coll)const{
+    return get(coll)->count;
+}
+
+bool PMapType::contains(Value *coll,Value *item)const{
+    return get(coll)->find(item)!=NULL;
+}
+
+int PMapType::getIndexOfContainedItem(Value *coll,Value *item)const {
+    throw RUNT(EX_BADOP,"cannot find index of item in a pmap");
+}
+
+void PMapType::removeAndReturn(Value *coll,Value *k,Value *result)const{
+    throw RUNT(EX_NOTSUP,"pmaps cannot be changed, use persist$del");
+}
+
+void PMapType::clone(Value *out,const Value *in,bool deep)const{
+    PMapObject *p = get(const_cast<Value *>(in));
+    if(!deep){
+        out->copy(in);
+        return;
+    }
+    PMapObject *o = new PMapObject();
+    Value tmp;
+    set(&tmp,o);
+    // keys can't be collections, so only the values need cloning
+    Iterator<Value *> *iter = p->makeKeyIterator();
+    for(iter->first();!iter->isDone();iter->next()){
+        Value v;
+        Value *item = p->find(iter->current());
+        item->t->clone(&v,item);
+        o->put(iter->current(),&v);
+    }
+    delete iter;
+    out->copy(&tmp);
+}
+
+}
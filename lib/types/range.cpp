@@ -77,6 +77,22 @@ template<> int RangeType<int>::getIndexOfContainedItem(Value *v,Value *item)cons
     return ((i-r->start)/r->step);
 }
 
+template<> int RangeType<int>::getSizeHint(Value *v)const{
+    Range<int> *r = v->v.irange;
+    if(!r->step)
+        return -1;
+    // the end is exclusive, so round the span away from zero
+    long span = (long)r->end-r->start;
+    span += r->step>0 ? r->step-1 : r->step+1;
+    long n = span/r->step;
+    return n>0 ? n : 0;
+}
+
+// float ranges can be a step out either way from rounding
+template<> int RangeType<float>::getSizeHint(Value *v)const{
+    return -1;
+}
+
 template<> void RangeType<float>::clone(Value *out,const Value *in,bool deep)const {
     Range<float> *i = in->v.frange;
     Range<float> *r = new Range<float>(*i);
@@ -226,4 +242,32 @@ template<> int RangeType<float>::getIndexOfContainedItem(Value *v,Value *item)co
         return -1;
     return ((i-r->start)/r->step);
 }
+
+template<> void RangeType<int>::serialise(Serialiser *s,Value *v)const{
+    Range<int> *r = v->v.irange;
+    s->writeInt(r->start);
+    s->writeInt(r->end);
+    s->writeInt(r->step);
+}
+
+template<> void RangeType<int>::deserialise(Deserialiser *d,Value *out)const{
+    int start = d->readInt();
+    int end = d->readInt();
+    int step = d->readInt();
+    set(out,start,end,step);
+}
+
+template<> void RangeType<float>::serialise(Serialiser *s,Value *v)const{
+    Range<float> *r = v->v.frange;
+    s->writeBytes(&r->start,sizeof(float));
+    s->writeBytes(&r->end,sizeof(float));
+    s->writeBytes(&r->step,sizeof(float));
+}
+
+template<> void RangeType<float>::deserialise(Deserialiser *d,Value *out)const{
+    float f[3];
+    memcpy(f,d->readBytes(sizeof(f)),sizeof(f));
+    set(out,f[0],f[1],f[2]);
+}
+
 }
@@ -0,0 +1,68 @@
+/**
+ * @file strbuild.cpp
+ * @brief  String builders - see strbuild.h.
+ *
+ */
+
+#include "angort.h"
+
+namespace angort {
+
+void StringBuilder::reserve(int n){
+    if(len+n+1 <= cap)
+        return;
+    int newcap = cap ? cap : 32;
+    while(newcap < len+n+1)
+        newcap *= 2;
+    buf = (char *)realloc(buf,newcap);
+    cap = newcap;
+}
+
+void StringBuilder::append(const char *s,int n){
+    reserve(n);
+    memcpy(buf+len,s,n);
+    len+=n;
+    buf[len]=0;
+}
+
+void StringBuilder::append(const Value *v){
+    // strings (and views) are by far the most common, so avoid the StringBuffer
+    if(StringType::isString(v))
+        append(Types::tString->getBytes(v),Types::tString->getByteLength(v));
+    else
+        append(v->toString().get());
+}
+
+StringBuilder *StrBuildType::get(Value *v)const{
+    if(v->t != this)
+        throw RUNT(EX_TYPE,"").set("not a string builder, is a %s",v->t->name);
+    return &((StrBuildObject *)v->v.gc)->b;
+}
+
+StringBuilder *StrBuildType::set(Value *v)const{
+    StrBuildObject *o = new StrBuildObject();
+    v->clr();
+    v->t = this;
+    v->v.gc = o;
+    incRef(v);
+    return &o->b;
+}
+
+int StrBuildType::getCount(Value *coll)const{
+    StringBuilder *b = get(coll);
+    return StringType::countUTF8(b->get(),b->length());
+}
+
+void StrBuildType::clone(Value *out,const Value *in,bool deep)const{
+    StringBuilder *src = get(const_cast<Value *>(in));
+    Value tmp;
+    set(&tmp)->append(src->get(),src->length());
+    out->copy(&tmp);
+}
+
+const char *StrBuildType::toString(bool *allocated,const Value *v) const {
+    *allocated=true;
+    return strdup(((StrBuildObject *)v->v.gc)->b.get());
+}
+
+}
@@ -7,20 +7,23 @@
  */
 
 #include "angort.h"
-#include <wchar.h>
 
 namespace angort {
 
+/// true for bytes which start a UTF-8 code point, rather than
+/// continuing one
+static inline bool isLead(char c){
+    return (c&0xc0)!=0x80;
+}
+
 class StringIterator : public Iterator<Value *> {
 private:
     Value v; // result
     Value string; // string we're going over
-    StringBuffer buf; // string buffer
-    const wchar_t *wstr; // the string (as wide)
-    char tmp[2];
-    int idx,len;
+    const char *str; // its data
+    int pos,bytes; // byte offset of the current character, and length
+    int idx;
 public:
-    const char *p,*str;
     StringIterator(const Value *v);
     virtual ~StringIterator(){}
     virtual void first();
@@ -35,55 +38,201 @@ public:
 
 StringIterator::StringIterator(const Value *s){
     string.copy(s);
-    buf.set(s);
-    wstr=buf.getWide();
+    str = Types::tString->getBytes(&string);
+    bytes = Types::tString->getByteLength(&string);
+    pos=0;
     idx=0;
-    len=wcslen(wstr);
 }
 
 void StringIterator::first(){
+    pos=0;
     idx=0;
 }
 void StringIterator::next(){
+    pos+=StringType::charBytesUTF8(str+pos);
     idx++;
 }
 
 bool StringIterator::isDone() const {
-    return idx>=len;
+    return pos>=bytes;
 }
 Value *StringIterator::current(){
-    int n = wctomb(tmp,wstr[idx]);
-    tmp[n]=0;
-    Types::tString->set(&v,tmp);
+    Types::tString->setwithlen(&v,str+pos,StringType::charBytesUTF8(str+pos));
     return &v;
 }
 
 
+int StringType::countUTF8(const char *s,int bytes){
+    const char *p = s;
+    const char *end = s+bytes;
+    int n=bytes;
+    // take off the continuation bytes (10xxxxxx), eight at a time. Each
+    // byte of acc counts those in its own lane, so it can take 255
+    // words before it has to be added up (popcount is a library call
+    // unless we're built for a CPU which has it).
+    while(p+8<=end){
+        uint64_t acc=0;
+        for(int k=0;k<255 && p+8<=end;k++,p+=8){
+            uint64_t w;
+            memcpy(&w,p,8);
+            acc += (w & ~(w<<1) & 0x8080808080808080ULL)>>7;
+        }
+        // add the lanes in pairs, then sum the 16-bit lanes
+        acc = (acc & 0x00ff00ff00ff00ffULL) + ((acc>>8) & 0x00ff00ff00ff00ffULL);
+        n -= (acc*0x0001000100010001ULL)>>48;
+    }
+    while(p<end)
+        if(!isLead(*p++))n--;
+    return n;
+}
+
+int StringType::offsetUTF8(const char *s,int bytes,int n){
+    const char *p = s;
+    const char *end = s+bytes;
+    int seen=0; // code points passed so far
+    while(p<end){
+        // skip eight ASCII characters at a time if we can
+        if(p+8<=end && seen+8<=n){
+            uint64_t w;
+            memcpy(&w,p,8);
+            if(!(w & 0x8080808080808080ULL)){
+                seen+=8;
+                p+=8;
+                continue;
+            }
+        }
+        if(isLead(*p)){
+            if(seen==n)
+                break;
+            seen++;
+        }
+        p++;
+    }
+    return p-s;
+}
+
+bool StringType::isString(const Value *v){
+    return v->t == Types::tString || v->t == Types::tStrView;
+}
+
+const char *StringType::getBytes(const Value *v)const{
+    if(v->t == Types::tStrView)
+        return Types::tStrView->getBytes(v);
+    return getData(v);
+}
+
+const char *StringType::getBytes(const Value *v,int *len,StringBuffer& sb)const{
+    if(isString(v)){
+        *len = getByteLength(v);
+        return getBytes(v);
+    }
+    sb.set(v);
+    *len = strlen(sb.get());
+    return sb.get();
+}
+
+int StringType::getByteLength(const Value *v)const{
+    BlockAllocHeader *h = v->v.block;
+    if(h->bytes<0)
+        h->bytes = strlen(getData(v));
+    return h->bytes;
+}
+
+int StringType::getCount(Value *v)const{
+    BlockAllocHeader *h = v->v.block;
+    if(h->chars<0)
+        h->chars = countUTF8(getBytes(v),getByteLength(v));
+    return h->chars;
+}
+
+bool StringType::isASCII(const Value *v)const{
+    return getCount(const_cast<Value *>(v)) == getByteLength(v);
+}
+
+int StringType::getByteOffset(const Value *v,int n)const{
+    int chars = getCount(const_cast<Value *>(v));
+    int bytes = getByteLength(v);
+    if(n<=0)
+        return 0;
+    if(n>=chars)
+        return bytes;
+    if(chars==bytes)
+        return n;
+    
+    const char *s = getBytes(v);
+    if(bytes < STRING_INDEX_STEP*4)
+        return offsetUTF8(s,bytes,n);
+    
+    BlockAllocHeader *h = v->v.block;
+    if(!h->index){
+        // build the index; if another thread beats us to it, use theirs
+        int *idx = (int *)malloc(sizeof(int)*(chars/STRING_INDEX_STEP+1));
+        int c=0;
+        for(int i=0;i<bytes;i++){
+            if(isLead(s[i])){
+                if(!(c%STRING_INDEX_STEP))
+                    idx[c/STRING_INDEX_STEP]=i;
+                c++;
+            }
+        }
+        if(!__sync_bool_compare_and_swap(&h->index,(int *)NULL,idx))
+            free(idx);
+    }
+    int base = h->index[n/STRING_INDEX_STEP];
+    return base+offsetUTF8(s+base,bytes-base,n%STRING_INDEX_STEP);
+}
+
+void StringType::substring(Value *out,const Value *v,int start,int end)const{
+    substringBytes(out,v,getByteOffset(v,start),getByteOffset(v,end),end-start);
+}
+
+void StringType::substringBytes(Value *out,const Value *v,int so,int eo,int chars)const{
+    if(eo-so < STRVIEW_MIN){
+        if(out==v){
+            // copy via a temporary, as setting out would free the data
+            Value t;
+            substringBytes(&t,v,so,eo,chars);
+            out->copy(&t);
+        } else {
+            setwithlen(out,getBytes(v)+so,eo-so);
+            out->v.block->chars = chars;
+        }
+    } else if(v->t == Types::tStrView){
+        // views are always of the original string, never of other views
+        Types::tStrView->set(out,Types::tStrView->getParent(v),
+                             Types::tStrView->getOffset(v)+so,eo-so,chars);
+    } else
+        Types::tStrView->set(out,v->v.block,so,eo-so,chars);
+}
 
+Value *StringType::coerce(Value *v,Value *tmp)const{
+    if(isString(v))
+        return v;
+    set(tmp,v->toString().get());
+    return tmp;
+}
 
 
+// these always make real strings, even when called on the view type
+// (as happens when slicing a view).
 void StringType::set(Value *v,const char *s)const{
     int len = strlen(s);
-    char *dest = allocate(v,len+1,this);
-    strcpy(dest,s);
+    char *dest = allocate(v,len+1,Types::tString);
+    memcpy(dest,s,len+1);
+    v->v.block->bytes = len;
 }
 
 char *StringType::setAllocateOnly(Value *v,int len)const{
-    return allocate(v,len+1,this);
+    return allocate(v,len+1,Types::tString);
 }
 
 void StringType::setwithlen(Value *v,const char *s,int len)const{
-    char *dest = allocate(v,len+1,this);
+    char *dest = allocate(v,len+1,Types::tString);
     memcpy(dest,s,len);
     dest[len]=0;
+    v->v.block->bytes = len;
 }
 
-int StringType::getCount(Value *v)const{
-    const char *s = getData(v);
-    return mbstowcs(NULL,s,0);
-}
-
-
 void StringType::setPreAllocated(Value *v,BlockAllocHeader *b)const{
     v->clr();
     v->t = Types::tString;
@@ -112,10 +261,12 @@ long StringType::toLong(const Value *v) const {
 
 uint32_t StringType::getHash(Value *v)const{
     // Fowler-Noll-Vo hash, variant 1a
-    const unsigned char *s = (const unsigned char *)getData(v);
+    // (of the bytes, so that views hash the same as strings)
+    const unsigned char *s = (const unsigned char *)getBytes(v);
+    const unsigned char *end = s+getByteLength(v);
     uint32_t h = 2166136261U;
     
-    while(*s){
+    while(s<end){
         h ^= *s++;
         h *= 16777619U;
     }
@@ -123,31 +274,62 @@ uint32_t StringType::getHash(Value *v)const{
 }
 
 bool StringType::equalForHashTable(Value *a,Value *b)const{
-    if(a->t != b->t)return false;
-    return !strcmp(getData(a),getData(b));
+    // strings and views are equal if they hold the same characters
+    if(!isString(a) || !isString(b))return false;
+    int len = getByteLength(a);
+    return len==getByteLength(b) && !memcmp(getBytes(a),getBytes(b),len);
 }
 
 void StringType::setValue(Value *coll,Value *k,Value *v)const{
-    char *s = (char *)getData(coll);
+    // This changes the string in place, so that everything referring
+    // to it sees the change. The block can't be moved, as that would
+    // leave the other references behind, so the new character can't
+    // have more bytes than the one it replaces. Substrings taken from
+    // it earlier mustn't change, though, so any views are moved onto
+    // a copy first.
+    BlockAllocHeader *h = coll->v.block;
+    if(h->flags & BAH_MAPPED)
+        throw RUNT(EX_NOTSUP,"cannot change a string read from a file - clone it first");
     int idx = k->toInt();
-    s[idx]=v->toString().get()[0];
+    if(idx<0 || idx>=getCount(coll))
+        throw RUNT(EX_OUTOFRANGE,"string set out of range");
+    
+    Value tmp;
+    Value *cv = coerce(v,&tmp);
+    if(!getByteLength(cv))
+        throw RUNT(EX_BADPARAM,"cannot set a character of a string to an empty string");
+    const char *c = getBytes(cv);
+    int clen = charBytesUTF8(c);
+    
+    char *s = (char *)getData(coll);
+    int bytes = getByteLength(coll);
+    int so = getByteOffset(coll,idx);
+    int eo = so+charBytesUTF8(s+so);
+    if(clen > eo-so)
+        throw RUNT(EX_NOTSUP,"cannot put a wider character into a string");
+    if(h->views)
+        Types::tStrView->detach(h,bytes);
+    
+    // close up the gap and put the terminator back
+    memmove(s+so+clen,s+eo,bytes-eo+1);
+    memcpy(s+so,c,clen);
+    
+    // what we know about the string has to be worked out again
+    h->bytes=bytes-(eo-so)+clen;
+    h->chars=-1;
+    free(h->index);
+    h->index=NULL;
 }
 void StringType::getValue(Value *coll,Value *k,Value *result)const{
-    const char *s = (char *)getData(coll);
-    
     int idx = k->toInt();
-    char out[2];
-    out[1]=0;
-    out[0]=s[idx];
-    set(result,out);
+    if(idx<0 || idx>=getCount(coll))
+        throw RUNT(EX_OUTOFRANGE,"string get out of range");
+    substring(result,coll,idx,idx+1);
 }
 
 /// deprecated version
 void StringType::slice_dep(Value *out,Value *coll,int start,int len)const{
-    const StringBuffer &b = StringBuffer(coll);
-    wchar_t *s = b.getWideBuffer(); // allocates memory
-    
-    int slen = wcslen(s);
+    int slen = getCount(coll);
     if(start<0)start=slen+start;
     if(start<0)start=0;
     if(len<0)len=slen;
@@ -160,75 +342,36 @@ void StringType::slice_dep(Value *out,Value *coll,int start,int len)const{
         if(len<=0)
             set(out,"");
         else
-        {
-            wchar_t *outbuf = s+start;
-            outbuf[len]=0;
-            
-            // and convert back.
-            
-            mbstate_t state;
-            memset(&state,0,sizeof(state));
-            
-            const wchar_t *p = outbuf;
-            int mblen = wcsrtombs(NULL,&p,0,&state);
-            char *smb = allocate(out,mblen+1,this);
-            p = outbuf;
-            wcsrtombs(smb,&p,mblen+1,&state); // +1 for the null
-        }
+            substring(out,coll,start,start+len);
     }
-    
-    
-    free(s); // free the buffer
 }
 
 /// good version
 void StringType::slice(Value *out,Value *coll,int startin,int endin)const{
-    const StringBuffer &b = StringBuffer(coll);
-    wchar_t *s = b.getWideBuffer(); // allocates memory
-    
     int start,end;
-    int slen = wcslen(s);
-    bool ok = getSliceEndpoints(&start,&end,slen,startin,endin);
-    
-    
-    if(ok){
-        // getWideBuffer will have allocated some data
-        // we can change, so we work out where the slice is
-        // in this buffer and terminate it.
-        s[end]=0;
-        wchar_t *slicebuf = s+start;
-        // slicebuf is now a null-terminated slice inside the wide
-        // buffer.
-        
-        // and now convert back to mbs
-        
-        mbstate_t state;
-        memset(&state,0,sizeof(state));
-        
-        const wchar_t *p = slicebuf;
-        int mblen = wcsrtombs(NULL,&p,0,&state);
-        char *smb = allocate(out,mblen+1,this);
-        p = slicebuf;
-        wcsrtombs(smb,&p,mblen+1,&state); // +1 for the null
-    } else {
+    if(getSliceEndpoints(&start,&end,getCount(coll),startin,endin))
+        substring(out,coll,start,end);
+    else
         set(out,"");
-    }
-    
-    free(s); // free the wide buffer
 }
 
 void StringType::clone(Value *out,const Value *in,bool deep)const{
     const char *s = getData(in);
     // note - will work for UTF-8, because gives memory size,
     // not character count
-    int len = strlen(s); 
+    int len = getByteLength(in);
     
     BlockAllocHeader *h = (BlockAllocHeader *)malloc(len+1+sizeof(BlockAllocHeader));
     h->refct=1;
+    h->flags=0;
+    h->bytes=len;
+    h->chars=in->v.block->chars;
+    h->index=NULL;
+    h->views=NULL;
     memcpy((char *)(h+1),s,len+1); // and the null too!
     
     out->v.block = h;
-    out->t = this;
+    out->t = Types::tString;
 }
 
 void StringType::toSelf(Value *out,const Value *v) const {
@@ -241,29 +384,30 @@ Iterator<Value *> *StringType::makeValueIterator(Value *v)const{
 }
 
 int StringType::getIndexOfContainedItem(Value *v,Value *item)const {
-    const StringBuffer &b = StringBuffer(v);
-    const wchar_t *haystack = b.getWideBuffer();
-    const StringBuffer &b2 = StringBuffer(item);
-    const wchar_t *needle = b2.getWideBuffer();
-    
-    const wchar_t *res = wcsstr(haystack,needle);
-    int out = res ? res-haystack: -1;
-    free((void *)needle);
-    free((void *)haystack);
-    return out;
+    Value tmp;
+    const char *haystack = getBytes(v);
+    Value *needle = coerce(item,&tmp);
+    const char *res = (const char *)memmem(haystack,getByteLength(v),
+                                           getBytes(needle),getByteLength(needle));
+    // the index is in code points, so count those before the match
+    return res ? countUTF8(haystack,res-haystack) : -1;
 }
 
 bool StringType::contains(Value *v,Value *item) const {
-    const StringBuffer &b = StringBuffer(v);
-    const wchar_t *haystack = b.getWideBuffer();
-    const StringBuffer &b2 = StringBuffer(item);
-    const wchar_t *needle = b2.getWideBuffer();
-    
-    const wchar_t *res = wcsstr(haystack,needle);
-    free((void *)needle);
-    free((void *)haystack);
-    return res!=NULL;
+    Value tmp;
+    Value *needle = coerce(item,&tmp);
+    return memmem(getBytes(v),getByteLength(v),
+                  getBytes(needle),getByteLength(needle))!=NULL;
 }
 
+void StringType::serialise(Serialiser *s,Value *v)const{
+    s->writeString(getBytes(v),getByteLength(v));
+}
+
+void StringType::deserialise(Deserialiser *d,Value *out)const{
+    int len;
+    const char *s = d->readString(&len);
+    Types::tString->setwithlen(out,s,len);
+}
 
 }
@@ -0,0 +1,119 @@
+/**
+ * @file strview.cpp
+ * @brief  String views - see strview.h.
+ *
+ */
+
+#include "angort.h"
+
+namespace angort {
+
+void StrViewType::set(Value *out,BlockAllocHeader *parent,int offset,int len,int chars)const{
+    {
+        // the view holds a reference to the parent. This is done first,
+        // so out can be cleared even if it's all that holds the parent.
+        WriteLock lock=WL(&globalLock);
+        parent->refct++;
+        if(!parent->refct)
+            parent->refct=BAH_MAXREF; // as BlockAllocType::incRef
+    }
+    StrViewData *d = (StrViewData *)allocate(out,sizeof(StrViewData),this);
+    d->parent = parent;
+    d->offset = offset;
+    out->v.block->bytes = len;
+    out->v.block->chars = chars;
+    
+    // add to the parent's list of views
+    WriteLock lock=WL(&globalLock);
+    d->prev = NULL;
+    d->next = parent->views;
+    if(d->next)
+        getStrViewData(d->next)->prev = out->v.block;
+    parent->views = out->v.block;
+}
+
+void StrViewType::detach(BlockAllocHeader *parent,int bytes)const{
+    WriteLock lock=WL(&globalLock);
+    if(!parent->views)
+        return;
+    BlockAllocHeader *h = (BlockAllocHeader *)malloc(bytes+1+sizeof(BlockAllocHeader));
+    h->flags=0;
+    h->bytes=bytes;
+    h->chars=parent->chars;
+    // the index is of the old data, so goes with it
+    h->index=parent->index;
+    parent->index=NULL;
+    memcpy((char *)(h+1),(char *)(parent+1),bytes+1);
+    
+    // each view's reference moves to the copy
+    uint32_t n=0;
+    for(BlockAllocHeader *v=parent->views;v;v=getStrViewData(v)->next){
+        getStrViewData(v)->parent = h;
+        n++;
+    }
+    h->refct=n;
+    h->views=parent->views;
+    parent->views=NULL;
+    if(parent->refct!=BAH_MAXREF)
+        parent->refct-=n;
+}
+
+void StrViewType::decRef(Value *v)const{
+    BlockAllocHeader *parent;
+    {
+        WriteLock lock=WL(&globalLock);
+        BlockAllocHeader *h = v->v.block;
+        if(h->refct!=BAH_MAXREF)h->refct--; // MAX REFCOUNT is never freed!
+        if(h->refct)
+            return;
+        StrViewData *d = getStrViewData(h);
+        parent = d->parent;
+        // take it out of the parent's list of views
+        if(d->prev)
+            getStrViewData(d->prev)->next = d->next;
+        else
+            parent->views = d->next;
+        if(d->next)
+            getStrViewData(d->next)->prev = d->prev;
+        free(h->index);
+        free(h);
+    }
+    // hand the view's reference to the parent to a temporary string,
+    // which drops it.
+    Value p;
+    Types::tString->setPreAllocated(&p,parent);
+}
+
+const char *StrViewType::toString(bool *allocated,const Value *v) const {
+    int len = getByteLength(v);
+    char *s = (char *)malloc(len+1);
+    memcpy(s,getBytes(v),len);
+    s[len]=0;
+    *allocated=true;
+    return s;
+}
+
+float StrViewType::toFloat(const Value *v) const {
+    return atof(v->toString().get());
+}
+
+double StrViewType::toDouble(const Value *v) const {
+    return atof(v->toString().get());
+}
+
+int StrViewType::toInt(const Value *v) const {
+    return atoi(v->toString().get());
+}
+
+long StrViewType::toLong(const Value *v) const {
+    return atol(v->toString().get());
+}
+
+void StrViewType::clone(Value *out,const Value *in,bool deep)const{
+    Value t;
+    Types::tString->setwithlen(&t,getBytes(in),getByteLength(in));
+    t.v.block->chars = in->v.block->chars;
+    out->copy(&t);
+}
+
+}
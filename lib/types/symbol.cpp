@@ -109,4 +109,22 @@ int getSymbolID(const char *s){
     return Types::tSymbol->getSymbol(s);
 }
 
+void SymbolType::serialise(Serialiser *s,Value *v)const{
+    const char *name = get(v);
+    s->writeString(name,strlen(name));
+}
+
+void SymbolType::deserialise(Deserialiser *d,Value *out)const{
+    int len;
+    const char *s = d->readString(&len);
+    if(len>=MAXSYMBOLLEN)
+        d->fail("symbol too long");
+    char buf[MAXSYMBOLLEN];
+    memcpy(buf,s,len);
+    buf[len]=0;
+    out->clr();
+    out->t = this;
+    out->v.i = getSymbol(buf);
+}
+
 }
@@ -21,6 +21,12 @@ inline void strappend(char **stream,const char *s){
     *stream=newstr;
 }
 
+bool Value::equalStringAndView(Value *other){
+    if(!StringType::isString(this) || !StringType::isString(other))
+        return false;
+    return t->equalForHashTable(this,other);
+}
+
 void Value::dump(char **str,int depth){
     if(!depth)*str=NULL;
     if(t == Types::tList){
@@ -57,7 +63,19 @@ void Value::dump(char **str,int depth){
         }
         delete iter;
         strappend(str,"]");
-    } else if(t==Types::tString){
+    } else if(t->flags & TF_NUMVEC){
+        // dump as the list it can be made from
+        strappend(str,"[");
+        int n = t->getCount(this);
+        for(int i=0;i<n;i++){
+            Value v;
+            ((NumVecTypeBase *)t)->getItem(this,i,&v);
+            v.dump(str,depth+1);
+            if(i!=n-1)strappend(str,",");
+        }
+        strappend(str,"] vec$");
+        strappend(str,t->name);
+    } else if(StringType::isString(this)){
         strappend(str,"\"");
         strappend(str,toString().get());
         strappend(str,"\"");
@@ -0,0 +1,171 @@
+/** @file
+ * Run-time dispatch of the vector kernels - see veckernels.h.
+ */
+
+#include <stddef.h>
+#include "veckernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VK_X86 1
+#else
+#define VK_X86 0
+#endif
+
+namespace angort {
+namespace veck {
+
+#if VK_X86
+// the SIMD versions, each compiled from veckernels_simd.h
+// in its own file with the right compiler flags.
+#define DECLARE_KERNELS(T) \
+    void add(T *c,const T *a,const T *b,int n); \
+    void mul(T *c,const T *a,const T *b,int n); \
+    void scale(T *c,const T *a,T k,int n); \
+    void axpy(T *y,const T *x,T alpha,int n); \
+    double sum(const T *a,int n); \
+    double dot(const T *a,const T *b,int n); \
+    void minmax(const T *a,int n,T *mn,T *mx);
+
+namespace sse2 {
+DECLARE_KERNELS(float)
+DECLARE_KERNELS(double)
+}
+namespace avx {
+DECLARE_KERNELS(float)
+DECLARE_KERNELS(double)
+}
+#endif
+
+static Level detect(){
+#if VK_X86
+    __builtin_cpu_init();
+    // checks the OS saves the AVX state, too.
+    if(__builtin_cpu_supports("avx"))
+        return VK_AVX;
+    if(__builtin_cpu_supports("sse2"))
+        return VK_SSE2;
+#endif
+    return VK_SCALAR;
+}
+
+static Level maxLevel = detect();
+static Level level = maxLevel;
+
+Level getLevel(){
+    return level;
+}
+
+Level getMaxLevel(){
+    return maxLevel;
+}
+
+void setLevel(Level l){
+    level = l>maxLevel ? maxLevel : l;
+}
+
+const char *getLevelName(Level l){
+    switch(l){
+    case VK_SCALAR:return "scalar";
+    case VK_SSE2:return "sse2";
+    case VK_AVX:return "avx";
+    default:return NULL;
+    }
+}
+
+// each of these calls the SIMD version for the current level,
+// or falls through to the scalar template.
+
+#if VK_X86
+#define DISPATCH(call) \
+    switch(level){ \
+    case VK_AVX:return avx::call; \
+    case VK_SSE2:return sse2::call; \
+    default:break; \
+    }
+#else
+#define DISPATCH(call)
+#endif
+
+template <> void add(float *c,const float *a,const float *b,int n){
+    DISPATCH(add(c,a,b,n));
+    for(int i=0;i<n;i++)c[i]=a[i]+b[i];
+}
+template <> void add(double *c,const double *a,const double *b,int n){
+    DISPATCH(add(c,a,b,n));
+    for(int i=0;i<n;i++)c[i]=a[i]+b[i];
+}
+
+template <> void mul(float *c,const float *a,const float *b,int n){
+    DISPATCH(mul(c,a,b,n));
+    for(int i=0;i<n;i++)c[i]=a[i]*b[i];
+}
+template <> void mul(double *c,const double *a,const double *b,int n){
+    DISPATCH(mul(c,a,b,n));
+    for(int i=0;i<n;i++)c[i]=a[i]*b[i];
+}
+
+template <> void scale(float *c,const float *a,float k,int n){
+    DISPATCH(scale(c,a,k,n));
+    for(int i=0;i<n;i++)c[i]=a[i]*k;
+}
+template <> void scale(double *c,const double *a,double k,int n){
+    DISPATCH(scale(c,a,k,n));
+    for(int i=0;i<n;i++)c[i]=a[i]*k;
+}
+
+template <> void axpy(float *y,const float *x,float alpha,int n){
+    DISPATCH(axpy(y,x,alpha,n));
+    for(int i=0;i<n;i++)y[i]+=alpha*x[i];
+}
+template <> void axpy(double *y,const double *x,double alpha,int n){
+    DISPATCH(axpy(y,x,alpha,n));
+    for(int i=0;i<n;i++)y[i]+=alpha*x[i];
+}
+
+template <> double sum(const float *a,int n){
+    DISPATCH(sum(a,n));
+    double s=0;
+    for(int i=0;i<n;i++)s+=a[i];
+    return s;
+}
+template <> double sum(const double *a,int n){
+    DISPATCH(sum(a,n));
+    double s=0;
+    for(int i=0;i<n;i++)s+=a[i];
+    return s;
+}
+
+template <> double dot(const float *a,const float *b,int n){
+    DISPATCH(dot(a,b,n));
+    double s=0;
+    for(int i=0;i<n;i++)s+=(double)a[i]*b[i];
+    return s;
+}
+template <> double dot(const double *a,const double *b,int n){
+    DISPATCH(dot(a,b,n));
+    double s=0;
+    for(int i=0;i<n;i++)s+=a[i]*b[i];
+    return s;
+}
+
+template <> void minmax(const float *a,int n,float *mn,float *mx){
+    DISPATCH(minmax(a,n,mn,mx));
+    float lo=a[0],hi=a[0];
+    for(int i=1;i<n;i++){
+        if(a[i]<lo)lo=a[i];
+        if(a[i]>hi)hi=a[i];
+    }
+    *mn=lo;*mx=hi;
+}
+template <> void minmax(const double *a,int n,double *mn,double *mx){
+    DISPATCH(minmax(a,n,mn,mx));
+    double lo=a[0],hi=a[0];
+    for(int i=1;i<n;i++){
+        if(a[i]<lo)lo=a[i];
+        if(a[i]>hi)hi=a[i];
+    }
+    *mn=lo;*mx=hi;
+}
+
+}
+}
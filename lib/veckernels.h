@@ -0,0 +1,96 @@
+/** @file
+ * Elementwise and reduction kernels over packed numeric arrays, used
+ * by the vec$ words. The float and double versions have SSE2 and AVX
+ * implementations (in veckernels_simd.h), and the best one the CPU
+ * supports is chosen at run time; integers use plain loops.
+ */
+
+#ifndef __VECKERNELS_H
+#define __VECKERNELS_H
+
+namespace angort {
+namespace veck {
+
+/// SIMD levels, in increasing order of capability
+enum Level {
+    VK_SCALAR,VK_SSE2,VK_AVX
+};
+
+/// the level currently in use
+Level getLevel();
+/// the best level this CPU supports
+Level getMaxLevel();
+/// use a given level (or the best there is, if that's lower); mostly
+/// for testing the fallbacks.
+void setLevel(Level l);
+/// the name of a level, or NULL if it's not a level
+const char *getLevelName(Level l);
+
+/// the type in which sums and dot products are accumulated and returned
+template <class T> struct Acc {
+    typedef long type;
+};
+template <> struct Acc<float> {
+    typedef double type;
+};
+template <> struct Acc<double> {
+    typedef double type;
+};
+
+// the scalar versions, used for integers and as the fallback.
+
+template <class T> void add(T *c,const T *a,const T *b,int n){
+    for(int i=0;i<n;i++)c[i]=a[i]+b[i];
+}
+template <class T> void mul(T *c,const T *a,const T *b,int n){
+    for(int i=0;i<n;i++)c[i]=a[i]*b[i];
+}
+/// c = a*k
+template <class T> void scale(T *c,const T *a,T k,int n){
+    for(int i=0;i<n;i++)c[i]=a[i]*k;
+}
+/// y = y + alpha*x
+template <class T> void axpy(T *y,const T *x,T alpha,int n){
+    for(int i=0;i<n;i++)y[i]+=alpha*x[i];
+}
+template <class T> typename Acc<T>::type sum(const T *a,int n){
+    typename Acc<T>::type s=0;
+    for(int i=0;i<n;i++)s+=a[i];
+    return s;
+}
+template <class T> typename Acc<T>::type dot(const T *a,const T *b,int n){
+    typename Acc<T>::type s=0;
+    for(int i=0;i<n;i++)s+=(typename Acc<T>::type)a[i]*b[i];
+    return s;
+}
+/// n must be at least 1
+template <class T> void minmax(const T *a,int n,T *mn,T *mx){
+    T lo=a[0],hi=a[0];
+    for(int i=1;i<n;i++){
+        if(a[i]<lo)lo=a[i];
+        if(a[i]>hi)hi=a[i];
+    }
+    *mn=lo;*mx=hi;
+}
+
+// the float and double versions dispatch on the current level
+
+template <> void add(float *c,const float *a,const float *b,int n);
+template <> void add(double *c,const double *a,const double *b,int n);
+template <> void mul(float *c,const float *a,const float *b,int n);
+template <> void mul(double *c,const double *a,const double *b,int n);
+template <> void scale(float *c,const float *a,float k,int n);
+template <> void scale(double *c,const double *a,double k,int n);
+template <> void axpy(float *y,const float *x,float alpha,int n);
+template <> void axpy(double *y,const double *x,double alpha,int n);
+template <> double sum(const float *a,int n);
+template <> double sum(const double *a,int n);
+template <> double dot(const float *a,const float *b,int n);
+template <> double dot(const double *a,const double *b,int n);
+template <> void minmax(const float *a,int n,float *mn,float *mx);
+template <> void minmax(const double *a,int n,double *mn,double *mx);
+
+}
+}
+
+#endif /* __VECKERNELS_H */
@@ -0,0 +1,37 @@
+/** @file
+ * AVX versions of the vector kernels - see veckernels_simd.h.
+ * This file is compiled with -mavx, so nothing in it may be called
+ * unless the CPU has been found to support AVX.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+#define VK_NS avx
+#define VK_WF 8
+#define VK_WD 4
+#define VK_PS __m256
+#define VK_PD __m256d
+#define VK_LOADPS _mm256_loadu_ps
+#define VK_LOADPD _mm256_loadu_pd
+#define VK_STOREPS _mm256_storeu_ps
+#define VK_STOREPD _mm256_storeu_pd
+#define VK_ADDPS _mm256_add_ps
+#define VK_ADDPD _mm256_add_pd
+#define VK_MULPS _mm256_mul_ps
+#define VK_MULPD _mm256_mul_pd
+#define VK_MINPS _mm256_min_ps
+#define VK_MINPD _mm256_min_pd
+#define VK_MAXPS _mm256_max_ps
+#define VK_MAXPD _mm256_max_pd
+#define VK_SET1PS _mm256_set1_ps
+#define VK_SET1PD _mm256_set1_pd
+#define VK_ZEROPD _mm256_setzero_pd
+// convert the low and high halves of a float vector to doubles
+#define VK_CVTLO(v) _mm256_cvtps_pd(_mm256_castps256_ps128(v))
+#define VK_CVTHI(v) _mm256_cvtps_pd(_mm256_extractf128_ps(v,1))
+
+#include "veckernels_simd.h"
+
+#endif
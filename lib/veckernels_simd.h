@@ -0,0 +1,173 @@
+/** @file
+ * The SIMD vector kernels, written once in terms of the VK_ macros
+ * and compiled by veckernels_sse2.cpp and veckernels_avx.cpp, each of
+ * which defines the macros for its instruction set and the namespace
+ * (VK_NS) to put the kernels in. Unaligned loads and stores are
+ * used throughout, and the leftover items at the end are done one by one.
+ * Float sums and dot products are accumulated as doubles.
+ */
+
+namespace angort {
+namespace veck {
+namespace VK_NS {
+
+void add(float *c,const float *a,const float *b,int n){
+    int i=0;
+    for(;i+VK_WF<=n;i+=VK_WF)
+        VK_STOREPS(c+i,VK_ADDPS(VK_LOADPS(a+i),VK_LOADPS(b+i)));
+    for(;i<n;i++)c[i]=a[i]+b[i];
+}
+void add(double *c,const double *a,const double *b,int n){
+    int i=0;
+    for(;i+VK_WD<=n;i+=VK_WD)
+        VK_STOREPD(c+i,VK_ADDPD(VK_LOADPD(a+i),VK_LOADPD(b+i)));
+    for(;i<n;i++)c[i]=a[i]+b[i];
+}
+
+void mul(float *c,const float *a,const float *b,int n){
+    int i=0;
+    for(;i+VK_WF<=n;i+=VK_WF)
+        VK_STOREPS(c+i,VK_MULPS(VK_LOADPS(a+i),VK_LOADPS(b+i)));
+    for(;i<n;i++)c[i]=a[i]*b[i];
+}
+void mul(double *c,const double *a,const double *b,int n){
+    int i=0;
+    for(;i+VK_WD<=n;i+=VK_WD)
+        VK_STOREPD(c+i,VK_MULPD(VK_LOADPD(a+i),VK_LOADPD(b+i)));
+    for(;i<n;i++)c[i]=a[i]*b[i];
+}
+
+void scale(float *c,const float *a,float k,int n){
+    VK_PS kk = VK_SET1PS(k);
+    int i=0;
+    for(;i+VK_WF<=n;i+=VK_WF)
+        VK_STOREPS(c+i,VK_MULPS(VK_LOADPS(a+i),kk));
+    for(;i<n;i++)c[i]=a[i]*k;
+}
+void scale(double *c,const double *a,double k,int n){
+    VK_PD kk = VK_SET1PD(k);
+    int i=0;
+    for(;i+VK_WD<=n;i+=VK_WD)
+        VK_STOREPD(c+i,VK_MULPD(VK_LOADPD(a+i),kk));
+    for(;i<n;i++)c[i]=a[i]*k;
+}
+
+void axpy(float *y,const float *x,float alpha,int n){
+    VK_PS aa = VK_SET1PS(alpha);
+    int i=0;
+    for(;i+VK_WF<=n;i+=VK_WF)
+        VK_STOREPS(y+i,VK_ADDPS(VK_LOADPS(y+i),VK_MULPS(aa,VK_LOADPS(x+i))));
+    for(;i<n;i++)y[i]+=alpha*x[i];
+}
+void axpy(double *y,const double *x,double alpha,int n){
+    VK_PD aa = VK_SET1PD(alpha);
+    int i=0;
+    for(;i+VK_WD<=n;i+=VK_WD)
+        VK_STOREPD(y+i,VK_ADDPD(VK_LOADPD(y+i),VK_MULPD(aa,VK_LOADPD(x+i))));
+    for(;i<n;i++)y[i]+=alpha*x[i];
+}
+
+/// add up the lanes of a double accumulator
+static inline double hsum(VK_PD acc){
+    double t[VK_WD];
+    VK_STOREPD(t,acc);
+    double s=0;
+    for(int i=0;i<VK_WD;i++)s+=t[i];
+    return s;
+}
+
+double sum(const float *a,int n){
+    VK_PD acc = VK_ZEROPD();
+    int i=0;
+    for(;i+VK_WF<=n;i+=VK_WF){
+        VK_PS v = VK_LOADPS(a+i);
+        acc = VK_ADDPD(acc,VK_CVTLO(v));
+        acc = VK_ADDPD(acc,VK_CVTHI(v));
+    }
+    double s = hsum(acc);
+    for(;i<n;i++)s+=a[i];
+    return s;
+}
+double sum(const double *a,int n){
+    VK_PD acc = VK_ZEROPD();
+    int i=0;
+    for(;i+VK_WD<=n;i+=VK_WD)
+        acc = VK_ADDPD(acc,VK_LOADPD(a+i));
+    double s = hsum(acc);
+    for(;i<n;i++)s+=a[i];
+    return s;
+}
+
+double dot(const float *a,const float *b,int n){
+    VK_PD acc = VK_ZEROPD();
+    int i=0;
+    for(;i+VK_WF<=n;i+=VK_WF){
+        VK_PS va = VK_LOADPS(a+i);
+        VK_PS vb = VK_LOADPS(b+i);
+        acc = VK_ADDPD(acc,VK_MULPD(VK_CVTLO(va),VK_CVTLO(vb)));
+        acc = VK_ADDPD(acc,VK_MULPD(VK_CVTHI(va),VK_CVTHI(vb)));
+    }
+    double s = hsum(acc);
+    for(;i<n;i++)s+=(double)a[i]*b[i];
+    return s;
+}
+double dot(const double *a,const double *b,int n){
+    VK_PD acc = VK_ZEROPD();
+    int i=0;
+    for(;i+VK_WD<=n;i+=VK_WD)
+        acc = VK_ADDPD(acc,VK_MULPD(VK_LOADPD(a+i),VK_LOADPD(b+i)));
+    double s = hsum(acc);
+    for(;i<n;i++)s+=a[i]*b[i];
+    return s;
+}
+
+void minmax(const float *a,int n,float *mn,float *mx){
+    float lo=a[0],hi=a[0];
+    int i=0;
+    if(n>=VK_WF){
+        VK_PS vlo = VK_LOADPS(a);
+        VK_PS vhi = vlo;
+        for(i=VK_WF;i+VK_WF<=n;i+=VK_WF){
+            VK_PS v = VK_LOADPS(a+i);
+            vlo = VK_MINPS(vlo,v);
+            vhi = VK_MAXPS(vhi,v);
+        }
+        float t[VK_WF];
+        VK_STOREPS(t,vlo);
+        for(int j=0;j<VK_WF;j++)if(t[j]<lo)lo=t[j];
+        VK_STOREPS(t,vhi);
+        for(int j=0;j<VK_WF;j++)if(t[j]>hi)hi=t[j];
+    }
+    for(;i<n;i++){
+        if(a[i]<lo)lo=a[i];
+        if(a[i]>hi)hi=a[i];
+    }
+    *mn=lo;*mx=hi;
+}
+void minmax(const double *a,int n,double *mn,double *mx){
+    double lo=a[0],hi=a[0];
+    int i=0;
+    if(n>=VK_WD){
+        VK_PD vlo = VK_LOADPD(a);
+        VK_PD vhi = vlo;
+        for(i=VK_WD;i+VK_WD<=n;i+=VK_WD){
+            VK_PD v = VK_LOADPD(a+i);
+            vlo = VK_MINPD(vlo,v);
+            vhi = VK_MAXPD(vhi,v);
+        }
+        double t[VK_WD];
+        VK_STOREPD(t,vlo);
+        for(int j=0;j<VK_WD;j++)if(t[j]<lo)lo=t[j];
+        VK_STOREPD(t,vhi);
+        for(int j=0;j<VK_WD;j++)if(t[j]>hi)hi=t[j];
+    }
+    for(;i<n;i++){
+        if(a[i]<lo)lo=a[i];
+        if(a[i]>hi)hi=a[i];
+    }
+    *mn=lo;*mx=hi;
+}
+
+}
+}
+}
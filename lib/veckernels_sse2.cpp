@@ -0,0 +1,35 @@
+/** @file
+ * SSE2 versions of the vector kernels - see veckernels_simd.h.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <emmintrin.h>
+
+#define VK_NS sse2
+#define VK_WF 4
+#define VK_WD 2
+#define VK_PS __m128
+#define VK_PD __m128d
+#define VK_LOADPS _mm_loadu_ps
+#define VK_LOADPD _mm_loadu_pd
+#define VK_STOREPS _mm_storeu_ps
+#define VK_STOREPD _mm_storeu_pd
+#define VK_ADDPS _mm_add_ps
+#define VK_ADDPD _mm_add_pd
+#define VK_MULPS _mm_mul_ps
+#define VK_MULPD _mm_mul_pd
+#define VK_MINPS _mm_min_ps
+#define VK_MINPD _mm_min_pd
+#define VK_MAXPS _mm_max_ps
+#define VK_MAXPD _mm_max_pd
+#define VK_SET1PS _mm_set1_ps
+#define VK_SET1PD _mm_set1_pd
+#define VK_ZEROPD _mm_setzero_pd
+// convert the low and high halves of a float vector to doubles
+#define VK_CVTLO(v) _mm_cvtps_pd(v)
+#define VK_CVTHI(v) _mm_cvtps_pd(_mm_movehl_ps(v,v))
+
+#include "veckernels_simd.h"
+
+#endif
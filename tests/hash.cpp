@@ -8,6 +8,7 @@
 
 #include "test.h"
 #include "hash.h"
+#include <sys/time.h>
 
 #define HCOUNT 10000
 
@@ -82,6 +83,194 @@ public:
     
     }
     
+    void t3(){
+        // deletion, with enough keys that the table is resized
+        // while there are deleted slots in it
+        printf("test 3, deletion----\n");
+        Hash h;
+        Value v,w;
+        
+        for(int i=0;i<HCOUNT;i++){
+            Types::tInteger->set(&v,i);
+            Types::tInteger->set(&w,i*2);
+            h.set(&v,&w);
+            // delete every third key as we go
+            if(i%3==0 && !h.del(&v))
+                die("key not deleted");
+        }
+        for(int i=0;i<HCOUNT;i++){
+            Types::tInteger->set(&v,i);
+            if(h.find(&v) == (i%3==0))
+                die("wrong key found after deletion");
+        }
+        if(h.count() != HCOUNT-(HCOUNT+2)/3)
+            die("wrong count after deletion");
+        Types::tInteger->set(&v,0);
+        if(h.del(&v))
+            die("deleted key deleted twice");
+        
+        // put them back, so the deleted entries get squeezed out
+        for(int i=0;i<HCOUNT;i+=3){
+            Types::tInteger->set(&v,i);
+            Types::tInteger->set(&w,-i);
+            h.set(&v,&w);
+        }
+        for(int i=0;i<HCOUNT;i++){
+            Types::tInteger->set(&v,i);
+            if(!h.find(&v))
+                die("key not found after reinsertion");
+            if(h.getval()->toInt() != (i%3 ? i*2 : -i))
+                die("value mismatch after reinsertion");
+        }
+        if(h.count() != HCOUNT)
+            die("wrong count after reinsertion");
+    }
+    
+    void t4(){
+        // reserving room
+        printf("test 4, reserve----\n");
+        Hash h;
+        Value v,w;
+        
+        h.reserve(HCOUNT);
+        int size = h.mask;
+        for(int i=0;i<HCOUNT;i++){
+            Types::tInteger->set(&v,i);
+            h.set(&v,&v);
+        }
+        if(h.mask != size)
+            die("reserved hash resized");
+        // and reserving more once there are keys in it
+        for(int i=HCOUNT;i<HCOUNT*2;i++){
+            Types::tInteger->set(&v,i);
+            h.set(&v,&v);
+        }
+        h.reserve(HCOUNT*8);
+        for(int i=0;i<HCOUNT*2;i++){
+            Types::tInteger->set(&v,i);
+            if(!h.find(&v) || h.getval()->toInt()!=i)
+                die("key lost in reserve");
+        }
+    }
+    
+    void t5(){
+        // finding, changing and deleting keys during an incremental
+        // resize, when they may be in either table
+        printf("test 5, incremental resize----\n");
+        Hash h;
+        Value v,w;
+        
+        int n=0;
+        while(n<HCOUNT*2 && !h.oldtable){
+            Types::tInteger->set(&v,n);
+            h.set(&v,&v);
+            n++;
+        }
+        if(!h.oldtable)
+            die("no incremental resize");
+        for(int i=0;i<n;i++){
+            Types::tInteger->set(&v,i);
+            if(!h.find(&v) || h.getval()->toInt()!=i)
+                die("key lost during resize");
+        }
+        int ct=0;
+        for(int i=h.nextUsed(0);i>=0;i=h.nextUsed(i+1))
+            ct++;
+        if(ct!=n || h.count()!=n)
+            die("wrong count during resize");
+        
+        // overwrite and delete keys, most of which are still in the
+        // old table
+        for(int i=0;i<n;i+=2){
+            Types::tInteger->set(&v,i);
+            Types::tInteger->set(&w,-i);
+            h.set(&v,&w);
+        }
+        for(int i=1;i<n;i+=4){
+            Types::tInteger->set(&v,i);
+            if(!h.del(&v))
+                die("key not deleted during resize");
+        }
+        if(h.oldtable)
+            die("resize not finished");
+        for(int i=0;i<n;i++){
+            Types::tInteger->set(&v,i);
+            bool found = h.find(&v);
+            if(found != (i%4!=1))
+                die("wrong key found after resize");
+            if(found && h.getval()->toInt() != (i%2 ? i : -i))
+                die("value mismatch after resize");
+        }
+        if(h.count() != n-(n+2)/4)
+            die("wrong count after resize");
+    }
+    
+    static double now(){
+        timeval tv;
+        gettimeofday(&tv,NULL);
+        return tv.tv_sec+tv.tv_usec*1e-6;
+    }
+    
+    void bench(){
+        // timings, for comparison between implementations. Only run
+        // if HASHBENCH is set to the number of keys.
+        int n = atoi(getenv("HASHBENCH"));
+        printf("benchmark, %d keys----\n",n);
+        Hash h;
+        Value v,w;
+        double worst=0;
+        
+        double t = now();
+        for(int i=0;i<n;i++){
+            double t0 = now();
+            Types::tInteger->set(&v,i*31);
+            h.set(&v,&w);
+            t0 = now()-t0;
+            if(t0>worst)worst=t0;
+        }
+        printf("  int set     %8.3fs (slowest set %.3fms)\n",now()-t,worst*1000);
+        t = now();
+        for(int i=0;i<n*2;i++){
+            Types::tInteger->set(&v,i*31);
+            h.find(&v);
+        }
+        printf("  int find    %8.3fs (half hits)\n",now()-t);
+        t = now();
+        for(int i=0;i<n;i++){
+            // the same keys, in a scattered order
+            Types::tInteger->set(&v,(int)(((uint32_t)i*2654435761u)%n)*31);
+            h.find(&v);
+        }
+        printf("  int scatter %8.3fs\n",now()-t);
+        t = now();
+        for(int i=0;i<n;i+=2){
+            Types::tInteger->set(&v,i*31);
+            h.del(&v);
+        }
+        for(int i=0;i<n;i+=2){
+            Types::tInteger->set(&v,i*31+1);
+            h.set(&v,&w);
+        }
+        printf("  int churn   %8.3fs\n",now()-t);
+        
+        Hash hs;
+        char buf[32];
+        t = now();
+        for(int i=0;i<n;i++){
+            sprintf(buf,"foo%x",i);
+            Types::tString->set(&v,buf);
+            hs.set(&v,&w);
+        }
+        printf("  string set  %8.3fs\n",now()-t);
+        t = now();
+        for(int i=0;i<n;i++){
+            sprintf(buf,"foo%x",i);
+            Types::tString->set(&v,buf);
+            hs.find(&v);
+        }
+        printf("  string find %8.3fs\n",now()-t);
+    }
+    
     virtual void run(Angort *a){
         
         Hash h;
@@ -89,6 +278,11 @@ public:
         
         t1();
         t2();
+        t3();
+        t4();
+        t5();
+        if(getenv("HASHBENCH"))
+            bench();
     
     }
 };
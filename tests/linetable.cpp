@@ -0,0 +1,52 @@
+/**
+ * @file
+ * Source positions of running code.
+ *
+ * An exception thrown from inside a word should report the line in
+ * the word where it happened, found through the codeblock's own
+ * table of positions.
+ */
+
+#include "test.h"
+
+class LineTableTest : public Test {
+public:
+    LineTableTest() : Test("LineTable") {
+        suite.add(this);
+    }
+
+    /// run some code which should throw, returning the line it
+    /// was thrown at
+    int thrownAt(Angort *a,const char *code){
+        try {
+            a->feed(code);
+        } catch(Exception& e){
+            if(!e.srcFile)
+                die("exception has no source position");
+            return e.srcLine;
+        }
+        die("no exception thrown");
+        return -1;
+    }
+
+    virtual void run(Angort *a){
+        a->run->traceOnException=false;
+        a->feed(":linetest_inner |x:|");
+        a->feed("  ?x 1 +");
+        a->feed("  ?x 0 /");
+        a->feed(";");
+        a->feed(":linetest_outer");
+        a->feed("  1 2 +");
+        a->feed("  linetest_inner");
+        a->feed(";");
+
+        // the division is on the third line fed
+        if(thrownAt(a,"10 linetest_inner")!=3)
+            die("wrong line for exception in word");
+        // and is still reported there when called from another word
+        if(thrownAt(a,"linetest_outer")!=3)
+            die("wrong line for exception in nested word");
+    }
+};
+
+LineTableTest LineTable;
@@ -0,0 +1,33 @@
+/**
+ * @file
+ * Ranges and the cycle detector.
+ *
+ * A range holds no values, so the cycle detector should be given no
+ * iterators over it; otherwise it steps through every number in the
+ * range each time it runs.
+ */
+
+#include "test.h"
+
+class RangeGCTest : public Test {
+public:
+    RangeGCTest() : Test("RangeGC") {
+        suite.add(this);
+    }
+
+    virtual void run(Angort *a){
+        a->feed("0 1000000000 range 0.0 1.0 0.5 frange");
+        Value *fr = a->run->stack.peekptr(0);
+        Value *ir = a->run->stack.peekptr(1);
+        if(ir->v.irange->makeGCValueIterator() ||
+           ir->v.irange->makeGCKeyIterator())
+            die("int range has GC iterators");
+        if(fr->v.frange->makeGCValueIterator() ||
+           fr->v.frange->makeGCKeyIterator())
+            die("float range has GC iterators");
+        // which would make this take minutes
+        a->feed("!RangeF !RangeI gc");
+    }
+};
+
+RangeGCTest RangeGC;
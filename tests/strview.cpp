@@ -0,0 +1,53 @@
+/**
+ * @file
+ * String views and the reference counts of the strings they view.
+ *
+ * Every view holds a reference to its string, so splitting a string
+ * into many pieces can take its count far past what a 16-bit count
+ * holds; the string must still be freed when they've all gone. Views
+ * also mustn't change when their string does.
+ */
+
+#include "test.h"
+
+#define VIEWCOUNT 70000
+
+class StrViewTest : public Test {
+public:
+    StrViewTest() : Test("StrView") {
+        suite.add(this);
+    }
+
+    virtual void run(Angort *a){
+        Value s;
+        Types::tString->set(&s,"a string which is long enough to be viewed");
+        BlockAllocHeader *h = s.v.block;
+        
+        Value *views = new Value[VIEWCOUNT];
+        for(int i=0;i<VIEWCOUNT;i++)
+            Types::tStrView->set(views+i,h,2,6,6);
+        if(h->refct != VIEWCOUNT+1)
+            die("wrong reference count with many views");
+        if(strcmp(views[VIEWCOUNT-1].toString().get(),"string"))
+            die("wrong view contents");
+        
+        // changing the string moves the views, and their references,
+        // onto a copy of it
+        Value k,c;
+        Types::tInteger->set(&k,2);
+        Types::tString->set(&c,"S");
+        s.t->setValue(&s,&k,&c);
+        if(h->refct != 1 || h->views)
+            die("views not moved off a changed string");
+        BlockAllocHeader *copy = Types::tStrView->getParent(views);
+        if(copy==h || copy->refct != VIEWCOUNT)
+            die("views not moved onto a copy");
+        if(strcmp(views[VIEWCOUNT-1].toString().get(),"string"))
+            die("view changed with its string");
+        delete [] views;
+        if(h->refct != 1)
+            die("reference count not dropped by views");
+    }
+};
+
+StrViewTest StrView;